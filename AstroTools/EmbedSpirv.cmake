@@ -0,0 +1,38 @@
+# Turns a SPIR-V binary into a header holding it as a constexpr uint32_t array, run at build time:
+#   cmake -DINPUT=<file.spv> -DOUTPUT=<file.h> -DVARIABLE=<array name> -P EmbedSpirv.cmake
+
+if( NOT INPUT OR NOT OUTPUT OR NOT VARIABLE )
+	message( FATAL_ERROR "EmbedSpirv.cmake needs INPUT, OUTPUT and VARIABLE" )
+endif()
+
+file( READ ${INPUT} spirvHex HEX )
+string( LENGTH "${spirvHex}" spirvHexLength )
+math( EXPR spirvWordRemainder "${spirvHexLength} % 8" )
+if( spirvHexLength EQUAL 0 OR NOT spirvWordRemainder EQUAL 0 )
+	message( FATAL_ERROR "${INPUT} isn't a SPIR-V binary (size isn't a multiple of 4 bytes)" )
+endif()
+
+# SPIR-V is a stream of little endian words, swap every word's bytes back in order
+string( REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1," spirvWords "${spirvHex}" )
+# 8 words a line (CMake regexes have no {n} repetition)
+set( wordPattern "0x[0-9a-f]+," )
+string( REGEX REPLACE "(${wordPattern}${wordPattern}${wordPattern}${wordPattern}${wordPattern}${wordPattern}${wordPattern}${wordPattern})" "\\1\n\t" spirvWords "${spirvWords}" )
+
+get_filename_component( inputName ${INPUT} NAME )
+file( WRITE ${OUTPUT}.tmp
+	"#pragma once\n"
+	"\n"
+	"// Generated from ${inputName} by AstroTools/EmbedSpirv.cmake, don't edit\n"
+	"\n"
+	"#include <cstdint>\n"
+	"\n"
+	"namespace Shaders\n"
+	"{\n"
+	"\tconstexpr uint32_t ${VARIABLE}[] = {\n"
+	"\t${spirvWords}\n"
+	"\t};\n"
+	"} // namespace Shaders\n" )
+
+# Only touch the header when the shader really changed, saves rebuilding everything including it
+configure_file( ${OUTPUT}.tmp ${OUTPUT} COPYONLY )
+file( REMOVE ${OUTPUT}.tmp )
@@ -1 +0,0 @@
-glslc $1 -o $1.spirv
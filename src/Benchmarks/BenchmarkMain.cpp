@@ -0,0 +1,54 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <Benchmarks/Benchmarks.h>
+
+struct BenchmarkEntry
+{
+	const char* name;
+	void ( *run )();
+};
+
+const BenchmarkEntry All_Benchmarks[] = {
+	{ "octree", Benchmarks::RunOctreeBenchmark },
+	{ "compression", Benchmarks::RunCompressionBenchmark },
+	{ "mesher", Benchmarks::RunMesherBenchmark },
+	{ "lod", Benchmarks::RunLodBenchmark },
+	{ "edit", Benchmarks::RunEditBenchmark },
+	{ "occupancy", Benchmarks::RunOccupancyBenchmark },
+	{ "jobs", Benchmarks::RunJobSystemBenchmark },
+};
+
+int main( int argc, char** argv )
+{
+	const char* selectedName = argc > 1 ? argv[1] : nullptr;
+
+	try
+	{
+		bool foundBenchmark = false;
+		for( const auto& benchmark : All_Benchmarks )
+		{
+			if( selectedName == nullptr || strcmp( selectedName, benchmark.name ) == 0 )
+			{
+				std::cout << "=== " << benchmark.name << " ===\n";
+				benchmark.run();
+				foundBenchmark = true;
+			}
+		}
+
+		if( !foundBenchmark )
+		{
+			std::cerr << "unknown benchmark: " << selectedName << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	catch( const std::exception& e )
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
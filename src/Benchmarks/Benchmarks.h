@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <Voxel/CompressedVoxelChunk.h>
+
+//-----------------------
+// Standalone CPU benchmarks, these don't need a GPU or a window.
+// Run "AstroBench" for all of them, or "AstroBench <name>" for a single one.
+
+namespace Benchmarks
+{
+	void RunOctreeBenchmark();
+	void RunCompressionBenchmark();
+	void RunMesherBenchmark();
+	void RunLodBenchmark();
+	void RunEditBenchmark();
+	void RunOccupancyBenchmark();
+	void RunJobSystemBenchmark();
+
+	class Stopwatch
+	{
+	  public:
+		Stopwatch()
+		  : m_start( std::chrono::steady_clock::now() )
+		{
+		}
+
+		double ElapsedSeconds() const
+		{
+			return std::chrono::duration<double>( std::chrono::steady_clock::now() - m_start ).count();
+		}
+
+	  private:
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	inline const char* SimdPathName( CompressedVoxelChunk::SimdPath simdPath )
+	{
+		switch( simdPath )
+		{
+		case CompressedVoxelChunk::SimdPath::Avx2:
+			return "avx2";
+		case CompressedVoxelChunk::SimdPath::Sse41:
+			return "sse4.1";
+		case CompressedVoxelChunk::SimdPath::Scalar:
+			break;
+		}
+		return "scalar";
+	}
+
+	inline double ToMiB( size_t bytes )
+	{
+		return static_cast<double>( bytes ) / ( 1024.0 * 1024.0 );
+	}
+
+	// 1, 2, 4, ... up to the hardware thread count (included), to see how parallel work scales
+	inline std::vector<uint32_t> GetThreadCountsToMeasure()
+	{
+		const uint32_t hardwareThreadCount = std::max( 1u, std::thread::hardware_concurrency() );
+		std::vector<uint32_t> threadCounts;
+		for( uint32_t threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2 )
+		{
+			threadCounts.push_back( threadCount );
+		}
+		threadCounts.push_back( hardwareThreadCount );
+		return threadCounts;
+	}
+} // namespace Benchmarks
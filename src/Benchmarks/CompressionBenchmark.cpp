@@ -0,0 +1,144 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <Voxel/CompressedVoxelChunk.h>
+#include <Voxel/SparseVoxelOctree.h>
+
+namespace
+{
+	// Terrain chunks along a hillside: air above, a few layered materials below, some scattered ores
+	std::vector<int8_t> GenerateTerrainChunk( const glm::ivec3& chunkCoord, std::mt19937& rng )
+	{
+		std::vector<int8_t> voxels( VOXEL_CHUNK_VOXEL_COUNT, 0 );
+		std::uniform_int_distribution<int> oreChance( 0, 199 );
+
+		const glm::ivec3 origin = chunkCoord * VOXEL_CHUNK_SIZE;
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+			{
+				const float worldX = static_cast<float>( origin.x + x );
+				const float worldZ = static_cast<float>( origin.z + z );
+				const int32_t height = static_cast<int32_t>( 24.0f * std::sin( worldX * 0.03f ) * std::cos( worldZ * 0.05f ) ) - origin.y;
+
+				for( int32_t y = 0; y < std::min( height, VOXEL_CHUNK_SIZE ); ++y )
+				{
+					int8_t material = y + 1 >= height ? 1 : ( y + 5 >= height ? 2 : 3 );
+					if( material == 3 && oreChance( rng ) == 0 )
+					{
+						material = 4;
+					}
+					voxels[VoxelChunkIndex( x, y, z )] = material;
+				}
+			}
+		}
+
+		return voxels;
+	}
+} // namespace
+
+void Benchmarks::RunCompressionBenchmark()
+{
+	// Only chunks crossing the surface, fully empty/solid ones compress to almost nothing and would flatter the ratio
+	std::mt19937 rng( 42 );
+	std::vector<std::vector<int8_t>> denseChunks;
+	for( int32_t z = 0; z < 8; ++z )
+	{
+		for( int32_t x = 0; x < 8; ++x )
+		{
+			for( int32_t y = -1; y <= 0; ++y )
+			{
+				denseChunks.push_back( GenerateTerrainChunk( glm::ivec3( x, y, z ), rng ) );
+			}
+		}
+	}
+
+	// Worst case: random noise over 100 materials
+	std::uniform_int_distribution<int> noise( 0, 99 );
+	std::vector<int8_t> noiseChunk( VOXEL_CHUNK_VOXEL_COUNT );
+	for( auto& voxel : noiseChunk )
+	{
+		voxel = static_cast<int8_t>( noise( rng ) );
+	}
+	denseChunks.push_back( noiseChunk );
+
+	size_t octreeBytes = 0;
+	for( const auto& denseChunk : denseChunks )
+	{
+		SparseVoxelOctree octree( VOXEL_CHUNK_SIZE );
+		octree.SetFromDense( denseChunk.data() );
+		octreeBytes += octree.GetMemoryFootprint();
+	}
+
+	const CompressedVoxelChunk::SimdPath bestSimdPath = CompressedVoxelChunk::GetSimdPath();
+	const CompressedVoxelChunk::SimdPath simdPaths[] = { CompressedVoxelChunk::SimdPath::Scalar, CompressedVoxelChunk::SimdPath::Sse41, CompressedVoxelChunk::SimdPath::Avx2 };
+
+	std::vector<int8_t> scratch( VOXEL_CHUNK_VOXEL_COUNT );
+	constexpr int repeatCount = 20;
+	for( const auto simdPath : simdPaths )
+	{
+		if( simdPath > bestSimdPath )
+		{
+			continue;
+		}
+		CompressedVoxelChunk::SetSimdPath( simdPath );
+
+		std::vector<CompressedVoxelChunk> compressedChunks;
+		Benchmarks::Stopwatch encodeTimer;
+		for( int repeat = 0; repeat < repeatCount; ++repeat )
+		{
+			compressedChunks.clear();
+			for( const auto& denseChunk : denseChunks )
+			{
+				compressedChunks.push_back( CompressedVoxelChunk::Encode( denseChunk.data() ) );
+			}
+		}
+		const double encodeSeconds = encodeTimer.ElapsedSeconds();
+
+		Benchmarks::Stopwatch decodeTimer;
+		for( int repeat = 0; repeat < repeatCount; ++repeat )
+		{
+			for( const auto& compressedChunk : compressedChunks )
+			{
+				compressedChunk.Decode( scratch.data() );
+			}
+		}
+		const double decodeSeconds = decodeTimer.ElapsedSeconds();
+
+		size_t compressedBytes = 0;
+		for( size_t i = 0; i < compressedChunks.size(); ++i )
+		{
+			compressedChunks[i].Decode( scratch.data() );
+			if( memcmp( scratch.data(), denseChunks[i].data(), VOXEL_CHUNK_VOXEL_COUNT ) != 0 )
+			{
+				throw std::runtime_error( "compressed chunk doesn't decode to its source!" );
+			}
+			compressedBytes += compressedChunks[i].GetMemoryFootprint();
+		}
+
+		const double chunkCount = static_cast<double>( compressedChunks.size() );
+		const size_t denseBytes = compressedChunks.size() * VOXEL_CHUNK_VOXEL_COUNT;
+		printf( "%-7s: encode %.1f us/chunk, decode %.1f us/chunk\n",
+		  Benchmarks::SimdPathName( simdPath ),
+		  encodeSeconds / ( chunkCount * repeatCount ) * 1e6,
+		  decodeSeconds / ( chunkCount * repeatCount ) * 1e6 );
+
+		if( simdPath == CompressedVoxelChunk::SimdPath::Scalar )
+		{
+			printf( "%zu chunks: dense %.2f MiB, octree %.2f MiB, compressed %.2f MiB (%.1fx smaller than dense)\n",
+			  compressedChunks.size(),
+			  Benchmarks::ToMiB( denseBytes ),
+			  Benchmarks::ToMiB( octreeBytes ),
+			  Benchmarks::ToMiB( compressedBytes ),
+			  static_cast<double>( denseBytes ) / static_cast<double>( compressedBytes ) );
+		}
+	}
+
+	CompressedVoxelChunk::SetSimdPath( bestSimdPath );
+}
@@ -0,0 +1,131 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <Jobs/JobSystem.h>
+#include <Voxel/VoxelChunkManager.h>
+#include <Voxel/VoxelEditQueue.h>
+
+namespace
+{
+	constexpr float VIEW_DISTANCE = 6.0f * VOXEL_CHUNK_SIZE;
+
+	// Rolling hills, stone under a grass layer
+	std::unique_ptr<VoxelObject> GenerateChunk( const glm::ivec3& chunkCoord )
+	{
+		const glm::ivec3 origin = chunkCoord * VOXEL_CHUNK_SIZE;
+		if( origin.y >= 64 || origin.y + VOXEL_CHUNK_SIZE <= -64 )
+		{
+			return nullptr;
+		}
+
+		auto chunk = std::make_unique<VoxelObject>( VoxelChunkManager::ChunkCoordToWorld( chunkCoord ), VOXEL_CHUNK_SIZE );
+		SparseVoxelOctree& voxelData = chunk->GetVoxelData();
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+			{
+				const float worldX = static_cast<float>( origin.x + x );
+				const float worldZ = static_cast<float>( origin.z + z );
+				const int32_t height = static_cast<int32_t>( 16.0f * std::sin( worldX * 0.05f ) * std::cos( worldZ * 0.04f ) ) - origin.y;
+				if( height > 0 )
+				{
+					voxelData.FillRegion( glm::ivec3( x, 0, z ), glm::ivec3( x + 1, height - 1, z + 1 ), 2 );
+					voxelData.FillRegion( glm::ivec3( x, height - 1, z ), glm::ivec3( x + 1, height, z + 1 ), 1 );
+				}
+			}
+		}
+		return chunk;
+	}
+} // namespace
+
+void Benchmarks::RunEditBenchmark()
+{
+	JobSystem jobSystem;
+	VoxelChunkManager chunkManager( 1024 * 1024 * 1024, VIEW_DISTANCE );
+	chunkManager.SetJobSystem( &jobSystem );
+	chunkManager.SetCompressDistance( VIEW_DISTANCE );
+	chunkManager.SetChunkLoader( GenerateChunk );
+	// Loads are capped per update, keep going until everything in view is resident
+	size_t residentCount = 0;
+	do
+	{
+		residentCount = chunkManager.GetResidentChunkCount();
+		chunkManager.Update( glm::vec3( 0.0f ) );
+	} while( chunkManager.GetResidentChunkCount() != residentCount );
+
+	// Remeshes what's dirty the way Scene::Render does (edits can fill empty chunks), returns how many chunks that was
+	std::vector<std::pair<glm::ivec3, VoxelObject*>> chunks;
+	auto remeshDirtyChunks = [&]() {
+		chunks.clear();
+		chunkManager.ForEachChunk( [&chunks]( const glm::ivec3& chunkCoord, VoxelObject& chunk ) {
+			chunks.emplace_back( chunkCoord, &chunk );
+		} );
+
+		std::atomic<uint32_t> remeshedCount{ 0 };
+		jobSystem.ParallelFor( chunks.size(), [&]( size_t index ) {
+			if( !chunks[index].second->IsMeshDirty() )
+			{
+				return;
+			}
+			const VoxelObject* neighbours[6];
+			chunkManager.FindNeighbours( chunks[index].first, neighbours );
+			chunks[index].second->Render( neighbours );
+			remeshedCount.fetch_add( 1, std::memory_order_relaxed );
+		} );
+		return remeshedCount.load();
+	};
+
+	Benchmarks::Stopwatch fullRemeshTimer;
+	remeshDirtyChunks();
+	const double fullRemeshSeconds = fullRemeshTimer.ElapsedSeconds();
+	printf( "%zu non-empty chunks, remeshing them all: %.2f ms\n", chunks.size(), fullRemeshSeconds * 1e3 );
+
+	// Sculpt strokes along the surface, a few brush dabs per frame. Strokes alternate carving & adding back.
+	VoxelEditQueue editQueue;
+	for( float radius : { 2.0f, 6.0f, 12.0f } )
+	{
+		constexpr int frameCount = 64;
+		constexpr int dabsPerFrame = 4;
+		double applySeconds = 0.0;
+		double remeshSeconds = 0.0;
+		uint64_t touchedCount = 0;
+		uint64_t changedCount = 0;
+		uint64_t neighbourCount = 0;
+		uint64_t remeshedCount = 0;
+		for( int frame = 0; frame < frameCount; ++frame )
+		{
+			for( int dab = 0; dab < dabsPerFrame; ++dab )
+			{
+				const float x = -96.0f + static_cast<float>( frame * dabsPerFrame + dab ) * 0.75f;
+				const float z = 20.0f * std::sin( x * 0.02f );
+				const float y = 16.0f * std::sin( x * 0.05f ) * std::cos( z * 0.04f );
+				editQueue.FillSphere( glm::vec3( x, y, z ), radius, ( frame / 16 ) % 2 == 0 ? 0 : 3 );
+			}
+
+			Benchmarks::Stopwatch applyTimer;
+			editQueue.Apply( chunkManager, &jobSystem );
+			applySeconds += applyTimer.ElapsedSeconds();
+
+			Benchmarks::Stopwatch remeshTimer;
+			remeshedCount += remeshDirtyChunks();
+			remeshSeconds += remeshTimer.ElapsedSeconds();
+
+			touchedCount += editQueue.GetTouchedChunkCount();
+			changedCount += editQueue.GetChangedChunkCount();
+			neighbourCount += editQueue.GetDirtiedNeighbourCount();
+		}
+
+		printf( "radius %4.1f: %.1f chunks touched, %.1f changed, %.1f neighbours dirtied, %.1f remeshed per frame: apply %.3f ms, remesh %.3f ms\n",
+		  radius,
+		  static_cast<double>( touchedCount ) / frameCount,
+		  static_cast<double>( changedCount ) / frameCount,
+		  static_cast<double>( neighbourCount ) / frameCount,
+		  static_cast<double>( remeshedCount ) / frameCount,
+		  applySeconds / frameCount * 1e3,
+		  remeshSeconds / frameCount * 1e3 );
+	}
+}
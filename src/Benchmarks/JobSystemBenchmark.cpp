@@ -0,0 +1,75 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include <Jobs/JobSystem.h>
+
+namespace
+{
+	// Stand-in for per object simulation work, a few microseconds each
+	float SimulateObject( uint32_t objectIndex )
+	{
+		float value = static_cast<float>( objectIndex );
+		for( int i = 0; i < 500; ++i )
+		{
+			value = std::sin( value ) * 0.5f + 1.0f;
+		}
+		return value;
+	}
+} // namespace
+
+void Benchmarks::RunJobSystemBenchmark()
+{
+	constexpr uint32_t objectCount = 16 * 1024;
+	std::vector<float> results( objectCount );
+
+	Benchmarks::Stopwatch serialTimer;
+	for( uint32_t i = 0; i < objectCount; ++i )
+	{
+		results[i] = SimulateObject( i );
+	}
+	const double serialSeconds = serialTimer.ElapsedSeconds();
+	printf( "%u objects, 1 thread, no jobs: %.2f ms\n", objectCount, serialSeconds * 1000.0 );
+
+	for( uint32_t threadCount : Benchmarks::GetThreadCountsToMeasure() )
+	{
+		JobSystem jobSystem( threadCount - 1 );
+
+		// Per object work through ParallelFor
+		Benchmarks::Stopwatch parallelForTimer;
+		jobSystem.ParallelFor( objectCount, [&results]( size_t index ) {
+			results[index] = SimulateObject( static_cast<uint32_t>( index ) );
+		} );
+		const double parallelForSeconds = parallelForTimer.ElapsedSeconds();
+
+		// Raw scheduling cost: empty jobs, a chain of dependent groups on top
+		constexpr uint32_t emptyJobCount = 100000;
+		std::atomic<uint32_t> executedJobCount{ 0 };
+		Benchmarks::Stopwatch overheadTimer;
+		JobCounter firstGroup;
+		JobCounter secondGroup;
+		for( uint32_t i = 0; i < emptyJobCount / 2; ++i )
+		{
+			jobSystem.Submit( [&executedJobCount]() { ++executedJobCount; }, &firstGroup );
+		}
+		for( uint32_t i = 0; i < emptyJobCount / 2; ++i )
+		{
+			jobSystem.SubmitAfter( firstGroup, [&executedJobCount]() { ++executedJobCount; }, &secondGroup );
+		}
+		jobSystem.Wait( secondGroup );
+		const double overheadSeconds = overheadTimer.ElapsedSeconds();
+
+		if( executedJobCount != emptyJobCount )
+		{
+			printf( "  job count mismatch: %u instead of %u!\n", executedJobCount.load(), emptyJobCount );
+		}
+
+		printf( "  %2u threads: parallel for %.2f ms (%.1fx), %.2f us/empty job\n",
+		  threadCount,
+		  parallelForSeconds * 1000.0,
+		  serialSeconds / parallelForSeconds,
+		  overheadSeconds * 1e6 / emptyJobCount );
+	}
+}
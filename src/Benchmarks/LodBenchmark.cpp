@@ -0,0 +1,183 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <Voxel/VoxelMipChain.h>
+#include <Voxel/VoxelObject.h>
+
+namespace
+{
+	constexpr int32_t GRID_SIZE_XZ = 6;
+	constexpr int32_t GRID_SIZE_Y = 3;
+
+	// Hilly terrain with caves, the thin cave walls are what the downsampling has to keep
+	std::vector<int8_t> GenerateDenseChunk( const glm::ivec3& chunkCoord )
+	{
+		const glm::ivec3 origin = chunkCoord * VOXEL_CHUNK_SIZE;
+		std::vector<int8_t> voxels( VOXEL_CHUNK_VOXEL_COUNT, 0 );
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t y = 0; y < VOXEL_CHUNK_SIZE; ++y )
+			{
+				for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+				{
+					const glm::vec3 world = glm::vec3( origin + glm::ivec3( x, y, z ) );
+					const float height = 48.0f + 20.0f * std::sin( world.x * 0.04f ) * std::cos( world.z * 0.03f );
+					const float cave = std::sin( world.x * 0.15f ) + std::sin( world.y * 0.2f ) + std::sin( world.z * 0.17f );
+					if( world.y < height && cave < 1.6f )
+					{
+						voxels[VoxelChunkIndex( x, y, z )] = world.y + 1.0f >= height ? 1 : ( world.y + 4.0f >= height ? 2 : 3 );
+					}
+				}
+			}
+		}
+		return voxels;
+	}
+
+	int32_t GridIndex( const glm::ivec3& chunkCoord )
+	{
+		return ( chunkCoord.z * GRID_SIZE_Y + chunkCoord.y ) * GRID_SIZE_XZ + chunkCoord.x;
+	}
+
+	size_t GetMipChainSize()
+	{
+		size_t size = 0;
+		for( uint32_t level = 1; level < VOXEL_MIP_LEVEL_COUNT; ++level )
+		{
+			const size_t levelSize = static_cast<size_t>( VoxelMipChain::GetLevelSize( level ) );
+			size += levelSize * levelSize * levelSize;
+		}
+		return size;
+	}
+} // namespace
+
+void Benchmarks::RunLodBenchmark()
+{
+	std::vector<glm::ivec3> chunkCoords;
+	std::vector<std::vector<int8_t>> denseChunks;
+	for( int32_t z = 0; z < GRID_SIZE_XZ; ++z )
+	{
+		for( int32_t y = 0; y < GRID_SIZE_Y; ++y )
+		{
+			for( int32_t x = 0; x < GRID_SIZE_XZ; ++x )
+			{
+				chunkCoords.emplace_back( x, y, z );
+				denseChunks.push_back( GenerateDenseChunk( chunkCoords.back() ) );
+			}
+		}
+	}
+
+	// Mip chain builds, every path must match the scalar one
+	std::vector<VoxelMipChain> referenceMips( denseChunks.size() );
+	const VoxelMipChain::SimdPath bestSimdPath = VoxelMipChain::GetSimdPath();
+	const VoxelMipChain::SimdPath simdPaths[] = { VoxelMipChain::SimdPath::Scalar, VoxelMipChain::SimdPath::Sse41, VoxelMipChain::SimdPath::Avx2 };
+
+	constexpr int buildRepeatCount = 20;
+	for( const auto simdPath : simdPaths )
+	{
+		if( simdPath > bestSimdPath )
+		{
+			continue;
+		}
+		VoxelMipChain::SetSimdPath( simdPath );
+
+		std::vector<VoxelMipChain> mips( denseChunks.size() );
+		Benchmarks::Stopwatch buildTimer;
+		for( int repeat = 0; repeat < buildRepeatCount; ++repeat )
+		{
+			for( size_t i = 0; i < denseChunks.size(); ++i )
+			{
+				mips[i].Build( denseChunks[i].data() );
+			}
+		}
+		const double buildSeconds = buildTimer.ElapsedSeconds();
+
+		if( simdPath == VoxelMipChain::SimdPath::Scalar )
+		{
+			referenceMips = mips;
+		}
+		for( size_t i = 0; i < mips.size(); ++i )
+		{
+			if( memcmp( mips[i].GetLevel( 1 ), referenceMips[i].GetLevel( 1 ), GetMipChainSize() ) != 0 )
+			{
+				throw std::runtime_error( "mip chain doesn't match the scalar one!" );
+			}
+		}
+
+		printf( "%-7s: build mips %.1f us/chunk\n",
+		  Benchmarks::SimdPathName( simdPath ),
+		  buildSeconds / ( static_cast<double>( mips.size() ) * buildRepeatCount ) * 1e6 );
+	}
+	VoxelMipChain::SetSimdPath( bestSimdPath );
+
+	// Meshing cost & resident voxels per LOD, the whole grid at the same LOD (neighbours included).
+	// Chunks get coarsened level after level, as streaming does with far ones.
+	std::vector<std::unique_ptr<VoxelObject>> chunks( chunkCoords.size() );
+	for( size_t i = 0; i < chunkCoords.size(); ++i )
+	{
+		auto chunk = std::make_unique<VoxelObject>( glm::vec3( chunkCoords[i] * VOXEL_CHUNK_SIZE ), VOXEL_CHUNK_SIZE );
+		chunk->GetVoxelData().SetFromDense( denseChunks[i].data() );
+		chunks[GridIndex( chunkCoords[i] )] = std::move( chunk );
+	}
+
+	auto findChunk = [&]( const glm::ivec3& chunkCoord ) -> const VoxelObject* {
+		if( chunkCoord.x < 0 || chunkCoord.y < 0 || chunkCoord.z < 0 || chunkCoord.x >= GRID_SIZE_XZ || chunkCoord.y >= GRID_SIZE_Y || chunkCoord.z >= GRID_SIZE_XZ )
+		{
+			return nullptr;
+		}
+		return chunks[GridIndex( chunkCoord )].get();
+	};
+
+	constexpr int meshRepeatCount = 5;
+	for( uint32_t lod = 0; lod < VOXEL_MIP_LEVEL_COUNT; ++lod )
+	{
+		for( auto& chunk : chunks )
+		{
+			chunk->Coarsen( lod );
+			chunk->SetLod( lod );
+			chunk->UpdateMips();
+		}
+
+		Benchmarks::Stopwatch meshTimer;
+		for( int repeat = 0; repeat < meshRepeatCount; ++repeat )
+		{
+			for( const glm::ivec3& chunkCoord : chunkCoords )
+			{
+				const VoxelObject* neighbours[6];
+				for( uint32_t faceDirection = 0; faceDirection < 6; ++faceDirection )
+				{
+					glm::ivec3 offset( 0 );
+					offset[faceDirection / 2] = ( faceDirection % 2 ) == 0 ? 1 : -1;
+					neighbours[faceDirection] = findChunk( chunkCoord + offset );
+				}
+
+				VoxelObject& chunk = *chunks[GridIndex( chunkCoord )];
+				chunk.MarkMeshDirty();
+				chunk.Render( neighbours );
+			}
+		}
+		const double meshSeconds = meshTimer.ElapsedSeconds();
+
+		size_t triangleCount = 0;
+		size_t meshBytes = 0;
+		size_t voxelBytes = 0; // everything but the mesh
+		for( const auto& chunk : chunks )
+		{
+			triangleCount += chunk->GetMesh().GetTriangleCount();
+			meshBytes += chunk->GetMesh().vertices.size() * sizeof( uint32_t ) + chunk->GetMesh().indices.size() * sizeof( uint32_t );
+			voxelBytes += chunk->GetMemoryFootprint() - chunk->GetMesh().GetMemoryFootprint();
+		}
+
+		const double chunkCount = static_cast<double>( chunks.size() );
+		printf( "LOD %u: %.1f triangles/chunk, %.1f KiB of vertex+index data/chunk, meshing %.1f us/chunk, %.1f KiB resident/chunk\n",
+		  lod,
+		  static_cast<double>( triangleCount ) / chunkCount,
+		  static_cast<double>( meshBytes ) / 1024.0 / chunkCount,
+		  meshSeconds / ( chunkCount * meshRepeatCount ) * 1e6,
+		  static_cast<double>( voxelBytes ) / 1024.0 / chunkCount );
+	}
+}
@@ -0,0 +1,127 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <Jobs/JobSystem.h>
+#include <Voxel/VoxelObject.h>
+
+namespace
+{
+	constexpr int32_t GRID_SIZE_XZ = 8;
+	constexpr int32_t GRID_SIZE_Y = 3;
+
+	// Hilly terrain with caves, spread over a GRID_SIZE_XZ x GRID_SIZE_Y x GRID_SIZE_XZ grid of chunks
+	std::unique_ptr<VoxelObject> GenerateChunk( const glm::ivec3& chunkCoord )
+	{
+		const glm::ivec3 origin = chunkCoord * VOXEL_CHUNK_SIZE;
+		auto chunk = std::make_unique<VoxelObject>( glm::vec3( origin ), VOXEL_CHUNK_SIZE );
+
+		std::vector<int8_t> voxels( VOXEL_CHUNK_VOXEL_COUNT, 0 );
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t y = 0; y < VOXEL_CHUNK_SIZE; ++y )
+			{
+				for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+				{
+					const glm::vec3 world = glm::vec3( origin + glm::ivec3( x, y, z ) );
+					const float height = 48.0f + 20.0f * std::sin( world.x * 0.04f ) * std::cos( world.z * 0.03f );
+					const float cave = std::sin( world.x * 0.15f ) + std::sin( world.y * 0.2f ) + std::sin( world.z * 0.17f );
+					if( world.y < height && cave < 1.6f )
+					{
+						voxels[VoxelChunkIndex( x, y, z )] = world.y + 1.0f >= height ? 1 : ( world.y + 4.0f >= height ? 2 : 3 );
+					}
+				}
+			}
+		}
+
+		chunk->GetVoxelData().SetFromDense( voxels.data() );
+		return chunk;
+	}
+
+	int32_t GridIndex( const glm::ivec3& chunkCoord )
+	{
+		return ( chunkCoord.z * GRID_SIZE_Y + chunkCoord.y ) * GRID_SIZE_XZ + chunkCoord.x;
+	}
+
+	const VoxelObject* FindGridChunk( const std::vector<std::unique_ptr<VoxelObject>>& chunks, const glm::ivec3& chunkCoord )
+	{
+		if( chunkCoord.x < 0 || chunkCoord.y < 0 || chunkCoord.z < 0 || chunkCoord.x >= GRID_SIZE_XZ || chunkCoord.y >= GRID_SIZE_Y || chunkCoord.z >= GRID_SIZE_XZ )
+		{
+			return nullptr;
+		}
+		return chunks[GridIndex( chunkCoord )].get();
+	}
+} // namespace
+
+void Benchmarks::RunMesherBenchmark()
+{
+	std::vector<std::unique_ptr<VoxelObject>> chunks( GRID_SIZE_XZ * GRID_SIZE_Y * GRID_SIZE_XZ );
+	std::vector<glm::ivec3> chunkCoords;
+	for( int32_t z = 0; z < GRID_SIZE_XZ; ++z )
+	{
+		for( int32_t y = 0; y < GRID_SIZE_Y; ++y )
+		{
+			for( int32_t x = 0; x < GRID_SIZE_XZ; ++x )
+			{
+				chunkCoords.emplace_back( x, y, z );
+				chunks[GridIndex( chunkCoords.back() )] = GenerateChunk( chunkCoords.back() );
+			}
+		}
+	}
+
+	auto renderChunk = [&]( size_t index ) {
+		const glm::ivec3& chunkCoord = chunkCoords[index];
+		const VoxelObject* neighbours[6];
+		for( uint32_t faceDirection = 0; faceDirection < 6; ++faceDirection )
+		{
+			glm::ivec3 offset( 0 );
+			offset[faceDirection / 2] = ( faceDirection % 2 ) == 0 ? 1 : -1;
+			neighbours[faceDirection] = FindGridChunk( chunks, chunkCoord + offset );
+		}
+
+		VoxelObject& chunk = *chunks[GridIndex( chunkCoord )];
+		chunk.MarkMeshDirty();
+		chunk.Render( neighbours );
+	};
+
+	constexpr int repeatCount = 5;
+	Benchmarks::Stopwatch singleThreadTimer;
+	for( int repeat = 0; repeat < repeatCount; ++repeat )
+	{
+		for( size_t i = 0; i < chunkCoords.size(); ++i )
+		{
+			renderChunk( i );
+		}
+	}
+	const double singleThreadSeconds = singleThreadTimer.ElapsedSeconds();
+
+	size_t triangleCount = 0;
+	size_t meshBytes = 0;
+	for( const auto& chunk : chunks )
+	{
+		triangleCount += chunk->GetMesh().GetTriangleCount();
+		meshBytes += chunk->GetMesh().vertices.size() * sizeof( uint32_t ) + chunk->GetMesh().indices.size() * sizeof( uint32_t );
+	}
+
+	const double meshedChunkCount = static_cast<double>( chunkCoords.size() * repeatCount );
+	printf( "%zu chunks: %.1f triangles/chunk, %.1f KiB of vertex+index data/chunk\n",
+	  chunks.size(),
+	  static_cast<double>( triangleCount ) / static_cast<double>( chunks.size() ),
+	  static_cast<double>( meshBytes ) / 1024.0 / static_cast<double>( chunks.size() ) );
+	printf( "  1 thread, no jobs: %.0f chunks/s\n", meshedChunkCount / singleThreadSeconds );
+
+	// Same meshing spread over the job system, for growing thread counts
+	for( uint32_t threadCount : Benchmarks::GetThreadCountsToMeasure() )
+	{
+		JobSystem jobSystem( threadCount - 1 );
+		Benchmarks::Stopwatch parallelTimer;
+		for( int repeat = 0; repeat < repeatCount; ++repeat )
+		{
+			jobSystem.ParallelFor( chunkCoords.size(), renderChunk );
+		}
+		printf( "  %2u threads      : %.0f chunks/s\n", threadCount, meshedChunkCount / parallelTimer.ElapsedSeconds() );
+	}
+}
@@ -0,0 +1,219 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <Voxel/VoxelChunkManager.h>
+#include <Voxel/VoxelOccupancy.h>
+#include <Voxel/VoxelRaycast.h>
+
+namespace
+{
+	constexpr float VIEW_DISTANCE = 6.0f * VOXEL_CHUNK_SIZE;
+
+	// Hilly terrain with caves
+	std::vector<int8_t> GenerateDenseChunk( const glm::ivec3& chunkCoord )
+	{
+		const glm::ivec3 origin = chunkCoord * VOXEL_CHUNK_SIZE;
+		std::vector<int8_t> voxels( VOXEL_CHUNK_VOXEL_COUNT, 0 );
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t y = 0; y < VOXEL_CHUNK_SIZE; ++y )
+			{
+				for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+				{
+					const glm::vec3 world = glm::vec3( origin + glm::ivec3( x, y, z ) );
+					const float height = 20.0f * std::sin( world.x * 0.04f ) * std::cos( world.z * 0.03f );
+					const float cave = std::sin( world.x * 0.15f ) + std::sin( world.y * 0.2f ) + std::sin( world.z * 0.17f );
+					if( world.y < height && cave < 1.6f )
+					{
+						voxels[VoxelChunkIndex( x, y, z )] = world.y + 1.0f >= height ? 1 : ( world.y + 4.0f >= height ? 2 : 3 );
+					}
+				}
+			}
+		}
+		return voxels;
+	}
+
+	// What scanning the voxels themselves costs: a branch per byte
+	uint32_t CountSolidBytewise( const int8_t* denseVoxels, uint64_t& brickMask )
+	{
+		uint32_t count = 0;
+		brickMask = 0;
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t y = 0; y < VOXEL_CHUNK_SIZE; ++y )
+			{
+				for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+				{
+					if( denseVoxels[VoxelChunkIndex( x, y, z )] != 0 )
+					{
+						++count;
+						brickMask |= 1ull << VoxelBrickIndex( x / VOXEL_BRICK_SIZE, y / VOXEL_BRICK_SIZE, z / VOXEL_BRICK_SIZE );
+					}
+				}
+			}
+		}
+		return count;
+	}
+
+	// Same stepping as VoxelRaycast::Trace, a voxel at a time over the dense voxels
+	std::optional<glm::ivec3> TraceBytewise( const std::unordered_map<glm::ivec3, std::vector<int8_t>, ChunkCoordHash>& denseChunks,
+	  const glm::vec3& origin,
+	  const glm::vec3& direction,
+	  float maxDistance )
+	{
+		const glm::vec3 safeDirection = direction + glm::vec3( glm::equal( direction, glm::vec3( 0.0f ) ) ) * 1e-7f;
+		const glm::vec3 inverseDirection = 1.0f / safeDirection;
+		const glm::ivec3 stepDirection = glm::ivec3( glm::sign( safeDirection ) );
+
+		glm::ivec3 voxel = glm::ivec3( glm::floor( origin ) );
+		for( ;; )
+		{
+			const glm::ivec3 chunkCoord = VoxelChunkManager::WorldToChunkCoord( glm::vec3( voxel ) );
+			auto denseChunk = denseChunks.find( chunkCoord );
+			if( denseChunk != denseChunks.end() )
+			{
+				const glm::ivec3 chunkVoxel = voxel - chunkCoord * VOXEL_CHUNK_SIZE;
+				if( denseChunk->second[VoxelChunkIndex( chunkVoxel.x, chunkVoxel.y, chunkVoxel.z )] != 0 )
+				{
+					return voxel;
+				}
+			}
+
+			const glm::vec3 exitPlanes = glm::vec3( voxel ) + glm::vec3( glm::greaterThan( stepDirection, glm::ivec3( 0 ) ) );
+			const glm::vec3 tCellExits = ( exitPlanes - origin ) * inverseDirection;
+			const int32_t axis = tCellExits.x < tCellExits.y ? ( tCellExits.x < tCellExits.z ? 0 : 2 ) : ( tCellExits.y < tCellExits.z ? 1 : 2 );
+			const float t = tCellExits[axis];
+			if( t > maxDistance )
+			{
+				return std::nullopt;
+			}
+
+			const glm::ivec3 nextVoxel = glm::ivec3( glm::floor( origin + direction * t ) );
+			voxel = glm::mix( glm::max( nextVoxel, voxel ), glm::min( nextVoxel, voxel ), glm::lessThan( stepDirection, glm::ivec3( 0 ) ) );
+			voxel[axis] = static_cast<int32_t>( exitPlanes[axis] ) - ( stepDirection[axis] > 0 ? 0 : 1 );
+		}
+	}
+} // namespace
+
+void Benchmarks::RunOccupancyBenchmark()
+{
+	VoxelChunkManager chunkManager( 1024 * 1024 * 1024, VIEW_DISTANCE );
+	chunkManager.SetCompressDistance( VIEW_DISTANCE );
+	chunkManager.SetChunkLoader( []( const glm::ivec3& chunkCoord ) {
+		auto chunk = std::make_unique<VoxelObject>( VoxelChunkManager::ChunkCoordToWorld( chunkCoord ), VOXEL_CHUNK_SIZE );
+		chunk->GetVoxelData().SetFromDense( GenerateDenseChunk( chunkCoord ).data() );
+		return chunk;
+	} );
+	size_t residentCount = 0;
+	do
+	{
+		residentCount = chunkManager.GetResidentChunkCount();
+		chunkManager.Update( glm::vec3( 0.0f ) );
+	} while( chunkManager.GetResidentChunkCount() != residentCount );
+
+	std::unordered_map<glm::ivec3, std::vector<int8_t>, ChunkCoordHash> denseChunks;
+	chunkManager.ForEachChunk( [&denseChunks]( const glm::ivec3& chunkCoord, VoxelObject& chunk ) {
+		std::vector<int8_t>& denseChunk = denseChunks[chunkCoord];
+		denseChunk.resize( VOXEL_CHUNK_VOXEL_COUNT );
+		chunk.CopyToDense( denseChunk.data() );
+	} );
+
+	// Counting solid voxels & finding the empty bricks: bytes against packing the occupancy & popcounts
+	constexpr int scanRepeatCount = 10;
+	uint64_t bytewiseCount = 0;
+	uint64_t bytewiseBricks = 0;
+	Benchmarks::Stopwatch bytewiseScanTimer;
+	for( int repeat = 0; repeat < scanRepeatCount; ++repeat )
+	{
+		for( const auto& denseChunk : denseChunks )
+		{
+			uint64_t brickMask;
+			bytewiseCount += CountSolidBytewise( denseChunk.second.data(), brickMask );
+			bytewiseBricks += static_cast<uint64_t>( __builtin_popcountll( brickMask ) );
+		}
+	}
+	const double bytewiseScanSeconds = bytewiseScanTimer.ElapsedSeconds();
+
+	uint64_t occupancyCount = 0;
+	uint64_t occupancyBricks = 0;
+	VoxelOccupancy occupancy;
+	Benchmarks::Stopwatch occupancyScanTimer;
+	for( int repeat = 0; repeat < scanRepeatCount; ++repeat )
+	{
+		for( const auto& denseChunk : denseChunks )
+		{
+			occupancy.Build( denseChunk.second.data() );
+			occupancyCount += occupancy.CountOccupied();
+			occupancyBricks += static_cast<uint64_t>( __builtin_popcountll( occupancy.GetBrickMask() ) );
+		}
+	}
+	const double occupancyScanSeconds = occupancyScanTimer.ElapsedSeconds();
+
+	if( bytewiseCount != occupancyCount || bytewiseBricks != occupancyBricks )
+	{
+		throw std::runtime_error( "occupancy doesn't match the voxels!" );
+	}
+
+	const double scannedChunkCount = static_cast<double>( denseChunks.size() * scanRepeatCount );
+	printf( "%zu chunks, %.1f%% solid: scan bytes %.1f us/chunk, build occupancy + popcount %.1f us/chunk (%.1fx)\n",
+	  denseChunks.size(),
+	  100.0 * static_cast<double>( bytewiseCount ) / ( scannedChunkCount * VOXEL_CHUNK_VOXEL_COUNT ),
+	  bytewiseScanSeconds / scannedChunkCount * 1e6,
+	  occupancyScanSeconds / scannedChunkCount * 1e6,
+	  bytewiseScanSeconds / occupancyScanSeconds );
+
+	// Rays from above the terrain, looking down at a slant, & level ones through the caves
+	std::mt19937 rng( 7 );
+	std::uniform_real_distribution<float> position( -VIEW_DISTANCE * 0.5f, VIEW_DISTANCE * 0.5f );
+	std::uniform_real_distribution<float> unit( -1.0f, 1.0f );
+	constexpr size_t rayCount = 20000;
+	constexpr float maxDistance = 256.0f;
+	std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+	for( size_t i = 0; i < rayCount; ++i )
+	{
+		const bool isLevel = ( i % 2 ) == 1;
+		const glm::vec3 origin( position( rng ), isLevel ? unit( rng ) * 40.0f - 20.0f : 40.0f, position( rng ) );
+		const glm::vec3 direction = glm::normalize( glm::vec3( unit( rng ), isLevel ? unit( rng ) * 0.2f : -1.0f + unit( rng ) * 0.3f, unit( rng ) ) );
+		rays.emplace_back( origin, direction );
+	}
+
+	std::vector<std::optional<glm::ivec3>> bytewiseHits( rays.size() );
+	Benchmarks::Stopwatch bytewiseRayTimer;
+	for( size_t i = 0; i < rays.size(); ++i )
+	{
+		bytewiseHits[i] = TraceBytewise( denseChunks, rays[i].first, rays[i].second, maxDistance );
+	}
+	const double bytewiseRaySeconds = bytewiseRayTimer.ElapsedSeconds();
+
+	std::vector<std::optional<VoxelRaycast::Hit>> occupancyHits( rays.size() );
+	Benchmarks::Stopwatch occupancyRayTimer;
+	for( size_t i = 0; i < rays.size(); ++i )
+	{
+		occupancyHits[i] = VoxelRaycast::Trace( chunkManager, rays[i].first, rays[i].second, maxDistance );
+	}
+	const double occupancyRaySeconds = occupancyRayTimer.ElapsedSeconds();
+
+	// Both walk the same planes, a ray could only differ on a rounding tie
+	size_t hitCount = 0;
+	size_t mismatchCount = 0;
+	for( size_t i = 0; i < rays.size(); ++i )
+	{
+		hitCount += occupancyHits[i].has_value();
+		mismatchCount += bytewiseHits[i].has_value() != occupancyHits[i].has_value() || ( bytewiseHits[i] && *bytewiseHits[i] != occupancyHits[i]->voxel );
+	}
+
+	printf( "%zu rays, %zu hits (%zu differ): byte-wise DDA %.0f rays/s, occupancy DDA %.0f rays/s (%.1fx)\n",
+	  rays.size(),
+	  hitCount,
+	  mismatchCount,
+	  static_cast<double>( rays.size() ) / bytewiseRaySeconds,
+	  static_cast<double>( rays.size() ) / occupancyRaySeconds,
+	  bytewiseRaySeconds / occupancyRaySeconds );
+}
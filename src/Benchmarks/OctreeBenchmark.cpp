@@ -0,0 +1,104 @@
+#include <Benchmarks/Benchmarks.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <Voxel/SparseVoxelOctree.h>
+
+namespace
+{
+	// Rolling terrain taking roughly the bottom fifth of the volume, the rest is empty air
+	int TerrainHeight( int x, int z, uint32_t size )
+	{
+		const float scale = static_cast<float>( size );
+		const float fx = static_cast<float>( x ) / scale;
+		const float fz = static_cast<float>( z ) / scale;
+		const float height = 0.15f + 0.05f * std::sin( fx * 12.0f ) * std::cos( fz * 9.0f ) + 0.02f * std::sin( ( fx + fz ) * 40.0f );
+		return static_cast<int>( height * scale );
+	}
+
+	int8_t TerrainMaterial( int y, int height )
+	{
+		return y + 1 >= height ? 1 : ( y + 4 >= height ? 2 : 3 ); // grass, dirt, stone
+	}
+
+	void RunForSize( uint32_t size )
+	{
+		const size_t denseBytes = static_cast<size_t>( size ) * size * size;
+		std::vector<int8_t> dense( denseBytes, 0 );
+		SparseVoxelOctree octree( size );
+
+		Benchmarks::Stopwatch buildTimer;
+		for( int z = 0; z < static_cast<int>( size ); ++z )
+		{
+			for( int x = 0; x < static_cast<int>( size ); ++x )
+			{
+				const int height = TerrainHeight( x, z, size );
+				for( int y = 0; y < height; ++y )
+				{
+					dense[( static_cast<size_t>( z ) * size + y ) * size + x] = TerrainMaterial( y, height );
+				}
+
+				// Stone, dirt & grass layers as three spans per column
+				octree.FillRegion( glm::ivec3( x, 0, z ), glm::ivec3( x + 1, height - 4, z + 1 ), 3 );
+				octree.FillRegion( glm::ivec3( x, height - 4, z ), glm::ivec3( x + 1, height - 1, z + 1 ), 2 );
+				octree.FillRegion( glm::ivec3( x, height - 1, z ), glm::ivec3( x + 1, height, z + 1 ), 1 );
+			}
+		}
+		const double buildSeconds = buildTimer.ElapsedSeconds();
+
+		constexpr size_t lookupCount = 1 << 22;
+		std::mt19937 rng( 1234 );
+		std::uniform_int_distribution<int> coordinate( 0, static_cast<int>( size ) - 1 );
+		std::vector<glm::ivec3> lookups( lookupCount );
+		for( auto& lookup : lookups )
+		{
+			lookup = glm::ivec3( coordinate( rng ), coordinate( rng ), coordinate( rng ) );
+		}
+
+		int64_t denseSum = 0;
+		Benchmarks::Stopwatch denseTimer;
+		for( const auto& lookup : lookups )
+		{
+			denseSum += dense[( static_cast<size_t>( lookup.z ) * size + lookup.y ) * size + lookup.x];
+		}
+		const double denseSeconds = denseTimer.ElapsedSeconds();
+
+		int64_t octreeSum = 0;
+		Benchmarks::Stopwatch octreeTimer;
+		for( const auto& lookup : lookups )
+		{
+			octreeSum += octree.Get( lookup );
+		}
+		const double octreeSeconds = octreeTimer.ElapsedSeconds();
+
+		size_t nonEmptyCount = 0;
+		Benchmarks::Stopwatch iterateTimer;
+		octree.ForEachNonEmptyNode( [&nonEmptyCount]( const glm::ivec3&, uint32_t nodeSize, int8_t ) {
+			nonEmptyCount += static_cast<size_t>( nodeSize ) * nodeSize * nodeSize;
+		} );
+		const double iterateSeconds = iterateTimer.ElapsedSeconds();
+
+		if( denseSum != octreeSum )
+		{
+			throw std::runtime_error( "octree and dense grid lookups disagree!" );
+		}
+
+		printf( "%u^3: build %.2fs, %zu nodes, %zu non-empty voxels (iterated in %.3fs)\n", size, buildSeconds, octree.GetNodeCount(), nonEmptyCount, iterateSeconds );
+		printf( "  memory : dense %.1f MiB, octree %.1f MiB (%.1fx smaller)\n",
+		  Benchmarks::ToMiB( denseBytes ),
+		  Benchmarks::ToMiB( octree.GetMemoryFootprint() ),
+		  static_cast<double>( denseBytes ) / static_cast<double>( octree.GetMemoryFootprint() ) );
+		printf( "  lookups: dense %.1f M/s, octree %.1f M/s\n",
+		  lookupCount / denseSeconds / 1e6,
+		  lookupCount / octreeSeconds / 1e6 );
+	}
+} // namespace
+
+void Benchmarks::RunOctreeBenchmark()
+{
+	RunForSize( 256 );
+	RunForSize( 1024 );
+}
@@ -1,5 +1,10 @@
 #include <GameFramework/AstroApp.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <optional>
 #include <set>
@@ -7,16 +12,27 @@
 
 #include <GameFramework/QueueFamilyIndices.h>
 #include <GameFramework/SwapchainHelpers.h>
-#include <Helpers/FileHelpers.h>
+#include <Helpers/FrustumHelpers.h>
+#include <Helpers/ImageHelpers.h>
 #include <Helpers/VulkanHelpers.h>
 
+// Compiled & embedded at build time, see the shader section of CMakelists.txt
+#include <Shaders/ChunkCull.comp.h>
+#include <Shaders/HiZBuild.comp.h>
+#include <Shaders/Raymarch.comp.h>
+#include <Shaders/SimpleShader.comp.h>
+#include <Shaders/VoxelChunk.frag.h>
+#include <Shaders/VoxelChunk.vert.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
 constexpr uint16_t WIDTH = 800;
 constexpr uint16_t HEIGHT = 600;
 const std::vector<const char*> Validation_Layers = {
 	"VK_LAYER_KHRONOS_validation"
 };
 
-const std::vector<const char*> Required_Device_Extensions = {
+const std::vector<const char*> Presentation_Device_Extensions = {
 	VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
 
@@ -26,10 +42,96 @@ constexpr bool EnableValidationLayers = false;
 constexpr bool EnableValidationLayers = true;
 #endif
 
-constexpr int8_t MAX_FRAMES_IN_FLIGHT = 2;
+constexpr VkDeviceSize READBACK_BYTES_PER_FRAME = 4 * 1024;
+
+const std::string Scene_File_Path = "Scenes/Default.astroscene";
+const std::string Pipeline_Cache_File_Path = "pipeline_cache.bin";
+
+// Headless rendering, offscreen images replacing the swapchain ones
+constexpr uint32_t OFFSCREEN_IMAGE_COUNT = 3;
+constexpr VkFormat OFFSCREEN_IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB; // byte order matches the dumped files
+
+// SimpleShader.comp's push constants, indices in the descriptor heap
+struct SimulatePushConstants
+{
+	uint32_t dataInIndex;
+	uint32_t dataOutIndex;
+};
+
+// Chunk drawing
+constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+constexpr VkDeviceSize CHUNK_MESH_POOL_SIZE = 128 * 1024 * 1024; // power of two, see ChunkMeshPool
+constexpr uint32_t CHUNKS_PER_COMMAND_BUFFER = 64; // draws per secondary, enough to be worth a job (--cpu-draws)
+constexpr uint32_t MAX_CHUNK_DRAW_COUNT = 128 * 1024; // per frame
+constexpr uint32_t CHUNK_CULL_GROUP_SIZE = 64; // ChunkCull.comp's local_size_x
+constexpr VkFormat HI_Z_FORMAT = VK_FORMAT_R32_SFLOAT;
+constexpr uint32_t HI_Z_BUILD_GROUP_SIZE = 8; // HiZBuild.comp's local_size_x & y
+
+// Raymarching (--raymarch)
+constexpr uint32_t RAYMARCH_GRID_SIZE = 24; // chunks per axis around the viewpoint, past the view distance
+constexpr uint32_t RAYMARCH_BRICK_CAPACITY = 64 * 1024; // ~33MB
+constexpr VkDeviceSize RAYMARCH_UPLOAD_BUDGET = 2 * 1024 * 1024; // per frame, the rest of the dirty bricks wait for the next ones
+constexpr VkFormat RAYMARCH_TARGET_FORMAT = VK_FORMAT_R8G8B8A8_UNORM; // blitted to the swapchain format
+constexpr uint32_t RAYMARCH_GROUP_SIZE = 8; // Raymarch.comp's local_size_x & y
+
+// --recording-benchmark, frames recorded per draw count
+constexpr uint32_t RECORDING_BENCHMARK_FRAME_COUNT = 100;
+
+// VoxelChunk.vert's push constants, the same for every draw: each one's chunk comes through firstInstance
+struct ChunkPassPushConstants
+{
+	glm::mat4 viewProjection;
+	uint32_t meshBufferIndex;
+	uint32_t chunkBufferIndex;
+};
+
+// ChunkCull.comp's push constants
+struct ChunkCullPushConstants
+{
+	glm::mat4 viewProjection;
+	uint32_t chunkBufferIndex;
+	uint32_t firstChunk;
+	uint32_t chunkCount;
+	uint32_t drawCommandBufferIndex;
+	uint32_t firstDrawCommand;
+	uint32_t drawCountBufferIndex;
+	uint32_t visibilityBufferIndex;
+	uint32_t cullPhase;
+	uint32_t hiZFirstIndex;
+	uint32_t hiZMipCount;
+	glm::uvec2 depthSize;
+};
+
+// Raymarch.comp's push constants
+struct RaymarchPushConstants
+{
+	glm::mat4 inverseViewProjection;
+	glm::ivec3 gridOrigin;
+	uint32_t gridSize;
+	uint32_t gridBufferIndex;
+	uint32_t firstGridCell;
+	uint32_t brickmapBufferIndex;
+	uint32_t brickBufferIndex;
+	uint32_t targetIndex;
+	uint32_t padding;
+	glm::uvec2 targetSize;
+};
+
+// HiZBuild.comp's push constants, per mip
+struct HiZBuildPushConstants
+{
+	glm::uvec2 sourceSize;
+	glm::uvec2 destinationSize;
+	uint32_t sourceIndex;
+	uint32_t destinationIndex;
+	uint32_t samplerIndex;
+	uint32_t isSourceDepth;
+};
 
 #pragma region Helpers
 
+// Without a surface (headless) there's nothing to present, the graphics family stands in for the present one.
+// Compute prefers a family without graphics (async compute), falling back on the first one that can do compute.
 QueueFamilyIndices FindQueueFamilies( VkPhysicalDevice device, VkSurfaceKHR surface )
 {
 	QueueFamilyIndices indices;
@@ -41,26 +143,32 @@ QueueFamilyIndices FindQueueFamilies( VkPhysicalDevice device, VkSurfaceKHR surf
 	vkGetPhysicalDeviceQueueFamilyProperties( device, &queueFamilyCount, queueFamilies.data() );
 
 	int i = 0;
+	bool hasDedicatedComputeFamily = false;
 	for( const auto& queueFamily : queueFamilies )
 	{
-		if( queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT )
+		if( ( queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT ) && !indices.presentFamily.has_value() )
 		{
 			indices.graphicsFamily = i;
 
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR( device, i, surface, &presentSupport );
+			VkBool32 presentSupport = surface == VK_NULL_HANDLE;
+			if( surface != VK_NULL_HANDLE )
+			{
+				vkGetPhysicalDeviceSurfaceSupportKHR( device, i, surface, &presentSupport );
+			}
 			if( presentSupport )
 			{
 				indices.presentFamily = i;
 			}
 		}
 
-		if( queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT )
+		const bool isDedicatedComputeFamily = ( queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT ) && !( queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT );
+		if( ( queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT ) && ( !indices.computeFamily.has_value() || ( isDedicatedComputeFamily && !hasDedicatedComputeFamily ) ) )
 		{
 			indices.computeFamily = i;
+			hasDedicatedComputeFamily = isDedicatedComputeFamily;
 		}
 
-		if( indices.IsComplete() )
+		if( indices.IsComplete() && hasDedicatedComputeFamily )
 		{
 			break;
 		}
@@ -71,7 +179,7 @@ QueueFamilyIndices FindQueueFamilies( VkPhysicalDevice device, VkSurfaceKHR surf
 	return indices;
 }
 
-bool CheckDeviceExtensionSupport( VkPhysicalDevice device )
+bool CheckDeviceExtensionSupport( VkPhysicalDevice device, const std::vector<const char*>& requiredDeviceExtensions )
 {
 
 	uint32_t extensionCount;
@@ -79,7 +187,7 @@ bool CheckDeviceExtensionSupport( VkPhysicalDevice device )
 	std::vector<VkExtensionProperties> availableExtensions( extensionCount );
 	vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, availableExtensions.data() );
 
-	std::set<std::string> requiredExtensions( Required_Device_Extensions.begin(), Required_Device_Extensions.end() );
+	std::set<std::string> requiredExtensions( requiredDeviceExtensions.begin(), requiredDeviceExtensions.end() );
 
 	for( const auto& extension : availableExtensions )
 	{
@@ -116,12 +224,13 @@ SwapChainSupportDetails QuerySwapChainSupport( VkPhysicalDevice device, VkSurfac
 	return details;
 }
 
-VkShaderModule CreateShaderModule( const std::vector<char>& code, VkDevice device )
+template<size_t WordCount>
+VkShaderModule CreateShaderModule( const uint32_t ( &code )[WordCount], VkDevice device )
 {
 	VkShaderModuleCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	createInfo.codeSize = code.size();
-	createInfo.pCode = reinterpret_cast<const uint32_t*>( code.data() );
+	createInfo.codeSize = sizeof( code );
+	createInfo.pCode = code;
 
 	VkShaderModule shaderModule;
 	if( vkCreateShaderModule( device, &createInfo, nullptr, &shaderModule ) != VK_SUCCESS )
@@ -132,39 +241,61 @@ VkShaderModule CreateShaderModule( const std::vector<char>& code, VkDevice devic
 	return shaderModule;
 }
 
+// Looking ahead & down at the chunks streamed around the viewpoint, from above & behind it
+const float Camera_Vertical_Fov = glm::radians( 60.0f );
 
-uint32_t FindCompatibleMemoryTypeIndex( VkPhysicalDeviceMemoryProperties memoryProperties, const VkDeviceSize memorySize )
+glm::vec3 ComputeCameraPosition( const glm::vec3& viewpoint )
 {
-	for( uint32_t k = 0; k < memoryProperties.memoryTypeCount; k++ )
-	{
-		const VkMemoryType memoryType = memoryProperties.memoryTypes[k];
-		if( ( VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT & memoryType.propertyFlags )
-			&& ( VK_MEMORY_PROPERTY_HOST_COHERENT_BIT & memoryType.propertyFlags )
-			&& ( memorySize < memoryProperties.memoryHeaps[memoryType.heapIndex].size ) )
-		{
-			return k;
-		}
-	}
+	return viewpoint + glm::vec3( 0.0f, 48.0f, -64.0f );
+}
+
+glm::mat4 ComputeViewProjection( const glm::vec3& viewpoint, VkExtent2D extent )
+{
+	const glm::vec3 eye = ComputeCameraPosition( viewpoint );
+	const glm::mat4 view = glm::lookAt( eye, viewpoint + glm::vec3( 0.0f, 0.0f, 64.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
 
-	throw std::runtime_error( "failed to find memory type for requested memory size" );
-	return 0;
+	glm::mat4 projection = glm::perspectiveRH_ZO( Camera_Vertical_Fov, extent.width / (float)extent.height, 0.1f, 1024.0f );
+	projection[1][1] *= -1.0f; // Vulkan's clip space Y points down
+	return projection * view;
 }
 
+
 #pragma endregion //Helpers
 
 
+AstroApp::AstroApp( const AstroAppSettings& settings )
+  : m_settings( settings )
+{
+}
+
 void AstroApp::Run()
 {
-	InitWindow();
+	if( !m_settings.isHeadless )
+	{
+		InitWindow();
+	}
+	// Before Vulkan: the scene & command recording both spread their work over it
+	m_jobSystem = std::make_unique<JobSystem>();
 	InitVulkan();
 
 	LoadScene();
-	MainLoop();
+	ReportStartup();
+	if( m_settings.isRecordingBenchmark )
+	{
+		RunRecordingBenchmark();
+	}
+	else
+	{
+		MainLoop();
+	}
+	ReportProfile();
 	Shutdown();
 }
 
 void AstroApp::InitWindow()
 {
+	ProfileScope profileScope( m_profiler, "InitWindow" );
+
 	glfwInit();
 	glfwWindowHint( GLFW_CLIENT_API, GLFW_NO_API ); // Tell glfw to not create an openGL context
 	glfwWindowHint( GLFW_RESIZABLE, GLFW_FALSE ); // disable resizing for now
@@ -174,28 +305,55 @@ void AstroApp::InitWindow()
 
 void AstroApp::InitVulkan()
 {
+	ProfileScope profileScope( m_profiler, "InitVulkan" );
+
 	CheckExtensions();
 	CreateVkInstance();
 	SetupDebugMessenger();
-	CreateSurface();
+	if( !m_settings.isHeadless )
+	{
+		CreateSurface();
+	}
 	PickGPU();
 	CreateVkLogicalDevice();
-	CreateSwapchain();
+	CreateMemoryAllocator();
+	CreateReadbackRing();
+	CreatePipelineCache();
+	CreateDescriptorHeap();
+	if( m_settings.isHeadless )
+	{
+		CreateOffscreenImages();
+	}
+	else
+	{
+		CreateSwapchain();
+	}
 	CreateImageViews();
-	CreateRenderPass();
+	m_renderPass = CreateRenderPass( VK_ATTACHMENT_LOAD_OP_CLEAR );
+	m_continueRenderPass = CreateRenderPass( VK_ATTACHMENT_LOAD_OP_LOAD ); // compatible with m_renderPass: same framebuffers & pipeline
 	CreateGraphicsPipeline();
-	CreateFramebuffers();
-
-	CreateCommandPool();
-	CreateComputeCommandBuffers();
-	CreateComputePipeline();
-
-	CreateCommandBuffers();
+	CreateGpuProfilers();
+
+	CreateCommandPools();
+	CreateComputeDataBuffers();
+	CreateComputePipelines();
+	CreateChunkMeshPool();
+	CreateIndirectChunkDraws();
+	CreateVoxelStore();
+	CreateCommandRecorder();
+
+	CreateRenderGraphs();
+	CreateHiZDescriptors();
+	CreateRaymarchDescriptors();
+	CreateFramebuffers(); // the depth attachment is a render graph transient
+	CreateFrameScheduler();
 	CreateSemaphores();
 }
 
 void AstroApp::CreateVkInstance()
 {
+	ProfileScope profileScope( m_profiler, "CreateVkInstance" );
+
 #ifndef NDEBUG
 	if( EnableValidationLayers && !CheckValidationLayers() )
 	{
@@ -209,7 +367,7 @@ void AstroApp::CreateVkInstance()
 	appInfo.applicationVersion = VK_MAKE_VERSION( 1, 0, 0 );
 	appInfo.pEngineName = "No Engine";
 	appInfo.engineVersion = VK_MAKE_VERSION( 1, 0, 0 );
-	appInfo.apiVersion = VK_API_VERSION_1_0;
+	appInfo.apiVersion = VK_API_VERSION_1_2; // timeline semaphores
 
 	VkInstanceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -242,69 +400,277 @@ void AstroApp::CreateVkInstance()
 
 void AstroApp::LoadScene()
 {
-	m_scene = std::make_unique<Scene>();
-	m_scene->Load();
+	ProfileScope profileScope( m_profiler, "LoadScene" );
+
+	m_scene = std::make_unique<Scene>( *m_jobSystem );
+	m_scene->GetLodSelector().SetMaxPixelError( static_cast<float>( m_settings.lodPixelError ) );
+	m_scene->Load( Scene_File_Path );
 }
 
 void AstroApp::MainLoop()
 {
-	while( !glfwWindowShouldClose( m_window ) )
+	ProfileScope profileScope( m_profiler, "MainLoop" );
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	uint32_t frameIndex = 0;
+	while( ShouldKeepRunning( frameIndex ) )
 	{
-		glfwPollEvents();
+		ProfileScope frameProfileScope( m_profiler, "Frame" );
 
-		vkWaitForFences( m_logicalDevice, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX );
+		if( !m_settings.isHeadless )
+		{
+			glfwPollEvents();
+		}
+
+		// The CPU only blocks here, once it gets framesInFlight frames ahead of the GPU
+		uint32_t frameSlot;
+		{
+			ProfileScope profileScope( m_profiler, "WaitForFrameInFlight" );
+			frameSlot = m_frameScheduler->BeginFrame();
+		}
+		CompleteFrameSlot( frameSlot );
+		BeginFrameCommands( frameSlot );
+		m_chunkMeshPool->ReleaseFreedRanges( m_frameScheduler->GetCompletedFrameNumber() );
 
-		//Tell vulkan which semaphore to signal, when image is acquired
 		uint32_t imageIndex;
-		vkAcquireNextImageKHR( m_logicalDevice, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex );
+		if( m_settings.isHeadless )
+		{
+			// Nothing to acquire, just cycle through the offscreen images
+			imageIndex = frameIndex % static_cast<uint32_t>( m_swapChainImages.size() );
+		}
+		else
+		{
+			//Tell vulkan which semaphore to signal, when image is acquired
+			vkAcquireNextImageKHR( m_logicalDevice, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[frameSlot], VK_NULL_HANDLE, &imageIndex );
+		}
 
+		ComputeFrame( frameSlot );
+		DrawFrame( frameSlot, imageIndex );
 
-		ComputeFrame( imageIndex );
-		DrawFrame( imageIndex );
+		if( !m_settings.frameDumpDirectory.empty() )
+		{
+			DumpFrame( imageIndex, frameIndex );
+		}
 
-		PrintComputeBufferData();
+		++frameIndex;
+		m_profiler.NextFrame();
 	}
 
 	//Wait till not busy (so we're not in the middle of rendering something when trying to destroy the resources)
 	vkDeviceWaitIdle( m_logicalDevice );
+
+	const double elapsedSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+	std::cout << "Rendered " << frameIndex << " frames in " << elapsedSeconds << "s (" << frameIndex / elapsedSeconds << " fps)\n";
+
+	// Everything is done, pick up the last frames' GPU timings & readbacks, oldest first
+	for( uint32_t slotOffset = 1; slotOffset <= m_frameScheduler->GetFramesInFlight(); slotOffset++ )
+	{
+		CompleteFrameSlot( ( m_frameScheduler->GetFrameSlot() + slotOffset ) % m_frameScheduler->GetFramesInFlight() );
+	}
 }
 
-//Acquire an image from the swap chain
-//Execute the command buffer with that image as attachment in the framebuffer
-//Return the image to the swap chain for presentation
-void AstroApp::DrawFrame( uint32_t imageIndex )
+void AstroApp::ReportStartup()
+{
+	// Everything so far is startup, pipeline creation being what a warm cache speeds up
+	const double startupMilliseconds = m_profiler.GetTimestamp() / 1000.0;
+	const double pipelineMilliseconds = m_pipelineCreationTime / 1000.0;
+	std::cout << "Startup took " << startupMilliseconds << "ms, " << pipelineMilliseconds << "ms creating pipelines ("
+			  << ( m_pipelineCache->IsLoadedFromDisk() ? "warm" : "cold" ) << " pipeline cache)\n";
+
+	const bool hasAsyncCompute = FindQueueFamilies( m_physicalDevice, m_surface ).HasAsyncCompute();
+	std::cout << "Compute runs on " << ( hasAsyncCompute ? "a dedicated queue family (async compute)" : "the graphics queue family" ) << "\n";
+
+	for( const RenderGraph* graph : { m_computeGraph.get(), m_graphicsGraph.get() } )
+	{
+		if( graph->GetUnaliasedTransientMemorySize() != 0 )
+		{
+			std::cout << "Render graph transients: " << graph->GetTransientMemorySize() / 1024 << "KB aliased, "
+					  << graph->GetUnaliasedTransientMemorySize() / 1024 << "KB without aliasing\n";
+		}
+	}
+}
+
+void AstroApp::ReportProfile()
+{
+	m_profiler.PrintSummary( std::cout );
+	ReportQueueOverlap();
+	if( m_simulationValueFrame != 0 )
+	{
+		std::cout << "Simulation readback: " << m_simulationValue << " (computed by frame " << m_simulationValueFrame << ")\n";
+	}
+	m_memoryAllocator->PrintStats( std::cout );
+	std::cout << "Chunk meshes: " << m_chunkMeshPool->GetDraws().size() << " resident, " << m_chunkMeshPool->GetUsedSize() / 1024 << "KB of the pool used, "
+			  << m_chunkMeshPool->GetFailedUploadCount() << " uploads didn't fit, " << m_indirectChunkDraws->GetDroppedChunkCount() << " draws over the limit\n";
+	if( m_settings.lodPixelError > 0 )
+	{
+		size_t lodChunkCounts[VOXEL_MIP_LEVEL_COUNT] = {};
+		size_t coarsenedChunkCount = 0;
+		m_scene->GetChunkManager().ForEachChunk( [&lodChunkCounts, &coarsenedChunkCount]( const glm::ivec3&, VoxelObject& chunk ) {
+			++lodChunkCounts[chunk.GetLod()];
+			coarsenedChunkCount += chunk.GetFinestLod() != 0;
+		} );
+		std::cout << "Chunk LODs (" << coarsenedChunkCount << " chunks only keep their mips):";
+		for( uint32_t level = 0; level < VOXEL_MIP_LEVEL_COUNT; ++level )
+		{
+			std::cout << " " << lodChunkCounts[level] << " at level " << level << " (from " << m_scene->GetLodSelector().GetLevelDistance( level ) << " units)"
+					  << ( level + 1 < VOXEL_MIP_LEVEL_COUNT ? "," : "\n" );
+		}
+	}
+	if( m_voxelStore )
+	{
+		// Against the rasterized path's triangles, for the same scene: the Raymarch pass' GPU time is per pixel
+		size_t triangleCount = 0;
+		for( const ChunkDraw& chunkDraw : m_chunkMeshPool->GetDraws() )
+		{
+			triangleCount += chunkDraw.indexCount / 3;
+		}
+		std::cout << "Voxel store: " << m_voxelStore->GetChunkCount() << " chunks, " << m_voxelStore->GetUsedBrickCount() << "/" << m_voxelStore->GetBrickCapacity()
+				  << " bricks used, " << m_voxelStore->GetFailedUploadCount() << " uploads didn't fit. Raymarched " << m_swapChainExtent.width << "x"
+				  << m_swapChainExtent.height << " pixels, the meshes would have been " << triangleCount << " triangles\n";
+		const uint64_t updateCount = std::max<uint64_t>( m_voxelStore->GetUpdateCount(), 1 );
+		std::cout << "Voxel uploads: " << m_voxelStore->GetTotalUploadedBytes() / updateCount / 1024 << "KB per frame on average, "
+				  << m_voxelStore->GetPeakUploadedBytes() / 1024 << "KB at most (budget " << m_voxelStore->GetUploadBudget() / 1024 << "KB), "
+				  << m_voxelStore->GetBudgetLimitedUpdateCount() << " frames left bricks for later\n";
+	}
+	if( !m_settings.traceFilePath.empty() )
+	{
+		m_profiler.WriteChromeTrace( m_settings.traceFilePath );
+		std::cout << "Wrote profiler trace to " << m_settings.traceFilePath << "\n";
+	}
+}
+
+void AstroApp::ReportQueueOverlap()
+{
+	if( !m_computeGpuProfiler->IsSupported() || !m_graphicsGpuProfiler->IsSupported() )
+	{
+		std::cout << "Compute/graphics overlap: unknown, a queue can't write timestamps\n";
+		return;
+	}
+
+	// How much of the compute work got hidden behind graphics work, 0% when they share a queue
+	const GpuQueueOverlap overlap = MeasureQueueOverlap( m_computeGpuProfiler->GetBusyIntervals(), m_graphicsGpuProfiler->GetBusyIntervals() );
+	const double overlapPercentage = overlap.firstBusyMilliseconds > 0.0 ? 100.0 * overlap.overlapMilliseconds / overlap.firstBusyMilliseconds : 0.0;
+	std::cout << "Compute/graphics overlap: compute busy " << overlap.firstBusyMilliseconds << "ms, graphics busy " << overlap.secondBusyMilliseconds
+			  << "ms, overlapping " << overlap.overlapMilliseconds << "ms (" << overlapPercentage << "% of compute)\n";
+}
+
+void AstroApp::CompleteFrameSlot( uint32_t frameSlot )
 {
-	if( m_imagesInFlight[imageIndex] != VK_NULL_HANDLE )
+	// The slot's last frame is done, its results can be picked up before its commands get recorded again
+	m_readbackRing->OnFrameCompleted( frameSlot );
+	m_computeGpuProfiler->Collect( frameSlot, m_profiler );
+	m_graphicsGpuProfiler->Collect( frameSlot, m_profiler );
+}
+
+void AstroApp::BeginFrameCommands( uint32_t frameSlot )
+{
+	// The slot's command buffers are done too, every pool they came from gets reset in one go
+	m_graphicsCommandPool->BeginFrame( frameSlot );
+	m_computeCommandPool->BeginFrame( frameSlot );
+	m_commandRecorder->BeginFrame( frameSlot );
+}
+
+void AstroApp::RunRecordingBenchmark()
+{
+	ProfileScope profileScope( m_profiler, "RecordingBenchmark" );
+
+	// The scene's chunk draws repeated up to each draw count, nothing gets submitted: only the CPU side is measured
+	m_scene->Render();
+	const uint32_t frameSlot = m_frameScheduler->BeginFrame();
+	m_chunkMeshPool->Update( m_scene->GetChunkManager(), m_frameScheduler->GetFrameNumber() );
+
+	const std::vector<ChunkDraw>& sceneDraws = m_chunkMeshPool->GetDraws();
+	if( sceneDraws.empty() )
 	{
-		// Check if a previous frame is using this image( i.e.there is its fence to wait on )
-		vkWaitForFences( m_logicalDevice, 1, &m_imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX );
+		throw std::runtime_error( "recording benchmark needs a scene with chunk meshes!" );
 	}
-	m_imagesInFlight[imageIndex] = m_inFlightFences[m_currentFrame];
 
+	if( m_settings.isCpuDrawing )
+	{
+		std::cout << "Recording benchmark, CPU culled draws: " << m_jobSystem->GetThreadCount() << " threads, " << CHUNKS_PER_COMMAND_BUFFER << " draws per secondary\n";
+	}
+	else
+	{
+		std::cout << "Recording benchmark, GPU culled draws: uploading the chunks, then the same commands whatever their count\n";
+	}
+	for( uint32_t drawCount : { 1000u, 10000u, 100000u } )
+	{
+		std::vector<ChunkDraw> chunkDraws( drawCount );
+		for( uint32_t drawIndex = 0; drawIndex < drawCount; ++drawIndex )
+		{
+			chunkDraws[drawIndex] = sceneDraws[drawIndex % sceneDraws.size()];
+		}
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		// Warm up: the first frame allocates the command buffers, the next ones reuse them
+		BeginFrameCommands( frameSlot );
+		RecordGraphicsCommands( frameSlot, 0, chunkDraws, std::nullopt );
+
+		const auto startTime = std::chrono::steady_clock::now();
+		for( uint32_t frameIndex = 0; frameIndex < RECORDING_BENCHMARK_FRAME_COUNT; ++frameIndex )
+		{
+			BeginFrameCommands( frameSlot );
+			RecordGraphicsCommands( frameSlot, 0, chunkDraws, std::nullopt );
+		}
+		const double frameMicroseconds = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - startTime ).count() / RECORDING_BENCHMARK_FRAME_COUNT;
+
+		std::cout << "  " << drawCount << " draws: " << frameMicroseconds / 1000.0 << "ms per frame, " << frameMicroseconds * 1000.0 / drawCount << "us per 1k draws\n";
+	}
+}
 
-	// Setup which semaphore we're waiting to be signaled before we can draw to the image & at which stage of the pipeline.
-	VkSemaphore waitSemaphores[] = { m_computeReadySemaphores[m_currentFrame] };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+bool AstroApp::ShouldKeepRunning( uint32_t frameIndex )
+{
+	if( m_settings.frameCount != 0 && frameIndex >= m_settings.frameCount )
+	{
+		return false;
+	}
 
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &m_commandBuffers[imageIndex];
+	return m_settings.isHeadless || !glfwWindowShouldClose( m_window );
+}
 
-	// which semaphore to signal once rendering is done
-	VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[m_currentFrame] }; // unused?
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+//Acquire an image from the swap chain
+//Execute the command buffer with that image as attachment in the framebuffer
+//Return the image to the swap chain for presentation
+void AstroApp::DrawFrame( uint32_t frameSlot, uint32_t imageIndex )
+{
+	ProfileScope profileScope( m_profiler, "DrawFrame" );
 
-	vkResetFences( m_logicalDevice, 1, &m_inFlightFences[m_currentFrame] );
+	{
+		ProfileScope sceneProfileScope( m_profiler, "Scene::Render" );
+		m_scene->GetLodSelector().SetCamera( ComputeCameraPosition( m_scene->GetViewpoint() ), Camera_Vertical_Fov, m_swapChainExtent.height );
+		m_scene->Render();
+	}
+	{
+		ProfileScope meshPoolProfileScope( m_profiler, "ChunkMeshPool::Update" );
+		m_chunkMeshPool->Update( m_scene->GetChunkManager(), m_frameScheduler->GetFrameNumber() );
+	}
+	if( m_voxelStore )
+	{
+		ProfileScope voxelStoreProfileScope( m_profiler, "GpuVoxelStore::Update" );
+		m_voxelStore->Update( m_scene->GetChunkManager(), m_scene->GetViewpoint(), frameSlot );
+	}
+	// Graphics reads the previous frame's simulation output, so this frame's compute runs alongside it instead of ahead of it
+	const uint64_t frameNumber = m_frameScheduler->GetFrameNumber();
+	const std::optional<uint32_t> simulationOutputIndex = frameNumber > 1 ? std::make_optional( GetSimulationOutputIndex( frameNumber - 1 ) ) : std::nullopt;
+	VkCommandBuffer commandBuffer = RecordGraphicsCommands( frameSlot, imageIndex, m_chunkMeshPool->GetDraws(), simulationOutputIndex );
+
+	// Reading it waits for that frame's compute submit, drawing waits (windowed) for the image to be acquired.
+	// Presenting waits on the binary renderFinished semaphore, it can't wait on a timeline.
+	const FrameScheduler::Wait simulationWait = m_frameScheduler->WaitForQueue( FrameQueue::Compute, frameNumber - 1, VK_PIPELINE_STAGE_TRANSFER_BIT );
+	if( m_settings.isHeadless )
+	{
+		m_frameScheduler->Submit( FrameQueue::Graphics, m_graphicsQueue, commandBuffer, { simulationWait } );
+	}
+	else
+	{
+		const FrameScheduler::Wait imageWait{ m_imageAvailableSemaphores[frameSlot], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		m_frameScheduler->Submit( FrameQueue::Graphics, m_graphicsQueue, commandBuffer, { simulationWait, imageWait }, m_renderFinishedSemaphores[frameSlot] );
+	}
+	m_graphicsGpuProfiler->OnSubmitted( frameSlot, m_profiler.GetTimestamp(), m_profiler.GetFrameIndex() );
 
-	if( vkQueueSubmit( m_graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame] ) != VK_SUCCESS )
+	if( m_settings.isHeadless )
 	{
-		throw std::runtime_error( "failed to submit draw command buffer!" );
+		return;
 	}
 
 	// Present
@@ -312,7 +678,7 @@ void AstroApp::DrawFrame( uint32_t imageIndex )
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
 	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+	presentInfo.pWaitSemaphores = &m_renderFinishedSemaphores[frameSlot];
 	VkSwapchainKHR swapChains[] = { m_swapChain };
 	presentInfo.swapchainCount = 1;
 	presentInfo.pSwapchains = swapChains;
@@ -320,84 +686,87 @@ void AstroApp::DrawFrame( uint32_t imageIndex )
 	presentInfo.pResults = nullptr; // Optional
 
 	vkQueuePresentKHR( m_presentQueue, &presentInfo );
-
-	m_currentFrame = ( m_currentFrame + 1 ) % MAX_FRAMES_IN_FLIGHT;
 }
 
-void AstroApp::ComputeFrame( uint32_t imageIndex )
+void AstroApp::ComputeFrame( uint32_t frameSlot )
 {
-	vkWaitForFences( m_logicalDevice, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX );
-
-	//m_scene->ComputeFrame();
-	//SetComputeCommands( &m_computeCommandBuffer[imageIndex], /*delegate for scene to fill commands*/ );
-	SetComputeCommandsToBuffer( m_computeCommandBuffers[imageIndex] );
-
+	ProfileScope profileScope( m_profiler, "ComputeFrame" );
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-	VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame] };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	{
+		ProfileScope sceneProfileScope( m_profiler, "Scene::ComputeFrame" );
+		m_scene->ComputeFrame();
+	}
+	VkCommandBuffer commandBuffer = RecordComputeCommands( frameSlot );
 
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &m_computeCommandBuffers[imageIndex];
+	// Doesn't touch the image, nothing to wait for: compute starts while the image is still being acquired.
+	// The output it writes was last read by a frame BeginFrame already waited for.
+	m_frameScheduler->Submit( FrameQueue::Compute, m_computeQueue, commandBuffer, {} );
+	m_computeGpuProfiler->OnSubmitted( frameSlot, m_profiler.GetTimestamp(), m_profiler.GetFrameIndex() );
+}
 
-	// which semaphore to signal once compute is done
-	VkSemaphore signalSemaphores[] = { m_computeReadySemaphores[m_currentFrame] };
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+void AstroApp::DumpFrame( uint32_t imageIndex, uint32_t frameIndex )
+{
+	// Simple & slow: wait for that frame to be done, frame dumps are for checking output, not measuring throughput
+	m_frameScheduler->WaitForFrame( m_frameScheduler->GetFrameNumber() );
 
+	const void* pixels = m_frameDumpAllocations[imageIndex].mappedData;
 
-	//vkResetFences( m_logicalDevice, 1, &m_inFlightFences[m_currentFrame] );
-	//Hoping that the graphics fence is enough to sync the compute pass as well... ie, no fence reset or argument in Submit
-	if( vkQueueSubmit( m_computeQueue, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS )
-	{
-		throw std::runtime_error( "failed to submit compute command buffer!" );
-	}
+	char fileName[32];
+	snprintf( fileName, sizeof( fileName ), "frame_%05u.ppm", frameIndex );
+	const std::string filePath = ( std::filesystem::path( m_settings.frameDumpDirectory ) / fileName ).string();
+	ImageHelpers::WritePpm( filePath, m_swapChainExtent.width, m_swapChainExtent.height, static_cast<const uint8_t*>( pixels ), m_swapChainExtent.width * 4 );
 }
 
 void AstroApp::Shutdown()
 {
 	m_scene.reset();
+	m_commandRecorder.reset();
+	m_jobSystem.reset();
+	m_graphicsCommandPool.reset();
+	m_computeCommandPool.reset();
+
+	m_computeGpuProfiler.reset();
+	m_graphicsGpuProfiler.reset();
+	m_computeGraph.reset();
+	m_graphicsGraph.reset();
 
 	//--------------------------------
 	// VULKAN
 	//--------------------------------
-	for( auto bufferMemory : m_deviceMemories )
-	{
-		vkFreeMemory( m_logicalDevice, bufferMemory, nullptr );
-	}
-
-	for( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+	for( size_t i = 0; i < m_imageAvailableSemaphores.size(); i++ )
 	{
 		vkDestroySemaphore( m_logicalDevice, m_renderFinishedSemaphores[i], nullptr );
 		vkDestroySemaphore( m_logicalDevice, m_imageAvailableSemaphores[i], nullptr );
-		vkDestroySemaphore( m_logicalDevice, m_computeReadySemaphores[i], nullptr );
-		vkDestroyFence( m_logicalDevice, m_inFlightFences[i], nullptr );
 	}
+	m_frameScheduler.reset();
 
-	vkDestroyCommandPool( m_logicalDevice, m_commandPool, nullptr );
-
-	for( auto computeDataBuffer : m_computeDataBuffers )
+	m_readbackRing.reset();
+	m_chunkMeshPool.reset();
+	m_indirectChunkDraws.reset();
+	m_voxelStore.reset();
+	for( size_t i = 0; i < m_computeDataBuffers.size(); i++ )
 	{
-		vkDestroyBuffer( m_logicalDevice, computeDataBuffer, nullptr );
+		vkDestroyBuffer( m_logicalDevice, m_computeDataBuffers[i], nullptr );
+		m_memoryAllocator->Free( m_computeDataAllocations[i] );
 	}
 
 	for( auto framebuffer : m_swapChainFramebuffers )
 	{
 		vkDestroyFramebuffer( m_logicalDevice, framebuffer, nullptr );
 	}
+	for( auto hiZMipView : m_hiZMipViews )
+	{
+		vkDestroyImageView( m_logicalDevice, hiZMipView, nullptr );
+	}
+	vkDestroySampler( m_logicalDevice, m_depthSampler, nullptr );
 
-	vkDestroyDescriptorSetLayout( m_logicalDevice, m_computeDescriptorSetLayout, nullptr );
-	vkDestroyDescriptorPool( m_logicalDevice, m_computeDescriptorPool, nullptr );
-
+	vkDestroyPipeline( m_logicalDevice, m_raymarchPipeline, nullptr );
+	vkDestroyPipeline( m_logicalDevice, m_hiZBuildPipeline, nullptr );
+	vkDestroyPipeline( m_logicalDevice, m_chunkCullPipeline, nullptr );
 	vkDestroyPipeline( m_logicalDevice, m_computePipeline, nullptr );
 	vkDestroyPipeline( m_logicalDevice, m_graphicsPipeline, nullptr );
-	vkDestroyPipelineLayout( m_logicalDevice, m_computePipelineLayout, nullptr );
-	vkDestroyPipelineLayout( m_logicalDevice, m_graphicsPipelineLayout, nullptr );
+	m_descriptorHeap.reset();
+	vkDestroyRenderPass( m_logicalDevice, m_continueRenderPass, nullptr );
 	vkDestroyRenderPass( m_logicalDevice, m_renderPass, nullptr );
 
 	for( auto imageView : m_swapChainImageViews )
@@ -405,6 +774,30 @@ void AstroApp::Shutdown()
 		vkDestroyImageView( m_logicalDevice, imageView, nullptr );
 	}
 
+	if( m_settings.isHeadless )
+	{
+		// We own the offscreen images, unlike the swapchain ones
+		for( size_t i = 0; i < m_swapChainImages.size(); i++ )
+		{
+			vkDestroyImage( m_logicalDevice, m_swapChainImages[i], nullptr );
+			m_memoryAllocator->Free( m_offscreenImageAllocations[i] );
+		}
+
+		for( size_t i = 0; i < m_frameDumpBuffers.size(); i++ )
+		{
+			vkDestroyBuffer( m_logicalDevice, m_frameDumpBuffers[i], nullptr );
+			m_memoryAllocator->Free( m_frameDumpAllocations[i] );
+		}
+	}
+
+	m_memoryAllocator.reset();
+
+	if( !m_pipelineCache->Save() )
+	{
+		std::cout << "Failed to save the pipeline cache to " << Pipeline_Cache_File_Path << "\n";
+	}
+	m_pipelineCache.reset();
+
 	vkDestroySwapchainKHR( m_logicalDevice, m_swapChain, nullptr );
 	vkDestroyDevice( m_logicalDevice, nullptr );
 	vkDestroySurfaceKHR( m_instance, m_surface, nullptr );
@@ -413,16 +806,22 @@ void AstroApp::Shutdown()
 		VulkanHelpers::DestroyDebugUtilsMessengerEXT( m_instance, m_debugMessenger, nullptr );
 	}
 	vkDestroyInstance( m_instance, nullptr );
-	glfwDestroyWindow( m_window );
-	glfwTerminate();
+
+	if( !m_settings.isHeadless )
+	{
+		glfwDestroyWindow( m_window );
+		glfwTerminate();
+	}
 }
 
 
-void AstroApp::SetComputeCommandsToBuffer( VkCommandBuffer& commandBuffer )
+VkCommandBuffer AstroApp::RecordComputeCommands( uint32_t frameSlot )
 {
+	VkCommandBuffer commandBuffer = m_computeCommandPool->Acquire( frameSlot, VK_COMMAND_BUFFER_LEVEL_PRIMARY );
+
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = 0; // Optional
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	beginInfo.pInheritanceInfo = nullptr; // Optional
 
 	if( vkBeginCommandBuffer( commandBuffer, &beginInfo ) != VK_SUCCESS )
@@ -430,16 +829,17 @@ void AstroApp::SetComputeCommandsToBuffer( VkCommandBuffer& commandBuffer )
 		throw std::runtime_error( "failed to begin recording compute command buffer!" );
 	}
 
-	vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline );
-	vkCmdBindDescriptorSets( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipelineLayout, 0, 1, &m_computeDescriptorSet, 0, 0 );
-
-	glm::vec3 dispatchGroupSize = glm::vec3( 1, 1, 1 );
-	vkCmdDispatch( commandBuffer, dispatchGroupSize.x, dispatchGroupSize.y, dispatchGroupSize.z );
+	// Then handed over to graphics, which waits for this submit before acquiring it
+	const uint32_t simulationOutputIndex = GetSimulationOutputIndex( m_frameScheduler->GetFrameNumber() );
+	m_computeGpuProfiler->BeginRecording( commandBuffer, frameSlot );
+	m_computeGraph->Execute( commandBuffer, simulationOutputIndex, m_computeGpuProfiler.get(), frameSlot );
+	m_simulationOutputTransfers[simulationOutputIndex].RecordRelease( commandBuffer );
 
 	if( vkEndCommandBuffer( commandBuffer ) != VK_SUCCESS )
 	{
 		throw std::runtime_error( "failed to record command buffer!" );
 	}
+	return commandBuffer;
 }
 
 void AstroApp::PopulateDebugMessengerCreateInfo( VkDebugUtilsMessengerCreateInfoEXT& createInfo )
@@ -481,10 +881,16 @@ void AstroApp::CheckExtensions()
 
 std::vector<const char*> AstroApp::GetRequiredExtensions()
 {
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions( &glfwExtensionCount );
-	std::vector<const char*> extensions( glfwExtensions, glfwExtensions + glfwExtensionCount );
+	// Headless doesn't need any surface extension, glfw isn't even initialised
+	std::vector<const char*> extensions;
+	if( !m_settings.isHeadless )
+	{
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions( &glfwExtensionCount );
+		extensions.assign( glfwExtensions, glfwExtensions + glfwExtensionCount );
+	}
+
 	if( EnableValidationLayers )
 	{
 		extensions.push_back( VK_EXT_DEBUG_UTILS_EXTENSION_NAME );
@@ -493,6 +899,17 @@ std::vector<const char*> AstroApp::GetRequiredExtensions()
 	return extensions;
 }
 
+std::vector<const char*> AstroApp::GetRequiredDeviceExtensions()
+{
+	std::vector<const char*> extensions;
+	if( !m_settings.isHeadless )
+	{
+		extensions.insert( extensions.end(), Presentation_Device_Extensions.begin(), Presentation_Device_Extensions.end() );
+	}
+
+	return extensions;
+}
+
 #ifndef NDEBUG
 bool AstroApp::CheckValidationLayers()
 {
@@ -535,6 +952,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL AstroApp::DebugCallback(
 
 void AstroApp::PickGPU()
 {
+	ProfileScope profileScope( m_profiler, "PickGPU" );
 
 	uint32_t deviceCount = 0;
 	vkEnumeratePhysicalDevices( m_instance, &deviceCount, nullptr );
@@ -571,13 +989,36 @@ bool AstroApp::IsGPUSuitable( VkPhysicalDevice device )
 	VkPhysicalDeviceFeatures deviceFeatures;
 	vkGetPhysicalDeviceFeatures( device, &deviceFeatures );
 
-	const bool deviceSupportsRequiredFeatures =
-	  deviceProperties.limits.maxComputeSharedMemorySize > 0;
-
-	const bool deviceSupportsRequiredExtensions = CheckDeviceExtensionSupport( device );
+	// Vulkan 1.2 features, timeline semaphores pace the frames & descriptor indexing makes the bindless descriptor heap
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 deviceFeatures2{};
+	deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	deviceFeatures2.pNext = &vulkan12Features;
+	const bool supportsVulkan12 = deviceProperties.apiVersion >= VK_API_VERSION_1_2;
+	if( supportsVulkan12 )
+	{
+		vkGetPhysicalDeviceFeatures2( device, &deviceFeatures2 );
+	}
 
-	bool swapChainSupported = false;
-	if( deviceSupportsRequiredExtensions )
+	const bool deviceSupportsRequiredFeatures =
+	  deviceProperties.limits.maxComputeSharedMemorySize > 0
+	  && supportsVulkan12
+	  && deviceFeatures.drawIndirectFirstInstance
+	  && vulkan12Features.timelineSemaphore
+	  && vulkan12Features.drawIndirectCount
+	  && vulkan12Features.descriptorIndexing
+	  && vulkan12Features.runtimeDescriptorArray
+	  && vulkan12Features.descriptorBindingPartiallyBound
+	  && vulkan12Features.descriptorBindingUpdateUnusedWhilePending
+	  && vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind
+	  && vulkan12Features.descriptorBindingStorageImageUpdateAfterBind
+	  && vulkan12Features.descriptorBindingSampledImageUpdateAfterBind;
+
+	const bool deviceSupportsRequiredExtensions = CheckDeviceExtensionSupport( device, GetRequiredDeviceExtensions() );
+
+	bool swapChainSupported = m_settings.isHeadless; // offscreen images don't need any
+	if( deviceSupportsRequiredExtensions && !m_settings.isHeadless )
 	{
 		const SwapChainSupportDetails swapchainSupportDetails = QuerySwapChainSupport( device, m_surface );
 		swapChainSupported = swapchainSupportDetails.formats.empty() == false && swapchainSupportDetails.presentModes.empty() == false;
@@ -591,6 +1032,8 @@ bool AstroApp::IsGPUSuitable( VkPhysicalDevice device )
 
 void AstroApp::CreateVkLogicalDevice()
 {
+	ProfileScope profileScope( m_profiler, "CreateVkLogicalDevice" );
+
 	QueueFamilyIndices indices = FindQueueFamilies( m_physicalDevice, m_surface );
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
@@ -613,17 +1056,32 @@ void AstroApp::CreateVkLogicalDevice()
 	//Declare which features we will be using (these should've been checked in "IsGPUSuitable")
 
 
-	//TODO: Add required features
 	VkPhysicalDeviceFeatures deviceFeatures{};
+	deviceFeatures.drawIndirectFirstInstance = VK_TRUE; // chunk draws pass their chunk's index as firstInstance
+
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.timelineSemaphore = VK_TRUE;
+	vulkan12Features.drawIndirectCount = VK_TRUE; // GPU culled chunk draws
+	// Bindless descriptor heap
+	vulkan12Features.descriptorIndexing = VK_TRUE;
+	vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+	vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+	vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	vulkan12Features.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+	vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
 
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = &vulkan12Features;
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>( queueCreateInfos.size() );
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>( Required_Device_Extensions.size() );
-	createInfo.ppEnabledExtensionNames = Required_Device_Extensions.data();
+	const std::vector<const char*> deviceExtensions = GetRequiredDeviceExtensions();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>( deviceExtensions.size() );
+	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 	if( EnableValidationLayers )
 	{
@@ -655,6 +1113,8 @@ void AstroApp::CreateSurface()
 
 void AstroApp::CreateSwapchain()
 {
+	ProfileScope profileScope( m_profiler, "CreateSwapchain" );
+
 	SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport( m_physicalDevice, m_surface );
 
 	VkSurfaceFormatKHR surfaceFormat = SwapchainHelpers::ChooseSwapSurfaceFormat( swapChainSupport.formats );
@@ -689,6 +1149,15 @@ void AstroApp::CreateSwapchain()
 	// we're going to render directly to this swapchain image, for multi-stage rendering, eg: with post process effect, could use
 	// VK_IMAGE_USAGE_TRANSFER_DST_BIT instead and use a memory operation to transfer the rendered image to a swap chain image.
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	if( m_settings.isRaymarching )
+	{
+		// Raymarched frames get blitted in
+		if( !( swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT ) )
+		{
+			throw std::runtime_error( "swapchain images can't be blitted to, raymarching needs it!" );
+		}
+		createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
 
 
 	QueueFamilyIndices indices = FindQueueFamilies( m_physicalDevice, m_surface );
@@ -736,6 +1205,71 @@ void AstroApp::CreateSwapchain()
 	vkGetSwapchainImagesKHR( m_logicalDevice, m_swapChain, &imageCount, m_swapChainImages.data() );
 }
 
+void AstroApp::CreateOffscreenImages()
+{
+	ProfileScope profileScope( m_profiler, "CreateOffscreenImages" );
+
+	m_swapChainImageFormat = OFFSCREEN_IMAGE_FORMAT;
+	m_swapChainExtent = { m_settings.width, m_settings.height };
+
+	const bool isDumpingFrames = !m_settings.frameDumpDirectory.empty();
+	if( isDumpingFrames )
+	{
+		std::filesystem::create_directories( m_settings.frameDumpDirectory );
+	}
+
+	m_swapChainImages.resize( OFFSCREEN_IMAGE_COUNT );
+	m_offscreenImageAllocations.resize( OFFSCREEN_IMAGE_COUNT );
+	for( uint32_t i = 0; i < OFFSCREEN_IMAGE_COUNT; i++ )
+	{
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = m_swapChainImageFormat;
+		imageInfo.extent = { m_swapChainExtent.width, m_swapChainExtent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		// Rendered to (or raymarched frames blitted in), then copied out when dumping
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if( vkCreateImage( m_logicalDevice, &imageInfo, nullptr, &m_swapChainImages[i] ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create offscreen image!" );
+		}
+
+		m_offscreenImageAllocations[i] = m_memoryAllocator->AllocateForImage( m_swapChainImages[i], GpuMemoryUsage::GpuOnly );
+	}
+
+	if( !isDumpingFrames )
+	{
+		return;
+	}
+
+	// One host visible buffer per image, tightly packed RGBA rows
+	const VkDeviceSize dumpSize = static_cast<VkDeviceSize>( m_swapChainExtent.width ) * m_swapChainExtent.height * 4;
+	m_frameDumpBuffers.resize( OFFSCREEN_IMAGE_COUNT );
+	m_frameDumpAllocations.resize( OFFSCREEN_IMAGE_COUNT );
+	for( uint32_t i = 0; i < OFFSCREEN_IMAGE_COUNT; i++ )
+	{
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = dumpSize;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if( vkCreateBuffer( m_logicalDevice, &bufferCreateInfo, nullptr, &m_frameDumpBuffers[i] ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create frame dump buffer!" );
+		}
+
+		m_frameDumpAllocations[i] = m_memoryAllocator->AllocateForBuffer( m_frameDumpBuffers[i], GpuMemoryUsage::GpuToCpu );
+	}
+}
+
 void AstroApp::CreateImageViews()
 {
 	m_swapChainImageViews.resize( m_swapChainImages.size() );
@@ -766,19 +1300,20 @@ void AstroApp::CreateImageViews()
 }
 
 
-void AstroApp::CreateRenderPass()
+VkRenderPass AstroApp::CreateRenderPass( VkAttachmentLoadOp loadOp )
 {
 	VkAttachmentDescription colorAttachment{};
 	colorAttachment.format = m_swapChainImageFormat;
 	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.loadOp = loadOp;
 	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	// Stencil - not used
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
-	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// The render graph transitions the image around the pass (from UNDEFINED, to PRESENT_SRC / TRANSFER_SRC...)
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 	// Note : images need to be transitioned to specific layouts that are suitable for the operation that they're going to be involved in next.
 	// eg:
 	// VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: Images used as color attachment
@@ -792,74 +1327,75 @@ void AstroApp::CreateRenderPass()
 	colorAttachmentRef.attachment = 0; // Attachement index 0 (ie: layout(location = 0) out vec4 outColor)
 	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+	// Stored: the Hi-Z pyramid is built from it, then chunks found visible by occlusion culling draw on top of it
+	VkAttachmentDescription depthAttachment{};
+	depthAttachment.format = DEPTH_FORMAT;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = loadOp;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference depthAttachmentRef{};
+	depthAttachmentRef.attachment = 1;
+	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
 	VkSubpassDescription subpass{};
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpass.colorAttachmentCount = 1;
 	subpass.pColorAttachments = &colorAttachmentRef;
+	subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-	VkSubpassDependency dependency{};
-	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	dependency.dstSubpass = 0;
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.srcAccessMask = 0;
-	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	// No subpass dependencies, the render graph's barriers sync the pass with what comes before & after it
 
 	// Create!
+	VkAttachmentDescription attachments[] = { colorAttachment, depthAttachment };
+
 	VkRenderPassCreateInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassInfo.attachmentCount = 1;
-	renderPassInfo.pAttachments = &colorAttachment;
+	renderPassInfo.attachmentCount = 2;
+	renderPassInfo.pAttachments = attachments;
 	renderPassInfo.subpassCount = 1;
 	renderPassInfo.pSubpasses = &subpass;
-	renderPassInfo.dependencyCount = 1;
-	renderPassInfo.pDependencies = &dependency;
+	renderPassInfo.dependencyCount = 0;
+	renderPassInfo.pDependencies = nullptr;
 
-	if( vkCreateRenderPass( m_logicalDevice, &renderPassInfo, nullptr, &m_renderPass ) != VK_SUCCESS )
+	VkRenderPass renderPass;
+	if( vkCreateRenderPass( m_logicalDevice, &renderPassInfo, nullptr, &renderPass ) != VK_SUCCESS )
 	{
 		throw std::runtime_error( "failed to create render pass!" );
 	}
+	return renderPass;
 }
 
 
 void AstroApp::CreateGraphicsPipeline()
 {
+	ProfileScope profileScope( m_profiler, "CreateGraphicsPipeline" );
 
-	// Load simple shader
-	auto simpleShaderVertCode = FileHelpers::ReadFile( "src/Resources/Shaders/SimpleShader.vert.spirv" );
-	auto simpleShaderFragCode = FileHelpers::ReadFile( "src/Resources/Shaders/SimpleShader.frag.spirv" );
-
-	if( simpleShaderVertCode.size() == 0 )
-	{
-		throw std::runtime_error( "Simple Shader (vert) file size is 0!" );
-	}
-
-	if( simpleShaderFragCode.size() == 0 )
-	{
-		throw std::runtime_error( "Simple Shader (frag) file size is 0!" );
-	}
-
-
-	VkShaderModule simpleShaderVertModule = CreateShaderModule( simpleShaderVertCode, m_logicalDevice );
-	VkShaderModule simpleShaderFragModule = CreateShaderModule( simpleShaderFragCode, m_logicalDevice );
+	// Load the chunk shaders
+	VkShaderModule voxelChunkVertModule = CreateShaderModule( Shaders::VoxelChunk_Vert, m_logicalDevice );
+	VkShaderModule voxelChunkFragModule = CreateShaderModule( Shaders::VoxelChunk_Frag, m_logicalDevice );
 
 	// Vertex shader stage
 	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
 	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageInfo.module = simpleShaderVertModule;
+	vertShaderStageInfo.module = voxelChunkVertModule;
 	vertShaderStageInfo.pName = "main";
 
 	// Fragment shader stage
 	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
 	fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module = simpleShaderFragModule;
+	fragShaderStageInfo.module = voxelChunkFragModule;
 	fragShaderStageInfo.pName = "main";
 
 	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
-	// Vertex shader input
+	// Vertex shader input - none, VoxelChunk.vert pulls its vertices out of the chunk mesh pool
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 	vertexInputInfo.vertexBindingDescriptionCount = 0;
@@ -903,7 +1439,7 @@ void AstroApp::CreateGraphicsPipeline()
 	rasterizer.polygonMode = VK_POLYGON_MODE_FILL; //note VK_POLYGON_MODE_LINE would be wireframe - requires a GPU feature though
 	rasterizer.lineWidth = 1.0f;
 	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT; // Cull backfaces
-	rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE; // order of vertices to define front facing face
+	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // order of vertices to define front facing face, see VoxelMesher & the flipped projection
 	// depth bias can be used for shadowmapping, but not needed here
 	rasterizer.depthBiasEnable = VK_FALSE;
 	rasterizer.depthBiasConstantFactor = 0.0f; // Optional
@@ -920,8 +1456,14 @@ void AstroApp::CreateGraphicsPipeline()
 	multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
 	multisampling.alphaToOneEnable = VK_FALSE; // Optional
 
-	// Depth & stencil info - no need for this yet
-	//VkPipelineDepthStencilStateCreateInfo
+	// Depth & stencil info - depth only
+	VkPipelineDepthStencilStateCreateInfo depthStencil{};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = VK_TRUE;
+	depthStencil.depthWriteEnable = VK_TRUE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.stencilTestEnable = VK_FALSE;
 
 	// Blend mode
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
@@ -946,19 +1488,6 @@ void AstroApp::CreateGraphicsPipeline()
 	colorBlending.blendConstants[3] = 0.0f; // Optional
 
 
-	// Pipeline Layout (uniforms)
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 0; // Optional
-	pipelineLayoutInfo.pSetLayouts = nullptr; // Optional
-	pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-	pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
-
-	if( vkCreatePipelineLayout( m_logicalDevice, &pipelineLayoutInfo, nullptr, &m_graphicsPipelineLayout ) != VK_SUCCESS )
-	{
-		throw std::runtime_error( "failed to create pipeline layout!" );
-	}
-
 	// Create pipeline
 	VkGraphicsPipelineCreateInfo pipelineInfo{};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -969,200 +1498,101 @@ void AstroApp::CreateGraphicsPipeline()
 	pipelineInfo.pViewportState = &viewportState;
 	pipelineInfo.pRasterizationState = &rasterizer;
 	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = nullptr; // Optional
+	pipelineInfo.pDepthStencilState = &depthStencil;
 	pipelineInfo.pColorBlendState = &colorBlending;
 	pipelineInfo.pDynamicState = nullptr; // Optional
-	pipelineInfo.layout = m_graphicsPipelineLayout;
+	pipelineInfo.layout = m_descriptorHeap->GetPipelineLayout(); // shared by every pipeline
 	pipelineInfo.renderPass = m_renderPass;
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
 	pipelineInfo.basePipelineIndex = -1; // Optional
 
-	if( vkCreateGraphicsPipelines( m_logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline ) != VK_SUCCESS )
+	const int64_t creationStartTimestamp = m_profiler.GetTimestamp();
+	if( vkCreateGraphicsPipelines( m_logicalDevice, m_pipelineCache->GetHandle(), 1, &pipelineInfo, nullptr, &m_graphicsPipeline ) != VK_SUCCESS )
 	{
 		throw std::runtime_error( "failed to create graphics pipeline!" );
 	}
+	m_pipelineCreationTime += m_profiler.GetTimestamp() - creationStartTimestamp;
 
 
 	// Shader modules are loaded into the graphics pipeline, so we can destroy the local variables since they're not referenced directly
-	vkDestroyShaderModule( m_logicalDevice, simpleShaderFragModule, nullptr );
-	vkDestroyShaderModule( m_logicalDevice, simpleShaderVertModule, nullptr );
+	vkDestroyShaderModule( m_logicalDevice, voxelChunkFragModule, nullptr );
+	vkDestroyShaderModule( m_logicalDevice, voxelChunkVertModule, nullptr );
 }
 
 
-void AstroApp::CreateComputePipeline()
+void AstroApp::CreateComputePipelines()
 {
-	// Load simple compute shader
-	auto simpleShaderComputeCode = FileHelpers::ReadFile( "src/Resources/Shaders/SimpleShader.comp.spirv" );
-
-	if( simpleShaderComputeCode.size() == 0 )
-	{
-		throw std::runtime_error( "Simple Shader (compute) file size is 0!" );
-	}
-
-	VkShaderModule simpleShaderComputeModule = CreateShaderModule( simpleShaderComputeCode, m_logicalDevice );
+	ProfileScope profileScope( m_profiler, "CreateComputePipelines" );
+
+	VkShaderModule simpleShaderComputeModule = CreateShaderModule( Shaders::SimpleShader_Comp, m_logicalDevice );
+	VkShaderModule chunkCullModule = CreateShaderModule( Shaders::ChunkCull_Comp, m_logicalDevice );
+	VkShaderModule hiZBuildModule = CreateShaderModule( Shaders::HiZBuild_Comp, m_logicalDevice );
+	VkShaderModule raymarchModule = CreateShaderModule( Shaders::Raymarch_Comp, m_logicalDevice );
+
+	m_computePipeline = CreateComputePipeline( simpleShaderComputeModule );
+	m_chunkCullPipeline = CreateComputePipeline( chunkCullModule );
+	m_hiZBuildPipeline = CreateComputePipeline( hiZBuildModule );
+	m_raymarchPipeline = CreateComputePipeline( raymarchModule );
+
+	// Shader modules are loaded into the compute pipelines, so we can destroy the local variables since they're not referenced directly
+	vkDestroyShaderModule( m_logicalDevice, raymarchModule, nullptr );
+	vkDestroyShaderModule( m_logicalDevice, hiZBuildModule, nullptr );
+	vkDestroyShaderModule( m_logicalDevice, chunkCullModule, nullptr );
+	vkDestroyShaderModule( m_logicalDevice, simpleShaderComputeModule, nullptr );
+}
 
+VkPipeline AstroApp::CreateComputePipeline( VkShaderModule shaderModule )
+{
 	VkPipelineShaderStageCreateInfo shaderStageInfo{};
 	shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	shaderStageInfo.pNext = nullptr;
 	shaderStageInfo.flags = 0;
 	shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-	shaderStageInfo.module = simpleShaderComputeModule;
+	shaderStageInfo.module = shaderModule;
 	shaderStageInfo.pName = "main";
 	shaderStageInfo.pSpecializationInfo = nullptr;
 
-	// Pipeline Layout (uniforms)
-	//-----TODO : update the layout to add the example simple compute shader's input & output textures
-	VkDescriptorSetLayoutBinding descriptorLayoutBindingZero{};
-	descriptorLayoutBindingZero.binding = 0;
-	descriptorLayoutBindingZero.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	descriptorLayoutBindingZero.descriptorCount = 1;
-	descriptorLayoutBindingZero.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-	descriptorLayoutBindingZero.pImmutableSamplers = nullptr;
-
-	VkDescriptorSetLayoutBinding descriptorLayoutBindingOne{};
-	descriptorLayoutBindingOne.binding = 1;
-	descriptorLayoutBindingOne.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	descriptorLayoutBindingOne.descriptorCount = 1;
-	descriptorLayoutBindingOne.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-	descriptorLayoutBindingOne.pImmutableSamplers = nullptr;
-
-	std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindings{ descriptorLayoutBindingZero, descriptorLayoutBindingOne };
-
-	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
-	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descriptorSetLayoutCreateInfo.pNext = nullptr;
-	descriptorSetLayoutCreateInfo.flags = 0;
-	descriptorSetLayoutCreateInfo.bindingCount = descriptorSetLayoutBindings.size();
-	descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
-
-	if( vkCreateDescriptorSetLayout( m_logicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &m_computeDescriptorSetLayout ) != VK_SUCCESS )
-	{
-		throw std::runtime_error( "failed to create compute pipeline descriptor layout!" );
-	}
-
-	VkDescriptorPoolSize descriptorPoolSize = {};
-	descriptorPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	descriptorPoolSize.descriptorCount = 2;
-
-	VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
-	descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	descriptorPoolInfo.pNext = nullptr;
-	descriptorPoolInfo.poolSizeCount = 1;
-	descriptorPoolInfo.pPoolSizes = &descriptorPoolSize;
-	descriptorPoolInfo.maxSets = 1;
-
-	if( vkCreateDescriptorPool( m_logicalDevice, &descriptorPoolInfo, nullptr, &m_computeDescriptorPool ) != VK_SUCCESS )
-	{
-		throw std::runtime_error( "failed to create compute storage descriptor pool!" );
-	}
-
-	VkDescriptorSetAllocateInfo descriptorSetAllocInfo = {};
-	descriptorSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	descriptorSetAllocInfo.pNext = nullptr;
-	descriptorSetAllocInfo.descriptorPool = m_computeDescriptorPool;
-	descriptorSetAllocInfo.pSetLayouts = &m_computeDescriptorSetLayout;
-	descriptorSetAllocInfo.descriptorSetCount = 1;
-	if( vkAllocateDescriptorSets( m_logicalDevice, &descriptorSetAllocInfo, &m_computeDescriptorSet ) != VK_SUCCESS )
-	{
-		throw std::runtime_error( "failed to create compute Descriptor set!" );
-	}
-
-	//TEMP, copied from buffer creation code - shouldn't be hardcoded & potentially different
-	const VkDeviceSize computeBufferMemorySize = sizeof( float );
-
-	VkDescriptorBufferInfo descriptorBufferInfo = {};
-	descriptorBufferInfo.buffer = m_computeDataBuffers[0];
-	descriptorBufferInfo.offset = 0;
-	descriptorBufferInfo.range = computeBufferMemorySize;
-
-	VkWriteDescriptorSet writeDescriptorSet = {};
-	writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	writeDescriptorSet.dstSet = m_computeDescriptorSet;
-	writeDescriptorSet.dstBinding = 0;
-	writeDescriptorSet.dstArrayElement = 0;
-	writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pBufferInfo = &descriptorBufferInfo;
-
-	// TODO, instead of calling this twice, we can probably just make a VECTOR of VkWriteDescriptorSet & set the count to 2
-	vkUpdateDescriptorSets(
-	  m_logicalDevice,
-	  1, //descriptor set count
-	  &writeDescriptorSet,
-	  0,
-	  nullptr );
-
-
-	VkDescriptorBufferInfo descriptorBufferInfo2 = {};
-	descriptorBufferInfo2.buffer = m_computeDataBuffers[1];
-	descriptorBufferInfo2.offset = 0;
-	descriptorBufferInfo2.range = computeBufferMemorySize;
-
-	VkWriteDescriptorSet writeDescriptorSet2 = {};
-	writeDescriptorSet2.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	writeDescriptorSet2.dstSet = m_computeDescriptorSet;
-	writeDescriptorSet2.dstBinding = 1;
-	writeDescriptorSet2.dstArrayElement = 0;
-	writeDescriptorSet2.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	writeDescriptorSet2.descriptorCount = 1;
-	writeDescriptorSet2.pBufferInfo = &descriptorBufferInfo2;
-
-	// TODO, instead of calling this twice, we can probably just make a VECTOR of VkWriteDescriptorSet & set the count to 2
-	vkUpdateDescriptorSets(
-	  m_logicalDevice,
-	  1, //descriptor set count
-	  &writeDescriptorSet2,
-	  0,
-	  nullptr );
-
-
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.pNext = nullptr;
-	pipelineLayoutInfo.flags = 0;
-	pipelineLayoutInfo.setLayoutCount = 1; // Optional
-	pipelineLayoutInfo.pSetLayouts = &m_computeDescriptorSetLayout; // Optional
-	pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-	pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
-
-	if( vkCreatePipelineLayout( m_logicalDevice, &pipelineLayoutInfo, nullptr, &m_computePipelineLayout ) != VK_SUCCESS )
-	{
-		throw std::runtime_error( "failed to create pipeline layout!" );
-	}
-
 	VkComputePipelineCreateInfo computePipelineInfo{};
 	computePipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
 	computePipelineInfo.pNext = nullptr;
 	computePipelineInfo.flags = 0;
 	computePipelineInfo.stage = shaderStageInfo;
-	computePipelineInfo.layout = m_computePipelineLayout;
+	computePipelineInfo.layout = m_descriptorHeap->GetPipelineLayout(); // shared by every pipeline
 	computePipelineInfo.basePipelineIndex = 0; // Optional
 	computePipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
 
-	if( vkCreateComputePipelines( m_logicalDevice, VK_NULL_HANDLE, 1, &computePipelineInfo, nullptr, &m_computePipeline ) != VK_SUCCESS )
+	VkPipeline computePipeline;
+	const int64_t creationStartTimestamp = m_profiler.GetTimestamp();
+	if( vkCreateComputePipelines( m_logicalDevice, m_pipelineCache->GetHandle(), 1, &computePipelineInfo, nullptr, &computePipeline ) != VK_SUCCESS )
 	{
 		throw std::runtime_error( "failed to create compute pipeline!" );
 	}
-
-	// Shader module is loaded into the compute pipeline, so we can destroy the local variables since they're not referenced directly
-	vkDestroyShaderModule( m_logicalDevice, simpleShaderComputeModule, nullptr );
+	m_pipelineCreationTime += m_profiler.GetTimestamp() - creationStartTimestamp;
+	return computePipeline;
 }
 
 void AstroApp::CreateFramebuffers()
 {
+	if( m_settings.isRaymarching )
+	{
+		return; // nothing rasterized
+	}
+
 	m_swapChainFramebuffers.resize( m_swapChainImageViews.size() );
 
 	for( size_t i = 0; i < m_swapChainImageViews.size(); i++ )
 	{
+		// One depth image shared by every framebuffer, frames on the graphics queue use it one after the other
 		VkImageView attachments[] = {
-			m_swapChainImageViews[i]
+			m_swapChainImageViews[i],
+			m_graphicsGraph->GetImageView( m_depthImage )
 		};
 
 		VkFramebufferCreateInfo framebufferInfo{};
 		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 		framebufferInfo.renderPass = m_renderPass;
-		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.attachmentCount = 2;
 		framebufferInfo.pAttachments = attachments;
 		framebufferInfo.width = m_swapChainExtent.width;
 		framebufferInfo.height = m_swapChainExtent.height;
@@ -1175,100 +1605,515 @@ void AstroApp::CreateFramebuffers()
 	}
 }
 
-void AstroApp::CreateCommandPool()
+void AstroApp::BeginRenderPass( VkCommandBuffer commandBuffer, VkRenderPass renderPass, uint32_t imageIndex, VkSubpassContents contents )
+{
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = renderPass;
+	renderPassInfo.framebuffer = m_swapChainFramebuffers[imageIndex];
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = m_swapChainExtent;
+
+	VkClearValue clearValues[2];
+	clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+	clearValues[1].depthStencil = { 1.0f, 0 }; // ignored by m_continueRenderPass
+	renderPassInfo.clearValueCount = 2;
+	renderPassInfo.pClearValues = clearValues;
+
+	vkCmdBeginRenderPass( commandBuffer, &renderPassInfo, contents );
+}
+
+void AstroApp::CreateCommandPools()
 {
 	QueueFamilyIndices queueFamilyIndices = FindQueueFamilies( m_physicalDevice, m_surface );
 
-	VkCommandPoolCreateInfo poolInfo{};
-	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // Optional
+	// Command buffers can only go to queues of their pool's family, compute may have its own
+	m_graphicsCommandPool = std::make_unique<FrameCommandPool>( m_logicalDevice, queueFamilyIndices.graphicsFamily.value(), m_settings.framesInFlight );
+	m_computeCommandPool = std::make_unique<FrameCommandPool>( m_logicalDevice, queueFamilyIndices.computeFamily.value(), m_settings.framesInFlight );
+}
 
-	if( vkCreateCommandPool( m_logicalDevice, &poolInfo, nullptr, &m_commandPool ) != VK_SUCCESS )
+void AstroApp::CreateRenderGraphs()
+{
+	ProfileScope profileScope( m_profiler, "CreateRenderGraphs" );
+
+	// Compute: the simulation step, into the frame's output that graphics reads the frame after (see DrawFrame).
+	// Executed with the output's index as the slot.
+	m_computeGraph = std::make_unique<RenderGraph>( m_logicalDevice, *m_memoryAllocator );
+	const RenderGraph::Resource dataIn = m_computeGraph->ImportBuffers( "Data in", { m_computeDataBuffers[0] } );
+	const RenderGraph::Resource dataOut =
+	  m_computeGraph->ImportBuffers( "Simulation output", std::vector<VkBuffer>( m_computeDataBuffers.begin() + 1, m_computeDataBuffers.end() ) );
+
+	m_computeGraph->AddPass( "Compute dispatch",
+	  { { dataIn, RenderGraphUsage::ComputeRead }, { dataOut, RenderGraphUsage::ComputeWrite } },
+	  [this]( VkCommandBuffer commandBuffer, uint32_t outputIndex ) {
+		  vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline );
+		  m_descriptorHeap->Bind( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE );
+		  m_descriptorHeap->PushConstants( commandBuffer, SimulatePushConstants{ m_computeDataDescriptorIndices[0], m_computeDataDescriptorIndices[1 + outputIndex] } );
+
+		  glm::vec3 dispatchGroupSize = glm::vec3( 1, 1, 1 );
+		  vkCmdDispatch( commandBuffer, dispatchGroupSize.x, dispatchGroupSize.y, dispatchGroupSize.z );
+	  } );
+
+	m_computeGraph->Compile();
+
+	// Graphics: the frame drawn into the image, then presented or copied out for DumpFrame
+	m_graphicsGraph = std::make_unique<RenderGraph>( m_logicalDevice, *m_memoryAllocator );
+	const std::optional<RenderGraphUsage> imageFinalUsage = m_settings.isHeadless ? std::nullopt : std::make_optional( RenderGraphUsage::Present );
+	const RenderGraph::Resource image = m_graphicsGraph->ImportImages( "Swapchain image", m_swapChainImages, VK_IMAGE_ASPECT_COLOR_BIT, true, imageFinalUsage );
+
+	if( m_settings.isRaymarching )
 	{
-		throw std::runtime_error( "failed to create command pool!" );
+		// A ray per pixel through the voxel store instead of the chunk meshes, then blitted to the image (converting its format)
+		m_raymarchTarget = m_graphicsGraph->CreateTransientImage( "Raymarch target",
+		  RAYMARCH_TARGET_FORMAT,
+		  m_swapChainExtent,
+		  VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		  VK_IMAGE_ASPECT_COLOR_BIT );
+
+		// The dirty bricks staged by GpuVoxelStore::Update
+		const RenderGraph::Resource brickmaps = m_graphicsGraph->ImportBuffers( "Voxel brickmaps", { m_voxelStore->GetBrickmapBuffer() } );
+		const RenderGraph::Resource bricks = m_graphicsGraph->ImportBuffers( "Voxel bricks", { m_voxelStore->GetBrickBuffer() } );
+		m_graphicsGraph->AddPass( "Voxel upload",
+		  { { brickmaps, RenderGraphUsage::TransferWrite }, { bricks, RenderGraphUsage::TransferWrite } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t ) {
+			  m_voxelStore->RecordUploads( commandBuffer );
+		  } );
+
+		m_graphicsGraph->AddPass( "Raymarch",
+		  { { brickmaps, RenderGraphUsage::ComputeRead }, { bricks, RenderGraphUsage::ComputeRead }, { m_raymarchTarget, RenderGraphUsage::ComputeWrite } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t ) {
+			  RecordRaymarch( commandBuffer );
+		  } );
+
+		m_graphicsGraph->AddPass( "Raymarch blit",
+		  { { m_raymarchTarget, RenderGraphUsage::TransferRead }, { image, RenderGraphUsage::TransferWrite } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t imageIndex ) {
+			  RecordRaymarchBlit( commandBuffer, imageIndex );
+		  } );
+	}
+	else if( m_settings.isCpuDrawing )
+	{
+		m_depthImage = m_graphicsGraph->CreateTransientImage( "Depth", DEPTH_FORMAT, m_swapChainExtent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT );
+
+		// The chunk draws are culled & recorded in parallel beforehand (see RecordChunkDrawSecondaries), the pass only executes them
+		m_graphicsGraph->AddPass( "Render pass",
+		  { { image, RenderGraphUsage::ColorAttachment }, { m_depthImage, RenderGraphUsage::DepthAttachment } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t imageIndex ) {
+			  BeginRenderPass( commandBuffer, m_renderPass, imageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+			  if( !m_chunkCommandBuffers.empty() )
+			  {
+				  vkCmdExecuteCommands( commandBuffer, static_cast<uint32_t>( m_chunkCommandBuffers.size() ), m_chunkCommandBuffers.data() );
+			  }
+			  vkCmdEndRenderPass( commandBuffer );
+		  } );
+	}
+	else
+	{
+		// GPU driven: the visible chunks' draws get appended by compute passes, the CPU records the same few commands whatever the chunk count.
+		// Two phase occlusion culling: the chunks visible last frame are drawn first, their depth builds a Hi-Z pyramid the
+		// rest are tested against, and the ones found visible get drawn on top. Chunks coming into view show up the same frame.
+		m_depthImage = m_graphicsGraph->CreateTransientImage( "Depth",
+		  DEPTH_FORMAT,
+		  m_swapChainExtent,
+		  VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		  VK_IMAGE_ASPECT_DEPTH_BIT );
+
+		// Half the depth buffer's size (rounded up) down to 1x1
+		VkExtent2D hiZMipExtent = { ( m_swapChainExtent.width + 1 ) / 2, ( m_swapChainExtent.height + 1 ) / 2 };
+		m_hiZMipExtents = { hiZMipExtent };
+		while( hiZMipExtent.width > 1 || hiZMipExtent.height > 1 )
+		{
+			hiZMipExtent = { ( hiZMipExtent.width + 1 ) / 2, ( hiZMipExtent.height + 1 ) / 2 };
+			m_hiZMipExtents.push_back( hiZMipExtent );
+		}
+		m_hiZImage = m_graphicsGraph->CreateTransientImage( "Hi-Z",
+		  HI_Z_FORMAT,
+		  m_hiZMipExtents[0],
+		  VK_IMAGE_USAGE_STORAGE_BIT,
+		  VK_IMAGE_ASPECT_COLOR_BIT,
+		  static_cast<uint32_t>( m_hiZMipExtents.size() ) );
+
+		const RenderGraph::Resource drawCommands = m_graphicsGraph->ImportBuffers( "Chunk draw commands", { m_indirectChunkDraws->GetDrawCommandBuffer() } );
+		const RenderGraph::Resource drawCount = m_graphicsGraph->ImportBuffers( "Chunk draw count", { m_indirectChunkDraws->GetDrawCountBuffer() } );
+		const RenderGraph::Resource visibility = m_graphicsGraph->ImportBuffers( "Chunk visibility", { m_indirectChunkDraws->GetVisibilityBuffer() } );
+
+		m_graphicsGraph->AddPass( "Clear chunk draw count", { { drawCount, RenderGraphUsage::TransferWrite } }, [this]( VkCommandBuffer commandBuffer, uint32_t ) {
+			vkCmdFillBuffer( commandBuffer, m_indirectChunkDraws->GetDrawCountBuffer(), 0, VK_WHOLE_SIZE, 0 );
+		} );
+
+		m_graphicsGraph->AddPass( "Chunk cull (visible last frame)",
+		  { { drawCommands, RenderGraphUsage::ComputeWrite },
+			{ drawCount, RenderGraphUsage::ComputeRead },
+			{ drawCount, RenderGraphUsage::ComputeWrite },
+			{ visibility, RenderGraphUsage::ComputeRead } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t ) {
+			  RecordChunkCull( commandBuffer, 0 );
+		  } );
+
+		m_graphicsGraph->AddPass( "Render pass (visible last frame)",
+		  { { image, RenderGraphUsage::ColorAttachment },
+			{ m_depthImage, RenderGraphUsage::DepthAttachment },
+			{ drawCommands, RenderGraphUsage::IndirectBuffer },
+			{ drawCount, RenderGraphUsage::IndirectBuffer } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t imageIndex ) {
+			  RecordIndirectChunkDraws( commandBuffer, m_renderPass, imageIndex, 0 );
+		  } );
+
+		m_graphicsGraph->AddPass( "Hi-Z build",
+		  { { m_depthImage, RenderGraphUsage::ComputeSampled }, { m_hiZImage, RenderGraphUsage::ComputeRead }, { m_hiZImage, RenderGraphUsage::ComputeWrite } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t ) {
+			  RecordHiZBuild( commandBuffer );
+		  } );
+
+		m_graphicsGraph->AddPass( "Chunk cull (occlusion)",
+		  { { m_hiZImage, RenderGraphUsage::ComputeRead },
+			{ drawCommands, RenderGraphUsage::ComputeWrite },
+			{ drawCount, RenderGraphUsage::ComputeRead },
+			{ drawCount, RenderGraphUsage::ComputeWrite },
+			{ visibility, RenderGraphUsage::ComputeRead },
+			{ visibility, RenderGraphUsage::ComputeWrite } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t ) {
+			  RecordChunkCull( commandBuffer, 1 );
+		  } );
+
+		m_graphicsGraph->AddPass( "Render pass (newly visible)",
+		  { { image, RenderGraphUsage::ColorAttachment },
+			{ m_depthImage, RenderGraphUsage::DepthAttachment },
+			{ drawCommands, RenderGraphUsage::IndirectBuffer },
+			{ drawCount, RenderGraphUsage::IndirectBuffer } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t imageIndex ) {
+			  RecordIndirectChunkDraws( commandBuffer, m_continueRenderPass, imageIndex, 1 );
+		  } );
 	}
-}
 
-void AstroApp::CreateCommandBuffers()
-{
-	m_commandBuffers.resize( m_swapChainFramebuffers.size() );
+	if( !m_frameDumpBuffers.empty() )
+	{
+		const RenderGraph::Resource frameDump = m_graphicsGraph->ImportBuffers( "Frame dump", m_frameDumpBuffers, RenderGraphUsage::HostRead );
+		m_graphicsGraph->AddPass( "Frame dump",
+		  { { image, RenderGraphUsage::TransferRead }, { frameDump, RenderGraphUsage::TransferWrite } },
+		  [this]( VkCommandBuffer commandBuffer, uint32_t imageIndex ) {
+			  VkBufferImageCopy copyRegion{};
+			  copyRegion.bufferOffset = 0;
+			  copyRegion.bufferRowLength = 0; // tightly packed
+			  copyRegion.bufferImageHeight = 0;
+			  copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			  copyRegion.imageSubresource.mipLevel = 0;
+			  copyRegion.imageSubresource.baseArrayLayer = 0;
+			  copyRegion.imageSubresource.layerCount = 1;
+			  copyRegion.imageOffset = { 0, 0, 0 };
+			  copyRegion.imageExtent = { m_swapChainExtent.width, m_swapChainExtent.height, 1 };
+			  vkCmdCopyImageToBuffer( commandBuffer,
+				m_swapChainImages[imageIndex],
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				m_frameDumpBuffers[imageIndex],
+				1,
+				&copyRegion );
+		  } );
+	}
 
-	VkCommandBufferAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.commandPool = m_commandPool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = (uint32_t)m_commandBuffers.size();
+	m_graphicsGraph->Compile();
+}
 
-	if( vkAllocateCommandBuffers( m_logicalDevice, &allocInfo, m_commandBuffers.data() ) != VK_SUCCESS )
+void AstroApp::CreateHiZDescriptors()
+{
+	if( m_hiZMipExtents.empty() )
 	{
-		throw std::runtime_error( "failed to allocate graphics command buffers!" );
+		return; // GPU culling only
 	}
 
-
-	for( size_t i = 0; i < m_commandBuffers.size(); i++ )
+	// A view per mip: each HiZBuild.comp dispatch reads one & writes the next, ChunkCull.comp picks one per chunk
+	const VkImage hiZImage = m_graphicsGraph->GetImage( m_hiZImage );
+	for( uint32_t mip = 0; mip < m_hiZMipExtents.size(); ++mip )
 	{
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = 0; // Optional
-		beginInfo.pInheritanceInfo = nullptr; // Optional
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = hiZImage;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = HI_Z_FORMAT;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = mip;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		VkImageView hiZMipView;
+		if( vkCreateImageView( m_logicalDevice, &viewInfo, nullptr, &hiZMipView ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create hi-z mip view!" );
+		}
+		m_hiZMipViews.push_back( hiZMipView );
 
-		if( vkBeginCommandBuffer( m_commandBuffers[i], &beginInfo ) != VK_SUCCESS )
+		const uint32_t descriptorIndex = m_descriptorHeap->AddStorageImage( hiZMipView );
+		if( mip == 0 )
+		{
+			m_hiZFirstDescriptorIndex = descriptorIndex;
+		}
+		else if( descriptorIndex != m_hiZFirstDescriptorIndex + mip )
 		{
-			throw std::runtime_error( "failed to begin recording command buffer!" );
+			throw std::runtime_error( "hi-z mip descriptors aren't in a row!" );
 		}
+	}
+
+	// Depth is read with texelFetch, the sampler only has to be there
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_NEAREST;
+	samplerInfo.minFilter = VK_FILTER_NEAREST;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	if( vkCreateSampler( m_logicalDevice, &samplerInfo, nullptr, &m_depthSampler ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create depth sampler!" );
+	}
 
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = m_renderPass;
-		renderPassInfo.framebuffer = m_swapChainFramebuffers[i];
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = m_swapChainExtent;
+	m_depthDescriptorIndex = m_descriptorHeap->AddSampledImage( m_graphicsGraph->GetImageView( m_depthImage ) );
+	m_depthSamplerDescriptorIndex = m_descriptorHeap->AddSampler( m_depthSampler );
+	m_descriptorHeap->FlushWrites();
+}
 
-		VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-		renderPassInfo.clearValueCount = 1;
-		renderPassInfo.pClearValues = &clearColor;
+void AstroApp::CreateRaymarchDescriptors()
+{
+	if( !m_settings.isRaymarching )
+	{
+		return;
+	}
 
-		vkCmdBeginRenderPass( m_commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
+	m_raymarchTargetDescriptorIndex = m_descriptorHeap->AddStorageImage( m_graphicsGraph->GetImageView( m_raymarchTarget ) );
+	m_descriptorHeap->FlushWrites();
+}
 
-		// Bind Graphics pipeline
-		vkCmdBindPipeline( m_commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline );
+void AstroApp::RecordRaymarch( VkCommandBuffer commandBuffer )
+{
+	const RaymarchPushConstants pushConstants{ glm::inverse( m_chunkFrame.viewProjection ),
+		m_voxelStore->GetGridOrigin(),
+		m_voxelStore->GetGridSize(),
+		m_voxelStore->GetGridDescriptorIndex(),
+		m_chunkFrame.firstGridCell,
+		m_voxelStore->GetBrickmapDescriptorIndex(),
+		m_voxelStore->GetBrickDescriptorIndex(),
+		m_raymarchTargetDescriptorIndex,
+		0,
+		glm::uvec2( m_swapChainExtent.width, m_swapChainExtent.height ) };
+
+	vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_raymarchPipeline );
+	m_descriptorHeap->Bind( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE );
+	m_descriptorHeap->PushConstants( commandBuffer, pushConstants );
+	vkCmdDispatch( commandBuffer,
+	  ( m_swapChainExtent.width + RAYMARCH_GROUP_SIZE - 1 ) / RAYMARCH_GROUP_SIZE,
+	  ( m_swapChainExtent.height + RAYMARCH_GROUP_SIZE - 1 ) / RAYMARCH_GROUP_SIZE,
+	  1 );
+}
 
-		// Draw triangle
-		vkCmdDraw( m_commandBuffers[i],
-		  3, // Vertex count
-		  1, // instance count
-		  0, // offset vertex -> gl_VertexIndex
-		  0 // offset instance index ->
-		);
+void AstroApp::RecordRaymarchBlit( VkCommandBuffer commandBuffer, uint32_t imageIndex )
+{
+	// Same size, the blit only converts the format (UNORM to the swapchain's, usually SRGB)
+	VkImageBlit blitRegion{};
+	blitRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	blitRegion.srcOffsets[1] = { static_cast<int32_t>( m_swapChainExtent.width ), static_cast<int32_t>( m_swapChainExtent.height ), 1 };
+	blitRegion.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	blitRegion.dstOffsets[1] = blitRegion.srcOffsets[1];
+
+	vkCmdBlitImage( commandBuffer,
+	  m_graphicsGraph->GetImage( m_raymarchTarget ),
+	  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	  m_swapChainImages[imageIndex],
+	  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	  1,
+	  &blitRegion,
+	  VK_FILTER_NEAREST );
+}
 
-		vkCmdEndRenderPass( m_commandBuffers[i] );
+void AstroApp::RecordHiZBuild( VkCommandBuffer commandBuffer )
+{
+	vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hiZBuildPipeline );
+	m_descriptorHeap->Bind( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE );
 
-		if( vkEndCommandBuffer( m_commandBuffers[i] ) != VK_SUCCESS )
+	VkExtent2D sourceExtent = m_swapChainExtent;
+	for( uint32_t mip = 0; mip < m_hiZMipExtents.size(); ++mip )
+	{
+		// The graph syncs the pass as a whole, each mip waits on the one above it here
+		if( mip != 0 )
 		{
-			throw std::runtime_error( "failed to record command buffer!" );
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr );
 		}
+
+		const VkExtent2D mipExtent = m_hiZMipExtents[mip];
+		const HiZBuildPushConstants pushConstants{ glm::uvec2( sourceExtent.width, sourceExtent.height ),
+			glm::uvec2( mipExtent.width, mipExtent.height ),
+			mip == 0 ? m_depthDescriptorIndex : m_hiZFirstDescriptorIndex + mip - 1,
+			m_hiZFirstDescriptorIndex + mip,
+			m_depthSamplerDescriptorIndex,
+			mip == 0 ? 1u : 0u };
+		m_descriptorHeap->PushConstants( commandBuffer, pushConstants );
+		vkCmdDispatch( commandBuffer,
+		  ( mipExtent.width + HI_Z_BUILD_GROUP_SIZE - 1 ) / HI_Z_BUILD_GROUP_SIZE,
+		  ( mipExtent.height + HI_Z_BUILD_GROUP_SIZE - 1 ) / HI_Z_BUILD_GROUP_SIZE,
+		  1 );
+		sourceExtent = mipExtent;
 	}
 }
 
+void AstroApp::RecordChunkCull( VkCommandBuffer commandBuffer, uint32_t cullPhase )
+{
+	if( m_chunkFrame.chunkCount == 0 )
+	{
+		return;
+	}
 
-void AstroApp::CreateComputeCommandBuffers()
+	const ChunkCullPushConstants pushConstants{ m_chunkFrame.viewProjection,
+		m_indirectChunkDraws->GetChunkDescriptorIndex(),
+		m_chunkFrame.firstChunk,
+		m_chunkFrame.chunkCount,
+		m_indirectChunkDraws->GetDrawCommandDescriptorIndex(),
+		m_indirectChunkDraws->GetFirstDrawCommand( cullPhase ),
+		m_indirectChunkDraws->GetDrawCountDescriptorIndex(),
+		m_indirectChunkDraws->GetVisibilityDescriptorIndex(),
+		cullPhase,
+		m_hiZFirstDescriptorIndex,
+		static_cast<uint32_t>( m_hiZMipExtents.size() ),
+		glm::uvec2( m_swapChainExtent.width, m_swapChainExtent.height ) };
+
+	vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_chunkCullPipeline );
+	m_descriptorHeap->Bind( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE );
+	m_descriptorHeap->PushConstants( commandBuffer, pushConstants );
+	vkCmdDispatch( commandBuffer, ( m_chunkFrame.chunkCount + CHUNK_CULL_GROUP_SIZE - 1 ) / CHUNK_CULL_GROUP_SIZE, 1, 1 );
+}
+
+void AstroApp::RecordIndirectChunkDraws( VkCommandBuffer commandBuffer, VkRenderPass renderPass, uint32_t imageIndex, uint32_t cullPhase )
 {
-	// Allocate the command buffers
-	m_computeCommandBuffers.resize( m_swapChainFramebuffers.size() );
+	BeginRenderPass( commandBuffer, renderPass, imageIndex, VK_SUBPASS_CONTENTS_INLINE );
+	if( m_chunkFrame.chunkCount != 0 )
+	{
+		RecordChunkDrawState( commandBuffer );
+		vkCmdDrawIndexedIndirectCount( commandBuffer,
+		  m_indirectChunkDraws->GetDrawCommandBuffer(),
+		  m_indirectChunkDraws->GetFirstDrawCommand( cullPhase ) * sizeof( VkDrawIndexedIndirectCommand ),
+		  m_indirectChunkDraws->GetDrawCountBuffer(),
+		  cullPhase * sizeof( uint32_t ),
+		  m_chunkFrame.chunkCount,
+		  sizeof( VkDrawIndexedIndirectCommand ) );
+	}
+	vkCmdEndRenderPass( commandBuffer );
+}
+
+VkCommandBuffer AstroApp::RecordGraphicsCommands( uint32_t frameSlot,
+  uint32_t imageIndex,
+  const std::vector<ChunkDraw>& chunkDraws,
+  std::optional<uint32_t> simulationOutputIndex )
+{
+	ProfileScope profileScope( m_profiler, "RecordGraphicsCommands" );
+
+	// Read by the graph's passes: the cull pass on the GPU, the chunk draw secondaries on the CPU
+	m_chunkFrame.viewProjection = ComputeViewProjection( m_scene->GetViewpoint(), m_swapChainExtent );
+	m_chunkFrame.firstChunk = m_indirectChunkDraws->GetFirstChunk( frameSlot );
+	m_chunkFrame.chunkCount = m_indirectChunkDraws->Upload( frameSlot, chunkDraws );
+	m_chunkFrame.firstGridCell = m_voxelStore ? m_voxelStore->GetFirstGridCell( frameSlot ) : 0;
 
-	VkCommandBufferAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.commandPool = m_commandPool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = (uint32_t)m_computeCommandBuffers.size();
+	m_chunkCommandBuffers.clear();
+	if( m_settings.isCpuDrawing )
+	{
+		RecordChunkDrawSecondaries( frameSlot, imageIndex, chunkDraws );
+	}
+
+	// Then the primary, the render graph culling & drawing the chunks (or executing the secondaries) in its passes
+	VkCommandBuffer commandBuffer = m_graphicsCommandPool->Acquire( frameSlot, VK_COMMAND_BUFFER_LEVEL_PRIMARY );
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if( vkBeginCommandBuffer( commandBuffer, &beginInfo ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to begin recording command buffer!" );
+	}
+
+	m_graphicsGpuProfiler->BeginRecording( commandBuffer, frameSlot );
+	if( simulationOutputIndex )
+	{
+		RecordSimulationReadback( commandBuffer, frameSlot, *simulationOutputIndex );
+	}
+	m_graphicsGraph->Execute( commandBuffer, imageIndex, m_graphicsGpuProfiler.get(), frameSlot );
 
-	if( vkAllocateCommandBuffers( m_logicalDevice, &allocInfo, m_computeCommandBuffers.data() ) != VK_SUCCESS )
+	if( vkEndCommandBuffer( commandBuffer ) != VK_SUCCESS )
 	{
-		throw std::runtime_error( "failed to allocate compute command buffers!" );
+		throw std::runtime_error( "failed to record command buffer!" );
 	}
+	return commandBuffer;
+}
 
+void AstroApp::RecordSimulationReadback( VkCommandBuffer commandBuffer, uint32_t frameSlot, uint32_t simulationOutputIndex )
+{
+	// Compute released the output after writing it, the acquire makes it this queue's. The value comes back once the slot's frame is done.
+	const BufferOwnershipTransfer& transfer = m_simulationOutputTransfers[simulationOutputIndex];
+	const uint64_t simulationFrame = m_frameScheduler->GetFrameNumber() - 1;
+	transfer.RecordAcquire( commandBuffer );
+	m_readbackRing->RequestReadback( commandBuffer,
+	  frameSlot,
+	  transfer.buffer,
+	  transfer.offset,
+	  transfer.size,
+	  VK_PIPELINE_STAGE_TRANSFER_BIT,
+	  0,
+	  [this, simulationFrame]( const void* data, VkDeviceSize ) {
+		  // Frames complete in order, the last callback has the latest value
+		  memcpy( &m_simulationValue, data, sizeof( m_simulationValue ) );
+		  m_simulationValueFrame = simulationFrame;
+	  } );
+}
 
+uint32_t AstroApp::GetSimulationOutputIndex( uint64_t frameNumber ) const
+{
+	// One more output than frames in flight: the frame reusing an output starts after the frame reading it is done (see BeginFrame)
+	return static_cast<uint32_t>( frameNumber % m_simulationOutputTransfers.size() );
+}
+
+void AstroApp::RecordChunkDrawSecondaries( uint32_t frameSlot, uint32_t imageIndex, const std::vector<ChunkDraw>& chunkDraws )
+{
+	// Culled on the CPU, draws spread over the job system's threads: secondaries continuing the render pass in the image's framebuffer
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = m_renderPass;
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = m_swapChainFramebuffers[imageIndex];
+
+	const uint32_t chunkCount = m_chunkFrame.chunkCount;
+	const uint32_t groupCount = ( chunkCount + CHUNKS_PER_COMMAND_BUFFER - 1 ) / CHUNKS_PER_COMMAND_BUFFER;
+	const std::array<glm::vec4, 6> frustumPlanes = FrustumHelpers::ExtractPlanes( m_chunkFrame.viewProjection );
+
+	m_chunkCommandBuffers = m_commandRecorder->RecordSecondaries( frameSlot, inheritanceInfo, groupCount, [&]( VkCommandBuffer commandBuffer, uint32_t groupIndex ) {
+		// Secondaries don't inherit any state from the primary
+		RecordChunkDrawState( commandBuffer );
+
+		const uint32_t firstChunk = groupIndex * CHUNKS_PER_COMMAND_BUFFER;
+		const uint32_t lastChunk = std::min( firstChunk + CHUNKS_PER_COMMAND_BUFFER, chunkCount );
+		for( uint32_t chunkIndex = firstChunk; chunkIndex < lastChunk; ++chunkIndex )
+		{
+			const ChunkDraw& chunkDraw = chunkDraws[chunkIndex];
+			if( FrustumHelpers::IsBoxVisible( frustumPlanes, chunkDraw.origin, chunkDraw.origin + static_cast<float>( VOXEL_CHUNK_SIZE ) ) )
+			{
+				vkCmdDrawIndexed( commandBuffer, chunkDraw.indexCount, 1, chunkDraw.firstIndex, chunkDraw.vertexOffset, m_chunkFrame.firstChunk + chunkIndex );
+			}
+		}
+	} );
+}
+
+void AstroApp::RecordChunkDrawState( VkCommandBuffer commandBuffer )
+{
+	vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline );
+	m_descriptorHeap->Bind( commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS );
+	m_descriptorHeap->PushConstants( commandBuffer,
+	  ChunkPassPushConstants{ m_chunkFrame.viewProjection, m_chunkMeshPool->GetDescriptorIndex(), m_indirectChunkDraws->GetChunkDescriptorIndex() } );
+	vkCmdBindIndexBuffer( commandBuffer, m_chunkMeshPool->GetBuffer(), 0, VK_INDEX_TYPE_UINT32 );
+}
+
+void AstroApp::CreateComputeDataBuffers()
+{
 	// DATA SIZE
 	const VkDeviceSize memorySize = sizeof( float ); // whatever size of memory we require
 	QueueFamilyIndices indices = FindQueueFamilies( m_physicalDevice, m_surface );
@@ -1276,9 +2121,10 @@ void AstroApp::CreateComputeCommandBuffers()
 		indices.computeFamily.value()
 	};
 
-	// Allocate Data Buffers
-	const std::vector<float> initialBufferDataValues{ 7.4f, 1.3f };
-	const uint8_t dataBufferCount = initialBufferDataValues.size(); // input buffer & output buffer
+	// Allocate Data Buffers: the input buffer, then an output buffer per frame in flight + 1 (see GetSimulationOutputIndex)
+	const uint32_t dataBufferCount = 1 + m_settings.framesInFlight + 1;
+	std::vector<float> initialBufferDataValues( dataBufferCount, 0.0f );
+	initialBufferDataValues[0] = 7.4f;
 
 	m_computeDataBuffers.resize( dataBufferCount );
 	for( auto& computeDataBuffer : m_computeDataBuffers )
@@ -1288,7 +2134,7 @@ void AstroApp::CreateComputeCommandBuffers()
 		bufferCreateInfo.pNext = nullptr;
 		bufferCreateInfo.flags = 0;
 		bufferCreateInfo.size = memorySize;
-		bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT; // outputs copied out for readback
 		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		bufferCreateInfo.queueFamilyIndexCount = 1;
 		bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices;
@@ -1299,93 +2145,117 @@ void AstroApp::CreateComputeCommandBuffers()
 		}
 	}
 
-	// Allocate the Memory backing the buffers
-	VkPhysicalDeviceMemoryProperties memoryProperties{};
-	vkGetPhysicalDeviceMemoryProperties( m_physicalDevice, &memoryProperties );
-
-	m_deviceMemories.resize( m_swapChainFramebuffers.size() );
+	// Allocate the Memory backing the buffers, host visible to write the initial values, results go through the readback ring
+	m_computeDataAllocations.resize( dataBufferCount );
 
 	for( uint32_t bufferIndex = 0; bufferIndex < dataBufferCount; ++bufferIndex )
 	{
-		auto& bufferMemory = m_deviceMemories[bufferIndex];
-		uint32_t memoryTypeIndex = FindCompatibleMemoryTypeIndex( memoryProperties, memorySize );
+		auto& allocation = m_computeDataAllocations[bufferIndex];
+		allocation = m_memoryAllocator->AllocateForBuffer( m_computeDataBuffers[bufferIndex], GpuMemoryUsage::CpuToGpu );
 
-		// found our memory type!
-		VkMemoryAllocateInfo memoryAllocInfo{};
-		memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memoryAllocInfo.pNext = nullptr;
-		memoryAllocInfo.allocationSize = memorySize;
-		memoryAllocInfo.memoryTypeIndex = memoryTypeIndex;
+		memcpy( allocation.mappedData, &initialBufferDataValues[bufferIndex], memorySize );
+		m_computeDataDescriptorIndices.push_back( m_descriptorHeap->AddStorageBuffer( m_computeDataBuffers[bufferIndex], 0, memorySize ) );
+	}
+	m_descriptorHeap->FlushWrites();
 
-		if( vkAllocateMemory( m_logicalDevice, &memoryAllocInfo, nullptr, &bufferMemory ) != VK_SUCCESS )
-		{
-			throw std::runtime_error( "failed to allocate memory for compute buffers!" );
-		}
+	// Outputs are written by the simulation's dispatch, then copied out on the graphics queue
+	for( uint32_t bufferIndex = 1; bufferIndex < dataBufferCount; ++bufferIndex )
+	{
+		m_simulationOutputTransfers.push_back( BufferOwnershipTransfer{ m_computeDataBuffers[bufferIndex],
+		  0,
+		  memorySize,
+		  indices.computeFamily.value(),
+		  indices.graphicsFamily.value(),
+		  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		  VK_ACCESS_SHADER_WRITE_BIT,
+		  VK_PIPELINE_STAGE_TRANSFER_BIT,
+		  VK_ACCESS_TRANSFER_READ_BIT } );
+	}
+}
 
-		if( vkBindBufferMemory( m_logicalDevice, m_computeDataBuffers[bufferIndex], bufferMemory, 0 ) != VK_SUCCESS )
-		{
-			throw std::runtime_error( "failed to bind memory to compute buffer!" );
-		}
+void AstroApp::CreateFrameScheduler()
+{
+	m_frameScheduler = std::make_unique<FrameScheduler>( m_logicalDevice, m_settings.framesInFlight );
+}
 
-		void* payloadPtr = nullptr;
-		if( vkMapMemory( m_logicalDevice, bufferMemory, 0, memorySize, 0, &payloadPtr ) != VK_SUCCESS )
+void AstroApp::CreateSemaphores()
+{
+	// Everything else syncs on the frame scheduler's timelines, only the swapchain needs binary semaphores
+	if( m_settings.isHeadless )
+	{
+		return;
+	}
+
+	m_imageAvailableSemaphores.resize( m_settings.framesInFlight );
+	m_renderFinishedSemaphores.resize( m_settings.framesInFlight );
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	for( size_t i = 0; i < m_settings.framesInFlight; i++ )
+	{
+		if( vkCreateSemaphore( m_logicalDevice, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i] ) != VK_SUCCESS
+			|| vkCreateSemaphore( m_logicalDevice, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[i] ) != VK_SUCCESS )
 		{
-			throw std::runtime_error( "failed to map memory to compute buffer!" );
+			throw std::runtime_error( "failed to create synchronization objects for a frame!" );
 		}
-
-		memcpy( payloadPtr, &initialBufferDataValues[bufferIndex], memorySize );
-		// TODO: check Data allignment?
-		vkUnmapMemory( m_logicalDevice, bufferMemory );
 	}
 }
 
-void AstroApp::PrintComputeBufferData()
+void AstroApp::CreateMemoryAllocator()
 {
-	const VkDeviceSize memorySize = sizeof( float ); // whatever size of memory we require
+	m_memoryAllocator = std::make_unique<GpuMemoryAllocator>( m_logicalDevice, m_physicalDevice );
+}
 
-	for( uint32_t bufferIndex = 0; bufferIndex < 2; ++bufferIndex )
-	{
-		auto bufferMemory = m_deviceMemories[bufferIndex];
+void AstroApp::CreatePipelineCache()
+{
+	m_pipelineCache = std::make_unique<PipelineCache>( m_logicalDevice, m_physicalDevice, Pipeline_Cache_File_Path );
+}
 
-		float copyTargetValue = 0;
-		void* copyValuePtr = &copyTargetValue;
-		void* gpuMemoryPtr = nullptr;
-		if( vkMapMemory( m_logicalDevice, bufferMemory, 0, memorySize, 0, &gpuMemoryPtr ) != VK_SUCCESS )
-		{
-			throw std::runtime_error( "failed to map memory to compute buffer!" );
-		}
+void AstroApp::CreateDescriptorHeap()
+{
+	m_descriptorHeap = std::make_unique<BindlessDescriptorHeap>( m_logicalDevice, m_physicalDevice );
+}
 
-		memcpy( copyValuePtr, gpuMemoryPtr, memorySize );
+void AstroApp::CreateChunkMeshPool()
+{
+	m_chunkMeshPool = std::make_unique<ChunkMeshPool>( m_logicalDevice, *m_memoryAllocator, *m_descriptorHeap, CHUNK_MESH_POOL_SIZE );
+	m_descriptorHeap->FlushWrites();
+}
 
-		std::cout << "Readback: " << ( copyTargetValue ) << "\n";
+void AstroApp::CreateIndirectChunkDraws()
+{
+	m_indirectChunkDraws = std::make_unique<IndirectChunkDraws>( m_logicalDevice, *m_memoryAllocator, *m_descriptorHeap, m_settings.framesInFlight, MAX_CHUNK_DRAW_COUNT );
+	m_descriptorHeap->FlushWrites();
+}
 
-		vkUnmapMemory( m_logicalDevice, bufferMemory );
+void AstroApp::CreateVoxelStore()
+{
+	if( !m_settings.isRaymarching )
+	{
+		return;
 	}
+
+	m_voxelStore = std::make_unique<GpuVoxelStore>( m_logicalDevice, *m_memoryAllocator, *m_descriptorHeap, m_settings.framesInFlight, RAYMARCH_GRID_SIZE, RAYMARCH_BRICK_CAPACITY, RAYMARCH_UPLOAD_BUDGET );
+	m_descriptorHeap->FlushWrites();
 }
 
-void AstroApp::CreateSemaphores()
+void AstroApp::CreateCommandRecorder()
 {
-	m_computeReadySemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-	m_imageAvailableSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-	m_renderFinishedSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-	m_inFlightFences.resize( MAX_FRAMES_IN_FLIGHT );
-	m_imagesInFlight.resize( m_swapChainImages.size(), VK_NULL_HANDLE );
+	QueueFamilyIndices indices = FindQueueFamilies( m_physicalDevice, m_surface );
+	m_commandRecorder = std::make_unique<ParallelCommandRecorder>( m_logicalDevice, indices.graphicsFamily.value(), m_settings.framesInFlight, *m_jobSystem );
+}
 
-	VkSemaphoreCreateInfo semaphoreInfo{};
-	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+void AstroApp::CreateReadbackRing()
+{
+	m_readbackRing = std::make_unique<GpuReadbackRing>( m_logicalDevice, *m_memoryAllocator, m_settings.framesInFlight, READBACK_BYTES_PER_FRAME );
+}
 
-	VkFenceCreateInfo fenceInfo{};
-	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+void AstroApp::CreateGpuProfilers()
+{
+	QueueFamilyIndices indices = FindQueueFamilies( m_physicalDevice, m_surface );
 
-	for( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-	{
-		if( vkCreateSemaphore( m_logicalDevice, &semaphoreInfo, nullptr, &m_computeReadySemaphores[i] ) != VK_SUCCESS
-			|| vkCreateSemaphore( m_logicalDevice, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i] ) != VK_SUCCESS
-			|| vkCreateSemaphore( m_logicalDevice, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[i] ) != VK_SUCCESS
-			|| vkCreateFence( m_logicalDevice, &fenceInfo, nullptr, &m_inFlightFences[i] ) != VK_SUCCESS )
-		{
-			throw std::runtime_error( "failed to create synchronization objects for a frame!" );
-		}
-	}
-}
\ No newline at end of file
+	// Both queues' commands are recorded per frame in flight
+	m_computeGpuProfiler = std::make_unique<GpuProfiler>( m_logicalDevice, m_physicalDevice, indices.computeFamily.value(), m_settings.framesInFlight, "Compute" );
+	m_graphicsGpuProfiler = std::make_unique<GpuProfiler>( m_logicalDevice, m_physicalDevice, indices.graphicsFamily.value(), m_settings.framesInFlight, "Graphics" );
+}
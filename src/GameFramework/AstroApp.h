@@ -2,7 +2,24 @@
 
 #define GLFW_INCLUDE_VULKAN //this will make glfw include the vulkan header
 #include <GLFW/glfw3.h>
+#include <GameFramework/AstroAppSettings.h>
 #include <GameFramework/Scene.h>
+#include <Graphics/BindlessDescriptorHeap.h>
+#include <Graphics/ChunkMeshPool.h>
+#include <Graphics/FrameCommandPool.h>
+#include <Graphics/FrameScheduler.h>
+#include <Graphics/GpuMemoryAllocator.h>
+#include <Graphics/GpuReadbackRing.h>
+#include <Graphics/GpuVoxelStore.h>
+#include <Graphics/IndirectChunkDraws.h>
+#include <Graphics/ParallelCommandRecorder.h>
+#include <Graphics/PipelineCache.h>
+#include <Graphics/QueueOwnership.h>
+#include <Graphics/RenderGraph.h>
+#include <Profiling/GpuProfiler.h>
+#include <Profiling/Profiler.h>
+#include <memory>
+#include <optional>
 #include <vector>
 
 //------------------------------
@@ -10,6 +27,8 @@
 class AstroApp
 {
   public:
+	explicit AstroApp( const AstroAppSettings& settings );
+
 	void Run();
 
   private:
@@ -18,30 +37,66 @@ class AstroApp
 	void CreateVkInstance();
 	void SetupDebugMessenger();
 	void CreateVkLogicalDevice();
+	void CreateMemoryAllocator();
+	void CreateReadbackRing();
+	void CreatePipelineCache();
+	void CreateDescriptorHeap();
+	void CreateChunkMeshPool();
+	void CreateIndirectChunkDraws();
+	void CreateVoxelStore();
+	void CreateCommandRecorder();
 	void CreateSurface();
 	void CreateSwapchain();
+	void CreateOffscreenImages(); // headless stand-in for the swapchain images
 	void CreateImageViews();
-	void CreateRenderPass();
+	VkRenderPass CreateRenderPass( VkAttachmentLoadOp loadOp ); // color & depth, cleared or loaded
 	void CreateGraphicsPipeline();
-	void CreateComputePipeline();
+	void CreateComputePipelines();
+	VkPipeline CreateComputePipeline( VkShaderModule shaderModule ); // with the descriptor heap's layout
 	void CreateFramebuffers();
-	void CreateCommandPool();
-	void CreateCommandBuffers();
-	void CreateComputeCommandBuffers();
+	void CreateCommandPools();
+	void CreateRenderGraphs();
+	void CreateHiZDescriptors(); // once the graph created the Hi-Z pyramid
+	void CreateRaymarchDescriptors(); // once the graph created the raymarch target
+	void CreateComputeDataBuffers();
+	void CreateFrameScheduler();
 	void CreateSemaphores();
+	void CreateGpuProfilers();
 
 	void LoadScene();
 	void MainLoop();
+	void RunRecordingBenchmark(); // instead of MainLoop
 	void Shutdown();
 
-	void ComputeFrame( uint32_t imageIndex );
-	void DrawFrame( uint32_t imageIndex );
-
-	void SetComputeCommandsToBuffer( VkCommandBuffer& commandBuffer );
+	bool ShouldKeepRunning( uint32_t frameIndex );
+	void ComputeFrame( uint32_t frameSlot );
+	void DrawFrame( uint32_t frameSlot, uint32_t imageIndex );
+	void DumpFrame( uint32_t imageIndex, uint32_t frameIndex );
+	void CompleteFrameSlot( uint32_t frameSlot );
+	void BeginFrameCommands( uint32_t frameSlot );
+	VkCommandBuffer RecordComputeCommands( uint32_t frameSlot );
+	VkCommandBuffer RecordGraphicsCommands( uint32_t frameSlot,
+	  uint32_t imageIndex,
+	  const std::vector<ChunkDraw>& chunkDraws,
+	  std::optional<uint32_t> simulationOutputIndex ); // the output to read back, if any
+	void RecordSimulationReadback( VkCommandBuffer commandBuffer, uint32_t frameSlot, uint32_t simulationOutputIndex );
+	uint32_t GetSimulationOutputIndex( uint64_t frameNumber ) const;
+	void RecordChunkDrawSecondaries( uint32_t frameSlot, uint32_t imageIndex, const std::vector<ChunkDraw>& chunkDraws );
+	void RecordChunkDrawState( VkCommandBuffer commandBuffer ); // pipeline, descriptors, push constants & index buffer
+	void BeginRenderPass( VkCommandBuffer commandBuffer, VkRenderPass renderPass, uint32_t imageIndex, VkSubpassContents contents );
+	void RecordHiZBuild( VkCommandBuffer commandBuffer );
+	void RecordChunkCull( VkCommandBuffer commandBuffer, uint32_t cullPhase );
+	void RecordIndirectChunkDraws( VkCommandBuffer commandBuffer, VkRenderPass renderPass, uint32_t imageIndex, uint32_t cullPhase );
+	void RecordRaymarch( VkCommandBuffer commandBuffer );
+	void RecordRaymarchBlit( VkCommandBuffer commandBuffer, uint32_t imageIndex );
+	void ReportStartup();
+	void ReportProfile();
+	void ReportQueueOverlap();
 
 	void PopulateDebugMessengerCreateInfo( VkDebugUtilsMessengerCreateInfoEXT& createInfo );
 
 	std::vector<const char*> GetRequiredExtensions();
+	std::vector<const char*> GetRequiredDeviceExtensions();
 	void CheckExtensions();
 #ifndef NDEBUG
 	bool CheckValidationLayers();
@@ -56,14 +111,14 @@ class AstroApp
 	bool IsGPUSuitable( VkPhysicalDevice device );
 
   private:
-	void PrintComputeBufferData();
+	AstroAppSettings m_settings;
 
-	GLFWwindow* m_window;
+	GLFWwindow* m_window = nullptr; // null when headless
 	VkInstance m_instance;
 	VkDebugUtilsMessengerEXT m_debugMessenger;
 	VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
 	VkDevice m_logicalDevice;
-	VkSurfaceKHR m_surface;
+	VkSurfaceKHR m_surface = VK_NULL_HANDLE; // null when headless
 
 	// Queues
 	VkQueue m_graphicsQueue;
@@ -73,43 +128,90 @@ class AstroApp
 	// Swapchain
 	VkFormat m_swapChainImageFormat;
 	VkExtent2D m_swapChainExtent;
-	VkSwapchainKHR m_swapChain;
-	std::vector<VkImage> m_swapChainImages;
+	VkSwapchainKHR m_swapChain = VK_NULL_HANDLE; // null when headless
+	std::vector<VkImage> m_swapChainImages; // offscreen images when headless
 	std::vector<VkImageView> m_swapChainImageViews; // Image views describes how we access an image (eg: 2D depth tex )
 
+	// Headless only
+	std::vector<GpuAllocation> m_offscreenImageAllocations;
+	std::vector<VkBuffer> m_frameDumpBuffers; // offscreen images get copied in there when dumping frames
+	std::vector<GpuAllocation> m_frameDumpAllocations;
+
 	// Pipeline
 	VkRenderPass m_renderPass;
-	VkPipelineLayout m_graphicsPipelineLayout;
+	VkRenderPass m_continueRenderPass; // loads what m_renderPass left, for the chunks occlusion culling found visible afterwards
 	VkPipeline m_graphicsPipeline;
-	VkPipelineLayout m_computePipelineLayout;
 	VkPipeline m_computePipeline;
+	VkPipeline m_chunkCullPipeline;
+	VkPipeline m_hiZBuildPipeline;
+	VkPipeline m_raymarchPipeline;
+	std::unique_ptr<PipelineCache> m_pipelineCache; // loaded from & saved to disk
+	int64_t m_pipelineCreationTime = 0; // microseconds, for the startup report
 
-	VkDescriptorPool m_computeDescriptorPool;
-	VkDescriptorSetLayout m_computeDescriptorSetLayout;
-	VkDescriptorSet m_computeDescriptorSet;
+	std::unique_ptr<BindlessDescriptorHeap> m_descriptorHeap; // every pipeline's layout, resources picked by push constant indices
 
 	// Framebuffer
 	std::vector<VkFramebuffer> m_swapChainFramebuffers;
 
 	// Memory
-	std::vector<VkDeviceMemory> m_deviceMemories;
+	std::unique_ptr<GpuMemoryAllocator> m_memoryAllocator;
+	std::vector<GpuAllocation> m_computeDataAllocations;
 	std::vector<VkBuffer> m_computeDataBuffers;
+	std::vector<uint32_t> m_computeDataDescriptorIndices; // in the descriptor heap
+	std::vector<BufferOwnershipTransfer> m_simulationOutputTransfers; // from compute to graphics, per output buffer (after the input one)
+	float m_simulationValue = 0.0f; // latest output read back, for the exit report
+	uint64_t m_simulationValueFrame = 0; // the frame that computed it, 0 if none came back
+	std::unique_ptr<GpuReadbackRing> m_readbackRing; // a region per frame in flight
+	std::unique_ptr<ChunkMeshPool> m_chunkMeshPool; // every resident chunk's mesh
+	std::unique_ptr<IndirectChunkDraws> m_indirectChunkDraws; // the frame's chunks, culled into indirect draws
+	std::unique_ptr<GpuVoxelStore> m_voxelStore; // the chunks' voxels, --raymarch only
 
 
 	// Commands
-	VkCommandPool m_commandPool;
-	std::vector<VkCommandBuffer> m_commandBuffers;
-	std::vector<VkCommandBuffer> m_computeCommandBuffers;
+	// Everything is re-recorded every frame, from pools reset once per frame in flight
+	std::unique_ptr<FrameCommandPool> m_graphicsCommandPool;
+	std::unique_ptr<FrameCommandPool> m_computeCommandPool; // on the compute family, may differ from the graphics one
+	std::unique_ptr<ParallelCommandRecorder> m_commandRecorder; // per thread pools for the chunk draws
+	std::vector<VkCommandBuffer> m_chunkCommandBuffers; // this frame's chunk draw secondaries (--cpu-draws), executed in the render pass
+	std::unique_ptr<RenderGraph> m_computeGraph; // executed per frame in flight
+	std::unique_ptr<RenderGraph> m_graphicsGraph; // executed per swapchain image
+	RenderGraph::Resource m_depthImage = 0; // graphics graph transient
+
+	// Hi-Z occlusion culling (GPU driven drawing only): the pyramid is built from the depth of the chunks visible last frame
+	RenderGraph::Resource m_hiZImage = 0; // graphics graph transient, farthest depth per texel
+	std::vector<VkExtent2D> m_hiZMipExtents;
+	std::vector<VkImageView> m_hiZMipViews;
+	uint32_t m_hiZFirstDescriptorIndex = 0; // storage images, one per mip in a row
+	uint32_t m_depthDescriptorIndex = 0; // sampled image
+	VkSampler m_depthSampler = VK_NULL_HANDLE;
+	uint32_t m_depthSamplerDescriptorIndex = 0;
+
+	// Raymarching (--raymarch), into a storage image blitted to the swapchain image
+	RenderGraph::Resource m_raymarchTarget = 0; // graphics graph transient
+	uint32_t m_raymarchTargetDescriptorIndex = 0; // storage image
+
+	// This frame's chunks, set by RecordGraphicsCommands for the graph's passes
+	struct ChunkFrame
+	{
+		glm::mat4 viewProjection;
+		uint32_t firstChunk; // in the chunk buffer
+		uint32_t chunkCount;
+		uint32_t firstGridCell; // in the voxel store's grid (--raymarch)
+	};
+	ChunkFrame m_chunkFrame{};
 
 	// Rendering / Presenting
-	std::vector<VkSemaphore> m_computeReadySemaphores;
-	std::vector<VkSemaphore> m_imageAvailableSemaphores;
-	std::vector<VkSemaphore> m_renderFinishedSemaphores;
-	std::vector<VkFence> m_inFlightFences;
-	std::vector<VkFence> m_imagesInFlight;
-	size_t m_currentFrame = 0;
+	std::unique_ptr<FrameScheduler> m_frameScheduler; // timelines syncing the queues & frames in flight
+	std::vector<VkSemaphore> m_imageAvailableSemaphores; // swapchain only, per frame in flight
+	std::vector<VkSemaphore> m_renderFinishedSemaphores; // swapchain only, per frame in flight
+
+	// Profiling, GPU timings are per queue, with a slot per frame in flight
+	Profiler m_profiler;
+	std::unique_ptr<GpuProfiler> m_computeGpuProfiler;
+	std::unique_ptr<GpuProfiler> m_graphicsGpuProfiler;
 
 
 	// Scene data
+	std::unique_ptr<JobSystem> m_jobSystem;
 	std::unique_ptr<Scene> m_scene;
 };
@@ -0,0 +1,111 @@
+#include <GameFramework/AstroAppSettings.h>
+
+#include <stdexcept>
+
+constexpr uint32_t DEFAULT_HEADLESS_FRAME_COUNT = 100;
+
+namespace
+{
+	uint32_t ParseUInt( const std::string& argument, const char* value )
+	{
+		try
+		{
+			size_t parsedLength = 0;
+			const unsigned long parsedValue = std::stoul( value, &parsedLength );
+			if( parsedLength == std::string( value ).size() && parsedValue <= UINT32_MAX )
+			{
+				return static_cast<uint32_t>( parsedValue );
+			}
+		}
+		catch( const std::exception& )
+		{
+		}
+
+		throw std::runtime_error( "invalid value for " + argument + ": " + value );
+	}
+} // namespace
+
+AstroAppSettings AstroAppSettings::ParseCommandLine( int argc, const char* const* argv )
+{
+	AstroAppSettings settings;
+	bool hasFrameCount = false;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		const std::string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if( argument == "--headless" )
+		{
+			settings.isHeadless = true;
+		}
+		else if( argument == "--frames" && hasValue )
+		{
+			settings.frameCount = ParseUInt( argument, argv[++i] );
+			hasFrameCount = true;
+		}
+		else if( argument == "--dump-frames" && hasValue )
+		{
+			settings.frameDumpDirectory = argv[++i];
+		}
+		else if( argument == "--trace" && hasValue )
+		{
+			settings.traceFilePath = argv[++i];
+		}
+		else if( argument == "--frames-in-flight" && hasValue )
+		{
+			settings.framesInFlight = ParseUInt( argument, argv[++i] );
+		}
+		else if( argument == "--cpu-draws" )
+		{
+			settings.isCpuDrawing = true;
+		}
+		else if( argument == "--recording-benchmark" )
+		{
+			settings.isRecordingBenchmark = true;
+		}
+		else if( argument == "--raymarch" )
+		{
+			settings.isRaymarching = true;
+		}
+		else if( argument == "--lod-error" && hasValue )
+		{
+			settings.lodPixelError = ParseUInt( argument, argv[++i] );
+		}
+		else if( argument == "--width" && hasValue )
+		{
+			settings.width = ParseUInt( argument, argv[++i] );
+		}
+		else if( argument == "--height" && hasValue )
+		{
+			settings.height = ParseUInt( argument, argv[++i] );
+		}
+		else
+		{
+			throw std::runtime_error( "unknown or incomplete argument: " + argument );
+		}
+	}
+
+	if( !settings.isHeadless && !settings.frameDumpDirectory.empty() )
+	{
+		throw std::runtime_error( "--dump-frames needs --headless!" );
+	}
+
+	if( settings.width == 0 || settings.height == 0 )
+	{
+		throw std::runtime_error( "frame size can't be 0!" );
+	}
+
+	if( settings.framesInFlight == 0 )
+	{
+		throw std::runtime_error( "--frames-in-flight can't be 0!" );
+	}
+
+	// Batch runs need to end on their own
+	if( settings.isHeadless && !hasFrameCount )
+	{
+		settings.frameCount = DEFAULT_HEADLESS_FRAME_COUNT;
+	}
+
+	return settings;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//-----------------------
+// Start up options, parsed from the command line:
+//   --headless          no window, frames get rendered to offscreen images (works with software ICDs like lavapipe)
+//   --frames <count>    stop after that many frames (headless defaults to 100, windowed runs until closed)
+//   --dump-frames <dir> write every frame to <dir> as a .ppm file (headless only)
+//   --width <pixels>, --height <pixels> offscreen image size (headless only, the window size is fixed)
+//   --trace <file>      write CPU & GPU timings as a Chrome trace json file on exit
+//   --frames-in-flight <count> how many frames the CPU can get ahead of the GPU (default 2)
+//   --cpu-draws         cull chunks & record their draws on the CPU (in parallel) instead of culling them on the GPU
+//   --recording-benchmark times recording the frame's commands for 1k to 100k draws instead of rendering
+//   --raymarch          trace rays through the voxels in a compute shader instead of rasterizing the chunk meshes
+//   --lod-error <pixels> mesh, upload & keep far chunks at coarser mip levels, as long as a voxel covers at most that many pixels
+//                       (default 0: full resolution everywhere)
+
+struct AstroAppSettings
+{
+	bool isHeadless = false;
+	uint32_t frameCount = 0; // 0 means no limit
+	std::string frameDumpDirectory; // empty means no dump
+	uint32_t width = 800;
+	uint32_t height = 600;
+	std::string traceFilePath; // empty means no trace
+	uint32_t framesInFlight = 2;
+	bool isCpuDrawing = false;
+	bool isRecordingBenchmark = false;
+	bool isRaymarching = false;
+	uint32_t lodPixelError = 0;
+
+	static AstroAppSettings ParseCommandLine( int argc, const char* const* argv );
+};
@@ -13,4 +13,10 @@ struct QueueFamilyIndices
 	{
 		return graphicsFamily.has_value() && presentFamily.has_value() && computeFamily.has_value();
 	}
+
+	// Compute gets its own queue family, its work can overlap graphics work instead of queueing behind it
+	bool HasAsyncCompute() const
+	{
+		return computeFamily.has_value() && computeFamily != graphicsFamily;
+	}
 };
\ No newline at end of file
@@ -1,24 +1,149 @@
-
 #include <GameFramework/Scene.h>
 
-Scene::Scene()
-  : m_testVoxelObject{}
+#include <cmath>
+
+constexpr size_t RESIDENT_CHUNK_MEMORY_BUDGET = 256 * 1024 * 1024;
+constexpr float VIEW_DISTANCE = 8.0f * VOXEL_CHUNK_SIZE;
+
+namespace
 {
+	// Test content until we load from a serialised scene file: rolling hills, stone under a grass layer
+	std::unique_ptr<VoxelObject> GenerateTestChunk( const glm::ivec3& chunkCoord )
+	{
+		const glm::ivec3 chunkOrigin = chunkCoord * VOXEL_CHUNK_SIZE;
+		if( chunkOrigin.y >= 64 || chunkOrigin.y + VOXEL_CHUNK_SIZE <= -64 )
+		{
+			return nullptr;
+		}
+
+		auto chunk = std::make_unique<VoxelObject>( VoxelChunkManager::ChunkCoordToWorld( chunkCoord ), VOXEL_CHUNK_SIZE );
+		SparseVoxelOctree& voxelData = chunk->GetVoxelData();
+
+		bool isEmpty = true;
+		for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+		{
+			for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+			{
+				const float worldX = static_cast<float>( chunkOrigin.x + x );
+				const float worldZ = static_cast<float>( chunkOrigin.z + z );
+				const int32_t height = static_cast<int32_t>( 16.0f * std::sin( worldX * 0.05f ) * std::cos( worldZ * 0.04f ) ) - chunkOrigin.y;
+
+				if( height > 0 )
+				{
+					voxelData.FillRegion( glm::ivec3( x, 0, z ), glm::ivec3( x + 1, height - 1, z + 1 ), 2 );
+					voxelData.FillRegion( glm::ivec3( x, height - 1, z ), glm::ivec3( x + 1, height, z + 1 ), 1 );
+					isEmpty = false;
+				}
+			}
+		}
+
+		return isEmpty ? nullptr : std::move( chunk );
+	}
+} // namespace
+
+Scene::Scene( JobSystem& jobSystem )
+  : m_jobSystem( jobSystem )
+  , m_sceneFile{}
+  , m_chunkManager( RESIDENT_CHUNK_MEMORY_BUDGET, VIEW_DISTANCE )
+  , m_viewpoint( 0.0f, 0.0f, 0.0f )
+{
+	m_chunkManager.SetJobSystem( &m_jobSystem );
+	m_chunkManager.SetLodSelector( &m_lodSelector );
 }
 
-void Scene::Load()
+void Scene::Load( const std::string& sceneFilePath )
 {
-	//Imagine loading from a serialised scene file
-	int8_t* voxelData = nullptr;
+	m_chunkManager.UnloadAll();
+
+	// Only maps the file, chunks get paged in as the chunk manager asks for them
+	m_sceneFile.Open( sceneFilePath );
+	m_chunkManager.SetChunkLoader( [this]( const glm::ivec3& chunkCoord ) {
+		return LoadChunk( chunkCoord );
+	} );
 
-	m_testVoxelObject = std::make_unique<VoxelObject>( glm::vec3( 0, 0, 0 ), voxelData );
+	m_chunkManager.Update( m_viewpoint );
 }
 
-void Scene::Save()
+void Scene::Save( const std::string& sceneFilePath )
 {
+	// Coarsened chunks were never edited (that refines them) but lost their detail: it comes from their source again
+	std::vector<SceneFile::ChunkToWrite> chunks;
+	std::vector<std::unique_ptr<VoxelObject>> reloadedChunks;
+	m_chunkManager.ForEachChunk( [this, &chunks, &reloadedChunks]( const glm::ivec3& chunkCoord, VoxelObject& chunk ) {
+		if( chunk.GetFinestLod() == 0 )
+		{
+			chunks.push_back( { chunkCoord, &chunk } );
+			return;
+		}
+
+		reloadedChunks.push_back( LoadChunk( chunkCoord ) );
+		if( reloadedChunks.back() )
+		{
+			chunks.push_back( { chunkCoord, reloadedChunks.back().get() } );
+		}
+	} );
+
+	// Chunks that aren't resident are carried over from the file we loaded
+	std::vector<std::unique_ptr<VoxelObject>> nonResidentChunks;
+	m_sceneFile.ForEachChunkCoord( [this, &chunks, &nonResidentChunks]( const glm::ivec3& chunkCoord ) {
+		if( !m_chunkManager.IsChunkResident( chunkCoord ) )
+		{
+			nonResidentChunks.push_back( m_sceneFile.LoadChunk( chunkCoord ) );
+			chunks.push_back( { chunkCoord, nonResidentChunks.back().get() } );
+		}
+	} );
+
+	SceneFile::Write( sceneFilePath, VOXEL_CHUNK_SIZE, std::move( chunks ) );
 }
 
 void Scene::ComputeFrame()
 {
-	m_testVoxelObject->ComputeFrame();
+	m_chunkManager.Update( m_viewpoint );
+	m_editQueue.Apply( m_chunkManager, &m_jobSystem );
+
+	// Chunks only touch their own data while computing
+	GatherResidentChunks();
+	m_jobSystem.ParallelFor( m_residentChunks.size(), [this]( size_t index ) {
+		m_residentChunks[index].second->ComputeFrame();
+	} );
+}
+
+void Scene::Render()
+{
+	GatherResidentChunks();
+
+	// A chunk changing LOD changes the border its neighbours mesh against
+	for( const auto& residentChunk : m_residentChunks )
+	{
+		if( residentChunk.second->SetLod( m_lodSelector.SelectLevel( residentChunk.second->GetPosition() ) ) )
+		{
+			m_chunkManager.MarkNeighbourMeshesDirty( residentChunk.first );
+		}
+	}
+
+	// Mips first, meshing reads the neighbours' ones. Occupancy only goes stale when voxels get edited outside of the edit queue.
+	m_jobSystem.ParallelFor( m_residentChunks.size(), [this]( size_t index ) {
+		m_residentChunks[index].second->UpdateMips();
+		m_residentChunks[index].second->UpdateOccupancy();
+	} );
+
+	// Chunks only read their neighbours while remeshing, so they can all go in parallel
+	m_jobSystem.ParallelFor( m_residentChunks.size(), [this]( size_t index ) {
+		const VoxelObject* neighbours[6];
+		m_chunkManager.FindNeighbours( m_residentChunks[index].first, neighbours );
+		m_residentChunks[index].second->Render( neighbours );
+	} );
+}
+
+std::unique_ptr<VoxelObject> Scene::LoadChunk( const glm::ivec3& chunkCoord ) const
+{
+	return m_sceneFile.IsOpen() ? m_sceneFile.LoadChunk( chunkCoord ) : GenerateTestChunk( chunkCoord );
+}
+
+void Scene::GatherResidentChunks()
+{
+	m_residentChunks.clear();
+	m_chunkManager.ForEachChunk( [this]( const glm::ivec3& chunkCoord, VoxelObject& chunk ) {
+		m_residentChunks.emplace_back( chunkCoord, &chunk );
+	} );
 }
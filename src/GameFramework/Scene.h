@@ -1,19 +1,64 @@
-
 #pragma once
 
+#include <GameFramework/SceneFile.h>
+#include <Jobs/JobSystem.h>
+#include <Voxel/VoxelChunkManager.h>
+#include <Voxel/VoxelEditQueue.h>
+#include <Voxel/VoxelLodSelector.h>
 #include <Voxel/VoxelObject.h>
+#include <Voxel/VoxelRaycast.h>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 //-----------------------
 
 class Scene
 {
   public:
-	Scene();
+	// Per chunk work (loading, simulation, meshing) gets spread over jobSystem, which must outlive the scene
+	explicit Scene( JobSystem& jobSystem );
 
-	void Load();
-	void Save();
+	// Falls back to generated test content if there is no scene file at sceneFilePath
+	void Load( const std::string& sceneFilePath );
+	void Save( const std::string& sceneFilePath );
 	void ComputeFrame();
+	void Render();
+
+	// World space position chunks get streamed around
+	void SetViewpoint( const glm::vec3& viewpoint ) { m_viewpoint = viewpoint; }
+	const glm::vec3& GetViewpoint() const { return m_viewpoint; }
+
+	// Voxel edits in world voxel coordinates, material 0 carves. Queued, then applied as one batch
+	// at the start of the next ComputeFrame (see VoxelEditQueue): only the chunks they touch get remeshed.
+	void SetVoxel( const glm::ivec3& position, int8_t material ) { m_editQueue.SetVoxel( position, material ); }
+	void FillBox( const glm::ivec3& min, const glm::ivec3& max, int8_t material ) { m_editQueue.FillBox( min, max, material ); }
+	void FillSphere( const glm::vec3& center, float radius, int8_t material ) { m_editQueue.FillSphere( center, radius, material ); }
+	void Paste( const glm::ivec3& origin, const glm::ivec3& size, const int8_t* voxels ) { m_editQueue.Paste( origin, size, voxels ); }
+	const VoxelEditQueue& GetEditQueue() const { return m_editQueue; }
+
+	// First solid voxel along the ray (direction normalized, world space), eg: to aim edits. Queued edits aren't applied yet.
+	std::optional<VoxelRaycast::Hit> Raycast( const glm::vec3& origin, const glm::vec3& direction, float maxDistance ) const
+	{
+		return VoxelRaycast::Trace( m_chunkManager, origin, direction, maxDistance );
+	}
+
+	VoxelChunkManager& GetChunkManager() { return m_chunkManager; }
+	// Picks the chunks' LODs every Render, everything stays at full resolution until it gets a max pixel error
+	VoxelLodSelector& GetLodSelector() { return m_lodSelector; }
 
   private:
-	std::unique_ptr<VoxelObject> m_testVoxelObject;
-};
\ No newline at end of file
+	// From the scene file, or generated if there's none. Called from job threads.
+	std::unique_ptr<VoxelObject> LoadChunk( const glm::ivec3& chunkCoord ) const;
+	void GatherResidentChunks();
+
+	JobSystem& m_jobSystem;
+	// Declared before the chunk manager: chunks loaded from the file reference its mapping, so it must be destroyed last
+	SceneFile m_sceneFile;
+	VoxelChunkManager m_chunkManager;
+	glm::vec3 m_viewpoint;
+	VoxelLodSelector m_lodSelector;
+	VoxelEditQueue m_editQueue;
+
+	std::vector<std::pair<glm::ivec3, VoxelObject*>> m_residentChunks; // kept around to avoid reallocating every frame
+};
@@ -0,0 +1,180 @@
+#include <GameFramework/SceneFile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <Voxel/VoxelChunkManager.h>
+
+namespace
+{
+	const char Scene_File_Magic[8] = { 'A', 'S', 'T', 'R', 'O', 'S', 'C', 'N' };
+
+	uint64_t AlignUp( uint64_t value, uint64_t alignment )
+	{
+		return ( value + alignment - 1 ) / alignment * alignment;
+	}
+
+	bool IsChunkEntryLess( const SceneFileChunkEntry& entry, const glm::ivec3& chunkCoord )
+	{
+		return std::tie( entry.z, entry.y, entry.x ) < std::tie( chunkCoord.z, chunkCoord.y, chunkCoord.x );
+	}
+
+	void WritePadding( std::ofstream& file, uint64_t alignment )
+	{
+		static const char zeros[SCENE_FILE_ALIGNMENT] = {};
+		const uint64_t position = static_cast<uint64_t>( file.tellp() );
+		file.write( zeros, static_cast<std::streamsize>( AlignUp( position, alignment ) - position ) );
+	}
+} // namespace
+
+bool SceneFile::Open( const std::string& filePath )
+{
+	Close();
+
+	if( !m_mappedFile.Open( filePath ) )
+	{
+		return false;
+	}
+
+	// Only the header & table bounds get validated here, payloads are checked when their chunk is loaded
+	const size_t fileSize = m_mappedFile.GetSize();
+	if( fileSize < sizeof( SceneFileHeader ) )
+	{
+		Close();
+		throw std::runtime_error( "scene file is too small to be valid!" );
+	}
+
+	const SceneFileHeader& header = GetHeader();
+	if( memcmp( header.magic, Scene_File_Magic, sizeof( Scene_File_Magic ) ) != 0 )
+	{
+		Close();
+		throw std::runtime_error( "not a scene file!" );
+	}
+
+	if( header.version != SCENE_FILE_VERSION )
+	{
+		Close();
+		throw std::runtime_error( "unsupported scene file version!" );
+	}
+
+	if( header.fileSize != fileSize
+		|| header.chunkSize != VOXEL_CHUNK_SIZE
+		|| header.chunkTableOffset % alignof( SceneFileChunkEntry ) != 0
+		|| header.chunkTableOffset > fileSize
+		|| header.chunkCount > ( fileSize - header.chunkTableOffset ) / sizeof( SceneFileChunkEntry ) )
+	{
+		Close();
+		throw std::runtime_error( "scene file is corrupt!" );
+	}
+
+	return true;
+}
+
+void SceneFile::Close()
+{
+	m_mappedFile.Close();
+}
+
+std::unique_ptr<VoxelObject> SceneFile::LoadChunk( const glm::ivec3& chunkCoord ) const
+{
+	if( !IsOpen() )
+	{
+		return nullptr;
+	}
+
+	const SceneFileChunkEntry* chunkTableBegin = GetChunkTable();
+	const SceneFileChunkEntry* chunkTableEnd = chunkTableBegin + GetHeader().chunkCount;
+	const SceneFileChunkEntry* entry = std::lower_bound( chunkTableBegin, chunkTableEnd, chunkCoord, IsChunkEntryLess );
+	if( entry == chunkTableEnd || entry->x != chunkCoord.x || entry->y != chunkCoord.y || entry->z != chunkCoord.z )
+	{
+		return nullptr;
+	}
+
+	const uint64_t payloadSize = static_cast<uint64_t>( entry->nodeCount ) * sizeof( SparseVoxelOctree::Node );
+	if( entry->payloadOffset % SCENE_FILE_ALIGNMENT != 0
+		|| entry->payloadOffset > m_mappedFile.GetSize()
+		|| payloadSize > m_mappedFile.GetSize() - entry->payloadOffset )
+	{
+		throw std::runtime_error( "scene file chunk payload is out of bounds!" );
+	}
+
+	const auto* nodes = reinterpret_cast<const SparseVoxelOctree::Node*>( m_mappedFile.GetData() + entry->payloadOffset );
+	if( !SparseVoxelOctree::ValidateCompactNodes( nodes, entry->nodeCount ) )
+	{
+		throw std::runtime_error( "scene file chunk payload is corrupt!" );
+	}
+
+	auto chunk = std::make_unique<VoxelObject>( VoxelChunkManager::ChunkCoordToWorld( chunkCoord ), VOXEL_CHUNK_SIZE );
+	chunk->GetVoxelData().SetExternalNodes( nodes, entry->nodeCount );
+	return chunk;
+}
+
+void SceneFile::Write( const std::string& filePath, uint32_t chunkSize, std::vector<ChunkToWrite> chunks )
+{
+	std::sort( chunks.begin(), chunks.end(), []( const ChunkToWrite& a, const ChunkToWrite& b ) {
+		return std::tie( a.chunkCoord.z, a.chunkCoord.y, a.chunkCoord.x ) < std::tie( b.chunkCoord.z, b.chunkCoord.y, b.chunkCoord.x );
+	} );
+
+	// Compact every chunk first, the table needs the node counts & payload offsets
+	std::vector<std::vector<SparseVoxelOctree::Node>> payloads;
+	payloads.reserve( chunks.size() );
+	for( const auto& chunk : chunks )
+	{
+		payloads.push_back( chunk.chunk->GetCompactNodes() );
+	}
+
+	std::vector<SceneFileChunkEntry> chunkTable( chunks.size() );
+	const uint64_t chunkTableOffset = AlignUp( sizeof( SceneFileHeader ), SCENE_FILE_ALIGNMENT );
+	uint64_t payloadOffset = AlignUp( chunkTableOffset + chunkTable.size() * sizeof( SceneFileChunkEntry ), SCENE_FILE_ALIGNMENT );
+	for( size_t i = 0; i < chunks.size(); ++i )
+	{
+		chunkTable[i].x = chunks[i].chunkCoord.x;
+		chunkTable[i].y = chunks[i].chunkCoord.y;
+		chunkTable[i].z = chunks[i].chunkCoord.z;
+		chunkTable[i].nodeCount = static_cast<uint32_t>( payloads[i].size() );
+		chunkTable[i].payloadOffset = payloadOffset;
+		payloadOffset = AlignUp( payloadOffset + payloads[i].size() * sizeof( SparseVoxelOctree::Node ), SCENE_FILE_ALIGNMENT );
+	}
+
+	SceneFileHeader header{};
+	memcpy( header.magic, Scene_File_Magic, sizeof( Scene_File_Magic ) );
+	header.version = SCENE_FILE_VERSION;
+	header.chunkSize = chunkSize;
+	header.chunkCount = chunks.size();
+	header.chunkTableOffset = chunkTableOffset;
+	header.fileSize = payloadOffset;
+
+	const std::string temporaryFilePath = filePath + ".tmp";
+	{
+		std::ofstream file( temporaryFilePath, std::ios::binary | std::ios::trunc );
+		if( !file.is_open() )
+		{
+			throw std::runtime_error( "failed to open scene file for writing!" );
+		}
+
+		file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		WritePadding( file, SCENE_FILE_ALIGNMENT );
+		file.write( reinterpret_cast<const char*>( chunkTable.data() ), static_cast<std::streamsize>( chunkTable.size() * sizeof( SceneFileChunkEntry ) ) );
+		WritePadding( file, SCENE_FILE_ALIGNMENT );
+
+		for( const auto& payload : payloads )
+		{
+			file.write( reinterpret_cast<const char*>( payload.data() ), static_cast<std::streamsize>( payload.size() * sizeof( SparseVoxelOctree::Node ) ) );
+			WritePadding( file, SCENE_FILE_ALIGNMENT );
+		}
+
+		if( !file.good() )
+		{
+			throw std::runtime_error( "failed to write scene file!" );
+		}
+	}
+
+	if( std::rename( temporaryFilePath.c_str(), filePath.c_str() ) != 0 )
+	{
+		throw std::runtime_error( "failed to replace scene file!" );
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Helpers/MappedFile.h>
+#include <Voxel/VoxelObject.h>
+
+//-----------------------
+// Binary scene file, memory mapped so opening it only costs the header & the chunks we actually touch.
+//
+// Layout (little endian, every section starts on a SCENE_FILE_ALIGNMENT boundary):
+//   SceneFileHeader
+//   SceneFileChunkEntry[chunkCount], sorted by chunk coordinate (z, y, x) so lookups binary search in place
+//   chunk payloads: compact SparseVoxelOctree nodes, used as is by the loaded VoxelObjects
+
+constexpr uint32_t SCENE_FILE_VERSION = 1;
+constexpr uint64_t SCENE_FILE_ALIGNMENT = 4096; // page size, payloads can be mapped/evicted independently
+
+struct SceneFileHeader
+{
+	char magic[8]; // "ASTROSCN"
+	uint32_t version;
+	uint32_t chunkSize;
+	uint64_t chunkCount;
+	uint64_t chunkTableOffset;
+	uint64_t fileSize;
+};
+
+struct SceneFileChunkEntry
+{
+	int32_t x;
+	int32_t y;
+	int32_t z;
+	uint32_t nodeCount;
+	uint64_t payloadOffset;
+};
+
+class SceneFile
+{
+  public:
+	struct ChunkToWrite
+	{
+		glm::ivec3 chunkCoord;
+		const VoxelObject* chunk;
+	};
+
+	// Returns false if there is no file at filePath, throws if the file is corrupt or from another version
+	bool Open( const std::string& filePath );
+	void Close();
+	bool IsOpen() const { return m_mappedFile.GetData() != nullptr; }
+
+	// Loaded chunks read their voxels straight from the mapping, so they must not outlive this SceneFile
+	// (unless modified, which moves their data into owned memory).
+	// Returns nullptr if the file has no such chunk.
+	std::unique_ptr<VoxelObject> LoadChunk( const glm::ivec3& chunkCoord ) const;
+
+	// Calls callback( const glm::ivec3& chunkCoord ) for every chunk in the file
+	template<typename Callback>
+	void ForEachChunkCoord( Callback&& callback ) const;
+
+	// Writes to a temporary file then renames it, so a SceneFile currently mapping filePath stays valid
+	static void Write( const std::string& filePath, uint32_t chunkSize, std::vector<ChunkToWrite> chunks );
+
+  private:
+	const SceneFileHeader& GetHeader() const { return *reinterpret_cast<const SceneFileHeader*>( m_mappedFile.GetData() ); }
+	const SceneFileChunkEntry* GetChunkTable() const { return reinterpret_cast<const SceneFileChunkEntry*>( m_mappedFile.GetData() + GetHeader().chunkTableOffset ); }
+
+	MappedFile m_mappedFile;
+};
+
+//-----------------------
+
+template<typename Callback>
+void SceneFile::ForEachChunkCoord( Callback&& callback ) const
+{
+	if( !IsOpen() )
+	{
+		return;
+	}
+
+	const SceneFileChunkEntry* chunkTable = GetChunkTable();
+	for( uint64_t i = 0; i < GetHeader().chunkCount; ++i )
+	{
+		callback( glm::ivec3( chunkTable[i].x, chunkTable[i].y, chunkTable[i].z ) );
+	}
+}
@@ -0,0 +1,244 @@
+#include <Graphics/BindlessDescriptorHeap.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	// Upper bounds, devices with lower update after bind limits get smaller arrays
+	constexpr uint32_t MAX_STORAGE_BUFFERS = 65536;
+	constexpr uint32_t MAX_STORAGE_IMAGES = 4096;
+	constexpr uint32_t MAX_SAMPLED_IMAGES = 16384;
+	constexpr uint32_t MAX_SAMPLERS = 64;
+
+	constexpr VkDescriptorType Descriptor_Types[] = {
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		VK_DESCRIPTOR_TYPE_SAMPLER
+	};
+} // namespace
+
+BindlessDescriptorHeap::BindlessDescriptorHeap( VkDevice device, VkPhysicalDevice physicalDevice )
+  : m_device( device )
+{
+	VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+	vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+	VkPhysicalDeviceProperties2 deviceProperties2{};
+	deviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	deviceProperties2.pNext = &vulkan12Properties;
+	vkGetPhysicalDeviceProperties2( physicalDevice, &deviceProperties2 );
+
+	// Every binding is visible to all stages, so the per stage limits apply to the whole array
+	m_capacities[static_cast<uint32_t>( BindlessResourceType::StorageBuffer )] = std::min( { MAX_STORAGE_BUFFERS,
+	  vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+	  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers } );
+	m_capacities[static_cast<uint32_t>( BindlessResourceType::StorageImage )] = std::min( { MAX_STORAGE_IMAGES,
+	  vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageImages,
+	  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageImages } );
+	m_capacities[static_cast<uint32_t>( BindlessResourceType::SampledImage )] = std::min( { MAX_SAMPLED_IMAGES,
+	  vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+	  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages } );
+	m_capacities[static_cast<uint32_t>( BindlessResourceType::Sampler )] = std::min( { MAX_SAMPLERS,
+	  vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers,
+	  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers } );
+
+	// Set layout, one array binding per type
+	std::array<VkDescriptorSetLayoutBinding, TYPE_COUNT> bindings{};
+	std::array<VkDescriptorBindingFlags, TYPE_COUNT> bindingFlags{};
+	std::array<VkDescriptorPoolSize, TYPE_COUNT> poolSizes{};
+	for( uint32_t typeIndex = 0; typeIndex < TYPE_COUNT; ++typeIndex )
+	{
+		if( m_capacities[typeIndex] == 0 )
+		{
+			throw std::runtime_error( "device doesn't support update after bind descriptors!" );
+		}
+
+		bindings[typeIndex].binding = typeIndex;
+		bindings[typeIndex].descriptorType = Descriptor_Types[typeIndex];
+		bindings[typeIndex].descriptorCount = m_capacities[typeIndex];
+		bindings[typeIndex].stageFlags = VK_SHADER_STAGE_ALL;
+		bindings[typeIndex].pImmutableSamplers = nullptr;
+
+		bindingFlags[typeIndex] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+								  | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+								  | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+		poolSizes[typeIndex].type = Descriptor_Types[typeIndex];
+		poolSizes[typeIndex].descriptorCount = m_capacities[typeIndex];
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount = TYPE_COUNT;
+	bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+	setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutInfo.pNext = &bindingFlagsInfo;
+	setLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	setLayoutInfo.bindingCount = TYPE_COUNT;
+	setLayoutInfo.pBindings = bindings.data();
+
+	if( vkCreateDescriptorSetLayout( m_device, &setLayoutInfo, nullptr, &m_setLayout ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create bindless descriptor set layout!" );
+	}
+
+	// Pipeline layout shared by every pipeline
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = PUSH_CONSTANTS_SIZE;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+	if( vkCreatePipelineLayout( m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create bindless pipeline layout!" );
+	}
+
+	// The one set
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = TYPE_COUNT;
+	poolInfo.pPoolSizes = poolSizes.data();
+
+	if( vkCreateDescriptorPool( m_device, &poolInfo, nullptr, &m_pool ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create bindless descriptor pool!" );
+	}
+
+	VkDescriptorSetAllocateInfo setAllocInfo{};
+	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAllocInfo.descriptorPool = m_pool;
+	setAllocInfo.descriptorSetCount = 1;
+	setAllocInfo.pSetLayouts = &m_setLayout;
+
+	if( vkAllocateDescriptorSets( m_device, &setAllocInfo, &m_set ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to allocate bindless descriptor set!" );
+	}
+}
+
+BindlessDescriptorHeap::~BindlessDescriptorHeap()
+{
+	// Frees the set with it
+	vkDestroyDescriptorPool( m_device, m_pool, nullptr );
+	vkDestroyPipelineLayout( m_device, m_pipelineLayout, nullptr );
+	vkDestroyDescriptorSetLayout( m_device, m_setLayout, nullptr );
+}
+
+uint32_t BindlessDescriptorHeap::AllocateIndex( BindlessResourceType type )
+{
+	const uint32_t typeIndex = static_cast<uint32_t>( type );
+	std::vector<uint32_t>& freeIndices = m_freeIndices[typeIndex];
+	if( !freeIndices.empty() )
+	{
+		const uint32_t index = freeIndices.back();
+		freeIndices.pop_back();
+		return index;
+	}
+
+	if( m_usedCounts[typeIndex] == m_capacities[typeIndex] )
+	{
+		throw std::runtime_error( "bindless descriptor heap is full!" );
+	}
+	return m_usedCounts[typeIndex]++;
+}
+
+uint32_t BindlessDescriptorHeap::AddStorageBuffer( VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range )
+{
+	const uint32_t index = AllocateIndex( BindlessResourceType::StorageBuffer );
+	m_pendingWrites.push_back( PendingWrite{ BindlessResourceType::StorageBuffer, index, static_cast<uint32_t>( m_pendingBufferInfos.size() ) } );
+	m_pendingBufferInfos.push_back( VkDescriptorBufferInfo{ buffer, offset, range } );
+	return index;
+}
+
+uint32_t BindlessDescriptorHeap::AddStorageImage( VkImageView imageView, VkImageLayout layout )
+{
+	return AddImageDescriptor( BindlessResourceType::StorageImage, VkDescriptorImageInfo{ VK_NULL_HANDLE, imageView, layout } );
+}
+
+uint32_t BindlessDescriptorHeap::AddSampledImage( VkImageView imageView, VkImageLayout layout )
+{
+	return AddImageDescriptor( BindlessResourceType::SampledImage, VkDescriptorImageInfo{ VK_NULL_HANDLE, imageView, layout } );
+}
+
+uint32_t BindlessDescriptorHeap::AddSampler( VkSampler sampler )
+{
+	return AddImageDescriptor( BindlessResourceType::Sampler, VkDescriptorImageInfo{ sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED } );
+}
+
+uint32_t BindlessDescriptorHeap::AddImageDescriptor( BindlessResourceType type, const VkDescriptorImageInfo& imageInfo )
+{
+	const uint32_t index = AllocateIndex( type );
+	m_pendingWrites.push_back( PendingWrite{ type, index, static_cast<uint32_t>( m_pendingImageInfos.size() ) } );
+	m_pendingImageInfos.push_back( imageInfo );
+	return index;
+}
+
+void BindlessDescriptorHeap::Remove( BindlessResourceType type, uint32_t index )
+{
+	const uint32_t typeIndex = static_cast<uint32_t>( type );
+	if( index >= m_usedCounts[typeIndex] )
+	{
+		throw std::runtime_error( "removing a resource that isn't in the bindless descriptor heap!" );
+	}
+
+	// Partially bound: the stale descriptor can stay until the index is reused, nothing should access it meanwhile
+	m_freeIndices[typeIndex].push_back( index );
+}
+
+void BindlessDescriptorHeap::FlushWrites()
+{
+	if( m_pendingWrites.empty() )
+	{
+		return;
+	}
+
+	m_descriptorWrites.clear();
+	for( const PendingWrite& pendingWrite : m_pendingWrites )
+	{
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = m_set;
+		descriptorWrite.dstBinding = static_cast<uint32_t>( pendingWrite.type );
+		descriptorWrite.dstArrayElement = pendingWrite.index;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = Descriptor_Types[static_cast<uint32_t>( pendingWrite.type )];
+		if( pendingWrite.type == BindlessResourceType::StorageBuffer )
+		{
+			descriptorWrite.pBufferInfo = &m_pendingBufferInfos[pendingWrite.infoIndex];
+		}
+		else
+		{
+			descriptorWrite.pImageInfo = &m_pendingImageInfos[pendingWrite.infoIndex];
+		}
+		m_descriptorWrites.push_back( descriptorWrite );
+	}
+
+	vkUpdateDescriptorSets( m_device, static_cast<uint32_t>( m_descriptorWrites.size() ), m_descriptorWrites.data(), 0, nullptr );
+
+	m_pendingWrites.clear();
+	m_pendingBufferInfos.clear();
+	m_pendingImageInfos.clear();
+}
+
+void BindlessDescriptorHeap::Bind( VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint ) const
+{
+	vkCmdBindDescriptorSets( commandBuffer, bindPoint, m_pipelineLayout, 0, 1, &m_set, 0, nullptr );
+}
+
+uint32_t BindlessDescriptorHeap::GetCount( BindlessResourceType type ) const
+{
+	const uint32_t typeIndex = static_cast<uint32_t>( type );
+	return m_usedCounts[typeIndex] - static_cast<uint32_t>( m_freeIndices[typeIndex].size() );
+}
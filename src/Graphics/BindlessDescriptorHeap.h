@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Also the set's binding numbers, must match src/Resources/Shaders/Bindless.glsl
+enum class BindlessResourceType : uint32_t
+{
+	StorageBuffer,
+	StorageImage,
+	SampledImage,
+	Sampler,
+	Count
+};
+
+//-----------------------
+// One descriptor set holding every resource shaders access, an array per resource type (descriptor indexing, core in Vulkan 1.2).
+// Resources get an index when they're added, shaders pick them out of the arrays with indices passed as push constants:
+// the set & pipeline layout are bound once per command buffer, draws & dispatches only push a few indices.
+// The bindings are UPDATE_AFTER_BIND & PARTIALLY_BOUND: adding resources doesn't invalidate command buffers using the set,
+// and unused indices may hold anything (or nothing).
+// Every pipeline shares the heap's pipeline layout, its push constants being whatever each shader declares up to PUSH_CONSTANTS_SIZE.
+
+class BindlessDescriptorHeap
+{
+  public:
+	// Spec's guaranteed minimum for maxPushConstantsSize
+	static constexpr uint32_t PUSH_CONSTANTS_SIZE = 128;
+
+	BindlessDescriptorHeap( VkDevice device, VkPhysicalDevice physicalDevice );
+	~BindlessDescriptorHeap();
+
+	BindlessDescriptorHeap( const BindlessDescriptorHeap& ) = delete;
+	BindlessDescriptorHeap& operator=( const BindlessDescriptorHeap& ) = delete;
+
+	// Return the resource's index in its type's array, throw if the array is full.
+	// Descriptors are written by the next FlushWrites, which has to happen before submitting work using them.
+	uint32_t AddStorageBuffer( VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE );
+	uint32_t AddStorageImage( VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL );
+	uint32_t AddSampledImage( VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+	uint32_t AddSampler( VkSampler sampler );
+	// The index gets reused by the next resource added, the GPU must be done with work using it
+	void Remove( BindlessResourceType type, uint32_t index );
+
+	// Every descriptor added since the last flush, in one vkUpdateDescriptorSets
+	void FlushWrites();
+
+	void Bind( VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint ) const;
+	// offset (bytes) updates part of the push constants, eg: per draw values after per pass ones
+	template<typename T>
+	void PushConstants( VkCommandBuffer commandBuffer, const T& pushConstants, uint32_t offset = 0 ) const
+	{
+		static_assert( sizeof( T ) <= PUSH_CONSTANTS_SIZE, "push constants don't fit in the bindless pipeline layout" );
+		vkCmdPushConstants( commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_ALL, offset, sizeof( T ), &pushConstants );
+	}
+
+	VkDescriptorSetLayout GetSetLayout() const { return m_setLayout; }
+	VkPipelineLayout GetPipelineLayout() const { return m_pipelineLayout; }
+	uint32_t GetCapacity( BindlessResourceType type ) const { return m_capacities[static_cast<uint32_t>( type )]; }
+	uint32_t GetCount( BindlessResourceType type ) const; // resources currently in the heap
+
+  private:
+	static constexpr uint32_t TYPE_COUNT = static_cast<uint32_t>( BindlessResourceType::Count );
+
+	struct PendingWrite
+	{
+		BindlessResourceType type;
+		uint32_t index;
+		uint32_t infoIndex; // in m_pendingBufferInfos or m_pendingImageInfos
+	};
+
+	uint32_t AllocateIndex( BindlessResourceType type );
+	uint32_t AddImageDescriptor( BindlessResourceType type, const VkDescriptorImageInfo& imageInfo );
+
+	VkDevice m_device;
+	VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+	VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_pool = VK_NULL_HANDLE;
+	VkDescriptorSet m_set = VK_NULL_HANDLE;
+
+	std::array<uint32_t, TYPE_COUNT> m_capacities{};
+	std::array<uint32_t, TYPE_COUNT> m_usedCounts{}; // indices handed out at least once
+	std::array<std::vector<uint32_t>, TYPE_COUNT> m_freeIndices; // removed, reused first
+
+	std::vector<PendingWrite> m_pendingWrites;
+	std::vector<VkDescriptorBufferInfo> m_pendingBufferInfos;
+	std::vector<VkDescriptorImageInfo> m_pendingImageInfos;
+	std::vector<VkWriteDescriptorSet> m_descriptorWrites; // kept around to avoid reallocating every flush
+};
@@ -0,0 +1,124 @@
+#include <Graphics/BuddyAllocator.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	bool IsPowerOfTwo( uint64_t value )
+	{
+		return value != 0 && ( value & ( value - 1 ) ) == 0;
+	}
+
+	uint64_t NextPowerOfTwo( uint64_t value )
+	{
+		uint64_t powerOfTwo = 1;
+		while( powerOfTwo < value )
+		{
+			powerOfTwo <<= 1;
+		}
+		return powerOfTwo;
+	}
+} // namespace
+
+BuddyAllocator::BuddyAllocator( uint64_t totalSize, uint64_t minBlockSize )
+  : m_totalSize( totalSize )
+  , m_levelCount( 1 )
+{
+	if( !IsPowerOfTwo( totalSize ) || !IsPowerOfTwo( minBlockSize ) || minBlockSize > totalSize )
+	{
+		throw std::runtime_error( "buddy allocator sizes must be powers of two!" );
+	}
+
+	while( GetBlockSize( m_levelCount - 1 ) > minBlockSize )
+	{
+		++m_levelCount;
+	}
+
+	m_freeBlocks.resize( m_levelCount );
+	m_freeBlocks[0].insert( 0 );
+}
+
+std::optional<uint64_t> BuddyAllocator::Allocate( uint64_t size, uint64_t alignment )
+{
+	const uint64_t blockSize = NextPowerOfTwo( std::max( size, alignment ) );
+	if( size == 0 || blockSize > m_totalSize )
+	{
+		return std::nullopt;
+	}
+
+	// Deepest level whose blocks still fit the allocation
+	uint32_t level = m_levelCount - 1;
+	while( GetBlockSize( level ) < blockSize )
+	{
+		--level;
+	}
+
+	// Nearest level up with a free block, to split down to the level we want
+	int32_t freeLevel = static_cast<int32_t>( level );
+	while( freeLevel >= 0 && m_freeBlocks[freeLevel].empty() )
+	{
+		--freeLevel;
+	}
+	if( freeLevel < 0 )
+	{
+		return std::nullopt;
+	}
+
+	const uint64_t offset = *m_freeBlocks[freeLevel].begin();
+	m_freeBlocks[freeLevel].erase( m_freeBlocks[freeLevel].begin() );
+
+	// Keep the lower half, free the upper one at every split
+	for( uint32_t splitLevel = static_cast<uint32_t>( freeLevel ) + 1; splitLevel <= level; ++splitLevel )
+	{
+		m_freeBlocks[splitLevel].insert( offset + GetBlockSize( splitLevel ) );
+	}
+
+	m_allocations.emplace( offset, Allocation{ level, size } );
+	m_allocatedSize += GetBlockSize( level );
+	m_requestedSize += size;
+	return offset;
+}
+
+void BuddyAllocator::Free( uint64_t offset )
+{
+	auto allocationIt = m_allocations.find( offset );
+	if( allocationIt == m_allocations.end() )
+	{
+		throw std::runtime_error( "freeing an offset that wasn't allocated!" );
+	}
+
+	uint32_t level = allocationIt->second.level;
+	m_allocatedSize -= GetBlockSize( level );
+	m_requestedSize -= allocationIt->second.size;
+	m_allocations.erase( allocationIt );
+
+	// Merge with the buddy for as long as it's free too
+	while( level > 0 )
+	{
+		const uint64_t buddyOffset = offset ^ GetBlockSize( level );
+		auto buddyIt = m_freeBlocks[level].find( buddyOffset );
+		if( buddyIt == m_freeBlocks[level].end() )
+		{
+			break;
+		}
+
+		m_freeBlocks[level].erase( buddyIt );
+		offset = std::min( offset, buddyOffset );
+		--level;
+	}
+
+	m_freeBlocks[level].insert( offset );
+}
+
+uint64_t BuddyAllocator::GetLargestFreeBlockSize() const
+{
+	for( uint32_t level = 0; level < m_levelCount; ++level )
+	{
+		if( !m_freeBlocks[level].empty() )
+		{
+			return GetBlockSize( level );
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+//-----------------------
+// Places allocations in a range of totalSize bytes, handing out offsets only: it never touches the memory itself.
+// Blocks are powers of two, split in halves (buddies) on demand and merged back when both halves are free.
+// A block is aligned to its own size, so any power of two alignment up to the block size comes for free.
+// Lowest offsets are used first, keeping the top of the range free for large blocks.
+
+class BuddyAllocator
+{
+  public:
+	// Both sizes must be powers of two, minBlockSize <= totalSize
+	BuddyAllocator( uint64_t totalSize, uint64_t minBlockSize );
+
+	// Returns the offset, or nothing when there's no free block big enough. alignment must be a power of two.
+	std::optional<uint64_t> Allocate( uint64_t size, uint64_t alignment = 1 );
+	void Free( uint64_t offset );
+
+	uint64_t GetTotalSize() const { return m_totalSize; }
+	size_t GetAllocationCount() const { return m_allocations.size(); }
+	// Block sizes, including the rounding up to powers of two
+	uint64_t GetAllocatedSize() const { return m_allocatedSize; }
+	// Sizes as requested, the gap to GetAllocatedSize is lost to rounding
+	uint64_t GetRequestedSize() const { return m_requestedSize; }
+	uint64_t GetLargestFreeBlockSize() const;
+	bool IsEmpty() const { return m_allocations.empty(); }
+
+  private:
+	struct Allocation
+	{
+		uint32_t level;
+		uint64_t size;
+	};
+
+	uint64_t GetBlockSize( uint32_t level ) const { return m_totalSize >> level; }
+
+	uint64_t m_totalSize;
+	uint32_t m_levelCount; // level 0 is the whole range, the last level holds blocks of minBlockSize
+	std::vector<std::set<uint64_t>> m_freeBlocks; // offsets of free blocks per level
+	std::unordered_map<uint64_t, Allocation> m_allocations; // by offset
+	uint64_t m_allocatedSize = 0;
+	uint64_t m_requestedSize = 0;
+};
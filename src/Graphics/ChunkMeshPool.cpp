@@ -0,0 +1,152 @@
+#include <Graphics/ChunkMeshPool.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <Graphics/BindlessDescriptorHeap.h>
+
+namespace
+{
+	// Small chunk meshes (a few faces) don't waste much, big ones lose at most half to the power of two rounding
+	constexpr uint64_t MIN_MESH_RANGE_SIZE = 256;
+} // namespace
+
+ChunkMeshPool::ChunkMeshPool( VkDevice device, GpuMemoryAllocator& allocator, BindlessDescriptorHeap& descriptorHeap, VkDeviceSize size )
+  : m_device( device )
+  , m_allocator( allocator )
+  , m_descriptorHeap( descriptorHeap )
+  , m_rangeAllocator( size, MIN_MESH_RANGE_SIZE )
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if( vkCreateBuffer( m_device, &bufferInfo, nullptr, &m_buffer ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create chunk mesh pool buffer!" );
+	}
+	m_allocation = m_allocator.AllocateForBuffer( m_buffer, GpuMemoryUsage::CpuToGpu );
+	m_descriptorIndex = m_descriptorHeap.AddStorageBuffer( m_buffer );
+}
+
+ChunkMeshPool::~ChunkMeshPool()
+{
+	m_descriptorHeap.Remove( BindlessResourceType::StorageBuffer, m_descriptorIndex );
+	vkDestroyBuffer( m_device, m_buffer, nullptr );
+	m_allocator.Free( m_allocation );
+}
+
+void ChunkMeshPool::Update( VoxelChunkManager& chunkManager, uint64_t frameNumber )
+{
+	++m_updateIndex;
+	m_draws.clear();
+
+	chunkManager.ForEachChunk( [&]( const glm::ivec3& chunkCoord, VoxelObject& chunk ) {
+		auto chunkMesh = m_chunkMeshes.find( chunkCoord );
+		if( chunkMesh == m_chunkMeshes.end() )
+		{
+			uint32_t chunkId = m_nextChunkId;
+			if( m_freeChunkIds.empty() )
+			{
+				++m_nextChunkId;
+			}
+			else
+			{
+				chunkId = m_freeChunkIds.back();
+				m_freeChunkIds.pop_back();
+			}
+			// Version 0 is never handed out, the mesh gets uploaded below
+			chunkMesh = m_chunkMeshes.emplace( chunkCoord, ChunkMesh{ 0, 0, 0, 0, 0, 0, chunkId } ).first;
+		}
+
+		ChunkMesh& residentMesh = chunkMesh->second;
+		residentMesh.lastUpdateIndex = m_updateIndex;
+		if( residentMesh.meshVersion != chunk.GetMeshVersion() )
+		{
+			FreeRange( residentMesh, frameNumber );
+			residentMesh.indexCount = 0;
+			if( !Upload( chunk.GetMesh(), residentMesh ) )
+			{
+				// Left at the old version, without a range: retried next update
+				++m_failedUploadCount;
+				return;
+			}
+			residentMesh.meshVersion = chunk.GetMeshVersion();
+			residentMesh.lod = chunk.GetMesh().lod;
+		}
+
+		if( residentMesh.indexCount != 0 )
+		{
+			const uint32_t firstVertex = static_cast<uint32_t>( residentMesh.offset / sizeof( uint32_t ) );
+			m_draws.push_back( ChunkDraw{ chunk.GetPosition(),
+			  firstVertex + residentMesh.vertexCount,
+			  residentMesh.indexCount,
+			  static_cast<int32_t>( firstVertex ),
+			  static_cast<float>( 1u << residentMesh.lod ),
+			  residentMesh.chunkId } );
+		}
+	} );
+
+	// Chunks that weren't there anymore
+	for( auto chunkMesh = m_chunkMeshes.begin(); chunkMesh != m_chunkMeshes.end(); )
+	{
+		if( chunkMesh->second.lastUpdateIndex != m_updateIndex )
+		{
+			FreeRange( chunkMesh->second, frameNumber );
+			m_freeChunkIds.push_back( chunkMesh->second.chunkId );
+			chunkMesh = m_chunkMeshes.erase( chunkMesh );
+		}
+		else
+		{
+			++chunkMesh;
+		}
+	}
+}
+
+bool ChunkMeshPool::Upload( const VoxelMesh& mesh, ChunkMesh& chunkMesh )
+{
+	if( mesh.indices.empty() )
+	{
+		return true;
+	}
+
+	const size_t vertexSize = mesh.vertices.size() * sizeof( uint32_t );
+	const size_t indexSize = mesh.indices.size() * sizeof( uint32_t );
+	const std::optional<uint64_t> offset = m_rangeAllocator.Allocate( vertexSize + indexSize, sizeof( uint32_t ) );
+	if( !offset )
+	{
+		return false;
+	}
+
+	// Vertices then indices, both as uint32_t: the draw's firstIndex & vertexOffset are counted in those
+	uint8_t* rangeData = static_cast<uint8_t*>( m_allocation.mappedData ) + *offset;
+	memcpy( rangeData, mesh.vertices.data(), vertexSize );
+	memcpy( rangeData + vertexSize, mesh.indices.data(), indexSize );
+
+	chunkMesh.offset = *offset;
+	chunkMesh.indexCount = static_cast<uint32_t>( mesh.indices.size() );
+	chunkMesh.vertexCount = static_cast<uint32_t>( mesh.vertices.size() );
+	return true;
+}
+
+void ChunkMeshPool::FreeRange( const ChunkMesh& chunkMesh, uint64_t frameNumber )
+{
+	if( chunkMesh.indexCount == 0 )
+	{
+		return;
+	}
+
+	// frameNumber doesn't draw it anymore, the ones before it might have
+	m_freedRanges.push_back( FreedRange{ chunkMesh.offset, frameNumber - 1 } );
+}
+
+void ChunkMeshPool::ReleaseFreedRanges( uint64_t completedFrameNumber )
+{
+	while( !m_freedRanges.empty() && m_freedRanges.front().frameNumber <= completedFrameNumber )
+	{
+		m_rangeAllocator.Free( m_freedRanges.front().offset );
+		m_freedRanges.pop_front();
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Graphics/BuddyAllocator.h>
+#include <Graphics/GpuMemoryAllocator.h>
+#include <Voxel/VoxelChunkManager.h>
+
+class BindlessDescriptorHeap;
+
+// One chunk's mesh in the pool, as vkCmdDrawIndexed wants it
+struct ChunkDraw
+{
+	glm::vec3 origin; // world space
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset; // in vertices, added to the chunk local indices
+	float voxelScale; // world units per vertex unit: the mesh is in its LOD's voxels (see VoxelMesh)
+	uint32_t chunkId; // the same while the chunk stays resident, for per chunk GPU state (eg: its visibility last frame)
+};
+
+//-----------------------
+// Every resident chunk's mesh in one GPU buffer, so all chunks draw with the same index buffer & descriptor.
+// Each mesh gets a range (vertices then indices) placed by a BuddyAllocator, shaders pull the packed vertices out of the
+// buffer as a storage buffer through the bindless descriptor heap (see VoxelChunk.vert).
+// Replaced & unloaded meshes' ranges are only reused once the frames that could still draw them are done on the GPU.
+// Host visible: meshes are written in place, there's no staging copy to schedule.
+
+class ChunkMeshPool
+{
+  public:
+	// size must be a power of two
+	ChunkMeshPool( VkDevice device, GpuMemoryAllocator& allocator, BindlessDescriptorHeap& descriptorHeap, VkDeviceSize size );
+	~ChunkMeshPool();
+
+	ChunkMeshPool( const ChunkMeshPool& ) = delete;
+	ChunkMeshPool& operator=( const ChunkMeshPool& ) = delete;
+
+	// Uploads the resident chunks' meshes that changed since the last update & drops the ones of chunks that went away.
+	// frameNumber is the frame about to draw them. Meshes that don't fit get retried next update, without a draw meanwhile.
+	void Update( VoxelChunkManager& chunkManager, uint64_t frameNumber );
+	// The GPU is done with every frame up to completedFrameNumber, their replaced meshes' ranges can be reused
+	void ReleaseFreedRanges( uint64_t completedFrameNumber );
+
+	// Chunks with a mesh, as of the last update
+	const std::vector<ChunkDraw>& GetDraws() const { return m_draws; }
+
+	VkBuffer GetBuffer() const { return m_buffer; } // index buffer, and storage buffer holding the vertices
+	uint32_t GetDescriptorIndex() const { return m_descriptorIndex; }
+	VkDeviceSize GetUsedSize() const { return m_rangeAllocator.GetAllocatedSize(); }
+	uint32_t GetFailedUploadCount() const { return m_failedUploadCount; } // since the start, meshes that didn't fit
+	uint32_t GetChunkIdCount() const { return m_nextChunkId; } // chunk ids are below it, freed ones get reused
+
+  private:
+	struct ChunkMesh
+	{
+		uint64_t meshVersion;
+		uint64_t offset; // in bytes
+		uint32_t indexCount; // 0: nothing to draw, no range
+		uint32_t vertexCount;
+		uint32_t lod; // the uploaded mesh's
+		uint64_t lastUpdateIndex; // last update the chunk was resident at
+		uint32_t chunkId;
+	};
+
+	struct FreedRange
+	{
+		uint64_t offset;
+		uint64_t frameNumber; // last frame that could draw it
+	};
+
+	bool Upload( const VoxelMesh& mesh, ChunkMesh& chunkMesh );
+	void FreeRange( const ChunkMesh& chunkMesh, uint64_t frameNumber );
+
+	VkDevice m_device;
+	GpuMemoryAllocator& m_allocator;
+	BindlessDescriptorHeap& m_descriptorHeap;
+
+	VkBuffer m_buffer = VK_NULL_HANDLE;
+	GpuAllocation m_allocation;
+	uint32_t m_descriptorIndex;
+	BuddyAllocator m_rangeAllocator;
+
+	std::unordered_map<glm::ivec3, ChunkMesh, ChunkCoordHash> m_chunkMeshes;
+	std::deque<FreedRange> m_freedRanges; // oldest first
+	std::vector<uint32_t> m_freeChunkIds;
+	uint32_t m_nextChunkId = 0;
+	uint64_t m_updateIndex = 0;
+	uint32_t m_failedUploadCount = 0;
+
+	std::vector<ChunkDraw> m_draws;
+};
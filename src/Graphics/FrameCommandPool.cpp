@@ -0,0 +1,71 @@
+#include <Graphics/FrameCommandPool.h>
+
+#include <stdexcept>
+
+FrameCommandPool::FrameCommandPool( VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight )
+  : m_device( device )
+  , m_slotPools( framesInFlight )
+{
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = queueFamilyIndex;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // short lived, re-recorded every frame
+
+	for( SlotPool& slotPool : m_slotPools )
+	{
+		if( vkCreateCommandPool( m_device, &poolInfo, nullptr, &slotPool.commandPool ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create frame command pool!" );
+		}
+	}
+}
+
+FrameCommandPool::~FrameCommandPool()
+{
+	// Frees the command buffers with them
+	for( SlotPool& slotPool : m_slotPools )
+	{
+		vkDestroyCommandPool( m_device, slotPool.commandPool, nullptr );
+	}
+}
+
+void FrameCommandPool::BeginFrame( uint32_t frameSlot )
+{
+	SlotPool& slotPool = m_slotPools[frameSlot];
+	if( slotPool.usedCounts[VK_COMMAND_BUFFER_LEVEL_PRIMARY] == 0 && slotPool.usedCounts[VK_COMMAND_BUFFER_LEVEL_SECONDARY] == 0 )
+	{
+		return;
+	}
+
+	if( vkResetCommandPool( m_device, slotPool.commandPool, 0 ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to reset frame command pool!" );
+	}
+	slotPool.usedCounts[VK_COMMAND_BUFFER_LEVEL_PRIMARY] = 0;
+	slotPool.usedCounts[VK_COMMAND_BUFFER_LEVEL_SECONDARY] = 0;
+}
+
+VkCommandBuffer FrameCommandPool::Acquire( uint32_t frameSlot, VkCommandBufferLevel level )
+{
+	SlotPool& slotPool = m_slotPools[frameSlot];
+	std::vector<VkCommandBuffer>& commandBuffers = slotPool.commandBuffers[level];
+	uint32_t& usedCount = slotPool.usedCounts[level];
+
+	if( usedCount == commandBuffers.size() )
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = slotPool.commandPool;
+		allocInfo.level = level;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		if( vkAllocateCommandBuffers( m_device, &allocInfo, &commandBuffer ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to allocate frame command buffer!" );
+		}
+		commandBuffers.push_back( commandBuffer );
+	}
+
+	return commandBuffers[usedCount++];
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+//-----------------------
+// A transient command pool per frame in flight, for command buffers recorded every frame.
+// BeginFrame resets the slot's pool in one go, cheaper than resetting its command buffers one by one, which then get reused:
+// after the first frames, recording doesn't allocate anything.
+// A pool can't be used by two threads at the same time, neither can this (see ParallelCommandRecorder for that).
+
+class FrameCommandPool
+{
+  public:
+	FrameCommandPool( VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight );
+	~FrameCommandPool();
+
+	FrameCommandPool( const FrameCommandPool& ) = delete;
+	FrameCommandPool& operator=( const FrameCommandPool& ) = delete;
+
+	// The GPU must be done with the slot's previous frame, its command buffers are reset
+	void BeginFrame( uint32_t frameSlot );
+
+	// A command buffer from the slot's pool, not begun. Valid until the slot's next BeginFrame.
+	VkCommandBuffer Acquire( uint32_t frameSlot, VkCommandBufferLevel level );
+
+  private:
+	static constexpr uint32_t LEVEL_COUNT = 2; // primary & secondary
+
+	struct SlotPool
+	{
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> commandBuffers[LEVEL_COUNT]; // allocated so far, per level
+		uint32_t usedCounts[LEVEL_COUNT] = {};
+	};
+
+	VkDevice m_device;
+	std::vector<SlotPool> m_slotPools; // per frame slot
+};
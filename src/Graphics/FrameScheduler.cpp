@@ -0,0 +1,179 @@
+#include <Graphics/FrameScheduler.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+// Acquire's image + another queue's work, room to spare for passes to come
+constexpr uint32_t MAX_SUBMIT_WAITS = 4;
+
+FrameScheduler::FrameScheduler( VkDevice device, uint32_t framesInFlight )
+  : m_device( device )
+  , m_framesInFlight( framesInFlight )
+{
+	if( m_framesInFlight == 0 )
+	{
+		throw std::runtime_error( "frame scheduler needs at least 1 frame in flight!" );
+	}
+
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+	semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	semaphoreTypeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+	for( VkSemaphore& timeline : m_timelines )
+	{
+		if( vkCreateSemaphore( m_device, &semaphoreInfo, nullptr, &timeline ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create timeline semaphore!" );
+		}
+	}
+}
+
+FrameScheduler::~FrameScheduler()
+{
+	for( VkSemaphore timeline : m_timelines )
+	{
+		vkDestroySemaphore( m_device, timeline, nullptr );
+	}
+}
+
+uint32_t FrameScheduler::BeginFrame()
+{
+	++m_frameNumber;
+	if( m_frameNumber > m_framesInFlight )
+	{
+		WaitForFrame( m_frameNumber - m_framesInFlight );
+	}
+
+	return GetFrameSlot();
+}
+
+FrameScheduler::Wait FrameScheduler::WaitForQueue( FrameQueue queue, VkPipelineStageFlags stage ) const
+{
+	// The queue's latest submit: a queue that skipped this frame doesn't leave the GPU waiting for a value that never comes
+	const uint32_t queueIndex = static_cast<uint32_t>( queue );
+	return Wait{ m_timelines[queueIndex], m_submittedValues[queueIndex], stage };
+}
+
+FrameScheduler::Wait FrameScheduler::WaitForQueue( FrameQueue queue, uint64_t frameNumber, VkPipelineStageFlags stage ) const
+{
+	// Frame 0 (before the first one) is a value the timeline starts at, the wait is already satisfied
+	const uint32_t queueIndex = static_cast<uint32_t>( queue );
+	return Wait{ m_timelines[queueIndex], std::min( frameNumber, m_submittedValues[queueIndex] ), stage };
+}
+
+void FrameScheduler::Submit( FrameQueue queue,
+  VkQueue vkQueue,
+  VkCommandBuffer commandBuffer,
+  std::initializer_list<Wait> waits,
+  VkSemaphore binarySignalSemaphore )
+{
+	const uint32_t queueIndex = static_cast<uint32_t>( queue );
+	if( m_submittedValues[queueIndex] >= m_frameNumber )
+	{
+		throw std::runtime_error( "queue already submitted to this frame!" );
+	}
+	if( waits.size() > MAX_SUBMIT_WAITS )
+	{
+		throw std::runtime_error( "too many semaphores to wait on in one submit!" );
+	}
+
+	VkSemaphore waitSemaphores[MAX_SUBMIT_WAITS];
+	uint64_t waitValues[MAX_SUBMIT_WAITS];
+	VkPipelineStageFlags waitStages[MAX_SUBMIT_WAITS];
+	uint32_t waitCount = 0;
+	for( const Wait& wait : waits )
+	{
+		waitSemaphores[waitCount] = wait.semaphore;
+		waitValues[waitCount] = wait.value;
+		waitStages[waitCount] = wait.stage;
+		++waitCount;
+	}
+
+	// The binary semaphore's value is ignored
+	const VkSemaphore signalSemaphores[] = { m_timelines[queueIndex], binarySignalSemaphore };
+	const uint64_t signalValues[] = { m_frameNumber, 0 };
+	const uint32_t signalCount = binarySignalSemaphore == VK_NULL_HANDLE ? 1 : 2;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = waitCount;
+	timelineInfo.pWaitSemaphoreValues = waitValues;
+	timelineInfo.signalSemaphoreValueCount = signalCount;
+	timelineInfo.pSignalSemaphoreValues = signalValues;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = waitCount;
+	submitInfo.pWaitSemaphores = waitSemaphores;
+	submitInfo.pWaitDstStageMask = waitStages;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	submitInfo.signalSemaphoreCount = signalCount;
+	submitInfo.pSignalSemaphores = signalSemaphores;
+
+	if( vkQueueSubmit( vkQueue, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to submit frame command buffer!" );
+	}
+	m_submittedValues[queueIndex] = m_frameNumber;
+}
+
+uint32_t FrameScheduler::GetFrameWaitValues( uint64_t frameNumber, VkSemaphore* semaphores, uint64_t* values ) const
+{
+	uint32_t count = 0;
+	for( uint32_t queueIndex = 0; queueIndex < QUEUE_COUNT; ++queueIndex )
+	{
+		const uint64_t value = std::min( frameNumber, m_submittedValues[queueIndex] );
+		if( value != 0 )
+		{
+			semaphores[count] = m_timelines[queueIndex];
+			values[count] = value;
+			++count;
+		}
+	}
+	return count;
+}
+
+void FrameScheduler::WaitForFrame( uint64_t frameNumber ) const
+{
+	VkSemaphore semaphores[QUEUE_COUNT];
+	uint64_t values[QUEUE_COUNT];
+	const uint32_t count = GetFrameWaitValues( frameNumber, semaphores, values );
+	if( count == 0 )
+	{
+		return;
+	}
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = count;
+	waitInfo.pSemaphores = semaphores;
+	waitInfo.pValues = values;
+
+	if( vkWaitSemaphores( m_device, &waitInfo, UINT64_MAX ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to wait for frame!" );
+	}
+}
+
+bool FrameScheduler::IsFrameComplete( uint64_t frameNumber ) const
+{
+	VkSemaphore semaphores[QUEUE_COUNT];
+	uint64_t values[QUEUE_COUNT];
+	const uint32_t count = GetFrameWaitValues( frameNumber, semaphores, values );
+	for( uint32_t i = 0; i < count; ++i )
+	{
+		uint64_t completedValue = 0;
+		if( vkGetSemaphoreCounterValue( m_device, semaphores[i], &completedValue ) != VK_SUCCESS || completedValue < values[i] )
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+enum class FrameQueue : uint32_t
+{
+	Compute,
+	Graphics,
+	Count
+};
+
+//-----------------------
+// Paces frames with one timeline semaphore per queue, instead of per frame fences & chains of binary semaphores.
+// Frame N's submit to a queue signals that queue's timeline with N: "is frame N done" is a value comparison,
+// a queue waiting on another one's work is a (timeline, N) pair, and a new pass doesn't need its own semaphore array.
+// Up to framesInFlight frames get recorded ahead of the GPU, BeginFrame only blocks on the frame that last used the slot.
+// Swapchain acquire & present can't use timeline semaphores, those keep their binary ones (see Submit's waits & binarySignalSemaphore).
+
+class FrameScheduler
+{
+  public:
+	struct Wait
+	{
+		VkSemaphore semaphore;
+		uint64_t value; // ignored for binary semaphores
+		VkPipelineStageFlags stage;
+	};
+
+	FrameScheduler( VkDevice device, uint32_t framesInFlight );
+	~FrameScheduler();
+
+	FrameScheduler( const FrameScheduler& ) = delete;
+	FrameScheduler& operator=( const FrameScheduler& ) = delete;
+
+	// Starts the next frame, waiting for the one that last used its slot to be done on every queue. Returns the slot.
+	uint32_t BeginFrame();
+
+	uint32_t GetFramesInFlight() const { return m_framesInFlight; }
+	uint64_t GetFrameNumber() const { return m_frameNumber; } // current frame, the first one is 1
+	uint32_t GetFrameSlot() const { return static_cast<uint32_t>( ( m_frameNumber - 1 ) % m_framesInFlight ); }
+	// Every frame up to this one is done on the GPU, BeginFrame waited for it. 0 until a slot gets reused.
+	uint64_t GetCompletedFrameNumber() const { return m_frameNumber > m_framesInFlight ? m_frameNumber - m_framesInFlight : 0; }
+
+	// For a submit that has to wait on the current frame's work on another queue, submit that one first
+	Wait WaitForQueue( FrameQueue queue, VkPipelineStageFlags stage ) const;
+	// Same for an earlier frame's work, eg: graphics consuming what compute produced the frame before
+	Wait WaitForQueue( FrameQueue queue, uint64_t frameNumber, VkPipelineStageFlags stage ) const;
+
+	// Submits the current frame's commands, signaling the queue's timeline with the frame number once they're done.
+	// One submit per queue and frame, binarySignalSemaphore is for presenting.
+	void Submit( FrameQueue queue,
+	  VkQueue vkQueue,
+	  VkCommandBuffer commandBuffer,
+	  std::initializer_list<Wait> waits,
+	  VkSemaphore binarySignalSemaphore = VK_NULL_HANDLE );
+
+	// Blocks until everything submitted for that frame (and the ones before) is done, 0 returns straight away
+	void WaitForFrame( uint64_t frameNumber ) const;
+	bool IsFrameComplete( uint64_t frameNumber ) const;
+
+  private:
+	static constexpr uint32_t QUEUE_COUNT = static_cast<uint32_t>( FrameQueue::Count );
+
+	// Every queue's timeline value that frame's work ends with, queues it skipped don't hold the wait up
+	uint32_t GetFrameWaitValues( uint64_t frameNumber, VkSemaphore* semaphores, uint64_t* values ) const;
+
+	VkDevice m_device;
+	uint32_t m_framesInFlight;
+	uint64_t m_frameNumber = 0;
+
+	std::array<VkSemaphore, QUEUE_COUNT> m_timelines{};
+	std::array<uint64_t, QUEUE_COUNT> m_submittedValues{}; // last frame number submitted to each queue
+};
@@ -0,0 +1,334 @@
+#include <Graphics/GpuMemoryAllocator.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+// Smallest range handed out of a block, keeps the buddy allocator's levels few
+constexpr VkDeviceSize MIN_SUB_ALLOCATION_SIZE = 256;
+
+GpuMemoryAllocator::GpuMemoryAllocator( VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize )
+  : m_device( device )
+  , m_blockSize( blockSize )
+{
+	vkGetPhysicalDeviceMemoryProperties( physicalDevice, &m_memoryProperties );
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProperties );
+	m_maxDeviceMemoryCount = deviceProperties.limits.maxMemoryAllocationCount;
+
+	m_pools.resize( m_memoryProperties.memoryTypeCount * 2 );
+}
+
+GpuMemoryAllocator::~GpuMemoryAllocator()
+{
+	for( Pool& pool : m_pools )
+	{
+		for( Block& block : pool.blocks )
+		{
+			DestroyBlock( block );
+		}
+	}
+}
+
+GpuAllocation GpuMemoryAllocator::AllocateForBuffer( VkBuffer buffer, GpuMemoryUsage usage )
+{
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements( m_device, buffer, &memoryRequirements );
+
+	GpuAllocation allocation = Allocate( memoryRequirements, usage, false );
+	if( vkBindBufferMemory( m_device, buffer, allocation.memory, allocation.offset ) != VK_SUCCESS )
+	{
+		Free( allocation );
+		throw std::runtime_error( "failed to bind buffer memory!" );
+	}
+	return allocation;
+}
+
+GpuAllocation GpuMemoryAllocator::AllocateForImage( VkImage image, GpuMemoryUsage usage )
+{
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements( m_device, image, &memoryRequirements );
+
+	GpuAllocation allocation = Allocate( memoryRequirements, usage, true );
+	if( vkBindImageMemory( m_device, image, allocation.memory, allocation.offset ) != VK_SUCCESS )
+	{
+		Free( allocation );
+		throw std::runtime_error( "failed to bind image memory!" );
+	}
+	return allocation;
+}
+
+GpuAllocation GpuMemoryAllocator::Allocate( const VkMemoryRequirements& memoryRequirements, GpuMemoryUsage usage, bool isImage )
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	const uint32_t memoryTypeIndex = FindMemoryTypeIndex( memoryRequirements.memoryTypeBits, usage );
+	GpuAllocation allocation;
+	allocation.poolIndex = memoryTypeIndex * 2 + ( isImage ? 1 : 0 );
+	allocation.size = memoryRequirements.size;
+	Pool& pool = m_pools[allocation.poolIndex];
+
+	// Big resources would waste most of a block, they get their own memory
+	if( memoryRequirements.size > m_blockSize / 2 )
+	{
+		Block block = CreateBlock( memoryTypeIndex, memoryRequirements.size );
+		block.dedicatedSize = memoryRequirements.size;
+
+		allocation.memory = block.memory;
+		allocation.mappedData = block.mappedData;
+		allocation.isDedicated = true;
+		allocation.blockIndex = AddBlock( pool, std::move( block ) );
+		++pool.allocationCount;
+		return allocation;
+	}
+
+	const VkDeviceSize alignedSize = std::max( memoryRequirements.size, MIN_SUB_ALLOCATION_SIZE );
+	for( uint32_t blockIndex = 0; blockIndex < pool.blocks.size(); ++blockIndex )
+	{
+		Block& block = pool.blocks[blockIndex];
+		if( block.allocator == nullptr )
+		{
+			continue;
+		}
+
+		if( auto offset = block.allocator->Allocate( alignedSize, memoryRequirements.alignment ) )
+		{
+			allocation.memory = block.memory;
+			allocation.offset = *offset;
+			allocation.mappedData = block.mappedData != nullptr ? block.mappedData + *offset : nullptr;
+			allocation.blockIndex = blockIndex;
+			++pool.allocationCount;
+			return allocation;
+		}
+	}
+
+	// Every block is full, start a new one
+	Block block = CreateBlock( memoryTypeIndex, m_blockSize );
+	block.allocator = std::make_unique<BuddyAllocator>( m_blockSize, MIN_SUB_ALLOCATION_SIZE );
+	allocation.offset = *block.allocator->Allocate( alignedSize, memoryRequirements.alignment );
+	allocation.memory = block.memory;
+	allocation.mappedData = block.mappedData != nullptr ? block.mappedData + allocation.offset : nullptr;
+	allocation.blockIndex = AddBlock( pool, std::move( block ) );
+	++pool.allocationCount;
+	return allocation;
+}
+
+void GpuMemoryAllocator::Free( GpuAllocation& allocation )
+{
+	if( allocation.memory == VK_NULL_HANDLE )
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	Pool& pool = m_pools[allocation.poolIndex];
+	Block& block = pool.blocks[allocation.blockIndex];
+	--pool.allocationCount;
+
+	if( allocation.isDedicated )
+	{
+		DestroyBlock( block );
+	}
+	else
+	{
+		block.allocator->Free( allocation.offset );
+
+		// Hand empty blocks back to the driver, but keep one around so a pool going up and down doesn't thrash
+		if( block.allocator->IsEmpty() )
+		{
+			uint32_t sharedBlockCount = 0;
+			for( const Block& poolBlock : pool.blocks )
+			{
+				sharedBlockCount += poolBlock.allocator != nullptr ? 1 : 0;
+			}
+
+			if( sharedBlockCount > 1 )
+			{
+				DestroyBlock( block );
+			}
+		}
+	}
+
+	allocation = GpuAllocation{};
+}
+
+uint32_t GpuMemoryAllocator::FindMemoryTypeIndex( uint32_t memoryTypeBits, GpuMemoryUsage usage ) const
+{
+	VkMemoryPropertyFlags requiredFlags = 0;
+	VkMemoryPropertyFlags preferredFlags = 0;
+	switch( usage )
+	{
+		case GpuMemoryUsage::GpuOnly:
+			preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			break;
+		case GpuMemoryUsage::CpuToGpu:
+			requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			break;
+		case GpuMemoryUsage::GpuToCpu:
+			requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+			break;
+	}
+
+	// First pass wants the preferred flags too, second pass makes do with the required ones
+	for( const VkMemoryPropertyFlags wantedFlags : { requiredFlags | preferredFlags, requiredFlags } )
+	{
+		for( uint32_t k = 0; k < m_memoryProperties.memoryTypeCount; k++ )
+		{
+			if( ( memoryTypeBits & ( 1u << k ) ) && ( m_memoryProperties.memoryTypes[k].propertyFlags & wantedFlags ) == wantedFlags )
+			{
+				return k;
+			}
+		}
+	}
+
+	throw std::runtime_error( "failed to find a memory type with the required properties!" );
+}
+
+GpuMemoryAllocator::Block GpuMemoryAllocator::CreateBlock( uint32_t memoryTypeIndex, VkDeviceSize size )
+{
+	if( m_deviceMemoryCount >= m_maxDeviceMemoryCount )
+	{
+		throw std::runtime_error( "out of device memory allocations (maxMemoryAllocationCount)!" );
+	}
+
+	VkMemoryAllocateInfo memoryAllocInfo{};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = size;
+	memoryAllocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	Block block;
+	if( vkAllocateMemory( m_device, &memoryAllocInfo, nullptr, &block.memory ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to allocate device memory block!" );
+	}
+	++m_deviceMemoryCount;
+
+	if( m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT )
+	{
+		void* mappedData = nullptr;
+		if( vkMapMemory( m_device, block.memory, 0, VK_WHOLE_SIZE, 0, &mappedData ) != VK_SUCCESS )
+		{
+			DestroyBlock( block );
+			throw std::runtime_error( "failed to map device memory block!" );
+		}
+		block.mappedData = static_cast<uint8_t*>( mappedData );
+	}
+
+	return block;
+}
+
+void GpuMemoryAllocator::DestroyBlock( Block& block )
+{
+	if( block.memory == VK_NULL_HANDLE )
+	{
+		return;
+	}
+
+	// Freeing memory unmaps it
+	vkFreeMemory( m_device, block.memory, nullptr );
+	--m_deviceMemoryCount;
+	block = Block{};
+}
+
+uint32_t GpuMemoryAllocator::AddBlock( Pool& pool, Block block )
+{
+	for( uint32_t blockIndex = 0; blockIndex < pool.blocks.size(); ++blockIndex )
+	{
+		if( pool.blocks[blockIndex].memory == VK_NULL_HANDLE )
+		{
+			pool.blocks[blockIndex] = std::move( block );
+			return blockIndex;
+		}
+	}
+
+	pool.blocks.push_back( std::move( block ) );
+	return static_cast<uint32_t>( pool.blocks.size() - 1 );
+}
+
+GpuMemoryStats GpuMemoryAllocator::GetStats() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	GpuMemoryStats stats;
+	stats.deviceMemoryCount = m_deviceMemoryCount;
+	for( const Pool& pool : m_pools )
+	{
+		stats.allocationCount += pool.allocationCount;
+		for( const Block& block : pool.blocks )
+		{
+			if( block.allocator != nullptr )
+			{
+				stats.reservedSize += block.allocator->GetTotalSize();
+				stats.usedSize += block.allocator->GetAllocatedSize();
+			}
+			else
+			{
+				stats.reservedSize += block.dedicatedSize;
+				stats.usedSize += block.dedicatedSize;
+			}
+		}
+	}
+	return stats;
+}
+
+void GpuMemoryAllocator::PrintStats( std::ostream& output ) const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	char line[256];
+	snprintf( line, sizeof( line ), "GPU memory: %u device memory allocations (max %u)\n", m_deviceMemoryCount, m_maxDeviceMemoryCount );
+	output << line;
+
+	for( uint32_t poolIndex = 0; poolIndex < m_pools.size(); ++poolIndex )
+	{
+		const Pool& pool = m_pools[poolIndex];
+		uint32_t blockCount = 0;
+		uint32_t dedicatedCount = 0;
+		VkDeviceSize reservedSize = 0;
+		VkDeviceSize usedSize = 0;
+		VkDeviceSize requestedSize = 0;
+		VkDeviceSize largestFreeSize = 0;
+		for( const Block& block : pool.blocks )
+		{
+			if( block.allocator != nullptr )
+			{
+				++blockCount;
+				reservedSize += block.allocator->GetTotalSize();
+				usedSize += block.allocator->GetAllocatedSize();
+				requestedSize += block.allocator->GetRequestedSize();
+				largestFreeSize = std::max( largestFreeSize, block.allocator->GetLargestFreeBlockSize() );
+			}
+			else if( block.memory != VK_NULL_HANDLE )
+			{
+				++dedicatedCount;
+				reservedSize += block.dedicatedSize;
+				usedSize += block.dedicatedSize;
+				requestedSize += block.dedicatedSize;
+			}
+		}
+
+		if( blockCount + dedicatedCount == 0 )
+		{
+			continue;
+		}
+
+		const uint32_t memoryTypeIndex = poolIndex / 2;
+		snprintf( line,
+		  sizeof( line ),
+		  "  type %u %-7s flags 0x%x: %u allocations in %u blocks + %u dedicated, %.2f/%.2f MB used (%.2f MB requested), largest free %.2f MB\n",
+		  memoryTypeIndex,
+		  poolIndex % 2 == 0 ? "buffers" : "images",
+		  m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags,
+		  pool.allocationCount,
+		  blockCount,
+		  dedicatedCount,
+		  usedSize / ( 1024.0 * 1024.0 ),
+		  reservedSize / ( 1024.0 * 1024.0 ),
+		  requestedSize / ( 1024.0 * 1024.0 ),
+		  largestFreeSize / ( 1024.0 * 1024.0 ) );
+		output << line;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <Graphics/BuddyAllocator.h>
+
+//-----------------------
+// What an allocation is for, picks the memory type
+enum class GpuMemoryUsage
+{
+	GpuOnly, // device local, never touched by the CPU (images, chunk meshes)
+	CpuToGpu, // host visible & coherent, written by the CPU every so often (uploads, staging)
+	GpuToCpu // host visible & coherent, cached when possible, read back by the CPU
+};
+
+// Memory backing a buffer or image: a range of one of the allocator's blocks
+struct GpuAllocation
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	void* mappedData = nullptr; // start of the allocation, host visible memory only (persistently mapped)
+
+	uint32_t poolIndex = 0;
+	uint32_t blockIndex = 0;
+	bool isDedicated = false; // too big to share a block, has its own VkDeviceMemory
+};
+
+struct GpuMemoryStats
+{
+	uint32_t deviceMemoryCount = 0; // vkAllocateMemory calls alive, blocks & dedicated allocations
+	uint32_t allocationCount = 0;
+	VkDeviceSize reservedSize = 0; // device memory allocated
+	VkDeviceSize usedSize = 0; // sub-allocated out of it, rounding included
+};
+
+//-----------------------
+// Sub-allocates buffers & images out of big VkDeviceMemory blocks, instead of one vkAllocateMemory per resource
+// (bounded by maxMemoryAllocationCount, and slow).
+// Blocks are pooled per memory type, with buffers and images in separate pools so bufferImageGranularity never matters.
+// Placement in a block is done by a BuddyAllocator. Host visible blocks stay mapped for their whole life.
+// Thread safe.
+
+class GpuMemoryAllocator
+{
+  public:
+	static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+	GpuMemoryAllocator( VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE );
+	~GpuMemoryAllocator();
+
+	GpuMemoryAllocator( const GpuMemoryAllocator& ) = delete;
+	GpuMemoryAllocator& operator=( const GpuMemoryAllocator& ) = delete;
+
+	// Allocates memory fitting the resource and binds it
+	GpuAllocation AllocateForBuffer( VkBuffer buffer, GpuMemoryUsage usage );
+	GpuAllocation AllocateForImage( VkImage image, GpuMemoryUsage usage );
+	// Unbound memory, for callers placing several resources in it themselves (eg: aliased render graph transients)
+	GpuAllocation Allocate( const VkMemoryRequirements& memoryRequirements, GpuMemoryUsage usage, bool isImage );
+	// The resource using it must be destroyed (or no longer used by the GPU) first
+	void Free( GpuAllocation& allocation );
+
+	GpuMemoryStats GetStats() const;
+	void PrintStats( std::ostream& output ) const;
+
+  private:
+	struct Block
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		uint8_t* mappedData = nullptr;
+		std::unique_ptr<BuddyAllocator> allocator; // null for dedicated allocations
+		VkDeviceSize dedicatedSize = 0;
+	};
+
+	struct Pool
+	{
+		std::vector<Block> blocks; // freed blocks are left empty (null memory) and reused, to keep block indices stable
+		uint32_t allocationCount = 0;
+	};
+
+	uint32_t FindMemoryTypeIndex( uint32_t memoryTypeBits, GpuMemoryUsage usage ) const;
+	Block CreateBlock( uint32_t memoryTypeIndex, VkDeviceSize size );
+	void DestroyBlock( Block& block );
+	uint32_t AddBlock( Pool& pool, Block block );
+
+	VkDevice m_device;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	VkDeviceSize m_blockSize;
+	uint32_t m_maxDeviceMemoryCount;
+
+	mutable std::mutex m_mutex;
+	std::vector<Pool> m_pools; // 2 per memory type: buffers, then images
+	uint32_t m_deviceMemoryCount = 0;
+};
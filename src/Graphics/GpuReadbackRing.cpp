@@ -0,0 +1,96 @@
+#include <Graphics/GpuReadbackRing.h>
+
+#include <stdexcept>
+
+// Keeps every result aligned for whatever type the callbacks read it as
+constexpr VkDeviceSize READBACK_ALIGNMENT = 16;
+
+GpuReadbackRing::GpuReadbackRing( VkDevice device, GpuMemoryAllocator& allocator, uint32_t frameCount, VkDeviceSize bytesPerFrame )
+  : m_device( device )
+  , m_allocator( allocator )
+  , m_bytesPerFrame( ( bytesPerFrame + READBACK_ALIGNMENT - 1 ) & ~( READBACK_ALIGNMENT - 1 ) )
+  , m_frames( frameCount )
+{
+	VkBufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size = m_bytesPerFrame * frameCount;
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if( vkCreateBuffer( m_device, &bufferCreateInfo, nullptr, &m_buffer ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create readback buffer!" );
+	}
+
+	// Coherent memory, so there's nothing to invalidate before reading
+	m_allocation = m_allocator.AllocateForBuffer( m_buffer, GpuMemoryUsage::GpuToCpu );
+}
+
+GpuReadbackRing::~GpuReadbackRing()
+{
+	vkDestroyBuffer( m_device, m_buffer, nullptr );
+	m_allocator.Free( m_allocation );
+}
+
+void GpuReadbackRing::RequestReadback( VkCommandBuffer commandBuffer,
+  uint32_t frame,
+  VkBuffer sourceBuffer,
+  VkDeviceSize sourceOffset,
+  VkDeviceSize size,
+  VkPipelineStageFlags writeStage,
+  VkAccessFlags writeAccess,
+  Callback callback )
+{
+	Frame& requestFrame = m_frames[frame];
+	const VkDeviceSize alignedSize = ( size + READBACK_ALIGNMENT - 1 ) & ~( READBACK_ALIGNMENT - 1 );
+	if( requestFrame.usedSize + alignedSize > m_bytesPerFrame )
+	{
+		throw std::runtime_error( "readback ring frame is full!" );
+	}
+
+	const VkDeviceSize offset = m_bytesPerFrame * frame + requestFrame.usedSize;
+	requestFrame.usedSize += alignedSize;
+	requestFrame.requests.push_back( Request{ offset, size, std::move( callback ) } );
+
+	// Source written -> copied, then copied -> read by the host once the frame is done
+	VkBufferMemoryBarrier sourceBarrier{};
+	sourceBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	sourceBarrier.srcAccessMask = writeAccess;
+	sourceBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	sourceBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	sourceBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	sourceBarrier.buffer = sourceBuffer;
+	sourceBarrier.offset = sourceOffset;
+	sourceBarrier.size = size;
+	vkCmdPipelineBarrier( commandBuffer, writeStage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &sourceBarrier, 0, nullptr );
+
+	VkBufferCopy copyRegion{};
+	copyRegion.srcOffset = sourceOffset;
+	copyRegion.dstOffset = offset;
+	copyRegion.size = size;
+	vkCmdCopyBuffer( commandBuffer, sourceBuffer, m_buffer, 1, &copyRegion );
+
+	VkBufferMemoryBarrier readbackBarrier{};
+	readbackBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	readbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	readbackBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	readbackBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	readbackBarrier.buffer = m_buffer;
+	readbackBarrier.offset = offset;
+	readbackBarrier.size = size;
+	vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &readbackBarrier, 0, nullptr );
+}
+
+void GpuReadbackRing::OnFrameCompleted( uint32_t frame )
+{
+	Frame& completedFrame = m_frames[frame];
+	const uint8_t* mappedData = static_cast<const uint8_t*>( m_allocation.mappedData );
+	for( const Request& request : completedFrame.requests )
+	{
+		request.callback( mappedData + request.offset, request.size );
+	}
+
+	completedFrame.requests.clear();
+	completedFrame.usedSize = 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <Graphics/GpuMemoryAllocator.h>
+
+//-----------------------
+// Gets small GPU results (simulation stats, pick results...) back to the CPU without stalling.
+// One persistently mapped, host visible buffer split in a region per frame in flight: copies into a frame's region
+// are recorded with that frame's commands, and their callbacks run once the GPU is done with the frame,
+// when the region is known to hold the results and nothing writes it anymore.
+
+class GpuReadbackRing
+{
+  public:
+	// data is only valid during the callback
+	using Callback = std::function<void( const void* data, VkDeviceSize size )>;
+
+	GpuReadbackRing( VkDevice device, GpuMemoryAllocator& allocator, uint32_t frameCount, VkDeviceSize bytesPerFrame );
+	~GpuReadbackRing();
+
+	GpuReadbackRing( const GpuReadbackRing& ) = delete;
+	GpuReadbackRing& operator=( const GpuReadbackRing& ) = delete;
+
+	// Records the copy of sourceBuffer's range into the frame's region, writeStage & writeAccess being how the source was last written.
+	// A source already synced with the copy (eg: by a render graph) passes VK_PIPELINE_STAGE_TRANSFER_BIT & no access.
+	// Throws if the frame's region is full.
+	void RequestReadback( VkCommandBuffer commandBuffer,
+	  uint32_t frame,
+	  VkBuffer sourceBuffer,
+	  VkDeviceSize sourceOffset,
+	  VkDeviceSize size,
+	  VkPipelineStageFlags writeStage,
+	  VkAccessFlags writeAccess,
+	  Callback callback );
+
+	// Call once the GPU is done with the frame, before recording its commands again: runs its callbacks, in request order
+	void OnFrameCompleted( uint32_t frame );
+
+  private:
+	struct Request
+	{
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		Callback callback;
+	};
+
+	struct Frame
+	{
+		VkDeviceSize usedSize = 0;
+		std::vector<Request> requests;
+	};
+
+	VkDevice m_device;
+	GpuMemoryAllocator& m_allocator;
+	VkDeviceSize m_bytesPerFrame;
+
+	VkBuffer m_buffer = VK_NULL_HANDLE;
+	GpuAllocation m_allocation;
+	std::vector<Frame> m_frames;
+};
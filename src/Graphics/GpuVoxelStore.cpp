@@ -0,0 +1,457 @@
+#include <Graphics/GpuVoxelStore.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <Graphics/BindlessDescriptorHeap.h>
+
+namespace
+{
+	constexpr VkDeviceSize BRICKMAP_BYTE_SIZE = sizeof( uint32_t ) * VOXEL_CHUNK_BRICK_COUNT;
+	// Pool bricks: their voxels, then a bit per 2^3 cell (64) & per 4^3 cell (8) holding solid voxels, for rays to skip empty ones
+	constexpr uint32_t BRICK_CELL_MASK_WORD_COUNT = 3;
+	constexpr VkDeviceSize BRICK_BYTE_SIZE = VOXEL_BRICK_VOXEL_COUNT + sizeof( uint32_t ) * BRICK_CELL_MASK_WORD_COUNT;
+	static_assert( VOXEL_BRICK_SIZE == 8, "brick cell masks are laid out for 8^3 bricks" );
+
+	// brickVoxels in brick order (x fastest, then y, then z)
+	void BuildBrickCellMasks( const int8_t* brickVoxels, uint32_t cellMasks[BRICK_CELL_MASK_WORD_COUNT] )
+	{
+		uint64_t cells = 0;
+		uint32_t coarseCells = 0;
+		for( int32_t z = 0; z < VOXEL_BRICK_SIZE; ++z )
+		{
+			for( int32_t y = 0; y < VOXEL_BRICK_SIZE; ++y )
+			{
+				const int8_t* row = brickVoxels + ( z * VOXEL_BRICK_SIZE + y ) * VOXEL_BRICK_SIZE;
+				uint32_t rowBits = 0;
+				for( int32_t x = 0; x < VOXEL_BRICK_SIZE; ++x )
+				{
+					rowBits |= static_cast<uint32_t>( row[x] != 0 ) << x;
+				}
+
+				// Voxel pairs to 2^3 cells, halves to 4^3 ones
+				const uint32_t pairBits = rowBits | ( rowBits >> 1 );
+				for( int32_t cellX = 0; cellX < 4; ++cellX )
+				{
+					cells |= static_cast<uint64_t>( ( pairBits >> ( cellX * 2 ) ) & 1u ) << ( ( ( z >> 1 ) * 4 + ( y >> 1 ) ) * 4 + cellX );
+				}
+				const uint32_t coarseCellIndex = ( ( z >> 2 ) * 2 + ( y >> 2 ) ) * 2;
+				coarseCells |= static_cast<uint32_t>( ( rowBits & 0x0fu ) != 0 ) << coarseCellIndex;
+				coarseCells |= static_cast<uint32_t>( ( rowBits & 0xf0u ) != 0 ) << ( coarseCellIndex + 1 );
+			}
+		}
+		cellMasks[0] = static_cast<uint32_t>( cells );
+		cellMasks[1] = static_cast<uint32_t>( cells >> 32 );
+		cellMasks[2] = coarseCells;
+	}
+	constexpr uint32_t NO_BRICKMAP = 0xffffffff;
+
+	// Per axis: the LOD's voxels still go in 8^3 bricks, the coarsest level only fills part of one
+	int32_t GetLevelBricks( uint32_t lod )
+	{
+		return std::max( ( VOXEL_CHUNK_SIZE >> lod ) / VOXEL_BRICK_SIZE, 1 );
+	}
+
+	uint32_t GetLevelBrickCount( uint32_t lod )
+	{
+		const uint32_t levelBricks = static_cast<uint32_t>( GetLevelBricks( lod ) );
+		return levelBricks * levelBricks * levelBricks;
+	}
+
+	uint64_t GetAllLevelBricks( uint32_t lod )
+	{
+		const uint32_t levelBrickCount = GetLevelBrickCount( lod );
+		return levelBrickCount == 64 ? ~0ull : ( 1ull << levelBrickCount ) - 1;
+	}
+
+	// Full resolution bricks (see VoxelBrickIndex) to the LOD's bricks holding their voxels
+	uint64_t ToLevelBricks( uint64_t bricks, uint32_t lod )
+	{
+		if( lod == 0 || bricks == 0 )
+		{
+			return bricks;
+		}
+
+		const int32_t levelBricks = GetLevelBricks( lod );
+		uint64_t levelBrickBits = 0;
+		for( ; bricks != 0; bricks &= bricks - 1 )
+		{
+			const int32_t brickIndex = __builtin_ctzll( bricks );
+			const int32_t brickX = ( brickIndex % VOXEL_CHUNK_BRICKS ) >> lod;
+			const int32_t brickY = ( ( brickIndex / VOXEL_CHUNK_BRICKS ) % VOXEL_CHUNK_BRICKS ) >> lod;
+			const int32_t brickZ = ( brickIndex / ( VOXEL_CHUNK_BRICKS * VOXEL_CHUNK_BRICKS ) ) >> lod;
+			levelBrickBits |= 1ull << ( ( brickZ * levelBricks + brickY ) * levelBricks + brickX );
+		}
+		return levelBrickBits;
+	}
+} // namespace
+
+GpuVoxelStore::GpuVoxelStore( VkDevice device,
+  GpuMemoryAllocator& allocator,
+  BindlessDescriptorHeap& descriptorHeap,
+  uint32_t framesInFlight,
+  uint32_t gridSize,
+  uint32_t brickCapacity,
+  VkDeviceSize uploadBudget )
+  : m_device( device )
+  , m_allocator( allocator )
+  , m_descriptorHeap( descriptorHeap )
+  , m_gridSize( gridSize )
+  , m_brickCapacity( brickCapacity )
+  , m_uploadBudget( uploadBudget )
+  , m_denseVoxels( VOXEL_CHUNK_VOXEL_COUNT )
+{
+	if( uploadBudget < BRICKMAP_BYTE_SIZE + BRICK_BYTE_SIZE )
+	{
+		throw std::runtime_error( "voxel store upload budget can't fit a brick!" );
+	}
+
+	// A brickmap per grid cell: dropped chunks' brickmaps are reused within the update
+	const uint32_t gridCellCount = gridSize * gridSize * gridSize;
+	if( gridCellCount > ( 1u << GRID_CELL_LOD_SHIFT ) )
+	{
+		throw std::runtime_error( "voxel store grid too big for its cells' brickmap indices!" );
+	}
+
+	m_grid = CreateBuffer( sizeof( uint32_t ) * gridCellCount * framesInFlight, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GpuMemoryUsage::CpuToGpu, true );
+	m_brickmaps = CreateBuffer( BRICKMAP_BYTE_SIZE * gridCellCount,
+	  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	  GpuMemoryUsage::GpuOnly,
+	  true );
+	m_bricks = CreateBuffer( BRICK_BYTE_SIZE * brickCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuMemoryUsage::GpuOnly, true );
+	m_staging = CreateBuffer( uploadBudget * framesInFlight, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, GpuMemoryUsage::CpuToGpu, false );
+
+	m_brickmapEntries.resize( static_cast<size_t>( VOXEL_CHUNK_BRICK_COUNT ) * gridCellCount );
+
+	// Lowest indices first
+	for( uint32_t brickmapIndex = gridCellCount; brickmapIndex > 0; --brickmapIndex )
+	{
+		m_freeBrickmaps.push_back( brickmapIndex - 1 );
+	}
+	for( uint32_t brickIndex = brickCapacity; brickIndex > 0; --brickIndex )
+	{
+		m_freeBricks.push_back( brickIndex - 1 );
+	}
+}
+
+GpuVoxelStore::~GpuVoxelStore()
+{
+	DestroyBuffer( m_staging, false );
+	DestroyBuffer( m_bricks, true );
+	DestroyBuffer( m_brickmaps, true );
+	DestroyBuffer( m_grid, true );
+}
+
+GpuVoxelStore::Buffer GpuVoxelStore::CreateBuffer( VkDeviceSize size, VkBufferUsageFlags usage, GpuMemoryUsage memoryUsage, bool isStorageBuffer )
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	Buffer buffer;
+	if( vkCreateBuffer( m_device, &bufferInfo, nullptr, &buffer.buffer ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create voxel store buffer!" );
+	}
+	buffer.allocation = m_allocator.AllocateForBuffer( buffer.buffer, memoryUsage );
+	if( isStorageBuffer )
+	{
+		buffer.descriptorIndex = m_descriptorHeap.AddStorageBuffer( buffer.buffer );
+	}
+	return buffer;
+}
+
+void GpuVoxelStore::DestroyBuffer( Buffer& buffer, bool isStorageBuffer )
+{
+	if( isStorageBuffer )
+	{
+		m_descriptorHeap.Remove( BindlessResourceType::StorageBuffer, buffer.descriptorIndex );
+	}
+	vkDestroyBuffer( m_device, buffer.buffer, nullptr );
+	m_allocator.Free( buffer.allocation );
+}
+
+void GpuVoxelStore::Update( VoxelChunkManager& chunkManager, const glm::vec3& viewpoint, uint32_t frameSlot )
+{
+	++m_updateIndex;
+	const glm::ivec3 viewChunk = VoxelChunkManager::WorldToChunkCoord( viewpoint );
+	m_gridOrigin = viewChunk - glm::ivec3( m_gridSize / 2 );
+
+	// Gather the chunks' new dirty bricks
+	m_pendingChunks.clear();
+	chunkManager.ForEachChunk( [&]( const glm::ivec3& chunkCoord, VoxelObject& chunk ) {
+		if( !IsInGrid( chunkCoord ) || chunk.GetSize() != VOXEL_CHUNK_SIZE )
+		{
+			return;
+		}
+
+		auto storedChunk = m_storedChunks.find( chunkCoord );
+		if( storedChunk == m_storedChunks.end() )
+		{
+			if( m_freeBrickmaps.empty() )
+			{
+				++m_failedUploadCount;
+				return;
+			}
+
+			// Empty until its bricks get staged, every one of them: the chunk may have been dirty while out of the grid
+			const uint32_t brickmapIndex = m_freeBrickmaps.back();
+			m_freeBrickmaps.pop_back();
+			std::fill_n( &m_brickmapEntries[static_cast<size_t>( brickmapIndex ) * VOXEL_CHUNK_BRICK_COUNT], VOXEL_CHUNK_BRICK_COUNT, UNIFORM_BRICK_BIT );
+			storedChunk = m_storedChunks
+							.emplace( chunkCoord, StoredChunk{ brickmapIndex, chunk.GetLod(), GetAllLevelBricks( chunk.GetLod() ), false, 0, NO_BRICKMAP, 0 } )
+							.first;
+		}
+
+		StoredChunk& stored = storedChunk->second;
+		if( stored.lod != chunk.GetLod() )
+		{
+			SwitchLod( stored, chunk.GetLod() );
+		}
+		stored.pendingBricks |= ToLevelBricks( chunk.GetDirtyBricks(), stored.lod );
+		stored.lastUpdateIndex = m_updateIndex;
+		chunk.ClearDirtyBricks();
+
+		if( stored.pendingBricks != 0 )
+		{
+			const glm::vec3 offset( chunkCoord - viewChunk );
+			m_pendingChunks.push_back( PendingChunk{ glm::dot( offset, offset ), &chunk, &stored } );
+		}
+	} );
+
+	// Chunks that went away or out of the grid, before staging: their bricks can go to the others right away
+	for( auto storedChunk = m_storedChunks.begin(); storedChunk != m_storedChunks.end(); )
+	{
+		if( storedChunk->second.lastUpdateIndex != m_updateIndex )
+		{
+			FreeBrickmap( storedChunk->second.brickmapIndex );
+			if( storedChunk->second.previousBrickmapIndex != NO_BRICKMAP )
+			{
+				FreeBrickmap( storedChunk->second.previousBrickmapIndex );
+			}
+			storedChunk = m_storedChunks.erase( storedChunk );
+		}
+		else
+		{
+			++storedChunk;
+		}
+	}
+
+	// Nearest first, as much as the budget allows
+	m_firstStagingOffset = frameSlot * m_uploadBudget;
+	m_uploadedBytes = 0;
+	m_brickmapCopies.clear();
+	m_brickCopies.clear();
+
+	std::sort( m_pendingChunks.begin(), m_pendingChunks.end(), []( const PendingChunk& a, const PendingChunk& b ) {
+		return a.distance < b.distance;
+	} );
+	for( const PendingChunk& pendingChunk : m_pendingChunks )
+	{
+		if( !StageBricks( *pendingChunk.chunk, *pendingChunk.storedChunk ) )
+		{
+			++m_budgetLimitedUpdateCount;
+			break;
+		}
+	}
+
+	m_totalUploadedBytes += m_uploadedBytes;
+	m_peakUploadedBytes = std::max( m_peakUploadedBytes, m_uploadedBytes );
+
+	uint32_t* gridCells = static_cast<uint32_t*>( m_grid.allocation.mappedData ) + GetFirstGridCell( frameSlot );
+	const uint32_t gridCellCount = m_gridSize * m_gridSize * m_gridSize;
+	std::fill( gridCells, gridCells + gridCellCount, EMPTY_GRID_CELL );
+
+	for( const auto& storedChunk : m_storedChunks )
+	{
+		const StoredChunk& stored = storedChunk.second;
+		const glm::ivec3 gridCoord = storedChunk.first - m_gridOrigin;
+		uint32_t& gridCell = gridCells[( gridCoord.z * m_gridSize + gridCoord.y ) * m_gridSize + gridCoord.x];
+		if( stored.isComplete )
+		{
+			gridCell = stored.brickmapIndex | ( stored.lod << GRID_CELL_LOD_SHIFT );
+		}
+		else if( stored.previousBrickmapIndex != NO_BRICKMAP )
+		{
+			gridCell = stored.previousBrickmapIndex | ( stored.previousLod << GRID_CELL_LOD_SHIFT );
+		}
+	}
+}
+
+bool GpuVoxelStore::StageBricks( const VoxelObject& chunk, StoredChunk& storedChunk )
+{
+	// The brickmap goes along with any of its bricks, only the LOD's entries
+	const VkDeviceSize brickmapByteSize = sizeof( uint32_t ) * GetLevelBrickCount( storedChunk.lod );
+	if( m_uploadedBytes + brickmapByteSize > m_uploadBudget )
+	{
+		return false;
+	}
+
+	chunk.CopyLodToDense( m_denseVoxels.data() );
+
+	const int32_t levelSize = static_cast<int32_t>( chunk.GetLodSize() );
+	const int32_t levelBricks = GetLevelBricks( storedChunk.lod );
+	const int32_t brickSize = std::min( levelSize, VOXEL_BRICK_SIZE ); // a brick's voxels inside the chunk, per axis
+	uint32_t* brickmapEntries = &m_brickmapEntries[static_cast<size_t>( storedChunk.brickmapIndex ) * VOXEL_CHUNK_BRICK_COUNT];
+	int8_t brickVoxels[VOXEL_BRICK_VOXEL_COUNT];
+	bool isBudgetLeft = true;
+	bool isBrickmapChanged = false;
+
+	// Rays never get past the chunk's voxels, the rest of a partial brick stays empty
+	memset( brickVoxels, 0, sizeof( brickVoxels ) );
+
+	for( int32_t brickIndex = 0; brickIndex < levelBricks * levelBricks * levelBricks && isBudgetLeft; ++brickIndex )
+	{
+		const uint64_t brickBit = 1ull << brickIndex;
+		if( ( storedChunk.pendingBricks & brickBit ) == 0 )
+		{
+			continue;
+		}
+
+		// Gather the brick's rows out of the chunk's
+		const int32_t brickX = brickIndex % levelBricks;
+		const int32_t brickY = ( brickIndex / levelBricks ) % levelBricks;
+		const int32_t brickZ = brickIndex / ( levelBricks * levelBricks );
+		bool isUniform = true;
+		for( int32_t z = 0; z < brickSize; ++z )
+		{
+			for( int32_t y = 0; y < brickSize; ++y )
+			{
+				const int32_t chunkY = brickY * VOXEL_BRICK_SIZE + y;
+				const int32_t chunkZ = brickZ * VOXEL_BRICK_SIZE + z;
+				const int8_t* row = &m_denseVoxels[( chunkZ * levelSize + chunkY ) * levelSize + brickX * VOXEL_BRICK_SIZE];
+				int8_t* brickRow = &brickVoxels[( z * VOXEL_BRICK_SIZE + y ) * VOXEL_BRICK_SIZE];
+				memcpy( brickRow, row, brickSize );
+				for( int32_t x = 0; x < brickSize; ++x )
+				{
+					isUniform &= brickRow[x] == brickVoxels[0];
+				}
+			}
+		}
+
+		uint32_t& brickmapEntry = brickmapEntries[brickIndex];
+		const bool hasPoolBrick = ( brickmapEntry & UNIFORM_BRICK_BIT ) == 0;
+		if( isUniform )
+		{
+			if( hasPoolBrick )
+			{
+				m_freeBricks.push_back( brickmapEntry );
+			}
+			brickmapEntry = UNIFORM_BRICK_BIT | static_cast<uint8_t>( brickVoxels[0] );
+			storedChunk.pendingBricks &= ~brickBit;
+			isBrickmapChanged = true;
+			continue;
+		}
+
+		// Leaving room for the brickmap
+		if( m_uploadedBytes + BRICK_BYTE_SIZE + brickmapByteSize > m_uploadBudget )
+		{
+			isBudgetLeft = false;
+			continue;
+		}
+		if( !hasPoolBrick )
+		{
+			if( m_freeBricks.empty() )
+			{
+				// Stays pending, the chunk keeps its old voxels there (or stays out of the grid) until a brick frees up
+				++m_failedUploadCount;
+				continue;
+			}
+			brickmapEntry = m_freeBricks.back();
+			m_freeBricks.pop_back();
+			isBrickmapChanged = true;
+		}
+
+		// Rewritten in place: the copy comes after the previous frames' reads on the queue
+		uint32_t cellMasks[BRICK_CELL_MASK_WORD_COUNT];
+		BuildBrickCellMasks( brickVoxels, cellMasks );
+		uint8_t* stagedBrick = Stage( BRICK_BYTE_SIZE, m_brickCopies, brickmapEntry * BRICK_BYTE_SIZE );
+		memcpy( stagedBrick, brickVoxels, VOXEL_BRICK_VOXEL_COUNT );
+		memcpy( stagedBrick + VOXEL_BRICK_VOXEL_COUNT, cellMasks, sizeof( cellMasks ) );
+		storedChunk.pendingBricks &= ~brickBit;
+	}
+
+	if( isBrickmapChanged )
+	{
+		memcpy( Stage( brickmapByteSize, m_brickmapCopies, storedChunk.brickmapIndex * BRICKMAP_BYTE_SIZE ), brickmapEntries, brickmapByteSize );
+	}
+	storedChunk.isComplete |= storedChunk.pendingBricks == 0;
+
+	// The previous LOD isn't in this update's grid anymore, its bricks can go right away
+	if( storedChunk.isComplete && storedChunk.previousBrickmapIndex != NO_BRICKMAP )
+	{
+		FreeBrickmap( storedChunk.previousBrickmapIndex );
+		storedChunk.previousBrickmapIndex = NO_BRICKMAP;
+	}
+	return isBudgetLeft;
+}
+
+uint8_t* GpuVoxelStore::Stage( VkDeviceSize size, std::vector<VkBufferCopy>& copies, VkDeviceSize dstOffset )
+{
+	const VkDeviceSize stagingOffset = m_firstStagingOffset + m_uploadedBytes;
+	copies.push_back( VkBufferCopy{ stagingOffset, dstOffset, size } );
+	m_uploadedBytes += size;
+	return static_cast<uint8_t*>( m_staging.allocation.mappedData ) + stagingOffset;
+}
+
+void GpuVoxelStore::RecordUploads( VkCommandBuffer commandBuffer ) const
+{
+	if( !m_brickCopies.empty() )
+	{
+		vkCmdCopyBuffer( commandBuffer, m_staging.buffer, m_bricks.buffer, static_cast<uint32_t>( m_brickCopies.size() ), m_brickCopies.data() );
+	}
+	if( !m_brickmapCopies.empty() )
+	{
+		vkCmdCopyBuffer( commandBuffer, m_staging.buffer, m_brickmaps.buffer, static_cast<uint32_t>( m_brickmapCopies.size() ), m_brickmapCopies.data() );
+	}
+}
+
+void GpuVoxelStore::SwitchLod( StoredChunk& storedChunk, uint32_t lod )
+{
+	if( storedChunk.isComplete && storedChunk.previousBrickmapIndex == NO_BRICKMAP && !m_freeBrickmaps.empty() )
+	{
+		storedChunk.previousBrickmapIndex = storedChunk.brickmapIndex;
+		storedChunk.previousLod = storedChunk.lod;
+		storedChunk.brickmapIndex = m_freeBrickmaps.back();
+		m_freeBrickmaps.pop_back();
+		std::fill_n( &m_brickmapEntries[static_cast<size_t>( storedChunk.brickmapIndex ) * VOXEL_CHUNK_BRICK_COUNT], VOXEL_CHUNK_BRICK_COUNT, UNIFORM_BRICK_BIT );
+	}
+	else
+	{
+		// Nothing to keep it in the grid with meanwhile (or still the older LOD doing it)
+		ClearBrickmap( storedChunk.brickmapIndex );
+	}
+
+	storedChunk.lod = lod;
+	storedChunk.pendingBricks = GetAllLevelBricks( lod );
+	storedChunk.isComplete = false;
+}
+
+void GpuVoxelStore::ClearBrickmap( uint32_t brickmapIndex )
+{
+	uint32_t* brickmapEntries = &m_brickmapEntries[static_cast<size_t>( brickmapIndex ) * VOXEL_CHUNK_BRICK_COUNT];
+	for( int32_t brickIndex = 0; brickIndex < VOXEL_CHUNK_BRICK_COUNT; ++brickIndex )
+	{
+		if( ( brickmapEntries[brickIndex] & UNIFORM_BRICK_BIT ) == 0 )
+		{
+			m_freeBricks.push_back( brickmapEntries[brickIndex] );
+		}
+		brickmapEntries[brickIndex] = UNIFORM_BRICK_BIT;
+	}
+}
+
+void GpuVoxelStore::FreeBrickmap( uint32_t brickmapIndex )
+{
+	ClearBrickmap( brickmapIndex );
+	m_freeBrickmaps.push_back( brickmapIndex );
+}
+
+bool GpuVoxelStore::IsInGrid( const glm::ivec3& chunkCoord ) const
+{
+	const glm::ivec3 gridCoord = chunkCoord - m_gridOrigin;
+	const int32_t gridSize = static_cast<int32_t>( m_gridSize );
+	return gridCoord.x >= 0 && gridCoord.y >= 0 && gridCoord.z >= 0 && gridCoord.x < gridSize && gridCoord.y < gridSize && gridCoord.z < gridSize;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Graphics/GpuMemoryAllocator.h>
+#include <Voxel/VoxelChunkManager.h>
+
+class BindlessDescriptorHeap;
+
+// Brickmap entries with this bit hold a whole brick of one material in their low byte (0: empty brick), a brick index otherwise
+constexpr uint32_t UNIFORM_BRICK_BIT = 0x80000000;
+// Grid cells without a chunk
+constexpr uint32_t EMPTY_GRID_CELL = 0xffffffff;
+// Grid cells hold their chunk's LOD from this bit up, its brickmap index below
+constexpr uint32_t GRID_CELL_LOD_SHIFT = 28;
+
+//-----------------------
+// The resident chunks' voxels on the GPU, for compute shaders to trace rays through (see Raymarch.comp & VoxelStore.glsl):
+// - grid: a cube of gridSize^3 cells around the viewpoint, one per chunk, holding the chunk's LOD & brickmap index.
+//   Host visible, rewritten every update in the frame slot's region.
+// - brickmaps: up to VOXEL_CHUNK_BRICK_COUNT entries per chunk, a uniform material or the index of a brick in the pool.
+// - bricks: VOXEL_BRICK_VOXEL_COUNT voxels each, a byte per voxel packed 4 to a uint, then a bit per 2^3 & 4^3 cell
+//   with solid voxels: rays cross the empty ones in one step.
+// Bricks all of one material (empty ones especially) don't take any room in the pool.
+// Chunks are stored at their LOD (see VoxelObject::SetLod), in its own voxels: a level 1 chunk has 8 bricks,
+// levels 2 & 3 a single one (level 3 only fills a 4^3 corner of it). When a chunk changes LOD, its old bricks
+// keep it in the grid until the new ones are all in, as long as there's a brickmap to spare.
+// Brickmaps & bricks are GPU only: each update only stages the bricks chunks marked dirty (see VoxelObject::GetDirtyBricks),
+// nearest chunks first, up to uploadBudget bytes. What doesn't fit stays pending for the next updates.
+// RecordUploads copies them in, ahead of the frame's reads: every write goes through the queue after the previous frames'
+// reads, so freed bricks & brickmaps are reused right away.
+// Every storage buffer is in the bindless descriptor heap, the caller must flush its writes.
+
+class GpuVoxelStore
+{
+  public:
+	// uploadBudget: staged bytes per update, at least a brickmap & a brick
+	GpuVoxelStore( VkDevice device,
+	  GpuMemoryAllocator& allocator,
+	  BindlessDescriptorHeap& descriptorHeap,
+	  uint32_t framesInFlight,
+	  uint32_t gridSize,
+	  uint32_t brickCapacity,
+	  VkDeviceSize uploadBudget );
+	~GpuVoxelStore();
+
+	GpuVoxelStore( const GpuVoxelStore& ) = delete;
+	GpuVoxelStore& operator=( const GpuVoxelStore& ) = delete;
+
+	// Stages the dirty bricks of the chunks inside the grid around viewpoint, drops the chunks that went away
+	// & writes the frame slot's grid. The GPU must be done with the slot's previous frame.
+	// Chunks join the grid once all their bricks made it, until then (or when the pool is full) they're missing from it.
+	void Update( VoxelChunkManager& chunkManager, const glm::vec3& viewpoint, uint32_t frameSlot );
+	// The copies the last update staged, the frame's shaders must wait for them (transfer writes)
+	void RecordUploads( VkCommandBuffer commandBuffer ) const;
+
+	const glm::ivec3& GetGridOrigin() const { return m_gridOrigin; } // chunk coordinate of the first cell, as of the last update
+	uint32_t GetGridSize() const { return m_gridSize; } // in chunks, per axis
+	uint32_t GetFirstGridCell( uint32_t frameSlot ) const { return frameSlot * m_gridSize * m_gridSize * m_gridSize; }
+
+	VkBuffer GetBrickmapBuffer() const { return m_brickmaps.buffer; }
+	VkBuffer GetBrickBuffer() const { return m_bricks.buffer; }
+	uint32_t GetGridDescriptorIndex() const { return m_grid.descriptorIndex; }
+	uint32_t GetBrickmapDescriptorIndex() const { return m_brickmaps.descriptorIndex; }
+	uint32_t GetBrickDescriptorIndex() const { return m_bricks.descriptorIndex; }
+
+	size_t GetChunkCount() const { return m_storedChunks.size(); }
+	uint32_t GetUsedBrickCount() const { return m_brickCapacity - static_cast<uint32_t>( m_freeBricks.size() ); }
+	uint32_t GetBrickCapacity() const { return m_brickCapacity; }
+	uint32_t GetFailedUploadCount() const { return m_failedUploadCount; } // since the start, chunks & bricks that didn't fit
+
+	// Upload stats: the last update's, then since the start
+	VkDeviceSize GetUploadedBytes() const { return m_uploadedBytes; }
+	VkDeviceSize GetUploadBudget() const { return m_uploadBudget; }
+	VkDeviceSize GetTotalUploadedBytes() const { return m_totalUploadedBytes; }
+	VkDeviceSize GetPeakUploadedBytes() const { return m_peakUploadedBytes; }
+	uint64_t GetUpdateCount() const { return m_updateIndex; }
+	uint64_t GetBudgetLimitedUpdateCount() const { return m_budgetLimitedUpdateCount; } // updates that left bricks pending
+
+  private:
+	struct Buffer
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		GpuAllocation allocation;
+		uint32_t descriptorIndex = 0;
+	};
+
+	struct StoredChunk
+	{
+		uint32_t brickmapIndex;
+		uint32_t lod;
+		uint64_t pendingBricks; // bricks (of the LOD) whose GPU copy is stale
+		bool isComplete; // every brick made it once, the chunk is in the grid
+		uint64_t lastUpdateIndex; // last update the chunk was in the grid at
+		uint32_t previousBrickmapIndex; // the previous LOD's, in the grid until the chunk is complete again. NO_BRICKMAP if none.
+		uint32_t previousLod;
+	};
+
+	struct PendingChunk
+	{
+		float distance; // to the viewpoint, in chunks
+		const VoxelObject* chunk;
+		StoredChunk* storedChunk;
+	};
+
+	Buffer CreateBuffer( VkDeviceSize size, VkBufferUsageFlags usage, GpuMemoryUsage memoryUsage, bool isStorageBuffer );
+	void DestroyBuffer( Buffer& buffer, bool isStorageBuffer );
+
+	// Stages the chunk's pending bricks & its brickmap, false once the budget ran out
+	bool StageBricks( const VoxelObject& chunk, StoredChunk& storedChunk );
+	uint8_t* Stage( VkDeviceSize size, std::vector<VkBufferCopy>& copies, VkDeviceSize dstOffset );
+	// Starts over at lod, every brick pending
+	void SwitchLod( StoredChunk& storedChunk, uint32_t lod );
+	void ClearBrickmap( uint32_t brickmapIndex ); // frees its bricks, every entry empty
+	void FreeBrickmap( uint32_t brickmapIndex ); // along with its bricks
+	bool IsInGrid( const glm::ivec3& chunkCoord ) const;
+
+	VkDevice m_device;
+	GpuMemoryAllocator& m_allocator;
+	BindlessDescriptorHeap& m_descriptorHeap;
+	uint32_t m_gridSize;
+	uint32_t m_brickCapacity;
+	VkDeviceSize m_uploadBudget;
+
+	Buffer m_grid; // a region per frame slot
+	Buffer m_brickmaps;
+	Buffer m_bricks;
+	Buffer m_staging; // an uploadBudget region per frame slot
+
+	glm::ivec3 m_gridOrigin = glm::ivec3( 0 );
+	std::unordered_map<glm::ivec3, StoredChunk, ChunkCoordHash> m_storedChunks;
+	std::vector<uint32_t> m_freeBrickmaps;
+	std::vector<uint32_t> m_freeBricks;
+	std::vector<uint32_t> m_brickmapEntries; // CPU copy of the brickmaps
+	uint64_t m_updateIndex = 0;
+	uint32_t m_failedUploadCount = 0;
+
+	// The last update's staging
+	VkDeviceSize m_firstStagingOffset = 0; // the frame slot's region
+	VkDeviceSize m_uploadedBytes = 0;
+	std::vector<VkBufferCopy> m_brickmapCopies;
+	std::vector<VkBufferCopy> m_brickCopies;
+
+	VkDeviceSize m_totalUploadedBytes = 0;
+	VkDeviceSize m_peakUploadedBytes = 0;
+	uint64_t m_budgetLimitedUpdateCount = 0;
+
+	// Kept around to avoid reallocating every update
+	std::vector<PendingChunk> m_pendingChunks;
+	std::vector<int8_t> m_denseVoxels;
+};
@@ -0,0 +1,84 @@
+#include <Graphics/IndirectChunkDraws.h>
+
+#include <stdexcept>
+
+#include <Graphics/BindlessDescriptorHeap.h>
+#include <Voxel/VoxelConstants.h>
+
+IndirectChunkDraws::IndirectChunkDraws( VkDevice device,
+  GpuMemoryAllocator& allocator,
+  BindlessDescriptorHeap& descriptorHeap,
+  uint32_t framesInFlight,
+  uint32_t maxChunkCount )
+  : m_device( device )
+  , m_allocator( allocator )
+  , m_descriptorHeap( descriptorHeap )
+  , m_maxChunkCount( maxChunkCount )
+{
+	m_chunks = CreateBuffer( sizeof( GpuChunk ) * maxChunkCount * framesInFlight, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GpuMemoryUsage::CpuToGpu );
+	m_drawCommands = CreateBuffer( sizeof( VkDrawIndexedIndirectCommand ) * maxChunkCount * CULL_PHASE_COUNT,
+	  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+	  GpuMemoryUsage::GpuOnly );
+	// Cleared every frame before culling appends to it
+	m_drawCount = CreateBuffer( sizeof( uint32_t ) * CULL_PHASE_COUNT,
+	  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	  GpuMemoryUsage::GpuOnly );
+	m_visibility = CreateBuffer( sizeof( uint32_t ) * maxChunkCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GpuMemoryUsage::GpuOnly );
+}
+
+IndirectChunkDraws::~IndirectChunkDraws()
+{
+	DestroyBuffer( m_visibility );
+	DestroyBuffer( m_drawCount );
+	DestroyBuffer( m_drawCommands );
+	DestroyBuffer( m_chunks );
+}
+
+IndirectChunkDraws::Buffer IndirectChunkDraws::CreateBuffer( VkDeviceSize size, VkBufferUsageFlags usage, GpuMemoryUsage memoryUsage )
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	Buffer buffer;
+	if( vkCreateBuffer( m_device, &bufferInfo, nullptr, &buffer.buffer ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create indirect chunk draw buffer!" );
+	}
+	buffer.allocation = m_allocator.AllocateForBuffer( buffer.buffer, memoryUsage );
+	buffer.descriptorIndex = m_descriptorHeap.AddStorageBuffer( buffer.buffer );
+	return buffer;
+}
+
+void IndirectChunkDraws::DestroyBuffer( Buffer& buffer )
+{
+	m_descriptorHeap.Remove( BindlessResourceType::StorageBuffer, buffer.descriptorIndex );
+	vkDestroyBuffer( m_device, buffer.buffer, nullptr );
+	m_allocator.Free( buffer.allocation );
+}
+
+uint32_t IndirectChunkDraws::Upload( uint32_t frameSlot, const std::vector<ChunkDraw>& chunkDraws )
+{
+	uint32_t chunkCount = static_cast<uint32_t>( chunkDraws.size() );
+	if( chunkCount > m_maxChunkCount )
+	{
+		m_droppedChunkCount += chunkCount - m_maxChunkCount;
+		chunkCount = m_maxChunkCount;
+	}
+
+	GpuChunk* chunks = static_cast<GpuChunk*>( m_chunks.allocation.mappedData ) + GetFirstChunk( frameSlot );
+	for( uint32_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex )
+	{
+		const ChunkDraw& chunkDraw = chunkDraws[chunkIndex];
+		chunks[chunkIndex] = GpuChunk{ glm::vec4( chunkDraw.origin, static_cast<float>( VOXEL_CHUNK_SIZE ) ),
+			chunkDraw.firstIndex,
+			chunkDraw.indexCount,
+			chunkDraw.vertexOffset,
+			chunkDraw.chunkId < m_maxChunkCount ? chunkDraw.chunkId : NO_CHUNK_ID,
+			chunkDraw.voxelScale,
+			{} };
+	}
+	return chunkCount;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Graphics/ChunkMeshPool.h>
+#include <Graphics/GpuMemoryAllocator.h>
+
+class BindlessDescriptorHeap;
+
+// A chunk as ChunkCull.comp & VoxelChunk.vert read it (std430)
+struct GpuChunk
+{
+	glm::vec4 origin; // xyz: world space min corner, w: size
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset;
+	uint32_t chunkId; // see ChunkDraw, NO_CHUNK_ID past the visibility buffer: always tested, never remembered
+	float voxelScale; // see ChunkDraw
+	uint32_t padding[3]; // std430 rounds the struct up to its vec4's alignment
+};
+static_assert( sizeof( GpuChunk ) == 48, "GpuChunk must match Chunks.glsl" );
+
+constexpr uint32_t NO_CHUNK_ID = 0xffffffff;
+
+//-----------------------
+// The buffers chunk draws go through, so they can be culled & issued on the GPU:
+// - chunks: the frame's GpuChunks, written by the CPU in the frame slot's region.
+//   Draws pass their chunk's index as firstInstance, VoxelChunk.vert reads the chunk back through gl_InstanceIndex.
+// - draw commands & count: ChunkCull.comp appends a VkDrawIndexedIndirectCommand per visible chunk,
+//   for vkCmdDrawIndexedIndirectCount. GPU only, frames on the graphics queue use them one after the other.
+//   There's a list & count per culling phase: chunks visible last frame, then the ones the Hi-Z test found visible since.
+// - visibility: a uint per chunk id (up to maxChunkCount), whether the chunk passed last frame's occlusion test.
+//   GPU only, it carries over to the next frame. It starts out undefined, as does a reused chunk id's:
+//   at worst a chunk gets drawn a phase early.
+// All of them are in the bindless descriptor heap, the caller must flush its writes.
+
+class IndirectChunkDraws
+{
+  public:
+	IndirectChunkDraws( VkDevice device, GpuMemoryAllocator& allocator, BindlessDescriptorHeap& descriptorHeap, uint32_t framesInFlight, uint32_t maxChunkCount );
+	~IndirectChunkDraws();
+
+	IndirectChunkDraws( const IndirectChunkDraws& ) = delete;
+	IndirectChunkDraws& operator=( const IndirectChunkDraws& ) = delete;
+
+	static constexpr uint32_t CULL_PHASE_COUNT = 2;
+
+	// Writes the frame's chunks, the GPU must be done with the slot's previous frame. Returns how many fit (up to maxChunkCount).
+	uint32_t Upload( uint32_t frameSlot, const std::vector<ChunkDraw>& chunkDraws );
+
+	uint32_t GetFirstChunk( uint32_t frameSlot ) const { return frameSlot * m_maxChunkCount; } // in the chunk buffer
+	uint32_t GetFirstDrawCommand( uint32_t cullPhase ) const { return cullPhase * m_maxChunkCount; } // in the draw command buffer
+	uint32_t GetMaxChunkCount() const { return m_maxChunkCount; }
+	uint64_t GetDroppedChunkCount() const { return m_droppedChunkCount; } // since the start, chunks past maxChunkCount
+
+	uint32_t GetChunkDescriptorIndex() const { return m_chunks.descriptorIndex; }
+	VkBuffer GetDrawCommandBuffer() const { return m_drawCommands.buffer; }
+	uint32_t GetDrawCommandDescriptorIndex() const { return m_drawCommands.descriptorIndex; }
+	VkBuffer GetDrawCountBuffer() const { return m_drawCount.buffer; } // a uint per culling phase
+	uint32_t GetDrawCountDescriptorIndex() const { return m_drawCount.descriptorIndex; }
+	VkBuffer GetVisibilityBuffer() const { return m_visibility.buffer; }
+	uint32_t GetVisibilityDescriptorIndex() const { return m_visibility.descriptorIndex; }
+
+  private:
+	struct Buffer
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		GpuAllocation allocation;
+		uint32_t descriptorIndex = 0;
+	};
+
+	Buffer CreateBuffer( VkDeviceSize size, VkBufferUsageFlags usage, GpuMemoryUsage memoryUsage );
+	void DestroyBuffer( Buffer& buffer );
+
+	VkDevice m_device;
+	GpuMemoryAllocator& m_allocator;
+	BindlessDescriptorHeap& m_descriptorHeap;
+	uint32_t m_maxChunkCount;
+	uint64_t m_droppedChunkCount = 0;
+
+	Buffer m_chunks; // host visible, a region per frame slot
+	Buffer m_drawCommands;
+	Buffer m_drawCount;
+	Buffer m_visibility;
+};
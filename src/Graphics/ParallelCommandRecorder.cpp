@@ -0,0 +1,56 @@
+#include <Graphics/ParallelCommandRecorder.h>
+
+#include <stdexcept>
+
+#include <Jobs/JobSystem.h>
+
+ParallelCommandRecorder::ParallelCommandRecorder( VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight, JobSystem& jobSystem )
+  : m_jobSystem( jobSystem )
+{
+	for( uint32_t threadIndex = 0; threadIndex < jobSystem.GetThreadCount(); ++threadIndex )
+	{
+		m_threadPools.push_back( std::make_unique<FrameCommandPool>( device, queueFamilyIndex, framesInFlight ) );
+	}
+}
+
+void ParallelCommandRecorder::BeginFrame( uint32_t frameSlot )
+{
+	for( auto& threadPool : m_threadPools )
+	{
+		threadPool->BeginFrame( frameSlot );
+	}
+}
+
+const std::vector<VkCommandBuffer>& ParallelCommandRecorder::RecordSecondaries( uint32_t frameSlot,
+  const VkCommandBufferInheritanceInfo& inheritanceInfo,
+  uint32_t groupCount,
+  const RecordCallback& record )
+{
+	m_recordedCommandBuffers.assign( groupCount, VK_NULL_HANDLE );
+
+	// One group per job: groups are already batches of draws
+	m_jobSystem.ParallelFor( groupCount, 1, [&]( size_t groupIndex ) {
+		FrameCommandPool& threadPool = *m_threadPools[m_jobSystem.GetCurrentThreadIndex()];
+		VkCommandBuffer commandBuffer = threadPool.Acquire( frameSlot, VK_COMMAND_BUFFER_LEVEL_SECONDARY );
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if( vkBeginCommandBuffer( commandBuffer, &beginInfo ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to begin recording secondary command buffer!" );
+		}
+
+		record( commandBuffer, static_cast<uint32_t>( groupIndex ) );
+
+		if( vkEndCommandBuffer( commandBuffer ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to record secondary command buffer!" );
+		}
+		m_recordedCommandBuffers[groupIndex] = commandBuffer;
+	} );
+
+	return m_recordedCommandBuffers;
+}
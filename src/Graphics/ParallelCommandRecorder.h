@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <Graphics/FrameCommandPool.h>
+
+class JobSystem;
+
+//-----------------------
+// Records secondary command buffers on every job system thread at once.
+// Command pools can't be used by two threads at the same time, so every thread gets its own FrameCommandPool.
+// Secondaries run inside a render pass of the primary they're executed in (see RecordSecondaries' inheritance).
+
+class ParallelCommandRecorder
+{
+  public:
+	// commandBuffer is begun & ended around the callback, groupIndex picks the part of the work it records
+	using RecordCallback = std::function<void( VkCommandBuffer commandBuffer, uint32_t groupIndex )>;
+
+	ParallelCommandRecorder( VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight, JobSystem& jobSystem );
+
+	ParallelCommandRecorder( const ParallelCommandRecorder& ) = delete;
+	ParallelCommandRecorder& operator=( const ParallelCommandRecorder& ) = delete;
+
+	// The GPU must be done with the slot's previous frame
+	void BeginFrame( uint32_t frameSlot );
+
+	// Records groupCount secondaries in parallel, returned in group order. They're valid until the slot's next BeginFrame.
+	const std::vector<VkCommandBuffer>& RecordSecondaries( uint32_t frameSlot,
+	  const VkCommandBufferInheritanceInfo& inheritanceInfo,
+	  uint32_t groupCount,
+	  const RecordCallback& record );
+
+  private:
+	JobSystem& m_jobSystem;
+
+	std::vector<std::unique_ptr<FrameCommandPool>> m_threadPools; // per job system thread
+	std::vector<VkCommandBuffer> m_recordedCommandBuffers; // last RecordSecondaries' ones
+};
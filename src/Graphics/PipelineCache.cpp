@@ -0,0 +1,179 @@
+#include <Graphics/PipelineCache.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	const char Pipeline_Cache_File_Magic[8] = { 'A', 'S', 'T', 'R', 'O', 'P', 'C', '\0' };
+	constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+	struct PipelineCacheFileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t dataSize;
+		uint64_t dataHash;
+	};
+
+	// Start of the driver's cache data, as defined by the spec (VkPipelineCacheHeaderVersionOne)
+	struct VulkanPipelineCacheHeader
+	{
+		uint32_t headerSize;
+		uint32_t headerVersion;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	};
+
+	// FNV-1a, catches truncated & corrupt files before the driver gets to see them
+	uint64_t HashData( const char* data, size_t size )
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for( size_t i = 0; i < size; ++i )
+		{
+			hash = ( hash ^ static_cast<uint8_t>( data[i] ) ) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Returns the driver's cache data, empty if there's no file or it can't be trusted
+	std::vector<char> ReadCacheFile( const std::string& filePath )
+	{
+		std::ifstream file( filePath, std::ios::ate | std::ios::binary );
+		if( !file.is_open() )
+		{
+			return {};
+		}
+
+		const size_t fileSize = static_cast<size_t>( file.tellg() );
+		PipelineCacheFileHeader header{};
+		if( fileSize < sizeof( header ) )
+		{
+			std::cout << "Ignoring pipeline cache " << filePath << ": truncated\n";
+			return {};
+		}
+
+		file.seekg( 0 );
+		file.read( reinterpret_cast<char*>( &header ), sizeof( header ) );
+		if( memcmp( header.magic, Pipeline_Cache_File_Magic, sizeof( header.magic ) ) != 0 || header.version != PIPELINE_CACHE_FILE_VERSION )
+		{
+			std::cout << "Ignoring pipeline cache " << filePath << ": unknown format\n";
+			return {};
+		}
+
+		if( header.dataSize != fileSize - sizeof( header ) )
+		{
+			std::cout << "Ignoring pipeline cache " << filePath << ": truncated\n";
+			return {};
+		}
+
+		std::vector<char> cacheData( header.dataSize );
+		file.read( cacheData.data(), static_cast<std::streamsize>( cacheData.size() ) );
+		if( !file.good() || HashData( cacheData.data(), cacheData.size() ) != header.dataHash )
+		{
+			std::cout << "Ignoring pipeline cache " << filePath << ": corrupt\n";
+			return {};
+		}
+
+		return cacheData;
+	}
+} // namespace
+
+PipelineCache::PipelineCache( VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath )
+  : m_device( device )
+  , m_filePath( filePath )
+{
+	vkGetPhysicalDeviceProperties( physicalDevice, &m_deviceProperties );
+
+	std::vector<char> cacheData = ReadCacheFile( m_filePath );
+	if( !cacheData.empty() && !IsCompatible( cacheData ) )
+	{
+		std::cout << "Ignoring pipeline cache " << m_filePath << ": made by another device or driver\n";
+		cacheData.clear();
+	}
+
+	VkPipelineCacheCreateInfo pipelineCacheInfo{};
+	pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipelineCacheInfo.initialDataSize = cacheData.size();
+	pipelineCacheInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+	m_isLoadedFromDisk = !cacheData.empty() && vkCreatePipelineCache( m_device, &pipelineCacheInfo, nullptr, &m_pipelineCache ) == VK_SUCCESS;
+	if( m_isLoadedFromDisk )
+	{
+		return;
+	}
+
+	// Whatever went wrong with the file, an empty cache still works
+	pipelineCacheInfo.initialDataSize = 0;
+	pipelineCacheInfo.pInitialData = nullptr;
+	if( vkCreatePipelineCache( m_device, &pipelineCacheInfo, nullptr, &m_pipelineCache ) != VK_SUCCESS )
+	{
+		throw std::runtime_error( "failed to create pipeline cache!" );
+	}
+}
+
+PipelineCache::~PipelineCache()
+{
+	vkDestroyPipelineCache( m_device, m_pipelineCache, nullptr );
+}
+
+bool PipelineCache::IsCompatible( const std::vector<char>& cacheData ) const
+{
+	VulkanPipelineCacheHeader vulkanHeader{};
+	if( cacheData.size() < sizeof( vulkanHeader ) )
+	{
+		return false;
+	}
+
+	memcpy( &vulkanHeader, cacheData.data(), sizeof( vulkanHeader ) );
+	return vulkanHeader.headerSize >= sizeof( vulkanHeader )
+		&& vulkanHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& vulkanHeader.vendorID == m_deviceProperties.vendorID
+		&& vulkanHeader.deviceID == m_deviceProperties.deviceID
+		&& memcmp( vulkanHeader.pipelineCacheUUID, m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE ) == 0;
+}
+
+bool PipelineCache::Save() const
+{
+	size_t dataSize = 0;
+	if( vkGetPipelineCacheData( m_device, m_pipelineCache, &dataSize, nullptr ) != VK_SUCCESS )
+	{
+		return false;
+	}
+
+	std::vector<char> cacheData( dataSize );
+	if( vkGetPipelineCacheData( m_device, m_pipelineCache, &dataSize, cacheData.data() ) != VK_SUCCESS )
+	{
+		return false;
+	}
+	cacheData.resize( dataSize );
+
+	PipelineCacheFileHeader header{};
+	memcpy( header.magic, Pipeline_Cache_File_Magic, sizeof( header.magic ) );
+	header.version = PIPELINE_CACHE_FILE_VERSION;
+	header.dataSize = static_cast<uint32_t>( cacheData.size() );
+	header.dataHash = HashData( cacheData.data(), cacheData.size() );
+
+	// Written next to it then swapped in, a crash mid write can't leave a half written cache behind
+	const std::string temporaryFilePath = m_filePath + ".tmp";
+	{
+		std::ofstream file( temporaryFilePath, std::ios::binary | std::ios::trunc );
+		if( !file.is_open() )
+		{
+			return false;
+		}
+
+		file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		file.write( cacheData.data(), static_cast<std::streamsize>( cacheData.size() ) );
+		if( !file.good() )
+		{
+			return false;
+		}
+	}
+
+	return std::rename( temporaryFilePath.c_str(), m_filePath.c_str() ) == 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+//-----------------------
+// VkPipelineCache kept on disk between runs, so pipelines only get compiled from scratch on the first launch.
+// The file holds the driver's cache data behind our own header (size + hash): truncated or corrupt files,
+// or caches from another GPU / driver (checked against the Vulkan cache header), are ignored and we start cold.
+
+class PipelineCache
+{
+  public:
+	PipelineCache( VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath );
+	~PipelineCache();
+
+	PipelineCache( const PipelineCache& ) = delete;
+	PipelineCache& operator=( const PipelineCache& ) = delete;
+
+	VkPipelineCache GetHandle() const { return m_pipelineCache; }
+	// Warm start: pipelines should mostly come out of the cache
+	bool IsLoadedFromDisk() const { return m_isLoadedFromDisk; }
+
+	// Returns false if the cache couldn't be written, losing it isn't worth failing for
+	bool Save() const;
+
+  private:
+	bool IsCompatible( const std::vector<char>& cacheData ) const;
+
+	VkDevice m_device;
+	VkPhysicalDeviceProperties m_deviceProperties;
+	std::string m_filePath;
+	VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+	bool m_isLoadedFromDisk = false;
+};
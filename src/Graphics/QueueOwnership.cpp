@@ -0,0 +1,47 @@
+#include <Graphics/QueueOwnership.h>
+
+void BufferOwnershipTransfer::RecordRelease( VkCommandBuffer commandBuffer ) const
+{
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = sourceAccess;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	if( IsCrossFamily() )
+	{
+		// The destination side's access & stage are the acquire's business, they're ignored here
+		barrier.dstAccessMask = 0;
+		barrier.srcQueueFamilyIndex = sourceFamily;
+		barrier.dstQueueFamilyIndex = destinationFamily;
+		vkCmdPipelineBarrier( commandBuffer, sourceStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+	}
+	else
+	{
+		barrier.dstAccessMask = destinationAccess;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		vkCmdPipelineBarrier( commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+	}
+}
+
+void BufferOwnershipTransfer::RecordAcquire( VkCommandBuffer commandBuffer ) const
+{
+	if( !IsCrossFamily() )
+	{
+		return;
+	}
+
+	// Must match the release, the source side's access is already covered by it
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = destinationAccess;
+	barrier.srcQueueFamilyIndex = sourceFamily;
+	barrier.dstQueueFamilyIndex = destinationFamily;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+	vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, destinationStage, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//-----------------------
+// Hands an exclusive buffer range from one queue family to another, eg: from the async compute queue writing it
+// to the graphics queue reading it. The release gets recorded on the source queue, the acquire on the destination one,
+// and the destination's submit has to wait on the source's (see FrameScheduler::WaitForQueue) for the two to pair up.
+// When both queues are of the same family there's nothing to hand over: the release is a regular barrier and the acquire records nothing.
+
+struct BufferOwnershipTransfer
+{
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	uint32_t sourceFamily;
+	uint32_t destinationFamily;
+	VkPipelineStageFlags sourceStage; // how the source queue last wrote it
+	VkAccessFlags sourceAccess;
+	VkPipelineStageFlags destinationStage; // how the destination queue uses it first
+	VkAccessFlags destinationAccess;
+
+	bool IsCrossFamily() const { return sourceFamily != destinationFamily; }
+
+	void RecordRelease( VkCommandBuffer commandBuffer ) const;
+	void RecordAcquire( VkCommandBuffer commandBuffer ) const;
+};
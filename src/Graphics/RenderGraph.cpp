@@ -0,0 +1,605 @@
+#include <Graphics/RenderGraph.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include <Profiling/GpuProfiler.h>
+
+namespace
+{
+	constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT
+												| VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+												| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+												| VK_ACCESS_TRANSFER_WRITE_BIT
+												| VK_ACCESS_HOST_WRITE_BIT
+												| VK_ACCESS_MEMORY_WRITE_BIT;
+
+	VkDeviceSize AlignUp( VkDeviceSize value, VkDeviceSize alignment )
+	{
+		return ( value + alignment - 1 ) / alignment * alignment;
+	}
+} // namespace
+
+RenderGraph::RenderGraph( VkDevice device, GpuMemoryAllocator& allocator )
+  : m_device( device )
+  , m_allocator( allocator )
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	for( ResourceInfo& resource : m_resources )
+	{
+		if( !resource.isTransient )
+		{
+			continue;
+		}
+
+		vkDestroyImageView( m_device, resource.imageView, nullptr );
+		for( VkImage image : resource.images )
+		{
+			vkDestroyImage( m_device, image, nullptr );
+		}
+		for( VkBuffer buffer : resource.buffers )
+		{
+			vkDestroyBuffer( m_device, buffer, nullptr );
+		}
+	}
+
+	for( TransientHeap& heap : m_heaps )
+	{
+		m_allocator.Free( heap.allocation );
+	}
+}
+
+RenderGraph::Resource RenderGraph::ImportBuffers( const char* name, const std::vector<VkBuffer>& buffers, std::optional<RenderGraphUsage> finalUsage )
+{
+	ResourceInfo resource{};
+	resource.name = name;
+	resource.buffers = buffers;
+	resource.finalUsage = finalUsage;
+	return AddResource( std::move( resource ) );
+}
+
+RenderGraph::Resource RenderGraph::ImportImages( const char* name,
+  const std::vector<VkImage>& images,
+  VkImageAspectFlags aspect,
+  bool discardContents,
+  std::optional<RenderGraphUsage> finalUsage )
+{
+	ResourceInfo resource{};
+	resource.name = name;
+	resource.isImage = true;
+	resource.images = images;
+	resource.aspect = aspect;
+	resource.discardContents = discardContents;
+	resource.finalUsage = finalUsage;
+	return AddResource( std::move( resource ) );
+}
+
+RenderGraph::Resource RenderGraph::CreateTransientBuffer( const char* name, VkDeviceSize size, VkBufferUsageFlags usage )
+{
+	ResourceInfo resource{};
+	resource.name = name;
+	resource.isTransient = true;
+	resource.discardContents = true;
+	resource.bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	resource.bufferInfo.size = size;
+	resource.bufferInfo.usage = usage;
+	resource.bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	return AddResource( std::move( resource ) );
+}
+
+RenderGraph::Resource RenderGraph::CreateTransientImage( const char* name,
+  VkFormat format,
+  VkExtent2D extent,
+  VkImageUsageFlags usage,
+  VkImageAspectFlags aspect,
+  uint32_t mipLevels )
+{
+	ResourceInfo resource{};
+	resource.name = name;
+	resource.isImage = true;
+	resource.isTransient = true;
+	resource.discardContents = true;
+	resource.aspect = aspect;
+	resource.imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	resource.imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	resource.imageInfo.format = format;
+	resource.imageInfo.extent = { extent.width, extent.height, 1 };
+	resource.imageInfo.mipLevels = mipLevels;
+	resource.imageInfo.arrayLayers = 1;
+	resource.imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	resource.imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	resource.imageInfo.usage = usage;
+	resource.imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	resource.imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	return AddResource( std::move( resource ) );
+}
+
+RenderGraph::Resource RenderGraph::AddResource( ResourceInfo resource )
+{
+	if( m_isCompiled )
+	{
+		throw std::runtime_error( "can't add resources to a compiled render graph!" );
+	}
+
+	m_resources.push_back( std::move( resource ) );
+	return static_cast<Resource>( m_resources.size() - 1 );
+}
+
+void RenderGraph::AddPass( const char* name, std::initializer_list<Access> accesses, ExecuteCallback execute )
+{
+	if( m_isCompiled )
+	{
+		throw std::runtime_error( "can't add passes to a compiled render graph!" );
+	}
+
+	Pass pass{ name, {}, std::move( execute ) };
+	for( const Access& access : accesses )
+	{
+		if( access.resource >= m_resources.size() )
+		{
+			throw std::runtime_error( std::string( "unknown resource used by render graph pass " ) + name + "!" );
+		}
+
+		const ResourceUse use = GetResourceUse( access.resource, access.usage );
+		auto sameResource = std::find_if( pass.uses.begin(), pass.uses.end(), [&]( const ResourceUse& passUse ) { return passUse.resource == use.resource; } );
+		if( sameResource == pass.uses.end() )
+		{
+			pass.uses.push_back( use );
+			continue;
+		}
+
+		// A barrier can't go between two uses in one pass, they have to get along as they are
+		if( m_resources[use.resource].isImage && sameResource->layout != use.layout )
+		{
+			throw std::runtime_error( std::string( "render graph pass " ) + name + " uses an image in two layouts!" );
+		}
+		sameResource->stages |= use.stages;
+		sameResource->access |= use.access;
+		sameResource->isWrite |= use.isWrite;
+	}
+
+	m_passes.push_back( std::move( pass ) );
+}
+
+RenderGraph::ResourceUse RenderGraph::GetResourceUse( Resource resource, RenderGraphUsage usage )
+{
+	switch( usage )
+	{
+	case RenderGraphUsage::ComputeRead:
+		return { resource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+	case RenderGraphUsage::ComputeWrite:
+		return { resource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+	case RenderGraphUsage::ComputeSampled:
+		return { resource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+	case RenderGraphUsage::VertexShaderRead:
+		return { resource, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+	case RenderGraphUsage::FragmentSampled:
+		return { resource, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+	case RenderGraphUsage::VertexBuffer:
+		return { resource, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+	case RenderGraphUsage::IndexBuffer:
+		return { resource, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+	case RenderGraphUsage::IndirectBuffer:
+		return { resource, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+	case RenderGraphUsage::TransferRead:
+		return { resource, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+	case RenderGraphUsage::TransferWrite:
+		return { resource, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+	case RenderGraphUsage::ColorAttachment:
+		return { resource,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			true };
+	case RenderGraphUsage::DepthAttachment:
+		return { resource,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			true };
+	case RenderGraphUsage::HostRead:
+		return { resource, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+	case RenderGraphUsage::Present:
+		// Same stage as the acquire semaphore wait, so next frame's first barrier chains with it
+		return { resource, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false };
+	}
+
+	throw std::runtime_error( "unknown render graph usage!" );
+}
+
+void RenderGraph::Compile()
+{
+	if( m_isCompiled )
+	{
+		throw std::runtime_error( "render graph is already compiled!" );
+	}
+
+	for( uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex )
+	{
+		for( const ResourceUse& use : m_passes[passIndex].uses )
+		{
+			ResourceInfo& resource = m_resources[use.resource];
+			resource.firstPass = std::min( resource.firstPass, passIndex );
+			resource.lastPass = std::max( resource.lastPass, passIndex );
+		}
+	}
+
+	CreateTransients();
+	PlaceTransients();
+
+	// Executions follow each other: a dry run gives the states the previous one leaves behind
+	std::vector<ResourceState> endStates( m_resources.size() );
+	SimulateExecution( endStates, nullptr, nullptr );
+
+	std::vector<ResourceState> states = endStates;
+	for( Resource resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex )
+	{
+		const ResourceInfo& resource = m_resources[resourceIndex];
+		ResourceState& state = states[resourceIndex];
+		if( resource.discardContents )
+		{
+			state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+		if( !resource.isTransient )
+		{
+			continue;
+		}
+
+		// Whatever shares the memory has to be done with it first, in this execution or the previous one
+		for( Resource otherIndex = 0; otherIndex < m_resources.size(); ++otherIndex )
+		{
+			if( otherIndex != resourceIndex && AreAliased( resource, m_resources[otherIndex] ) )
+			{
+				const ResourceState& otherState = endStates[otherIndex];
+				state.writeStages |= otherState.writeStages | otherState.readStages | otherState.visibleStages;
+				state.writeAccess |= otherState.writeAccess;
+			}
+		}
+	}
+
+	m_passBarriers.assign( m_passes.size(), BarrierBatch{} );
+	m_finalBarriers = BarrierBatch{};
+	SimulateExecution( states, &m_passBarriers, &m_finalBarriers );
+
+	m_isCompiled = true;
+}
+
+void RenderGraph::CreateTransients()
+{
+	for( ResourceInfo& resource : m_resources )
+	{
+		if( !resource.isTransient )
+		{
+			continue;
+		}
+		if( resource.firstPass == UINT32_MAX )
+		{
+			throw std::runtime_error( std::string( "render graph transient " ) + resource.name + " is never used!" );
+		}
+
+		if( resource.isImage )
+		{
+			VkImage image;
+			if( vkCreateImage( m_device, &resource.imageInfo, nullptr, &image ) != VK_SUCCESS )
+			{
+				throw std::runtime_error( "failed to create render graph transient image!" );
+			}
+			resource.images.push_back( image );
+			vkGetImageMemoryRequirements( m_device, image, &resource.memoryRequirements );
+		}
+		else
+		{
+			VkBuffer buffer;
+			if( vkCreateBuffer( m_device, &resource.bufferInfo, nullptr, &buffer ) != VK_SUCCESS )
+			{
+				throw std::runtime_error( "failed to create render graph transient buffer!" );
+			}
+			resource.buffers.push_back( buffer );
+			vkGetBufferMemoryRequirements( m_device, buffer, &resource.memoryRequirements );
+		}
+	}
+}
+
+void RenderGraph::PlaceTransients()
+{
+	std::vector<Resource> transients;
+	for( Resource resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex )
+	{
+		if( m_resources[resourceIndex].isTransient )
+		{
+			transients.push_back( resourceIndex );
+		}
+	}
+
+	// Biggest first, the small ones fill the gaps around them
+	std::sort( transients.begin(), transients.end(), [&]( Resource first, Resource second ) {
+		return m_resources[first].memoryRequirements.size > m_resources[second].memoryRequirements.size;
+	} );
+
+	std::vector<Resource> placed;
+	for( Resource resourceIndex : transients )
+	{
+		ResourceInfo& resource = m_resources[resourceIndex];
+		const VkMemoryRequirements& requirements = resource.memoryRequirements;
+		m_unaliasedTransientMemorySize += AlignUp( requirements.size, requirements.alignment );
+
+		auto heap = std::find_if( m_heaps.begin(), m_heaps.end(), [&]( const TransientHeap& transientHeap ) {
+			return transientHeap.isImage == resource.isImage && transientHeap.memoryTypeBits == requirements.memoryTypeBits;
+		} );
+		if( heap == m_heaps.end() )
+		{
+			m_heaps.push_back( TransientHeap{ resource.isImage, requirements.memoryTypeBits } );
+			heap = m_heaps.end() - 1;
+		}
+		resource.heapIndex = static_cast<uint32_t>( heap - m_heaps.begin() );
+
+		// Lowest offset clear of everything alive at the same time: the heap start or right after one of those
+		std::vector<Resource> neighbours;
+		std::vector<VkDeviceSize> candidateOffsets{ 0 };
+		for( Resource placedIndex : placed )
+		{
+			const ResourceInfo& placedResource = m_resources[placedIndex];
+			const bool livesAlongside = placedResource.firstPass <= resource.lastPass && resource.firstPass <= placedResource.lastPass;
+			if( placedResource.heapIndex == resource.heapIndex && livesAlongside )
+			{
+				neighbours.push_back( placedIndex );
+				candidateOffsets.push_back( AlignUp( placedResource.heapOffset + placedResource.memoryRequirements.size, requirements.alignment ) );
+			}
+		}
+		std::sort( candidateOffsets.begin(), candidateOffsets.end() );
+
+		for( VkDeviceSize offset : candidateOffsets )
+		{
+			const bool isFree = std::none_of( neighbours.begin(), neighbours.end(), [&]( Resource neighbourIndex ) {
+				const ResourceInfo& neighbour = m_resources[neighbourIndex];
+				return offset < neighbour.heapOffset + neighbour.memoryRequirements.size && neighbour.heapOffset < offset + requirements.size;
+			} );
+			if( isFree )
+			{
+				resource.heapOffset = offset;
+				break;
+			}
+		}
+
+		heap->size = std::max( heap->size, resource.heapOffset + requirements.size );
+		heap->alignment = std::max( heap->alignment, requirements.alignment );
+		placed.push_back( resourceIndex );
+	}
+
+	for( TransientHeap& heap : m_heaps )
+	{
+		const VkMemoryRequirements heapRequirements{ heap.size, heap.alignment, heap.memoryTypeBits };
+		heap.allocation = m_allocator.Allocate( heapRequirements, GpuMemoryUsage::GpuOnly, heap.isImage );
+		m_transientMemorySize += heap.size;
+	}
+
+	for( Resource resourceIndex : transients )
+	{
+		ResourceInfo& resource = m_resources[resourceIndex];
+		const GpuAllocation& allocation = m_heaps[resource.heapIndex].allocation;
+		const VkDeviceSize offset = allocation.offset + resource.heapOffset;
+
+		if( !resource.isImage )
+		{
+			if( vkBindBufferMemory( m_device, resource.buffers[0], allocation.memory, offset ) != VK_SUCCESS )
+			{
+				throw std::runtime_error( "failed to bind render graph transient buffer memory!" );
+			}
+			continue;
+		}
+
+		if( vkBindImageMemory( m_device, resource.images[0], allocation.memory, offset ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to bind render graph transient image memory!" );
+		}
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = resource.images[0];
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = resource.imageInfo.format;
+		viewInfo.subresourceRange.aspectMask = resource.aspect;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = resource.imageInfo.mipLevels;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+		if( vkCreateImageView( m_device, &viewInfo, nullptr, &resource.imageView ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create render graph transient image view!" );
+		}
+	}
+}
+
+bool RenderGraph::AreAliased( const ResourceInfo& first, const ResourceInfo& second ) const
+{
+	return first.isTransient && second.isTransient
+		   && first.heapIndex == second.heapIndex
+		   && first.heapOffset < second.heapOffset + second.memoryRequirements.size
+		   && second.heapOffset < first.heapOffset + first.memoryRequirements.size;
+}
+
+void RenderGraph::SimulateExecution( std::vector<ResourceState>& states, std::vector<BarrierBatch>* passBatches, BarrierBatch* finalBatch ) const
+{
+	for( uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex )
+	{
+		BarrierBatch* batch = passBatches ? &( *passBatches )[passIndex] : nullptr;
+		for( const ResourceUse& use : m_passes[passIndex].uses )
+		{
+			AddUse( use, states[use.resource], batch );
+		}
+	}
+
+	for( Resource resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex )
+	{
+		const ResourceInfo& resource = m_resources[resourceIndex];
+		if( resource.finalUsage.has_value() )
+		{
+			AddUse( GetResourceUse( resourceIndex, *resource.finalUsage ), states[resourceIndex], finalBatch );
+		}
+	}
+}
+
+void RenderGraph::AddUse( const ResourceUse& use, ResourceState& state, BarrierBatch* batch ) const
+{
+	const bool isImage = m_resources[use.resource].isImage;
+	const VkImageLayout oldLayout = state.layout;
+	const VkImageLayout newLayout = isImage ? use.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+	const bool needsTransition = isImage && newLayout != oldLayout;
+	// What the barrier makes available is the last write, whoever read it since only needs an execution dependency
+	const VkAccessFlags srcAccess = state.writeAccess;
+
+	VkPipelineStageFlags srcStages = 0;
+	bool needsBarrier = false;
+	if( use.isWrite || needsTransition )
+	{
+		// After writes (WAW) & reads (WAR), a transition being a write too
+		srcStages = state.writeStages | state.readStages | state.visibleStages;
+		needsBarrier = srcStages != 0 || needsTransition;
+
+		if( use.isWrite )
+		{
+			state = ResourceState{};
+			state.writeStages = use.stages;
+			state.writeAccess = use.access & WRITE_ACCESS_MASK;
+		}
+		else
+		{
+			state.readStages = use.stages;
+			state.visibleStages = use.stages;
+			state.visibleAccess = use.access;
+		}
+		state.layout = newLayout;
+	}
+	else
+	{
+		// RAW: only needs a barrier if the last write (or transition) isn't visible to this stage & access yet
+		const bool isVisible = ( use.stages & ~state.visibleStages ) == 0 && ( use.access & ~state.visibleAccess ) == 0;
+		srcStages = state.writeStages | state.visibleStages;
+		needsBarrier = srcStages != 0 && !isVisible;
+
+		if( needsBarrier )
+		{
+			state.visibleStages |= use.stages;
+			state.visibleAccess |= use.access;
+		}
+		state.readStages |= use.stages;
+	}
+
+	if( !needsBarrier || batch == nullptr )
+	{
+		return;
+	}
+
+	batch->srcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	batch->dstStages |= use.stages;
+	batch->barriers.push_back( Barrier{ use.resource, srcAccess, use.access, oldLayout, newLayout } );
+}
+
+void RenderGraph::Execute( VkCommandBuffer commandBuffer, uint32_t slot, GpuProfiler* gpuProfiler, std::optional<uint32_t> profilerSlot ) const
+{
+	if( !m_isCompiled )
+	{
+		throw std::runtime_error( "render graph must be compiled before executing it!" );
+	}
+	const uint32_t gpuProfilerSlot = profilerSlot.value_or( slot );
+
+	for( uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex )
+	{
+		const Pass& pass = m_passes[passIndex];
+		RecordBatch( commandBuffer, m_passBarriers[passIndex], slot );
+
+		if( gpuProfiler )
+		{
+			gpuProfiler->BeginScope( commandBuffer, gpuProfilerSlot, pass.name, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT );
+		}
+		pass.execute( commandBuffer, slot );
+		if( gpuProfiler )
+		{
+			gpuProfiler->EndScope( commandBuffer, gpuProfilerSlot, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT );
+		}
+	}
+
+	RecordBatch( commandBuffer, m_finalBarriers, slot );
+}
+
+void RenderGraph::RecordBatch( VkCommandBuffer commandBuffer, const BarrierBatch& batch, uint32_t slot ) const
+{
+	if( batch.barriers.empty() )
+	{
+		return;
+	}
+
+	m_bufferBarriers.clear();
+	m_imageBarriers.clear();
+	for( const Barrier& barrier : batch.barriers )
+	{
+		const ResourceInfo& resource = m_resources[barrier.resource];
+		if( resource.isImage )
+		{
+			VkImageMemoryBarrier imageBarrier{};
+			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask = barrier.srcAccess;
+			imageBarrier.dstAccessMask = barrier.dstAccess;
+			imageBarrier.oldLayout = barrier.oldLayout;
+			imageBarrier.newLayout = barrier.newLayout;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image = GetImage( barrier.resource, slot );
+			imageBarrier.subresourceRange = { resource.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+			m_imageBarriers.push_back( imageBarrier );
+		}
+		else
+		{
+			VkBufferMemoryBarrier bufferBarrier{};
+			bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			bufferBarrier.srcAccessMask = barrier.srcAccess;
+			bufferBarrier.dstAccessMask = barrier.dstAccess;
+			bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferBarrier.buffer = GetBuffer( barrier.resource, slot );
+			bufferBarrier.offset = 0;
+			bufferBarrier.size = VK_WHOLE_SIZE;
+			m_bufferBarriers.push_back( bufferBarrier );
+		}
+	}
+
+	vkCmdPipelineBarrier( commandBuffer,
+	  batch.srcStages,
+	  batch.dstStages,
+	  0,
+	  0,
+	  nullptr,
+	  static_cast<uint32_t>( m_bufferBarriers.size() ),
+	  m_bufferBarriers.data(),
+	  static_cast<uint32_t>( m_imageBarriers.size() ),
+	  m_imageBarriers.data() );
+}
+
+VkBuffer RenderGraph::GetBuffer( Resource resource, uint32_t slot ) const
+{
+	const std::vector<VkBuffer>& buffers = m_resources[resource].buffers;
+	return buffers[slot % buffers.size()];
+}
+
+VkImage RenderGraph::GetImage( Resource resource, uint32_t slot ) const
+{
+	const std::vector<VkImage>& images = m_resources[resource].images;
+	return images[slot % images.size()];
+}
+
+VkImageView RenderGraph::GetImageView( Resource resource ) const
+{
+	return m_resources[resource].imageView;
+}
+
+uint32_t RenderGraph::GetBarrierCount() const
+{
+	return std::accumulate( m_passBarriers.begin(), m_passBarriers.end(), static_cast<uint32_t>( m_finalBarriers.barriers.size() ), []( uint32_t count, const BarrierBatch& batch ) {
+		return count + static_cast<uint32_t>( batch.barriers.size() );
+	} );
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+#include <Graphics/GpuMemoryAllocator.h>
+
+class GpuProfiler;
+
+// How a pass uses a resource, sets the stage, access & image layout the graph syncs it with
+enum class RenderGraphUsage
+{
+	ComputeRead, // storage buffer / image, GENERAL layout
+	ComputeWrite, // storage buffer / image, GENERAL layout
+	ComputeSampled,
+	VertexShaderRead, // storage buffer
+	FragmentSampled,
+	VertexBuffer,
+	IndexBuffer,
+	IndirectBuffer,
+	TransferRead,
+	TransferWrite,
+	ColorAttachment,
+	DepthAttachment,
+	HostRead, // mapped memory read back by the CPU once the work is done
+	Present
+};
+
+//-----------------------
+// Records a queue's passes into a command buffer with the barriers in between worked out for it.
+// Passes declare the resources they read & write, compiling the graph turns that into the minimal set of pipeline barriers
+// & image layout transitions, batched into one vkCmdPipelineBarrier ahead of each pass that needs any.
+// The graph is compiled once and executed into every command buffer recorded with it: executions are assumed to follow
+// each other on one queue, so the first uses also sync with the previous execution's last ones.
+// Transient resources belong to the graph: their contents only live through one execution, and ones that are never alive
+// at the same time share memory.
+// Imported resources live outside the graph, with one handle per slot (eg: per swapchain image) or the same one for all.
+
+class RenderGraph
+{
+  public:
+	using Resource = uint32_t;
+	// slot is the one given to Execute, for passes picking per slot objects (framebuffers...)
+	using ExecuteCallback = std::function<void( VkCommandBuffer commandBuffer, uint32_t slot )>;
+
+	struct Access
+	{
+		Resource resource;
+		RenderGraphUsage usage;
+	};
+
+	RenderGraph( VkDevice device, GpuMemoryAllocator& allocator );
+	~RenderGraph();
+
+	RenderGraph( const RenderGraph& ) = delete;
+	RenderGraph& operator=( const RenderGraph& ) = delete;
+
+	// finalUsage: transitions the resource at the end of every execution (eg: Present), left as the last pass used it otherwise
+	Resource ImportBuffers( const char* name, const std::vector<VkBuffer>& buffers, std::optional<RenderGraphUsage> finalUsage = std::nullopt );
+	// discardContents: every execution starts from an UNDEFINED layout (eg: swapchain images, overwritten each frame)
+	Resource ImportImages( const char* name,
+	  const std::vector<VkImage>& images,
+	  VkImageAspectFlags aspect,
+	  bool discardContents,
+	  std::optional<RenderGraphUsage> finalUsage = std::nullopt );
+
+	// Created & placed in memory by Compile
+	Resource CreateTransientBuffer( const char* name, VkDeviceSize size, VkBufferUsageFlags usage );
+	Resource CreateTransientImage( const char* name,
+	  VkFormat format,
+	  VkExtent2D extent,
+	  VkImageUsageFlags usage,
+	  VkImageAspectFlags aspect,
+	  uint32_t mipLevels = 1 );
+
+	// Passes run in the order they're added. A pass can use a resource more than once (eg: read & write), in one image layout.
+	// name must outlive the graph (string literal), it names the pass' GPU profiler scope.
+	void AddPass( const char* name, std::initializer_list<Access> accesses, ExecuteCallback execute );
+
+	// Works out the barriers, creates the transient resources & their memory. Passes & resources can't be added afterwards.
+	void Compile();
+	// Records every pass & barrier, timing each pass in the profiler when there's one.
+	// profilerSlot defaults to slot, commands recorded per frame in flight use images picked per swapchain image.
+	void Execute( VkCommandBuffer commandBuffer, uint32_t slot, GpuProfiler* gpuProfiler = nullptr, std::optional<uint32_t> profilerSlot = std::nullopt ) const;
+
+	VkBuffer GetBuffer( Resource resource, uint32_t slot = 0 ) const;
+	VkImage GetImage( Resource resource, uint32_t slot = 0 ) const;
+	VkImageView GetImageView( Resource resource ) const; // transient images only, whole image view
+
+	uint32_t GetBarrierCount() const; // per execution
+	VkDeviceSize GetTransientMemorySize() const { return m_transientMemorySize; }
+	VkDeviceSize GetUnaliasedTransientMemorySize() const { return m_unaliasedTransientMemorySize; }
+
+  private:
+	struct ResourceInfo
+	{
+		const char* name;
+		bool isImage = false;
+		bool isTransient = false;
+		bool discardContents = false;
+		std::optional<RenderGraphUsage> finalUsage;
+
+		std::vector<VkBuffer> buffers; // one per slot, or one for all
+		std::vector<VkImage> images;
+		VkImageAspectFlags aspect = 0;
+
+		// Transients only
+		VkBufferCreateInfo bufferInfo{};
+		VkImageCreateInfo imageInfo{};
+		VkImageView imageView = VK_NULL_HANDLE;
+		VkMemoryRequirements memoryRequirements{};
+		uint32_t heapIndex = 0;
+		VkDeviceSize heapOffset = 0;
+		uint32_t firstPass = UINT32_MAX;
+		uint32_t lastPass = 0;
+	};
+
+	// An access as the GPU sees it, a pass' accesses to the same resource merged in one
+	struct ResourceUse
+	{
+		Resource resource;
+		VkPipelineStageFlags stages;
+		VkAccessFlags access;
+		VkImageLayout layout;
+		bool isWrite;
+	};
+
+	struct Pass
+	{
+		const char* name;
+		std::vector<ResourceUse> uses;
+		ExecuteCallback execute;
+	};
+
+	// What has touched a resource since it was last written, what the next barrier on it has to wait for
+	struct ResourceState
+	{
+		VkPipelineStageFlags writeStages = 0;
+		VkAccessFlags writeAccess = 0;
+		VkPipelineStageFlags readStages = 0; // since the last write
+		VkPipelineStageFlags visibleStages = 0; // that already waited on the last write
+		VkAccessFlags visibleAccess = 0;
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	};
+
+	struct Barrier
+	{
+		Resource resource;
+		VkAccessFlags srcAccess;
+		VkAccessFlags dstAccess;
+		VkImageLayout oldLayout;
+		VkImageLayout newLayout;
+	};
+
+	struct BarrierBatch
+	{
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+		std::vector<Barrier> barriers;
+	};
+
+	// Transients sharing a VkDeviceMemory allocation (same resource kind & memory types)
+	struct TransientHeap
+	{
+		bool isImage;
+		uint32_t memoryTypeBits;
+		VkDeviceSize size = 0;
+		VkDeviceSize alignment = 1;
+		GpuAllocation allocation;
+	};
+
+	Resource AddResource( ResourceInfo resource );
+	void CreateTransients();
+	void PlaceTransients();
+	bool AreAliased( const ResourceInfo& first, const ResourceInfo& second ) const;
+	// Runs the accesses through the states, filling the barrier batches when there are any
+	void SimulateExecution( std::vector<ResourceState>& states, std::vector<BarrierBatch>* passBatches, BarrierBatch* finalBatch ) const;
+	static ResourceUse GetResourceUse( Resource resource, RenderGraphUsage usage );
+	void AddUse( const ResourceUse& use, ResourceState& state, BarrierBatch* batch ) const;
+	void RecordBatch( VkCommandBuffer commandBuffer, const BarrierBatch& batch, uint32_t slot ) const;
+
+	VkDevice m_device;
+	GpuMemoryAllocator& m_allocator;
+	bool m_isCompiled = false;
+
+	std::vector<ResourceInfo> m_resources;
+	std::vector<Pass> m_passes;
+	std::vector<TransientHeap> m_heaps;
+	VkDeviceSize m_transientMemorySize = 0;
+	VkDeviceSize m_unaliasedTransientMemorySize = 0;
+
+	std::vector<BarrierBatch> m_passBarriers; // ahead of each pass
+	BarrierBatch m_finalBarriers; // final usages
+
+	// Kept around to avoid reallocating every execution
+	mutable std::vector<VkBufferMemoryBarrier> m_bufferBarriers;
+	mutable std::vector<VkImageMemoryBarrier> m_imageBarriers;
+};
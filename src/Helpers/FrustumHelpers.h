@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+namespace FrustumHelpers
+{
+	// Left, right, bottom, top, near & far planes of a Vulkan (0 to 1 depth) view projection matrix, normals pointing inside:
+	// a point is on the inside of a plane when dot( plane.xyz, point ) + plane.w >= 0
+	inline std::array<glm::vec4, 6> ExtractPlanes( const glm::mat4& viewProjection )
+	{
+		const glm::mat4 rows = glm::transpose( viewProjection );
+		std::array<glm::vec4, 6> planes = {
+			rows[3] + rows[0],
+			rows[3] - rows[0],
+			rows[3] + rows[1],
+			rows[3] - rows[1],
+			rows[2],
+			rows[3] - rows[2]
+		};
+
+		// Normalized, so distances to them are in world units
+		for( glm::vec4& plane : planes )
+		{
+			plane /= glm::length( glm::vec3( plane ) );
+		}
+		return planes;
+	}
+
+	// Conservative: a box entirely outside the frustum near one of its edges can still pass. Same test as ChunkCull.comp.
+	inline bool IsBoxVisible( const std::array<glm::vec4, 6>& planes, const glm::vec3& boxMin, const glm::vec3& boxMax )
+	{
+		for( const glm::vec4& plane : planes )
+		{
+			// The box corner furthest along the plane's normal
+			const glm::vec3 corner( plane.x >= 0.0f ? boxMax.x : boxMin.x, plane.y >= 0.0f ? boxMax.y : boxMin.y, plane.z >= 0.0f ? boxMax.z : boxMin.z );
+			if( glm::dot( glm::vec3( plane ), corner ) + plane.w < 0.0f )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace FrustumHelpers
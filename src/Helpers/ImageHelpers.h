@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ImageHelpers
+{
+	// Writes 8 bit RGBA pixels (alpha dropped) as a binary PPM, rowPitch is the byte size of a source row
+	inline void WritePpm( const std::string& filePath, uint32_t width, uint32_t height, const uint8_t* rgbaPixels, size_t rowPitch )
+	{
+		std::ofstream file( filePath, std::ios::binary );
+		if( !file.is_open() )
+		{
+			throw std::runtime_error( "failed to open image file for writing!" );
+		}
+
+		file << "P6\n" << width << " " << height << "\n255\n";
+
+		std::vector<uint8_t> rgbRow( static_cast<size_t>( width ) * 3 );
+		for( uint32_t y = 0; y < height; ++y )
+		{
+			const uint8_t* sourceRow = rgbaPixels + y * rowPitch;
+			for( uint32_t x = 0; x < width; ++x )
+			{
+				rgbRow[x * 3 + 0] = sourceRow[x * 4 + 0];
+				rgbRow[x * 3 + 1] = sourceRow[x * 4 + 1];
+				rgbRow[x * 3 + 2] = sourceRow[x * 4 + 2];
+			}
+			file.write( reinterpret_cast<const char*>( rgbRow.data() ), rgbRow.size() );
+		}
+
+		if( !file )
+		{
+			throw std::runtime_error( "failed to write image file!" );
+		}
+	}
+} // namespace ImageHelpers
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------------------
+// Read only memory mapping of a whole file, pages are only read from disk once touched
+
+class MappedFile
+{
+  public:
+	MappedFile() = default;
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	~MappedFile()
+	{
+		Close();
+	}
+
+	// Returns false if the file doesn't exist, throws if it exists but can't be mapped
+	bool Open( const std::string& filePath )
+	{
+		Close();
+
+		const int fileDescriptor = open( filePath.c_str(), O_RDONLY );
+		if( fileDescriptor < 0 )
+		{
+			return false;
+		}
+
+		struct stat fileStats;
+		if( fstat( fileDescriptor, &fileStats ) != 0 )
+		{
+			close( fileDescriptor );
+			throw std::runtime_error( "failed to stat file to map!" );
+		}
+
+		m_size = static_cast<size_t>( fileStats.st_size );
+		if( m_size > 0 )
+		{
+			void* mapping = mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+			if( mapping == MAP_FAILED )
+			{
+				close( fileDescriptor );
+				m_size = 0;
+				throw std::runtime_error( "failed to memory map file!" );
+			}
+
+			// Chunks are touched in whatever order the viewer streams them, read ahead would mostly load data we don't need
+			madvise( mapping, m_size, MADV_RANDOM );
+			m_data = static_cast<const uint8_t*>( mapping );
+		}
+
+		// The mapping keeps its own reference to the file
+		close( fileDescriptor );
+		return true;
+	}
+
+	void Close()
+	{
+		if( m_data != nullptr )
+		{
+			munmap( const_cast<uint8_t*>( m_data ), m_size );
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	const uint8_t* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+  private:
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+};
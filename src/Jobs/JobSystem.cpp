@@ -0,0 +1,240 @@
+#include <Jobs/JobSystem.h>
+
+namespace
+{
+	// Which job system (if any) owns the current thread, and its queue in there
+	thread_local const JobSystem* t_jobSystem = nullptr;
+	thread_local uint32_t t_queueIndex = 0;
+} // namespace
+
+JobSystem::JobSystem( uint32_t workerThreadCount )
+  : m_queues{}
+  , m_workerThreads{}
+{
+	for( uint32_t i = 0; i <= workerThreadCount; ++i )
+	{
+		m_queues.push_back( std::make_unique<WorkerQueue>() );
+	}
+
+	t_jobSystem = this;
+	t_queueIndex = 0;
+
+	for( uint32_t i = 1; i <= workerThreadCount; ++i )
+	{
+		m_workerThreads.emplace_back( &JobSystem::WorkerLoop, this, i );
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_sleepMutex );
+		m_isShuttingDown = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for( auto& workerThread : m_workerThreads )
+	{
+		workerThread.join();
+	}
+
+	if( t_jobSystem == this )
+	{
+		t_jobSystem = nullptr;
+	}
+}
+
+uint32_t JobSystem::GetDefaultWorkerThreadCount()
+{
+	// One per core, minus the main thread
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+	return hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0;
+}
+
+void JobSystem::Submit( Job job, JobCounter* counter )
+{
+	if( counter != nullptr )
+	{
+		counter->m_pendingJobCount.fetch_add( 1, std::memory_order_relaxed );
+	}
+	Enqueue( QueuedJob{ std::move( job ), counter } );
+}
+
+void JobSystem::SubmitAfter( JobCounter& dependency, Job job, JobCounter* counter )
+{
+	if( counter != nullptr )
+	{
+		counter->m_pendingJobCount.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	{
+		// The last job of dependency takes this lock too, so either it sees our continuation or we see it done
+		std::lock_guard<std::mutex> lock( dependency.m_mutex );
+		if( !dependency.IsDone() )
+		{
+			dependency.m_continuations.push_back( JobCounter::Continuation{ std::move( job ), counter } );
+			return;
+		}
+	}
+
+	Enqueue( QueuedJob{ std::move( job ), counter } );
+}
+
+void JobSystem::Wait( JobCounter& counter )
+{
+	const uint32_t queueIndex = GetCurrentQueueIndex();
+	while( !counter.IsDone() )
+	{
+		if( !TryRunJob( queueIndex ) )
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// Sync with the thread that finished the last job, it may still hold the lock
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> lock( counter.m_mutex );
+		std::swap( exception, counter.m_exception );
+	}
+
+	if( exception )
+	{
+		std::rethrow_exception( exception );
+	}
+}
+
+void JobSystem::Enqueue( QueuedJob queuedJob )
+{
+	// Our own threads keep their jobs local, others spread them around
+	const uint32_t queueIndex = t_jobSystem == this ? t_queueIndex : m_nextExternalQueue++ % GetThreadCount();
+	{
+		WorkerQueue& queue = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> lock( queue.mutex );
+		queue.jobs.push_back( std::move( queuedJob ) );
+	}
+
+	// Taking the sleep lock makes sure a worker can't miss the count change between checking it and going to sleep
+	{
+		std::lock_guard<std::mutex> lock( m_sleepMutex );
+		++m_queuedJobCount;
+	}
+	m_wakeCondition.notify_one();
+}
+
+bool JobSystem::TryPopJob( uint32_t queueIndex, QueuedJob& queuedJob )
+{
+	// Newest first from our own queue, it's the most likely to still be in cache
+	{
+		WorkerQueue& queue = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> lock( queue.mutex );
+		if( !queue.jobs.empty() )
+		{
+			queuedJob = std::move( queue.jobs.back() );
+			queue.jobs.pop_back();
+			return true;
+		}
+	}
+
+	// Then steal the oldest job of someone else, oldest jobs tend to be the biggest ones
+	const uint32_t queueCount = GetThreadCount();
+	for( uint32_t i = 1; i < queueCount; ++i )
+	{
+		WorkerQueue& queue = *m_queues[( queueIndex + i ) % queueCount];
+		std::unique_lock<std::mutex> lock( queue.mutex, std::try_to_lock );
+		if( lock.owns_lock() && !queue.jobs.empty() )
+		{
+			queuedJob = std::move( queue.jobs.front() );
+			queue.jobs.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::TryRunJob( uint32_t queueIndex )
+{
+	if( m_queuedJobCount.load( std::memory_order_relaxed ) == 0 )
+	{
+		return false;
+	}
+
+	QueuedJob queuedJob;
+	if( !TryPopJob( queueIndex, queuedJob ) )
+	{
+		return false;
+	}
+	--m_queuedJobCount;
+
+	std::exception_ptr exception;
+	try
+	{
+		queuedJob.job();
+	}
+	catch( ... )
+	{
+		exception = std::current_exception();
+	}
+
+	FinishJob( queuedJob.counter, exception );
+	return true;
+}
+
+void JobSystem::FinishJob( JobCounter* counter, std::exception_ptr exception )
+{
+	if( counter == nullptr )
+	{
+		if( exception )
+		{
+			// Nobody is waiting on this job, there's no one to hand the exception to
+			std::rethrow_exception( exception );
+		}
+		return;
+	}
+
+	std::vector<JobCounter::Continuation> continuations;
+	{
+		std::lock_guard<std::mutex> lock( counter->m_mutex );
+		if( exception && !counter->m_exception )
+		{
+			counter->m_exception = exception;
+		}
+
+		if( counter->m_pendingJobCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+		{
+			std::swap( continuations, counter->m_continuations );
+		}
+	}
+
+	// The counter may be gone by now, only touch what we moved out of it
+	for( auto& continuation : continuations )
+	{
+		Enqueue( QueuedJob{ std::move( continuation.job ), continuation.counter } );
+	}
+}
+
+void JobSystem::WorkerLoop( uint32_t queueIndex )
+{
+	t_jobSystem = this;
+	t_queueIndex = queueIndex;
+
+	while( !m_isShuttingDown )
+	{
+		if( TryRunJob( queueIndex ) )
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock( m_sleepMutex );
+		m_wakeCondition.wait( lock, [this]() {
+			return m_queuedJobCount > 0 || m_isShuttingDown;
+		} );
+	}
+}
+
+uint32_t JobSystem::GetCurrentQueueIndex() const
+{
+	// Threads we don't own help out from the main thread's queue, stealing from everyone else
+	return t_jobSystem == this ? t_queueIndex : 0;
+}
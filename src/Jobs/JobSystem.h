@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using Job = std::function<void()>;
+
+//-----------------------
+// Tracks a group of submitted jobs, done once they've all run.
+// Jobs can be chained to run once a counter is done (see JobSystem::SubmitAfter).
+// Only add jobs to a counter while nobody else can be finishing its last job, eg: before waiting on it.
+
+class JobCounter
+{
+  public:
+	bool IsDone() const { return m_pendingJobCount.load( std::memory_order_acquire ) == 0; }
+
+  private:
+	friend class JobSystem;
+
+	struct Continuation
+	{
+		Job job;
+		JobCounter* counter;
+	};
+
+	std::atomic<uint32_t> m_pendingJobCount{ 0 };
+	std::mutex m_mutex; // guards the continuations & exception, and the last decrement so waiters can't free us under it
+	std::vector<Continuation> m_continuations;
+	std::exception_ptr m_exception; // first exception thrown by one of the jobs, rethrown by Wait
+};
+
+//-----------------------
+// Work stealing thread pool.
+// Every worker thread (plus the thread that created the job system) owns a deque: it pushes and pops its own jobs
+// at the back, idle threads steal from the front of the others. Waiting threads run jobs instead of blocking,
+// so jobs can submit & wait on more jobs without deadlocking.
+
+class JobSystem
+{
+  public:
+	// workerThreadCount doesn't include the creating thread, which runs jobs while it waits
+	explicit JobSystem( uint32_t workerThreadCount = GetDefaultWorkerThreadCount() );
+	~JobSystem();
+
+	JobSystem( const JobSystem& ) = delete;
+	JobSystem& operator=( const JobSystem& ) = delete;
+
+	// Jobs without a counter have nobody to report to, they must not throw
+	void Submit( Job job, JobCounter* counter = nullptr );
+	// job only gets queued once dependency is done, counter (if any) accounts for it straight away
+	void SubmitAfter( JobCounter& dependency, Job job, JobCounter* counter = nullptr );
+
+	// Runs jobs until counter is done, rethrows the first exception its jobs threw
+	void Wait( JobCounter& counter );
+
+	// Runs function( index ) for every index in [0, count), batchSize indices per job, blocks until done
+	template<typename Function>
+	void ParallelFor( size_t count, size_t batchSize, Function&& function );
+	// Same, with a batch size giving every thread a few batches to balance uneven work
+	template<typename Function>
+	void ParallelFor( size_t count, Function&& function );
+
+	// Worker threads + the creating thread
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>( m_queues.size() ); }
+	// In [0, GetThreadCount()), for per thread data (eg: command pools). 0 is the creating thread,
+	// which threads the job system doesn't own share: only use it from jobs & the creating thread.
+	uint32_t GetCurrentThreadIndex() const { return GetCurrentQueueIndex(); }
+
+	static uint32_t GetDefaultWorkerThreadCount();
+
+  private:
+	struct QueuedJob
+	{
+		Job job;
+		JobCounter* counter;
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<QueuedJob> jobs;
+	};
+
+	void Enqueue( QueuedJob queuedJob );
+	bool TryPopJob( uint32_t queueIndex, QueuedJob& queuedJob );
+	bool TryRunJob( uint32_t queueIndex );
+	void FinishJob( JobCounter* counter, std::exception_ptr exception );
+	void WorkerLoop( uint32_t queueIndex );
+	uint32_t GetCurrentQueueIndex() const;
+
+	// Index 0 belongs to the creating thread, then one per worker
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_workerThreads;
+
+	std::atomic<int32_t> m_queuedJobCount{ 0 }; // signed, it can briefly dip below 0 between a push and its increment
+	std::atomic<uint32_t> m_nextExternalQueue{ 0 }; // round robin for jobs submitted from threads we don't own
+	std::atomic<bool> m_isShuttingDown{ false };
+
+	// Idle workers sleep here until jobs get queued
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+};
+
+//-----------------------
+
+template<typename Function>
+void JobSystem::ParallelFor( size_t count, size_t batchSize, Function&& function )
+{
+	if( count == 0 )
+	{
+		return;
+	}
+
+	batchSize = std::max<size_t>( batchSize, 1 );
+	if( count <= batchSize || GetThreadCount() == 1 )
+	{
+		for( size_t index = 0; index < count; ++index )
+		{
+			function( index );
+		}
+		return;
+	}
+
+	JobCounter counter;
+	for( size_t begin = 0; begin < count; begin += batchSize )
+	{
+		const size_t end = std::min( begin + batchSize, count );
+		Submit( [&function, begin, end]() {
+			for( size_t index = begin; index < end; ++index )
+			{
+				function( index );
+			}
+		},
+		  &counter );
+	}
+	Wait( counter );
+}
+
+template<typename Function>
+void JobSystem::ParallelFor( size_t count, Function&& function )
+{
+	constexpr size_t batchesPerThread = 4;
+	ParallelFor( count, count / ( GetThreadCount() * batchesPerThread ), std::forward<Function>( function ) );
+}
@@ -0,0 +1,224 @@
+#include <Profiling/GpuProfiler.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <Profiling/Profiler.h>
+
+// Two per scope, plenty for a command buffer's worth of passes
+constexpr uint32_t MAX_QUERIES_PER_SLOT = 64;
+// Two a frame, hours worth at any sensible frame rate
+constexpr size_t MAX_RECORDED_BUSY_INTERVALS = 1024 * 1024;
+
+namespace
+{
+	// Sorts & merges touching intervals, the ones left don't overlap each other
+	void MergeIntervals( std::vector<GpuBusyInterval>& intervals )
+	{
+		std::sort( intervals.begin(), intervals.end(), []( const GpuBusyInterval& a, const GpuBusyInterval& b ) { return a.begin < b.begin; } );
+
+		size_t mergedCount = 0;
+		for( const GpuBusyInterval& interval : intervals )
+		{
+			if( mergedCount > 0 && interval.begin <= intervals[mergedCount - 1].end )
+			{
+				intervals[mergedCount - 1].end = std::max( intervals[mergedCount - 1].end, interval.end );
+			}
+			else
+			{
+				intervals[mergedCount++] = interval;
+			}
+		}
+		intervals.resize( mergedCount );
+	}
+
+	uint64_t TotalDuration( const std::vector<GpuBusyInterval>& intervals )
+	{
+		uint64_t duration = 0;
+		for( const GpuBusyInterval& interval : intervals )
+		{
+			duration += interval.end - interval.begin;
+		}
+		return duration;
+	}
+} // namespace
+
+GpuProfiler::GpuProfiler( VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t slotCount, const char* trackName )
+  : m_device( device )
+  , m_trackName( trackName )
+  , m_slots( slotCount )
+{
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProperties );
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &queueFamilyCount, nullptr );
+	std::vector<VkQueueFamilyProperties> queueFamilies( queueFamilyCount );
+	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &queueFamilyCount, queueFamilies.data() );
+
+	// Queues without timestamp support just don't record anything
+	const uint32_t timestampValidBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+	if( timestampValidBits == 0 )
+	{
+		return;
+	}
+	m_timestampPeriod = deviceProperties.limits.timestampPeriod;
+	m_timestampMask = timestampValidBits >= 64 ? ~0ull : ( ( 1ull << timestampValidBits ) - 1 );
+
+	for( Slot& slot : m_slots )
+	{
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = MAX_QUERIES_PER_SLOT;
+
+		if( vkCreateQueryPool( m_device, &queryPoolInfo, nullptr, &slot.queryPool ) != VK_SUCCESS )
+		{
+			throw std::runtime_error( "failed to create timestamp query pool!" );
+		}
+	}
+	m_queryResults.resize( MAX_QUERIES_PER_SLOT );
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for( Slot& slot : m_slots )
+	{
+		vkDestroyQueryPool( m_device, slot.queryPool, nullptr );
+	}
+}
+
+void GpuProfiler::BeginRecording( VkCommandBuffer commandBuffer, uint32_t slot )
+{
+	Slot& recordingSlot = m_slots[slot];
+	recordingSlot.scopes.clear();
+	recordingSlot.queryCount = 0;
+
+	if( IsSupported() )
+	{
+		vkCmdResetQueryPool( commandBuffer, recordingSlot.queryPool, 0, MAX_QUERIES_PER_SLOT );
+	}
+}
+
+void GpuProfiler::BeginScope( VkCommandBuffer commandBuffer, uint32_t slot, const char* name, VkPipelineStageFlagBits stage )
+{
+	Slot& recordingSlot = m_slots[slot];
+	if( !IsSupported() || recordingSlot.queryCount + 2 > MAX_QUERIES_PER_SLOT )
+	{
+		return;
+	}
+
+	recordingSlot.scopes.push_back( Scope{ name, recordingSlot.queryCount } );
+	vkCmdWriteTimestamp( commandBuffer, stage, recordingSlot.queryPool, recordingSlot.queryCount++ );
+}
+
+void GpuProfiler::EndScope( VkCommandBuffer commandBuffer, uint32_t slot, VkPipelineStageFlagBits stage )
+{
+	Slot& recordingSlot = m_slots[slot];
+	if( !IsSupported() || recordingSlot.queryCount % 2 == 0 )
+	{
+		return; // the matching BeginScope was dropped
+	}
+
+	vkCmdWriteTimestamp( commandBuffer, stage, recordingSlot.queryPool, recordingSlot.queryCount++ );
+}
+
+void GpuProfiler::OnSubmitted( uint32_t slot, int64_t cpuTimestamp, uint32_t frameIndex )
+{
+	Slot& submittedSlot = m_slots[slot];
+	submittedSlot.isSubmitted = true;
+	submittedSlot.submitCpuTimestamp = cpuTimestamp;
+	submittedSlot.submitFrameIndex = frameIndex;
+}
+
+void GpuProfiler::Collect( uint32_t slot, Profiler& profiler )
+{
+	Slot& collectedSlot = m_slots[slot];
+	if( !IsSupported() || !collectedSlot.isSubmitted || collectedSlot.queryCount == 0 )
+	{
+		return;
+	}
+	collectedSlot.isSubmitted = false;
+
+	// The work is done, results are available without waiting
+	const VkResult result = vkGetQueryPoolResults( m_device,
+	  collectedSlot.queryPool,
+	  0,
+	  collectedSlot.queryCount,
+	  collectedSlot.queryCount * sizeof( uint64_t ),
+	  m_queryResults.data(),
+	  sizeof( uint64_t ),
+	  VK_QUERY_RESULT_64_BIT );
+	if( result != VK_SUCCESS )
+	{
+		return;
+	}
+
+	const uint64_t firstTimestamp = m_queryResults[0] & m_timestampMask;
+	auto toCpuTimestamp = [&]( uint64_t gpuTimestamp ) {
+		const uint64_t elapsedTicks = ( ( gpuTimestamp & m_timestampMask ) - firstTimestamp ) & m_timestampMask;
+		return collectedSlot.submitCpuTimestamp + static_cast<int64_t>( static_cast<double>( elapsedTicks ) * m_timestampPeriod / 1000.0 );
+	};
+
+	auto toNanoseconds = [&]( uint64_t gpuTimestamp ) {
+		return static_cast<uint64_t>( static_cast<double>( gpuTimestamp & m_timestampMask ) * m_timestampPeriod );
+	};
+
+	GpuBusyInterval busyInterval{ UINT64_MAX, 0 };
+	for( const Scope& scope : collectedSlot.scopes )
+	{
+		if( scope.beginQuery + 1 < collectedSlot.queryCount )
+		{
+			const uint64_t beginTimestamp = m_queryResults[scope.beginQuery];
+			const uint64_t endTimestamp = m_queryResults[scope.beginQuery + 1];
+			profiler.AddGpuEvent( scope.name,
+			  m_trackName,
+			  collectedSlot.submitFrameIndex,
+			  toCpuTimestamp( beginTimestamp ),
+			  toCpuTimestamp( endTimestamp ) );
+
+			busyInterval.begin = std::min( busyInterval.begin, toNanoseconds( beginTimestamp ) );
+			busyInterval.end = std::max( busyInterval.end, toNanoseconds( endTimestamp ) );
+		}
+	}
+
+	if( busyInterval.begin < busyInterval.end && m_busyIntervals.size() < MAX_RECORDED_BUSY_INTERVALS )
+	{
+		m_busyIntervals.push_back( busyInterval );
+	}
+}
+
+GpuQueueOverlap MeasureQueueOverlap( std::vector<GpuBusyInterval> first, std::vector<GpuBusyInterval> second )
+{
+	MergeIntervals( first );
+	MergeIntervals( second );
+
+	// Both sorted & disjoint, walk them side by side
+	uint64_t overlap = 0;
+	size_t firstIndex = 0;
+	size_t secondIndex = 0;
+	while( firstIndex < first.size() && secondIndex < second.size() )
+	{
+		const uint64_t begin = std::max( first[firstIndex].begin, second[secondIndex].begin );
+		const uint64_t end = std::min( first[firstIndex].end, second[secondIndex].end );
+		if( begin < end )
+		{
+			overlap += end - begin;
+		}
+
+		if( first[firstIndex].end < second[secondIndex].end )
+		{
+			++firstIndex;
+		}
+		else
+		{
+			++secondIndex;
+		}
+	}
+
+	GpuQueueOverlap queueOverlap;
+	queueOverlap.firstBusyMilliseconds = TotalDuration( first ) / 1e6;
+	queueOverlap.secondBusyMilliseconds = TotalDuration( second ) / 1e6;
+	queueOverlap.overlapMilliseconds = overlap / 1e6;
+	return queueOverlap;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+class Profiler;
+
+// Span of a slot's timed GPU work, in nanoseconds on the device's timestamp clock
+struct GpuBusyInterval
+{
+	uint64_t begin;
+	uint64_t end;
+};
+
+// How much two queues' busy intervals overlap, eg: async compute running alongside graphics
+struct GpuQueueOverlap
+{
+	double firstBusyMilliseconds = 0.0;
+	double secondBusyMilliseconds = 0.0;
+	double overlapMilliseconds = 0.0;
+};
+
+//-----------------------
+// Timestamp queries around GPU work of one queue, fed back into a Profiler once the work is done.
+// There's one query pool per slot (eg: per frame in flight or swapchain image), a slot being recorded, submitted, then collected
+// once the GPU is done with it, before it gets submitted again.
+// GPU timestamps don't share the CPU clock: a slot's events are placed relative to its submission time on the CPU,
+// durations are exact but the offset to CPU events is only approximate.
+
+class GpuProfiler
+{
+  public:
+	// trackName labels these events in traces & summaries, it must outlive the profiler (string literal)
+	GpuProfiler( VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t slotCount, const char* trackName );
+	~GpuProfiler();
+
+	GpuProfiler( const GpuProfiler& ) = delete;
+	GpuProfiler& operator=( const GpuProfiler& ) = delete;
+
+	// Call first when (re)recording the slot's command buffer, outside of any render pass
+	void BeginRecording( VkCommandBuffer commandBuffer, uint32_t slot );
+	// name must outlive the profiler (string literal), scopes can't nest
+	void BeginScope( VkCommandBuffer commandBuffer, uint32_t slot, const char* name, VkPipelineStageFlagBits stage );
+	void EndScope( VkCommandBuffer commandBuffer, uint32_t slot, VkPipelineStageFlagBits stage );
+
+	// Call when submitting the slot's command buffer
+	void OnSubmitted( uint32_t slot, int64_t cpuTimestamp, uint32_t frameIndex );
+	// Call once the slot's last submission is done, before submitting it again
+	void Collect( uint32_t slot, Profiler& profiler );
+
+	bool IsSupported() const { return m_timestampPeriod > 0.0f; }
+
+	// Every collected slot's span, in collection order
+	const std::vector<GpuBusyInterval>& GetBusyIntervals() const { return m_busyIntervals; }
+
+  private:
+	struct Scope
+	{
+		const char* name;
+		uint32_t beginQuery;
+	};
+
+	struct Slot
+	{
+		VkQueryPool queryPool = VK_NULL_HANDLE;
+		std::vector<Scope> scopes;
+		uint32_t queryCount = 0;
+		bool isSubmitted = false;
+		int64_t submitCpuTimestamp = 0;
+		uint32_t submitFrameIndex = 0;
+	};
+
+	VkDevice m_device;
+	float m_timestampPeriod = 0.0f; // nanoseconds per tick, 0 when the queue can't write timestamps
+	uint64_t m_timestampMask = 0; // valid bits of the queue's timestamps
+	const char* m_trackName;
+	std::vector<Slot> m_slots;
+	std::vector<uint64_t> m_queryResults; // kept around to avoid reallocating every collect
+	std::vector<GpuBusyInterval> m_busyIntervals;
+};
+
+// Only meaningful across queues whose timestamps share a clock. The spec only promises that within a queue,
+// but desktop drivers time every queue of a device off the same counter.
+GpuQueueOverlap MeasureQueueOverlap( std::vector<GpuBusyInterval> first, std::vector<GpuBusyInterval> second );
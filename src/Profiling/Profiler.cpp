@@ -0,0 +1,159 @@
+#include <Profiling/Profiler.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+// Keeps long runs from eating all the memory, ~40 bytes each
+constexpr size_t MAX_RECORDED_EVENTS = 4 * 1024 * 1024;
+
+namespace
+{
+	uint32_t GetCurrentThreadId()
+	{
+		static std::atomic<uint32_t> nextThreadId{ 0 };
+		thread_local const uint32_t threadId = nextThreadId++;
+		return threadId;
+	}
+
+	// Nearest rank percentile of sorted values
+	double Percentile( const std::vector<double>& sortedValues, double percentile )
+	{
+		const size_t rank = static_cast<size_t>( percentile / 100.0 * static_cast<double>( sortedValues.size() - 1 ) + 0.5 );
+		return sortedValues[std::min( rank, sortedValues.size() - 1 )];
+	}
+} // namespace
+
+Profiler::Profiler()
+  : m_startTime( std::chrono::steady_clock::now() )
+{
+}
+
+int64_t Profiler::GetTimestamp() const
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - m_startTime ).count();
+}
+
+void Profiler::AddCpuEvent( const char* name, uint32_t frameIndex, int64_t startTimestamp, int64_t endTimestamp )
+{
+	AddEvent( Event{ name, nullptr, GetCurrentThreadId(), frameIndex, startTimestamp, endTimestamp - startTimestamp } );
+}
+
+void Profiler::AddGpuEvent( const char* name, const char* trackName, uint32_t frameIndex, int64_t startTimestamp, int64_t endTimestamp )
+{
+	AddEvent( Event{ name, trackName, GPU_TRACE_THREAD_ID, frameIndex, startTimestamp, endTimestamp - startTimestamp } );
+}
+
+void Profiler::AddEvent( const Event& event )
+{
+	std::lock_guard<std::mutex> lock( m_eventsMutex );
+	if( m_events.size() >= MAX_RECORDED_EVENTS )
+	{
+		m_hasDroppedEvents = true;
+		return;
+	}
+	m_events.push_back( event );
+}
+
+void Profiler::WriteChromeTrace( const std::string& filePath ) const
+{
+	FILE* file = fopen( filePath.c_str(), "w" );
+	if( file == nullptr )
+	{
+		throw std::runtime_error( "failed to open profiler trace file!" );
+	}
+
+	std::lock_guard<std::mutex> lock( m_eventsMutex );
+
+	// Every GPU track gets its own thread id past GPU_TRACE_THREAD_ID, named with a metadata event
+	std::map<std::string, uint32_t> gpuTrackThreadIds;
+	for( const Event& event : m_events )
+	{
+		if( event.trackName != nullptr )
+		{
+			gpuTrackThreadIds.emplace( event.trackName, GPU_TRACE_THREAD_ID + static_cast<uint32_t>( gpuTrackThreadIds.size() ) );
+		}
+	}
+
+	fprintf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	bool isFirstEvent = true;
+	for( const auto& gpuTrack : gpuTrackThreadIds )
+	{
+		fprintf( file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"GPU %s\"}}", isFirstEvent ? "" : ",\n", gpuTrack.second, gpuTrack.first.c_str() );
+		isFirstEvent = false;
+	}
+
+	for( const Event& event : m_events )
+	{
+		const uint32_t threadId = event.trackName != nullptr ? gpuTrackThreadIds[event.trackName] : event.threadId;
+		fprintf( file,
+		  "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%" PRId64 ",\"dur\":%" PRId64 ",\"args\":{\"frame\":%u}}",
+		  isFirstEvent ? "" : ",\n",
+		  event.name,
+		  event.trackName != nullptr ? "gpu" : "cpu",
+		  threadId,
+		  event.startTimestamp,
+		  event.duration,
+		  event.frameIndex );
+		isFirstEvent = false;
+	}
+	fprintf( file, "\n]}\n" );
+
+	const bool hasWriteFailed = ferror( file ) != 0;
+	fclose( file );
+	if( hasWriteFailed )
+	{
+		throw std::runtime_error( "failed to write profiler trace file!" );
+	}
+}
+
+void Profiler::PrintSummary( std::ostream& output ) const
+{
+	std::lock_guard<std::mutex> lock( m_eventsMutex );
+
+	// Total time per event name per frame, an event running several times a frame (eg: per chunk) adds up
+	std::map<std::string, std::map<uint32_t, double>> frameTimesPerName;
+	std::set<uint32_t> frames;
+	for( const Event& event : m_events )
+	{
+		std::string name = event.name;
+		if( event.trackName != nullptr )
+		{
+			name = std::string( "GPU " ) + event.trackName + ": " + name;
+		}
+		frameTimesPerName[name][event.frameIndex] += static_cast<double>( event.duration ) / 1000.0;
+		frames.insert( event.frameIndex );
+	}
+
+	char line[256];
+	snprintf( line, sizeof( line ), "Profile over %zu frames (ms per frame)%s\n", frames.size(), m_hasDroppedEvents ? ", events dropped past the recording limit" : "" );
+	output << line;
+	snprintf( line, sizeof( line ), "  %-40s %9s %9s %9s %9s %9s\n", "", "mean", "p50", "p95", "p99", "max" );
+	output << line;
+
+	for( const auto& nameAndFrameTimes : frameTimesPerName )
+	{
+		std::vector<double> frameTimes;
+		double totalTime = 0.0;
+		for( const auto& frameTime : nameAndFrameTimes.second )
+		{
+			frameTimes.push_back( frameTime.second );
+			totalTime += frameTime.second;
+		}
+		std::sort( frameTimes.begin(), frameTimes.end() );
+
+		snprintf( line,
+		  sizeof( line ),
+		  "  %-40s %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+		  nameAndFrameTimes.first.c_str(),
+		  totalTime / static_cast<double>( frameTimes.size() ),
+		  Percentile( frameTimes, 50.0 ),
+		  Percentile( frameTimes, 95.0 ),
+		  Percentile( frameTimes, 99.0 ),
+		  frameTimes.back() );
+		output << line;
+	}
+}
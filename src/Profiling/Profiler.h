@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//-----------------------
+// Collects timed events from the CPU (any thread, see ProfileScope) and the GPU (see GpuProfiler),
+// tagged with the frame they happened in.
+// Exports them as a Chrome trace (chrome://tracing or ui.perfetto.dev) and summarises them per frame:
+// for every event name, percentiles of the time it took per frame.
+
+class Profiler
+{
+  public:
+	// Thread id used for GPU events in the trace, CPU threads count up from 0
+	static constexpr uint32_t GPU_TRACE_THREAD_ID = 1000;
+
+	Profiler();
+
+	// Microseconds since the profiler was created, the time base of every event
+	int64_t GetTimestamp() const;
+
+	// Following events belong to the next frame
+	void NextFrame() { ++m_frameIndex; }
+	uint32_t GetFrameIndex() const { return m_frameIndex; }
+
+	// name must outlive the profiler (string literals)
+	void AddCpuEvent( const char* name, uint32_t frameIndex, int64_t startTimestamp, int64_t endTimestamp );
+	// GPU events go on their own track per queue, trackName names it in the trace
+	void AddGpuEvent( const char* name, const char* trackName, uint32_t frameIndex, int64_t startTimestamp, int64_t endTimestamp );
+
+	void WriteChromeTrace( const std::string& filePath ) const;
+	void PrintSummary( std::ostream& output ) const;
+
+  private:
+	struct Event
+	{
+		const char* name;
+		const char* trackName; // GPU events only
+		uint32_t threadId;
+		uint32_t frameIndex;
+		int64_t startTimestamp;
+		int64_t duration;
+	};
+
+	void AddEvent( const Event& event );
+
+	std::chrono::steady_clock::time_point m_startTime;
+	std::atomic<uint32_t> m_frameIndex{ 0 };
+
+	mutable std::mutex m_eventsMutex;
+	std::vector<Event> m_events;
+	bool m_hasDroppedEvents = false;
+};
+
+//-----------------------
+// Times its own scope on the CPU, counted in the frame it started in:
+//   ProfileScope profileScope( m_profiler, "DrawFrame" );
+
+class ProfileScope
+{
+  public:
+	ProfileScope( Profiler& profiler, const char* name )
+	  : m_profiler( profiler )
+	  , m_name( name )
+	  , m_frameIndex( profiler.GetFrameIndex() )
+	  , m_startTimestamp( profiler.GetTimestamp() )
+	{
+	}
+
+	~ProfileScope()
+	{
+		m_profiler.AddCpuEvent( m_name, m_frameIndex, m_startTimestamp, m_profiler.GetTimestamp() );
+	}
+
+	ProfileScope( const ProfileScope& ) = delete;
+	ProfileScope& operator=( const ProfileScope& ) = delete;
+
+  private:
+	Profiler& m_profiler;
+	const char* m_name;
+	uint32_t m_frameIndex;
+	int64_t m_startTimestamp;
+};
@@ -0,0 +1,22 @@
+// The bindless descriptor heap's set (see src/Graphics/BindlessDescriptorHeap.h), resources are picked by index
+// out of one array per type, the indices coming from push constants.
+// Binding numbers match BindlessResourceType.
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define BINDLESS_STORAGE_BUFFER_BINDING 0
+#define BINDLESS_STORAGE_IMAGE_BINDING 1
+#define BINDLESS_SAMPLED_IMAGE_BINDING 2
+#define BINDLESS_SAMPLER_BINDING 3
+
+// Every storage buffer seen as one block type, declare one per layout used: BINDLESS_STORAGE_BUFFERS( DataBlock, { float values[]; }, dataBuffers );
+// Indices that aren't the same across the draw / dispatch (eg: from a buffer) need nonuniformEXT()
+#define BINDLESS_STORAGE_BUFFERS( blockName, members, arrayName ) \
+	layout( std430, set = 0, binding = BINDLESS_STORAGE_BUFFER_BINDING ) buffer blockName members arrayName[]
+
+// Storage images need their format: BINDLESS_STORAGE_IMAGES( rgba8, image2D, colorImages );
+#define BINDLESS_STORAGE_IMAGES( format, imageType, arrayName ) \
+	layout( format, set = 0, binding = BINDLESS_STORAGE_IMAGE_BINDING ) uniform imageType arrayName[]
+
+layout( set = 0, binding = BINDLESS_SAMPLED_IMAGE_BINDING ) uniform texture2D bindlessTextures[];
+layout( set = 0, binding = BINDLESS_SAMPLER_BINDING ) uniform sampler bindlessSamplers[];
@@ -0,0 +1,15 @@
+// The frame's chunks (see src/Graphics/IndirectChunkDraws.h), include Bindless.glsl first
+
+struct GpuChunk
+{
+	vec4 origin; // xyz: world space min corner, w: size
+	uint firstIndex;
+	uint indexCount;
+	int vertexOffset;
+	uint chunkId; // NO_CHUNK_ID: no visibility kept for it
+	float voxelScale; // world units per mesh vertex unit, 2^LOD
+};
+
+const uint NO_CHUNK_ID = 0xffffffffu;
+
+BINDLESS_STORAGE_BUFFERS( ChunkBlock, { GpuChunk chunks[]; }, chunkBuffers );
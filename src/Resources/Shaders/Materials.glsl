@@ -0,0 +1,17 @@
+// Voxel shading shared by the rasterized (VoxelChunk.vert) & raymarched (Raymarch.comp) paths, so they can be compared
+
+// By material, 0 is empty and never drawn
+const vec3 materialColors[4] = vec3[](
+	vec3( 1.0, 0.0, 1.0 ),
+	vec3( 0.30, 0.60, 0.20 ), // grass
+	vec3( 0.50, 0.50, 0.50 ), // stone
+	vec3( 0.55, 0.40, 0.25 )
+);
+
+const vec3 sunDirection = normalize( vec3( 0.4, 1.0, 0.3 ) );
+
+vec3 ShadeVoxelFace( uint material, vec3 faceNormal )
+{
+	float lighting = 0.35 + 0.65 * max( dot( faceNormal, sunDirection ), 0.0 );
+	return materialColors[material % 4u] * lighting;
+}
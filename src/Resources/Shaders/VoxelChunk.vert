@@ -0,0 +1,42 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "Bindless.glsl"
+#include "Chunks.glsl"
+#include "Materials.glsl"
+
+// Packed vertices (see VoxelMesher.h), pulled out of the chunk mesh pool: gl_VertexIndex already has the draw's vertexOffset
+BINDLESS_STORAGE_BUFFERS( ChunkMeshBlock, { uint packedVertices[]; }, chunkMeshBuffers );
+
+// The draw's chunk comes through firstInstance, its index in the chunk buffer
+layout( push_constant ) uniform PushConstants
+{
+	mat4 viewProjection;
+	uint meshBufferIndex;
+	uint chunkBufferIndex;
+};
+
+layout( location = 0 ) out vec3 fragColor;
+
+const vec3 faceNormals[6] = vec3[](
+	vec3( 1.0, 0.0, 0.0 ),
+	vec3( -1.0, 0.0, 0.0 ),
+	vec3( 0.0, 1.0, 0.0 ),
+	vec3( 0.0, -1.0, 0.0 ),
+	vec3( 0.0, 0.0, 1.0 ),
+	vec3( 0.0, 0.0, -1.0 )
+);
+
+void main()
+{
+	uint packedVertex = chunkMeshBuffers[meshBufferIndex].packedVertices[gl_VertexIndex];
+	vec3 localPosition = vec3( packedVertex & 63u, ( packedVertex >> 6 ) & 63u, ( packedVertex >> 12 ) & 63u );
+	uint faceDirection = ( packedVertex >> 18 ) & 7u;
+	uint material = ( packedVertex >> 21 ) & 255u;
+
+	// Far chunks are meshed in their LOD's voxels
+	GpuChunk chunk = chunkBuffers[chunkBufferIndex].chunks[gl_InstanceIndex];
+	gl_Position = viewProjection * vec4( chunk.origin.xyz + localPosition * chunk.voxelScale, 1.0 );
+
+	fragColor = ShadeVoxelFace( material, faceNormals[faceDirection] );
+}
@@ -0,0 +1,84 @@
+// The resident chunks' voxels (see src/Graphics/GpuVoxelStore.h), include Bindless.glsl first.
+// Chunk sizes match src/Voxel/VoxelConstants.h.
+
+const int VOXEL_CHUNK_SIZE = 32;
+const int VOXEL_BRICK_SIZE = 8;
+const int VOXEL_CHUNK_BRICKS = VOXEL_CHUNK_SIZE / VOXEL_BRICK_SIZE;
+const uint VOXEL_CHUNK_BRICK_COUNT = 64u;
+const uint VOXEL_BRICK_WORD_COUNT = 131u; // a byte per voxel, then the cell masks
+const uint VOXEL_BRICK_CELL_WORD = 128u; // 2 words, a bit per 2^3 cell with solid voxels
+const uint VOXEL_BRICK_COARSE_CELL_WORD = 130u; // a bit per 4^3 cell with solid voxels
+
+const uint UNIFORM_BRICK_BIT = 0x80000000u;
+const uint EMPTY_GRID_CELL = 0xffffffffu;
+const uint GRID_CELL_LOD_SHIFT = 28u; // the chunk's LOD above, its brickmap index below
+
+// Grid cells, brickmaps & bricks all are arrays of uint
+BINDLESS_STORAGE_BUFFERS( VoxelStoreBlock, { uint words[]; }, voxelStoreBuffers );
+
+struct VoxelStore
+{
+	ivec3 gridOrigin; // in chunks
+	uint gridSize;
+	uint gridBufferIndex;
+	uint firstGridCell; // the frame slot's region of the grid
+	uint brickmapBufferIndex;
+	uint brickBufferIndex;
+};
+
+// The material at a voxel (world space voxel coordinate), 0 when empty.
+// cellSize is the size of the aligned cube around the voxel known to hold that same material: a chunk, brick, brick cell or voxel.
+// Chunks are stored in their LOD's voxels, 2^LOD voxels wide: so are their bricks & cells.
+uint SampleVoxelStore( VoxelStore store, ivec3 voxel, out int cellSize )
+{
+	cellSize = VOXEL_CHUNK_SIZE;
+	ivec3 gridCoord = ( voxel >> 5 ) - store.gridOrigin;
+	if( any( lessThan( gridCoord, ivec3( 0 ) ) ) || any( greaterThanEqual( gridCoord, ivec3( store.gridSize ) ) ) )
+	{
+		return 0u;
+	}
+
+	uint gridCell = ( uint( gridCoord.z ) * store.gridSize + uint( gridCoord.y ) ) * store.gridSize + uint( gridCoord.x );
+	uint gridEntry = voxelStoreBuffers[store.gridBufferIndex].words[store.firstGridCell + gridCell];
+	if( gridEntry == EMPTY_GRID_CELL )
+	{
+		return 0u;
+	}
+
+	uint brickmapIndex = gridEntry & ( ( 1u << GRID_CELL_LOD_SHIFT ) - 1u );
+	int lod = int( gridEntry >> GRID_CELL_LOD_SHIFT );
+	int levelBricks = max( ( VOXEL_CHUNK_SIZE >> lod ) / VOXEL_BRICK_SIZE, 1 );
+	cellSize = min( VOXEL_BRICK_SIZE << lod, VOXEL_CHUNK_SIZE );
+	ivec3 levelVoxel = ( voxel & ( VOXEL_CHUNK_SIZE - 1 ) ) >> lod;
+	ivec3 brickCoord = levelVoxel >> 3;
+	uint brickIndex = uint( ( brickCoord.z * levelBricks + brickCoord.y ) * levelBricks + brickCoord.x );
+	uint brickmapEntry = voxelStoreBuffers[store.brickmapBufferIndex].words[brickmapIndex * VOXEL_CHUNK_BRICK_COUNT + brickIndex];
+	if( ( brickmapEntry & UNIFORM_BRICK_BIT ) != 0u )
+	{
+		return brickmapEntry & 255u;
+	}
+
+	// Empty 4^3 & 2^3 cells of mixed bricks are skipped just the same
+	uint firstBrickWord = brickmapEntry * VOXEL_BRICK_WORD_COUNT;
+	ivec3 brickVoxel = levelVoxel & ( VOXEL_BRICK_SIZE - 1 );
+	ivec3 coarseCell = brickVoxel >> 2;
+	uint coarseCells = voxelStoreBuffers[store.brickBufferIndex].words[firstBrickWord + VOXEL_BRICK_COARSE_CELL_WORD];
+	if( ( ( coarseCells >> uint( ( coarseCell.z * 2 + coarseCell.y ) * 2 + coarseCell.x ) ) & 1u ) == 0u )
+	{
+		cellSize = 4 << lod;
+		return 0u;
+	}
+	ivec3 cell = brickVoxel >> 1;
+	uint cellIndex = uint( ( cell.z * 4 + cell.y ) * 4 + cell.x );
+	uint cells = voxelStoreBuffers[store.brickBufferIndex].words[firstBrickWord + VOXEL_BRICK_CELL_WORD + cellIndex / 32u];
+	if( ( ( cells >> ( cellIndex & 31u ) ) & 1u ) == 0u )
+	{
+		cellSize = 2 << lod;
+		return 0u;
+	}
+
+	cellSize = 1 << lod;
+	uint voxelIndex = uint( ( brickVoxel.z * VOXEL_BRICK_SIZE + brickVoxel.y ) * VOXEL_BRICK_SIZE + brickVoxel.x );
+	uint word = voxelStoreBuffers[store.brickBufferIndex].words[firstBrickWord + voxelIndex / 4u];
+	return ( word >> ( ( voxelIndex & 3u ) * 8u ) ) & 255u;
+}
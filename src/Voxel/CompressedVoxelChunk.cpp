@@ -0,0 +1,483 @@
+#include <Voxel/CompressedVoxelChunk.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define ASTRO_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+static_assert( VOXEL_CHUNK_SIZE == 32, "the SIMD paths decode/encode a row as exactly 32 voxels" );
+
+namespace
+{
+	using SimdPath = CompressedVoxelChunk::SimdPath;
+
+	SimdPath DetectSimdPath()
+	{
+#ifdef ASTRO_X86_SIMD
+		if( __builtin_cpu_supports( "avx2" ) )
+		{
+			return SimdPath::Avx2;
+		}
+		if( __builtin_cpu_supports( "sse4.1" ) )
+		{
+			return SimdPath::Sse41;
+		}
+#endif
+		return SimdPath::Scalar;
+	}
+
+	SimdPath Selected_Simd_Path = DetectSimdPath();
+
+	uint32_t BitsPerIndexForPaletteSize( size_t paletteSize )
+	{
+		// Powers of two only, so an index never straddles two bytes
+		if( paletteSize <= 1 ) return 0;
+		if( paletteSize <= 2 ) return 1;
+		if( paletteSize <= 4 ) return 2;
+		if( paletteSize <= 16 ) return 4;
+		return 8;
+	}
+
+	//-----------------------
+	// Scalar
+
+	bool IsRowUniformScalar( const int8_t* row )
+	{
+		for( int32_t x = 1; x < VOXEL_CHUNK_SIZE; ++x )
+		{
+			if( row[x] != row[0] )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void PackRowScalar( const uint8_t* indices, uint32_t bitsPerIndex, uint8_t* packedRow )
+	{
+		memset( packedRow, 0, VOXEL_CHUNK_SIZE * bitsPerIndex / 8 );
+		for( uint32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+		{
+			const uint32_t bitOffset = x * bitsPerIndex;
+			packedRow[bitOffset / 8] |= static_cast<uint8_t>( indices[x] << ( bitOffset % 8 ) );
+		}
+	}
+
+	void DecodeRowsScalar( const uint8_t* packedRows, uint32_t rowCount, uint32_t bitsPerIndex, const int8_t* palette, int8_t* out )
+	{
+		const uint32_t mask = ( 1u << bitsPerIndex ) - 1;
+		const uint32_t voxelCount = rowCount * VOXEL_CHUNK_SIZE;
+		for( uint32_t i = 0; i < voxelCount; ++i )
+		{
+			const uint32_t bitOffset = i * bitsPerIndex;
+			out[i] = palette[( packedRows[bitOffset / 8] >> ( bitOffset % 8 ) ) & mask];
+		}
+	}
+
+#ifdef ASTRO_X86_SIMD
+	//-----------------------
+	// SSE4.1
+	// Unpacking repeatedly splits each byte in its low & high halves and interleaves them, doubling the element count.
+	// Packing does the reverse with maddubs (low + high << width) & packus.
+	// Palettes of up to 16 entries (<= 4 bits) fit a register, so the lookup is a single pshufb.
+
+	__attribute__( ( target( "sse4.1" ) ) ) inline void SplitSse( __m128i packed, int shift, __m128i mask, __m128i& low, __m128i& high )
+	{
+		const __m128i lowHalves = _mm_and_si128( packed, mask );
+		const __m128i highHalves = _mm_and_si128( _mm_srli_epi16( packed, shift ), mask );
+		low = _mm_unpacklo_epi8( lowHalves, highHalves );
+		high = _mm_unpackhi_epi8( lowHalves, highHalves );
+	}
+
+	// Unpacks one row of 32 indices into two registers
+	__attribute__( ( target( "sse4.1" ) ) ) inline void UnpackRowSse( const uint8_t* packedRow, uint32_t bitsPerIndex, __m128i& low, __m128i& high )
+	{
+		const __m128i nibbleMask = _mm_set1_epi8( 0x0F );
+		__m128i unused;
+		if( bitsPerIndex == 4 )
+		{
+			SplitSse( _mm_loadu_si128( reinterpret_cast<const __m128i*>( packedRow ) ), 4, nibbleMask, low, high );
+		}
+		else if( bitsPerIndex == 2 )
+		{
+			__m128i nibbles;
+			SplitSse( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( packedRow ) ), 4, nibbleMask, nibbles, unused );
+			SplitSse( nibbles, 2, _mm_set1_epi8( 0x03 ), low, high );
+		}
+		else
+		{
+			int32_t packedBits;
+			memcpy( &packedBits, packedRow, sizeof( packedBits ) );
+			__m128i nibbles, pairs;
+			SplitSse( _mm_cvtsi32_si128( packedBits ), 4, nibbleMask, nibbles, unused );
+			SplitSse( nibbles, 2, _mm_set1_epi8( 0x03 ), pairs, unused );
+			SplitSse( pairs, 1, _mm_set1_epi8( 0x01 ), low, high );
+		}
+	}
+
+	__attribute__( ( target( "sse4.1" ) ) ) void DecodeRowsSse41( const uint8_t* packedRows, uint32_t rowCount, uint32_t bitsPerIndex, const int8_t* palette, size_t paletteSize, int8_t* out )
+	{
+		if( bitsPerIndex == 8 )
+		{
+			// Palette doesn't fit a register
+			DecodeRowsScalar( packedRows, rowCount, bitsPerIndex, palette, out );
+			return;
+		}
+
+		int8_t paddedPalette[16] = {};
+		// the palette may be shorter than 1 << bitsPerIndex, unused entries are never indexed
+		memcpy( paddedPalette, palette, paletteSize );
+		const __m128i paletteRegister = _mm_loadu_si128( reinterpret_cast<const __m128i*>( paddedPalette ) );
+
+		const uint32_t packedRowSize = VOXEL_CHUNK_SIZE * bitsPerIndex / 8;
+		for( uint32_t row = 0; row < rowCount; ++row )
+		{
+			__m128i low, high;
+			UnpackRowSse( packedRows + row * packedRowSize, bitsPerIndex, low, high );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( out + row * VOXEL_CHUNK_SIZE ), _mm_shuffle_epi8( paletteRegister, low ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( out + row * VOXEL_CHUNK_SIZE + 16 ), _mm_shuffle_epi8( paletteRegister, high ) );
+		}
+	}
+
+	__attribute__( ( target( "sse4.1" ) ) ) bool IsRowUniformSse41( const int8_t* row )
+	{
+		const __m128i first = _mm_set1_epi8( row[0] );
+		const __m128i equalLow = _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( row ) ), first );
+		const __m128i equalHigh = _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( row + 16 ) ), first );
+		return _mm_movemask_epi8( _mm_and_si128( equalLow, equalHigh ) ) == 0xFFFF;
+	}
+
+	// Packs two registers of byte elements holding `width` bits each into one register of 2 * width bits elements
+	__attribute__( ( target( "sse4.1" ) ) ) inline __m128i PackStepSse( __m128i low, __m128i high, int width )
+	{
+		const __m128i multipliers = _mm_set1_epi16( static_cast<int16_t>( 1 | ( ( 1 << width ) << 8 ) ) );
+		return _mm_packus_epi16( _mm_maddubs_epi16( low, multipliers ), _mm_maddubs_epi16( high, multipliers ) );
+	}
+
+	// Finishes packing a row whose first step (pairs of indices) is done: 16 bytes of 2 * bitsPerIndex bits elements
+	__attribute__( ( target( "sse4.1" ) ) ) inline void StorePackedRowSse( __m128i packed, uint32_t bitsPerIndex, uint8_t* packedRow )
+	{
+		const __m128i zero = _mm_setzero_si128();
+		if( bitsPerIndex == 4 )
+		{
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( packedRow ), packed );
+		}
+		else if( bitsPerIndex == 2 )
+		{
+			packed = PackStepSse( packed, zero, 4 );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( packedRow ), packed );
+		}
+		else
+		{
+			packed = PackStepSse( packed, zero, 2 );
+			packed = PackStepSse( packed, zero, 4 );
+			const int32_t packedBits = _mm_cvtsi128_si32( packed );
+			memcpy( packedRow, &packedBits, sizeof( packedBits ) );
+		}
+	}
+
+	__attribute__( ( target( "sse4.1" ) ) ) void PackRowSse41( const uint8_t* indices, uint32_t bitsPerIndex, uint8_t* packedRow )
+	{
+		if( bitsPerIndex == 8 )
+		{
+			memcpy( packedRow, indices, VOXEL_CHUNK_SIZE );
+			return;
+		}
+
+		const __m128i packed = PackStepSse(
+		  _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices ) ),
+		  _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices + 16 ) ),
+		  static_cast<int>( bitsPerIndex ) );
+		StorePackedRowSse( packed, bitsPerIndex, packedRow );
+	}
+
+	//-----------------------
+	// AVX2
+	// Same as SSE4.1 but two rows at a time, one per 128 bit lane, the lanes get reordered on store.
+	// Packing takes a whole row per register instead, its first step gets both halves done at once.
+
+	__attribute__( ( target( "avx2" ) ) ) inline void SplitAvx( __m256i packed, int shift, __m256i mask, __m256i& low, __m256i& high )
+	{
+		const __m256i lowHalves = _mm256_and_si256( packed, mask );
+		const __m256i highHalves = _mm256_and_si256( _mm256_srli_epi16( packed, shift ), mask );
+		low = _mm256_unpacklo_epi8( lowHalves, highHalves );
+		high = _mm256_unpackhi_epi8( lowHalves, highHalves );
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) void DecodeRowsAvx2( const uint8_t* packedRows, uint32_t rowCount, uint32_t bitsPerIndex, const int8_t* palette, size_t paletteSize, int8_t* out )
+	{
+		if( bitsPerIndex == 8 )
+		{
+			DecodeRowsScalar( packedRows, rowCount, bitsPerIndex, palette, out );
+			return;
+		}
+
+		int8_t paddedPalette[16] = {};
+		memcpy( paddedPalette, palette, paletteSize );
+		const __m256i paletteRegister = _mm256_broadcastsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( paddedPalette ) ) );
+		const __m256i nibbleMask = _mm256_set1_epi8( 0x0F );
+
+		const uint32_t packedRowSize = VOXEL_CHUNK_SIZE * bitsPerIndex / 8;
+		uint32_t row = 0;
+		for( ; row + 2 <= rowCount; row += 2 )
+		{
+			const uint8_t* packedRow = packedRows + row * packedRowSize;
+			__m256i low, high, unused;
+			if( bitsPerIndex == 4 )
+			{
+				SplitAvx( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( packedRow ) ), 4, nibbleMask, low, high );
+			}
+			else if( bitsPerIndex == 2 )
+			{
+				const __m256i packed = _mm256_inserti128_si256(
+				  _mm256_castsi128_si256( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( packedRow ) ) ),
+				  _mm_loadl_epi64( reinterpret_cast<const __m128i*>( packedRow + packedRowSize ) ),
+				  1 );
+				__m256i nibbles;
+				SplitAvx( packed, 4, nibbleMask, nibbles, unused );
+				SplitAvx( nibbles, 2, _mm256_set1_epi8( 0x03 ), low, high );
+			}
+			else
+			{
+				int32_t packedBits[2];
+				memcpy( packedBits, packedRow, sizeof( packedBits ) );
+				const __m256i packed = _mm256_inserti128_si256(
+				  _mm256_castsi128_si256( _mm_cvtsi32_si128( packedBits[0] ) ),
+				  _mm_cvtsi32_si128( packedBits[1] ),
+				  1 );
+				__m256i nibbles, pairs;
+				SplitAvx( packed, 4, nibbleMask, nibbles, unused );
+				SplitAvx( nibbles, 2, _mm256_set1_epi8( 0x03 ), pairs, unused );
+				SplitAvx( pairs, 1, _mm256_set1_epi8( 0x01 ), low, high );
+			}
+
+			low = _mm256_shuffle_epi8( paletteRegister, low );
+			high = _mm256_shuffle_epi8( paletteRegister, high );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( out + row * VOXEL_CHUNK_SIZE ), _mm256_permute2x128_si256( low, high, 0x20 ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( out + ( row + 1 ) * VOXEL_CHUNK_SIZE ), _mm256_permute2x128_si256( low, high, 0x31 ) );
+		}
+
+		if( row < rowCount )
+		{
+			DecodeRowsSse41( packedRows + row * packedRowSize, rowCount - row, bitsPerIndex, palette, paletteSize, out + row * VOXEL_CHUNK_SIZE );
+		}
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) bool IsRowUniformAvx2( const int8_t* row )
+	{
+		const __m256i equal = _mm256_cmpeq_epi8( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( row ) ), _mm256_set1_epi8( row[0] ) );
+		return _mm256_movemask_epi8( equal ) == -1;
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) void PackRowAvx2( const uint8_t* indices, uint32_t bitsPerIndex, uint8_t* packedRow )
+	{
+		if( bitsPerIndex == 8 )
+		{
+			memcpy( packedRow, indices, VOXEL_CHUNK_SIZE );
+			return;
+		}
+
+		const __m256i multipliers = _mm256_set1_epi16( static_cast<int16_t>( 1 | ( ( 1 << bitsPerIndex ) << 8 ) ) );
+		const __m256i pairs = _mm256_maddubs_epi16( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( indices ) ), multipliers );
+		// packus works per lane, each lane's 8 bytes land in its low half: gather qwords 0 & 2
+		const __m256i packedLanes = _mm256_packus_epi16( pairs, pairs );
+		StorePackedRowSse( _mm256_castsi256_si128( _mm256_permute4x64_epi64( packedLanes, 0x08 ) ), bitsPerIndex, packedRow );
+	}
+
+	// Palettes of up to 16 entries: a compare per entry over the whole row rather than a table lookup per voxel
+	__attribute__( ( target( "avx2" ) ) ) void MapRowIndicesAvx2( const int8_t* rowVoxels, const int8_t* palette, size_t paletteSize, uint8_t* rowIndices )
+	{
+		const __m256i voxels = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( rowVoxels ) );
+		__m256i indices = _mm256_setzero_si256();
+		for( size_t paletteIndex = 1; paletteIndex < paletteSize; ++paletteIndex )
+		{
+			const __m256i isEntry = _mm256_cmpeq_epi8( voxels, _mm256_set1_epi8( palette[paletteIndex] ) );
+			indices = _mm256_or_si256( indices, _mm256_and_si256( isEntry, _mm256_set1_epi8( static_cast<char>( paletteIndex ) ) ) );
+		}
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( rowIndices ), indices );
+	}
+#endif // ASTRO_X86_SIMD
+
+	bool IsRowUniform( const int8_t* row )
+	{
+#ifdef ASTRO_X86_SIMD
+		switch( Selected_Simd_Path )
+		{
+		case SimdPath::Avx2:
+			return IsRowUniformAvx2( row );
+		case SimdPath::Sse41:
+			return IsRowUniformSse41( row );
+		case SimdPath::Scalar:
+			break;
+		}
+#endif
+		return IsRowUniformScalar( row );
+	}
+
+	void PackRow( const uint8_t* indices, uint32_t bitsPerIndex, uint8_t* packedRow )
+	{
+#ifdef ASTRO_X86_SIMD
+		switch( Selected_Simd_Path )
+		{
+		case SimdPath::Avx2:
+			PackRowAvx2( indices, bitsPerIndex, packedRow );
+			return;
+		case SimdPath::Sse41:
+			PackRowSse41( indices, bitsPerIndex, packedRow );
+			return;
+		case SimdPath::Scalar:
+			break;
+		}
+#endif
+		PackRowScalar( indices, bitsPerIndex, packedRow );
+	}
+
+	void MapRowIndices( const int8_t* rowVoxels, const uint8_t* paletteIndices, const std::vector<int8_t>& palette, uint8_t* rowIndices )
+	{
+#ifdef ASTRO_X86_SIMD
+		if( Selected_Simd_Path == SimdPath::Avx2 && palette.size() <= 16 )
+		{
+			MapRowIndicesAvx2( rowVoxels, palette.data(), palette.size(), rowIndices );
+			return;
+		}
+#endif
+		for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+		{
+			rowIndices[x] = paletteIndices[static_cast<uint8_t>( rowVoxels[x] )];
+		}
+	}
+
+	void DecodeRows( const uint8_t* packedRows, uint32_t rowCount, uint32_t bitsPerIndex, const int8_t* palette, size_t paletteSize, int8_t* out )
+	{
+#ifdef ASTRO_X86_SIMD
+		switch( Selected_Simd_Path )
+		{
+		case SimdPath::Avx2:
+			DecodeRowsAvx2( packedRows, rowCount, bitsPerIndex, palette, paletteSize, out );
+			return;
+		case SimdPath::Sse41:
+			DecodeRowsSse41( packedRows, rowCount, bitsPerIndex, palette, paletteSize, out );
+			return;
+		case SimdPath::Scalar:
+			break;
+		}
+#endif
+		DecodeRowsScalar( packedRows, rowCount, bitsPerIndex, palette, out );
+	}
+} // namespace
+
+CompressedVoxelChunk CompressedVoxelChunk::Encode( const int8_t* denseVoxels )
+{
+	CompressedVoxelChunk chunk;
+
+	// Build the palette, paletteIndices maps a voxel value (as uint8_t) to its palette index
+	uint8_t paletteIndices[256];
+	bool isInPalette[256] = {};
+	for( int32_t i = 0; i < VOXEL_CHUNK_VOXEL_COUNT; ++i )
+	{
+		const uint8_t key = static_cast<uint8_t>( denseVoxels[i] );
+		if( !isInPalette[key] )
+		{
+			isInPalette[key] = true;
+			paletteIndices[key] = static_cast<uint8_t>( chunk.m_palette.size() );
+			chunk.m_palette.push_back( denseVoxels[i] );
+		}
+	}
+	chunk.m_bitsPerIndex = BitsPerIndexForPaletteSize( chunk.m_palette.size() );
+
+	const uint32_t packedRowSize = chunk.GetPackedRowSize();
+	uint8_t rowIndices[VOXEL_CHUNK_SIZE];
+	for( int32_t row = 0; row < VOXEL_CHUNK_ROW_COUNT; ++row )
+	{
+		const int8_t* rowVoxels = denseVoxels + row * VOXEL_CHUNK_SIZE;
+		const bool isUniform = chunk.m_bitsPerIndex == 0 || IsRowUniform( rowVoxels );
+		const uint16_t paletteIndex = paletteIndices[static_cast<uint8_t>( rowVoxels[0] )];
+
+		// Extend the previous span if it's the same kind (and the same value for uniform runs)
+		Span* previousSpan = chunk.m_spans.empty() ? nullptr : &chunk.m_spans.back();
+		if( previousSpan != nullptr && previousSpan->isUniform == isUniform && ( !isUniform || previousSpan->value == paletteIndex ) )
+		{
+			++previousSpan->rowCount;
+		}
+		else
+		{
+			const uint16_t packedRowIndex = static_cast<uint16_t>( packedRowSize > 0 ? chunk.m_packedRows.size() / packedRowSize : 0 );
+			chunk.m_spans.push_back( Span{ static_cast<uint16_t>( row ), 1, isUniform, isUniform ? paletteIndex : packedRowIndex } );
+		}
+
+		if( !isUniform )
+		{
+			MapRowIndices( rowVoxels, paletteIndices, chunk.m_palette, rowIndices );
+			chunk.m_packedRows.resize( chunk.m_packedRows.size() + packedRowSize );
+			PackRow( rowIndices, chunk.m_bitsPerIndex, chunk.m_packedRows.data() + chunk.m_packedRows.size() - packedRowSize );
+		}
+	}
+
+	chunk.m_palette.shrink_to_fit();
+	chunk.m_spans.shrink_to_fit();
+	chunk.m_packedRows.shrink_to_fit();
+	return chunk;
+}
+
+void CompressedVoxelChunk::Decode( int8_t* denseVoxels ) const
+{
+	const uint32_t packedRowSize = GetPackedRowSize();
+	for( const auto& span : m_spans )
+	{
+		int8_t* out = denseVoxels + span.firstRow * VOXEL_CHUNK_SIZE;
+		if( span.isUniform )
+		{
+			memset( out, m_palette[span.value], static_cast<size_t>( span.rowCount ) * VOXEL_CHUNK_SIZE );
+		}
+		else
+		{
+			DecodeRows( m_packedRows.data() + span.value * packedRowSize, span.rowCount, m_bitsPerIndex, m_palette.data(), m_palette.size(), out );
+		}
+	}
+}
+
+int8_t CompressedVoxelChunk::Get( const glm::ivec3& position ) const
+{
+	if( static_cast<uint32_t>( position.x ) >= VOXEL_CHUNK_SIZE
+		|| static_cast<uint32_t>( position.y ) >= VOXEL_CHUNK_SIZE
+		|| static_cast<uint32_t>( position.z ) >= VOXEL_CHUNK_SIZE )
+	{
+		return 0;
+	}
+
+	const uint32_t row = static_cast<uint32_t>( position.z * VOXEL_CHUNK_SIZE + position.y );
+	const auto span = std::upper_bound( m_spans.begin(), m_spans.end(), row, []( uint32_t value, const Span& s ) {
+		return value < s.firstRow;
+	} ) - 1;
+
+	if( span->isUniform )
+	{
+		return m_palette[span->value];
+	}
+
+	const uint8_t* packedRow = m_packedRows.data() + ( span->value + row - span->firstRow ) * GetPackedRowSize();
+	const uint32_t bitOffset = static_cast<uint32_t>( position.x ) * m_bitsPerIndex;
+	return m_palette[( packedRow[bitOffset / 8] >> ( bitOffset % 8 ) ) & ( ( 1u << m_bitsPerIndex ) - 1 )];
+}
+
+size_t CompressedVoxelChunk::GetMemoryFootprint() const
+{
+	return sizeof( CompressedVoxelChunk )
+		   + m_palette.capacity() * sizeof( int8_t )
+		   + m_spans.capacity() * sizeof( Span )
+		   + m_packedRows.capacity();
+}
+
+CompressedVoxelChunk::SimdPath CompressedVoxelChunk::GetSimdPath()
+{
+	return Selected_Simd_Path;
+}
+
+void CompressedVoxelChunk::SetSimdPath( SimdPath simdPath )
+{
+	// Never go above what the CPU supports
+	Selected_Simd_Path = std::min( simdPath, DetectSimdPath() );
+}
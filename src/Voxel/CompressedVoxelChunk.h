@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Voxel/VoxelConstants.h>
+
+//-----------------------
+// Palette + run length compressed chunk.
+// Voxel values are replaced by indices into a per-chunk palette, bit packed at 1, 2, 4 or 8 bits.
+// Rows are then grouped in spans: consecutive uniform rows holding the same value are stored as a single run,
+// only rows with mixed content keep their packed indices.
+// Read only: voxels can be read in place (Get) or decoded to a dense scratch chunk (Decode).
+
+class CompressedVoxelChunk
+{
+  public:
+	enum class SimdPath
+	{
+		Scalar,
+		Sse41,
+		Avx2
+	};
+
+	// denseVoxels holds VOXEL_CHUNK_VOXEL_COUNT voxels, see VoxelChunkIndex
+	static CompressedVoxelChunk Encode( const int8_t* denseVoxels );
+	void Decode( int8_t* denseVoxels ) const;
+
+	int8_t Get( const glm::ivec3& position ) const;
+
+	uint32_t GetBitsPerIndex() const { return m_bitsPerIndex; }
+	size_t GetPaletteSize() const { return m_palette.size(); }
+	size_t GetMemoryFootprint() const;
+
+	// Best path the CPU supports by default, can be lowered to compare paths
+	static SimdPath GetSimdPath();
+	static void SetSimdPath( SimdPath simdPath );
+
+  private:
+	struct Span
+	{
+		uint16_t firstRow;
+		uint16_t rowCount;
+		uint16_t isUniform;
+		uint16_t value; // palette index when uniform, otherwise index of the first packed row
+	};
+
+	uint32_t GetPackedRowSize() const { return VOXEL_CHUNK_SIZE * m_bitsPerIndex / 8; }
+
+	std::vector<int8_t> m_palette;
+	std::vector<Span> m_spans; // sorted by firstRow, covering all VOXEL_CHUNK_ROW_COUNT rows
+	std::vector<uint8_t> m_packedRows;
+	uint32_t m_bitsPerIndex = 0;
+};
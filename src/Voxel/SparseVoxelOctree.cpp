@@ -0,0 +1,334 @@
+#include <Voxel/SparseVoxelOctree.h>
+
+#include <cstring>
+#include <stdexcept>
+
+SparseVoxelOctree::SparseVoxelOctree( uint32_t size )
+  : m_nodes{}
+  , m_freeBlocks{}
+  , m_size( size )
+{
+	if( size == 0 || ( size & ( size - 1 ) ) != 0 )
+	{
+		throw std::runtime_error( "sparse voxel octree size must be a power of two!" );
+	}
+
+	Clear();
+}
+
+int8_t SparseVoxelOctree::Get( const glm::ivec3& position ) const
+{
+	if( !IsInBounds( position ) )
+	{
+		return 0;
+	}
+
+	const Node* nodes = GetNodes();
+	uint32_t nodeIndex = 0;
+	uint32_t half = m_size >> 1;
+	while( nodes[nodeIndex].firstChild != 0 )
+	{
+		const uint32_t octant = ( ( position.x & half ) ? 1u : 0u )
+								| ( ( position.y & half ) ? 2u : 0u )
+								| ( ( position.z & half ) ? 4u : 0u );
+		nodeIndex = nodes[nodeIndex].firstChild + octant;
+		half >>= 1;
+	}
+
+	return nodes[nodeIndex].value;
+}
+
+void SparseVoxelOctree::Set( const glm::ivec3& position, int8_t value )
+{
+	if( !IsInBounds( position ) )
+	{
+		return;
+	}
+
+	MakeNodesOwned();
+
+	// Walk down to the unit voxel, splitting uniform leaves on the way, then collapse back up
+	uint32_t path[32];
+	uint32_t depth = 0;
+
+	uint32_t nodeIndex = 0;
+	uint32_t half = m_size >> 1;
+	while( half > 0 )
+	{
+		if( m_nodes[nodeIndex].firstChild == 0 )
+		{
+			if( m_nodes[nodeIndex].value == value )
+			{
+				// Already holds the value, nothing to do
+				return;
+			}
+			Split( nodeIndex );
+		}
+
+		path[depth++] = nodeIndex;
+
+		const uint32_t octant = ( ( position.x & half ) ? 1u : 0u )
+								| ( ( position.y & half ) ? 2u : 0u )
+								| ( ( position.z & half ) ? 4u : 0u );
+		nodeIndex = m_nodes[nodeIndex].firstChild + octant;
+		half >>= 1;
+	}
+
+	m_nodes[nodeIndex].value = value;
+
+	while( depth > 0 )
+	{
+		TryCollapse( path[--depth] );
+	}
+}
+
+void SparseVoxelOctree::FillRegion( const glm::ivec3& min, const glm::ivec3& max, int8_t value )
+{
+	const glm::ivec3 clampedMin = glm::max( min, glm::ivec3( 0 ) );
+	const glm::ivec3 clampedMax = glm::min( max, glm::ivec3( static_cast<int>( m_size ) ) );
+	if( glm::any( glm::greaterThanEqual( clampedMin, clampedMax ) ) )
+	{
+		return;
+	}
+
+	MakeNodesOwned();
+	FillNode( 0, glm::ivec3( 0 ), m_size, clampedMin, clampedMax, value );
+}
+
+void SparseVoxelOctree::Clear()
+{
+	m_nodes.clear();
+	m_freeBlocks.clear();
+	m_externalNodes = nullptr;
+	m_externalNodeCount = 0;
+	m_nodes.push_back( Node{ 0, 0 } );
+}
+
+void SparseVoxelOctree::SetFromDense( const int8_t* denseVoxels )
+{
+	Clear();
+	BuildFromDense( 0, glm::ivec3( 0 ), m_size, denseVoxels );
+}
+
+void SparseVoxelOctree::CopyToDense( int8_t* denseVoxels ) const
+{
+	memset( denseVoxels, 0, static_cast<size_t>( m_size ) * m_size * m_size );
+
+	const size_t size = m_size;
+	ForEachNonEmptyNode( [denseVoxels, size]( const glm::ivec3& origin, uint32_t nodeSize, int8_t value ) {
+		for( size_t z = origin.z; z < origin.z + nodeSize; ++z )
+		{
+			for( size_t y = origin.y; y < origin.y + nodeSize; ++y )
+			{
+				memset( denseVoxels + ( z * size + y ) * size + origin.x, value, nodeSize );
+			}
+		}
+	} );
+}
+
+std::vector<SparseVoxelOctree::Node> SparseVoxelOctree::GetCompactNodes() const
+{
+	const Node* nodes = GetNodes();
+
+	// Breadth first: copy each node, then append its children as a new contiguous block
+	std::vector<Node> compactNodes;
+	compactNodes.reserve( GetNodeCount() );
+	compactNodes.push_back( Node{ 0, nodes[0].value } );
+
+	std::vector<uint32_t> sourceIndices{ 0 };
+	for( size_t i = 0; i < sourceIndices.size(); ++i )
+	{
+		const uint32_t firstChild = nodes[sourceIndices[i]].firstChild;
+		if( firstChild == 0 )
+		{
+			continue;
+		}
+
+		compactNodes[i].firstChild = static_cast<uint32_t>( compactNodes.size() );
+		for( uint32_t octant = 0; octant < 8; ++octant )
+		{
+			compactNodes.push_back( Node{ 0, nodes[firstChild + octant].value } );
+			sourceIndices.push_back( firstChild + octant );
+		}
+	}
+
+	return compactNodes;
+}
+
+bool SparseVoxelOctree::ValidateCompactNodes( const Node* nodes, size_t nodeCount )
+{
+	if( nodeCount == 0 || ( nodeCount - 1 ) % 8 != 0 )
+	{
+		return false;
+	}
+
+	// Children strictly after their parent means every traversal terminates & stays in bounds
+	for( size_t i = 0; i < nodeCount; ++i )
+	{
+		const uint32_t firstChild = nodes[i].firstChild;
+		if( firstChild != 0 && ( firstChild <= i || static_cast<size_t>( firstChild ) + 8 > nodeCount ) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SparseVoxelOctree::SetExternalNodes( const Node* nodes, size_t nodeCount )
+{
+	m_nodes.clear();
+	m_nodes.shrink_to_fit();
+	m_freeBlocks.clear();
+	m_externalNodes = nodes;
+	m_externalNodeCount = nodeCount;
+}
+
+void SparseVoxelOctree::MakeNodesOwned()
+{
+	if( m_externalNodes == nullptr )
+	{
+		return;
+	}
+
+	m_nodes.assign( m_externalNodes, m_externalNodes + m_externalNodeCount );
+	m_externalNodes = nullptr;
+	m_externalNodeCount = 0;
+}
+
+size_t SparseVoxelOctree::GetMemoryFootprint() const
+{
+	return sizeof( SparseVoxelOctree )
+		   + m_nodes.capacity() * sizeof( Node )
+		   + m_freeBlocks.capacity() * sizeof( uint32_t );
+}
+
+bool SparseVoxelOctree::IsInBounds( const glm::ivec3& position ) const
+{
+	return static_cast<uint32_t>( position.x ) < m_size
+		   && static_cast<uint32_t>( position.y ) < m_size
+		   && static_cast<uint32_t>( position.z ) < m_size;
+}
+
+uint32_t SparseVoxelOctree::AllocateChildren( int8_t value )
+{
+	uint32_t firstChild;
+	if( !m_freeBlocks.empty() )
+	{
+		firstChild = m_freeBlocks.back();
+		m_freeBlocks.pop_back();
+	}
+	else
+	{
+		firstChild = static_cast<uint32_t>( m_nodes.size() );
+		m_nodes.resize( m_nodes.size() + 8 );
+	}
+
+	for( uint32_t i = 0; i < 8; ++i )
+	{
+		m_nodes[firstChild + i] = Node{ 0, value };
+	}
+
+	return firstChild;
+}
+
+void SparseVoxelOctree::FreeChildren( uint32_t nodeIndex )
+{
+	const uint32_t firstChild = m_nodes[nodeIndex].firstChild;
+	if( firstChild == 0 )
+	{
+		return;
+	}
+
+	for( uint32_t i = 0; i < 8; ++i )
+	{
+		FreeChildren( firstChild + i );
+	}
+
+	m_freeBlocks.push_back( firstChild );
+	m_nodes[nodeIndex].firstChild = 0;
+}
+
+void SparseVoxelOctree::Split( uint32_t nodeIndex )
+{
+	// Note: AllocateChildren can grow m_nodes, don't hold a reference across it
+	const uint32_t firstChild = AllocateChildren( m_nodes[nodeIndex].value );
+	m_nodes[nodeIndex].firstChild = firstChild;
+}
+
+void SparseVoxelOctree::TryCollapse( uint32_t nodeIndex )
+{
+	const uint32_t firstChild = m_nodes[nodeIndex].firstChild;
+	if( firstChild == 0 )
+	{
+		return;
+	}
+
+	const int8_t value = m_nodes[firstChild].value;
+	for( uint32_t i = 0; i < 8; ++i )
+	{
+		const Node& child = m_nodes[firstChild + i];
+		if( child.firstChild != 0 || child.value != value )
+		{
+			return;
+		}
+	}
+
+	m_freeBlocks.push_back( firstChild );
+	m_nodes[nodeIndex] = Node{ 0, value };
+}
+
+void SparseVoxelOctree::BuildFromDense( uint32_t nodeIndex, const glm::ivec3& origin, uint32_t size, const int8_t* denseVoxels )
+{
+	if( size == 1 )
+	{
+		m_nodes[nodeIndex].value = denseVoxels[( static_cast<size_t>( origin.z ) * m_size + origin.y ) * m_size + origin.x];
+		return;
+	}
+
+	// Build children first, then collapse if they all turned out uniform with the same value
+	Split( nodeIndex );
+	const uint32_t childSize = size >> 1;
+	for( uint32_t octant = 0; octant < 8; ++octant )
+	{
+		BuildFromDense( m_nodes[nodeIndex].firstChild + octant, ChildOrigin( origin, childSize, octant ), childSize, denseVoxels );
+	}
+
+	TryCollapse( nodeIndex );
+}
+
+void SparseVoxelOctree::FillNode( uint32_t nodeIndex, const glm::ivec3& origin, uint32_t size, const glm::ivec3& min, const glm::ivec3& max, int8_t value )
+{
+	const glm::ivec3 end = origin + glm::ivec3( static_cast<int>( size ) );
+
+	// No overlap
+	if( glm::any( glm::greaterThanEqual( origin, max ) ) || glm::any( glm::lessThanEqual( end, min ) ) )
+	{
+		return;
+	}
+
+	// Node fully covered, replace whatever was below it
+	if( glm::all( glm::greaterThanEqual( origin, min ) ) && glm::all( glm::lessThanEqual( end, max ) ) )
+	{
+		FreeChildren( nodeIndex );
+		m_nodes[nodeIndex].value = value;
+		return;
+	}
+
+	if( m_nodes[nodeIndex].firstChild == 0 )
+	{
+		if( m_nodes[nodeIndex].value == value )
+		{
+			return;
+		}
+		Split( nodeIndex );
+	}
+
+	const uint32_t childSize = size >> 1;
+	for( uint32_t octant = 0; octant < 8; ++octant )
+	{
+		FillNode( m_nodes[nodeIndex].firstChild + octant, ChildOrigin( origin, childSize, octant ), childSize, min, max, value );
+	}
+
+	TryCollapse( nodeIndex );
+}
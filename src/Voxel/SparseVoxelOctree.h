@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//-----------------------
+// Sparse voxel octree
+// Stores one int8_t material per voxel, 0 meaning empty.
+// Nodes whose whole volume holds the same value are collapsed into a single leaf,
+// so large empty (or large solid) areas only cost one node.
+
+class SparseVoxelOctree
+{
+  public:
+	struct Node
+	{
+		// Index of the first of 8 contiguous children, 0 means this node is a leaf
+		// (the root lives at index 0 so it can never be somebody's child)
+		uint32_t firstChild;
+		// Value of the whole node when it's a leaf
+		int8_t value;
+		uint8_t padding[3];
+	};
+	static_assert( sizeof( Node ) == 8, "octree nodes are serialised as is, keep them 8 bytes" );
+
+	// size must be a power of two, the octree covers [0, size) on each axis
+	explicit SparseVoxelOctree( uint32_t size );
+
+	int8_t Get( const glm::ivec3& position ) const;
+	void Set( const glm::ivec3& position, int8_t value );
+
+	// Fills the box [min, max) with value, out of bounds parts are ignored
+	void FillRegion( const glm::ivec3& min, const glm::ivec3& max, int8_t value );
+	void Clear();
+
+	// Dense arrays hold size^3 voxels, x fastest, then y, then z
+	void SetFromDense( const int8_t* denseVoxels );
+	void CopyToDense( int8_t* denseVoxels ) const;
+
+	// Calls callback( const glm::ivec3& origin, uint32_t size, int8_t value ) for every non-empty uniform cube
+	template<typename Callback>
+	void ForEachNonEmptyNode( Callback&& callback ) const;
+
+	// Calls callback( const glm::ivec3& position, int8_t value ) for every non-empty voxel
+	template<typename Callback>
+	void ForEachNonEmpty( Callback&& callback ) const;
+
+	uint32_t GetSize() const { return m_size; }
+	size_t GetNodeCount() const { return m_externalNodes != nullptr ? m_externalNodeCount : m_nodes.size() - m_freeBlocks.size() * 8; }
+	size_t GetMemoryFootprint() const;
+
+	// Nodes in breadth first order without any released blocks, children always come after their parent
+	std::vector<Node> GetCompactNodes() const;
+	// Checks that compact nodes (as returned by GetCompactNodes) can be traversed safely
+	static bool ValidateCompactNodes( const Node* nodes, size_t nodeCount );
+
+	// Reads straight from externally owned compact nodes (eg: a memory mapped scene file), without copying them.
+	// The nodes must outlive this octree or the next modification, which copies them into owned memory first.
+	void SetExternalNodes( const Node* nodes, size_t nodeCount );
+	bool HasExternalNodes() const { return m_externalNodes != nullptr; }
+
+  private:
+	const Node* GetNodes() const { return m_externalNodes != nullptr ? m_externalNodes : m_nodes.data(); }
+	void MakeNodesOwned();
+
+	bool IsInBounds( const glm::ivec3& position ) const;
+
+	uint32_t AllocateChildren( int8_t value );
+	void FreeChildren( uint32_t nodeIndex );
+	void Split( uint32_t nodeIndex );
+	void TryCollapse( uint32_t nodeIndex );
+
+	void BuildFromDense( uint32_t nodeIndex, const glm::ivec3& origin, uint32_t size, const int8_t* denseVoxels );
+	void FillNode( uint32_t nodeIndex, const glm::ivec3& origin, uint32_t size, const glm::ivec3& min, const glm::ivec3& max, int8_t value );
+
+	template<typename Callback>
+	void VisitNonEmptyNode( uint32_t nodeIndex, const glm::ivec3& origin, uint32_t size, Callback& callback ) const;
+
+	static glm::ivec3 ChildOrigin( const glm::ivec3& origin, uint32_t childSize, uint32_t octant )
+	{
+		return origin + glm::ivec3( octant & 1, ( octant >> 1 ) & 1, ( octant >> 2 ) & 1 ) * static_cast<int>( childSize );
+	}
+
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_freeBlocks; // first child index of released blocks of 8, reused before growing m_nodes
+	const Node* m_externalNodes = nullptr;
+	size_t m_externalNodeCount = 0;
+	uint32_t m_size;
+};
+
+//-----------------------
+
+template<typename Callback>
+void SparseVoxelOctree::ForEachNonEmptyNode( Callback&& callback ) const
+{
+	VisitNonEmptyNode( 0, glm::ivec3( 0 ), m_size, callback );
+}
+
+template<typename Callback>
+void SparseVoxelOctree::ForEachNonEmpty( Callback&& callback ) const
+{
+	ForEachNonEmptyNode( [&callback]( const glm::ivec3& origin, uint32_t size, int8_t value ) {
+		const glm::ivec3 end = origin + glm::ivec3( static_cast<int>( size ) );
+		for( int z = origin.z; z < end.z; ++z )
+		{
+			for( int y = origin.y; y < end.y; ++y )
+			{
+				for( int x = origin.x; x < end.x; ++x )
+				{
+					callback( glm::ivec3( x, y, z ), value );
+				}
+			}
+		}
+	} );
+}
+
+template<typename Callback>
+void SparseVoxelOctree::VisitNonEmptyNode( uint32_t nodeIndex, const glm::ivec3& origin, uint32_t size, Callback& callback ) const
+{
+	const Node& node = GetNodes()[nodeIndex];
+	if( node.firstChild == 0 )
+	{
+		if( node.value != 0 )
+		{
+			callback( origin, size, node.value );
+		}
+		return;
+	}
+
+	const uint32_t childSize = size >> 1;
+	for( uint32_t octant = 0; octant < 8; ++octant )
+	{
+		VisitNonEmptyNode( node.firstChild + octant, ChildOrigin( origin, childSize, octant ), childSize, callback );
+	}
+}
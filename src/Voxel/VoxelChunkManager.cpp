@@ -0,0 +1,319 @@
+#include <Voxel/VoxelChunkManager.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Jobs/JobSystem.h>
+#include <Voxel/VoxelLodSelector.h>
+
+// Bounds the hitch when the viewpoint jumps, the rest gets streamed in over the next frames
+constexpr uint32_t MAX_CHUNK_LOADS_PER_UPDATE = 32;
+// Chunks are only unloaded a bit past the view distance so moving back and forth on a chunk border doesn't reload them
+constexpr float UNLOAD_DISTANCE_MARGIN = static_cast<float>( VOXEL_CHUNK_SIZE );
+// Close chunks stay as octrees, they're the ones likely to be edited
+constexpr float DEFAULT_COMPRESS_DISTANCE = 2.0f * VOXEL_CHUNK_SIZE;
+// Same for detail: chunks only drop it a bit past the LOD distances, so they don't get reloaded right after
+constexpr float LOD_DISTANCE_MARGIN = static_cast<float>( VOXEL_CHUNK_SIZE );
+
+VoxelChunkManager::VoxelChunkManager( size_t residentMemoryBudget, float viewDistance )
+  : m_chunks{}
+  , m_chunkLoader{}
+  , m_residentMemoryBudget( residentMemoryBudget )
+  , m_viewDistance( viewDistance )
+  , m_compressDistance( DEFAULT_COMPRESS_DISTANCE )
+{
+}
+
+void VoxelChunkManager::Update( const glm::vec3& viewpoint )
+{
+	m_viewpoint = viewpoint;
+
+	// Drop everything out of range, compress & coarsen what's far enough.
+	// Coarsened chunks that came closer are load candidates again, to get their detail back.
+	m_loadCandidates.clear();
+	const float unloadDistance = m_viewDistance + UNLOAD_DISTANCE_MARGIN;
+	for( auto it = m_chunks.begin(); it != m_chunks.end(); )
+	{
+		auto current = it++;
+		if( DistanceToChunk( current->first ) > unloadDistance )
+		{
+			UnloadChunk( current );
+			continue;
+		}
+
+		UpdateResidentChunk( current->first, current->second );
+		const VoxelObject* voxelObject = current->second.voxelObject.get();
+		if( voxelObject != nullptr && voxelObject->GetFinestLod() > SelectLod( current->first, 0.0f ) )
+		{
+			m_loadCandidates.push_back( current->first );
+		}
+	}
+
+	// Chunks grow with edits & decompression, give back what went over the budget
+	if( m_residentMemory > m_residentMemoryBudget )
+	{
+		EvictFartherChunks( -1.0f );
+	}
+
+	if( !m_chunkLoader )
+	{
+		return;
+	}
+
+	// Gather missing chunks in range, nearest first
+	const glm::ivec3 viewChunk = WorldToChunkCoord( viewpoint );
+	const int32_t chunkRadius = static_cast<int32_t>( std::ceil( m_viewDistance / VOXEL_CHUNK_SIZE ) );
+
+	for( int32_t z = -chunkRadius; z <= chunkRadius; ++z )
+	{
+		for( int32_t y = -chunkRadius; y <= chunkRadius; ++y )
+		{
+			for( int32_t x = -chunkRadius; x <= chunkRadius; ++x )
+			{
+				const glm::ivec3 chunkCoord = viewChunk + glm::ivec3( x, y, z );
+				if( DistanceToChunk( chunkCoord ) <= m_viewDistance && m_chunks.find( chunkCoord ) == m_chunks.end() )
+				{
+					m_loadCandidates.push_back( chunkCoord );
+				}
+			}
+		}
+	}
+
+	std::sort( m_loadCandidates.begin(), m_loadCandidates.end(), [this]( const glm::ivec3& a, const glm::ivec3& b ) {
+		return DistanceToChunk( a ) < DistanceToChunk( b );
+	} );
+
+	if( m_loadCandidates.empty() )
+	{
+		return;
+	}
+
+	// The last candidate that didn't fit still wouldn't and there's nothing farther to make room with: don't bother loading anything
+	if( m_residentMemory + m_droppedFootprint > m_residentMemoryBudget && FindFarthestChunk( DistanceToChunk( m_loadCandidates.front() ) ) == m_chunks.end() )
+	{
+		return;
+	}
+	m_droppedFootprint = 0;
+
+	// Load the nearest candidates all at once, loaders only read shared data so they can run in parallel.
+	// Chunks are resident with their occupancy, raycasts & the mesher rely on it. Far ones get coarsened right away.
+	const size_t loadCount = std::min<size_t>( m_loadCandidates.size(), MAX_CHUNK_LOADS_PER_UPDATE );
+	m_loadedChunks.clear();
+	m_loadedChunks.resize( loadCount );
+	auto loadChunk = [this]( size_t index ) {
+		m_loadedChunks[index] = m_chunkLoader( m_loadCandidates[index] );
+		if( m_loadedChunks[index] )
+		{
+			m_loadedChunks[index]->UpdateOccupancy();
+			m_loadedChunks[index]->Coarsen( SelectLod( m_loadCandidates[index], -LOD_DISTANCE_MARGIN ) );
+		}
+	};
+
+	if( m_jobSystem != nullptr )
+	{
+		m_jobSystem->ParallelFor( loadCount, 1, loadChunk );
+	}
+	else
+	{
+		for( size_t i = 0; i < loadCount; ++i )
+		{
+			loadChunk( i );
+		}
+	}
+
+	for( size_t i = 0; i < loadCount; ++i )
+	{
+		const glm::ivec3& chunkCoord = m_loadCandidates[i];
+		ResidentChunk residentChunk{ std::move( m_loadedChunks[i] ), 0 };
+		UpdateResidentChunk( chunkCoord, residentChunk );
+
+		// Coarsened chunks getting their detail back replace the resident one
+		auto replacedChunk = m_chunks.find( chunkCoord );
+		const size_t replacedFootprint = replacedChunk != m_chunks.end() ? replacedChunk->second.memoryFootprint : 0;
+		m_residentMemory -= replacedFootprint;
+
+		// Doesn't fit: only make room with chunks farther than the candidate, otherwise we're done
+		if( m_residentMemory > m_residentMemoryBudget && !EvictFartherChunks( DistanceToChunk( chunkCoord ) ) )
+		{
+			m_residentMemory += replacedFootprint;
+			m_residentMemory -= residentChunk.memoryFootprint;
+			m_droppedFootprint = residentChunk.memoryFootprint;
+			break;
+		}
+
+		const bool isEmpty = residentChunk.voxelObject == nullptr;
+		if( replacedChunk != m_chunks.end() )
+		{
+			replacedChunk->second = std::move( residentChunk );
+		}
+		else
+		{
+			m_chunks.emplace( chunkCoord, std::move( residentChunk ) );
+		}
+		if( !isEmpty )
+		{
+			MarkNeighbourMeshesDirty( chunkCoord );
+		}
+	}
+
+	// Chunks that didn't fit get dropped, they'll be loaded again once there's room
+	m_loadedChunks.clear();
+}
+
+void VoxelChunkManager::UnloadAll()
+{
+	m_chunks.clear();
+	m_residentMemory = 0;
+}
+
+VoxelObject* VoxelChunkManager::FindChunk( const glm::ivec3& chunkCoord )
+{
+	auto it = m_chunks.find( chunkCoord );
+	return it != m_chunks.end() ? it->second.voxelObject.get() : nullptr;
+}
+
+const VoxelObject* VoxelChunkManager::FindChunk( const glm::ivec3& chunkCoord ) const
+{
+	auto it = m_chunks.find( chunkCoord );
+	return it != m_chunks.end() ? it->second.voxelObject.get() : nullptr;
+}
+
+VoxelObject* VoxelChunkManager::FindOrCreateChunk( const glm::ivec3& chunkCoord )
+{
+	auto it = m_chunks.find( chunkCoord );
+	if( it == m_chunks.end() )
+	{
+		return nullptr;
+	}
+
+	if( !it->second.voxelObject )
+	{
+		it->second.voxelObject = std::make_unique<VoxelObject>( ChunkCoordToWorld( chunkCoord ), VOXEL_CHUNK_SIZE );
+	}
+	return it->second.voxelObject.get();
+}
+
+void VoxelChunkManager::FindNeighbours( const glm::ivec3& chunkCoord, const VoxelObject* neighbours[6] ) const
+{
+	for( uint32_t faceDirection = 0; faceDirection < 6; ++faceDirection )
+	{
+		glm::ivec3 offset( 0 );
+		offset[faceDirection / 2] = ( faceDirection % 2 ) == 0 ? 1 : -1;
+		neighbours[faceDirection] = FindChunk( chunkCoord + offset );
+	}
+}
+
+glm::ivec3 VoxelChunkManager::WorldToChunkCoord( const glm::vec3& worldPosition )
+{
+	return glm::ivec3( glm::floor( worldPosition / static_cast<float>( VOXEL_CHUNK_SIZE ) ) );
+}
+
+glm::vec3 VoxelChunkManager::ChunkCoordToWorld( const glm::ivec3& chunkCoord )
+{
+	return glm::vec3( chunkCoord * VOXEL_CHUNK_SIZE );
+}
+
+float VoxelChunkManager::DistanceToChunk( const glm::ivec3& chunkCoord ) const
+{
+	// Distance to the closest point of the chunk bounds, so the chunk we stand in is always at 0
+	const glm::vec3 chunkMin = ChunkCoordToWorld( chunkCoord );
+	const glm::vec3 chunkMax = chunkMin + static_cast<float>( VOXEL_CHUNK_SIZE );
+	const glm::vec3 closestPoint = glm::clamp( m_viewpoint, chunkMin, chunkMax );
+	return glm::length( m_viewpoint - closestPoint );
+}
+
+uint32_t VoxelChunkManager::SelectLod( const glm::ivec3& chunkCoord, float distanceOffset ) const
+{
+	return m_lodSelector != nullptr ? m_lodSelector->SelectLevel( ChunkCoordToWorld( chunkCoord ), distanceOffset ) : 0;
+}
+
+void VoxelChunkManager::UpdateResidentChunk( const glm::ivec3& chunkCoord, ResidentChunk& residentChunk )
+{
+	VoxelObject* voxelObject = residentChunk.voxelObject.get();
+	const uint32_t keptLod = SelectLod( chunkCoord, -LOD_DISTANCE_MARGIN );
+	if( voxelObject != nullptr && voxelObject->GetFinestLod() < keptLod )
+	{
+		// Coarsening can change its LOD, the neighbours mesh against it
+		const uint32_t lod = voxelObject->GetLod();
+		voxelObject->Coarsen( keptLod );
+		if( voxelObject->GetLod() != lod )
+		{
+			MarkNeighbourMeshesDirty( chunkCoord );
+		}
+	}
+	if( voxelObject != nullptr && !voxelObject->IsCompressed() && DistanceToChunk( chunkCoord ) > m_compressDistance )
+	{
+		voxelObject->Compress();
+	}
+
+	// Footprints change with compression & edits, keep the total in sync
+	m_residentMemory -= residentChunk.memoryFootprint;
+	residentChunk.memoryFootprint = sizeof( ResidentChunk ) + ( voxelObject != nullptr ? voxelObject->GetMemoryFootprint() : 0 );
+	m_residentMemory += residentChunk.memoryFootprint;
+}
+
+VoxelChunkManager::ChunkMap::iterator VoxelChunkManager::FindFarthestChunk( float fartherThan )
+{
+	auto farthest = m_chunks.end();
+	float farthestDistance = fartherThan;
+	for( auto it = m_chunks.begin(); it != m_chunks.end(); ++it )
+	{
+		const float distance = DistanceToChunk( it->first );
+		if( distance > farthestDistance )
+		{
+			farthest = it;
+			farthestDistance = distance;
+		}
+	}
+	return farthest;
+}
+
+bool VoxelChunkManager::EvictFartherChunks( float fartherThan )
+{
+	const size_t excessMemory = m_residentMemory - std::min( m_residentMemory, m_residentMemoryBudget );
+	size_t evictableMemory = 0;
+	for( const auto& chunk : m_chunks )
+	{
+		if( DistanceToChunk( chunk.first ) > fartherThan )
+		{
+			evictableMemory += chunk.second.memoryFootprint;
+		}
+	}
+	if( evictableMemory < excessMemory )
+	{
+		return false;
+	}
+
+	while( m_residentMemory > m_residentMemoryBudget )
+	{
+		UnloadChunk( FindFarthestChunk( fartherThan ) );
+	}
+	return true;
+}
+
+void VoxelChunkManager::UnloadChunk( ChunkMap::iterator it )
+{
+	const glm::ivec3 chunkCoord = it->first;
+	const bool wasEmpty = it->second.voxelObject == nullptr;
+
+	m_residentMemory -= it->second.memoryFootprint;
+	m_chunks.erase( it );
+
+	if( !wasEmpty )
+	{
+		MarkNeighbourMeshesDirty( chunkCoord );
+	}
+}
+
+void VoxelChunkManager::MarkNeighbourMeshesDirty( const glm::ivec3& chunkCoord )
+{
+	for( uint32_t faceDirection = 0; faceDirection < 6; ++faceDirection )
+	{
+		glm::ivec3 offset( 0 );
+		offset[faceDirection / 2] = ( faceDirection % 2 ) == 0 ? 1 : -1;
+		if( VoxelObject* neighbour = FindChunk( chunkCoord + offset ) )
+		{
+			neighbour->MarkMeshDirty();
+		}
+	}
+}
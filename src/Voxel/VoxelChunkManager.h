@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Voxel/VoxelConstants.h>
+#include <Voxel/VoxelObject.h>
+
+class JobSystem;
+class VoxelLodSelector;
+
+struct ChunkCoordHash
+{
+	size_t operator()( const glm::ivec3& chunkCoord ) const
+	{
+		return static_cast<size_t>( static_cast<int64_t>( chunkCoord.x ) * 73856093 ) ^ static_cast<size_t>( static_cast<int64_t>( chunkCoord.y ) * 19349663 )
+		  ^ static_cast<size_t>( static_cast<int64_t>( chunkCoord.z ) * 83492791 );
+	}
+};
+
+//-----------------------
+// Keeps the chunks around a viewpoint resident, keyed by chunk coordinate.
+// Chunks are streamed in nearest first and dropped once out of view distance,
+// or when the resident memory budget is needed for nearer chunks. The budget is never exceeded past an update,
+// chunks that grew from edits get the farthest ones evicted too.
+// Chunks past the compress distance are kept palette compressed, so the budget holds a lot more of them.
+// With a LOD selector, chunks past its LOD distances only keep the mips they get rendered at (see VoxelObject::Coarsen),
+// they get loaded again once they need more detail.
+
+class VoxelChunkManager
+{
+  public:
+	// Returns the chunk at chunkCoord, or nullptr if that chunk is entirely empty.
+	// Called from job threads when there's a job system, several chunks at a time.
+	using ChunkLoader = std::function<std::unique_ptr<VoxelObject>( const glm::ivec3& chunkCoord )>;
+
+	VoxelChunkManager( size_t residentMemoryBudget, float viewDistance );
+
+	void SetChunkLoader( ChunkLoader chunkLoader ) { m_chunkLoader = std::move( chunkLoader ); }
+	// Chunks get loaded in parallel on it, nullptr loads them one by one on the calling thread
+	void SetJobSystem( JobSystem* jobSystem ) { m_jobSystem = jobSystem; }
+	void SetViewDistance( float viewDistance ) { m_viewDistance = viewDistance; }
+	void SetCompressDistance( float compressDistance ) { m_compressDistance = compressDistance; }
+	// Read from job threads while loading, nullptr keeps every chunk at full resolution
+	void SetLodSelector( const VoxelLodSelector* lodSelector ) { m_lodSelector = lodSelector; }
+
+	// Streams chunks in/out around the viewpoint (world space)
+	void Update( const glm::vec3& viewpoint );
+	void UnloadAll();
+
+	// Resident chunks include known empty ones, which FindChunk returns nullptr for
+	bool IsChunkResident( const glm::ivec3& chunkCoord ) const { return m_chunks.find( chunkCoord ) != m_chunks.end(); }
+	VoxelObject* FindChunk( const glm::ivec3& chunkCoord );
+	const VoxelObject* FindChunk( const glm::ivec3& chunkCoord ) const;
+	// Same as FindChunk, known empty chunks get an empty voxel object first so edits can fill them. nullptr if not resident.
+	// Its footprint gets accounted for on the next update.
+	VoxelObject* FindOrCreateChunk( const glm::ivec3& chunkCoord );
+
+	// Resident neighbours in face direction order (+x, -x, +y, -y, +z, -z), nullptr where empty or not resident
+	void FindNeighbours( const glm::ivec3& chunkCoord, const VoxelObject* neighbours[6] ) const;
+	// Neighbour meshes cull their border faces against this chunk, they need remeshing when it comes, goes or changes LOD
+	void MarkNeighbourMeshesDirty( const glm::ivec3& chunkCoord );
+
+	// Calls callback( const glm::ivec3& chunkCoord, VoxelObject& chunk ) for every resident, non-empty chunk
+	template<typename Callback>
+	void ForEachChunk( Callback&& callback );
+
+	size_t GetResidentChunkCount() const { return m_chunks.size(); }
+	size_t GetResidentMemory() const { return m_residentMemory; }
+	size_t GetResidentMemoryBudget() const { return m_residentMemoryBudget; }
+
+	static glm::ivec3 WorldToChunkCoord( const glm::vec3& worldPosition );
+	static glm::vec3 ChunkCoordToWorld( const glm::ivec3& chunkCoord );
+
+  private:
+	struct ResidentChunk
+	{
+		std::unique_ptr<VoxelObject> voxelObject; // null for known empty chunks
+		size_t memoryFootprint;
+	};
+	using ChunkMap = std::unordered_map<glm::ivec3, ResidentChunk, ChunkCoordHash>;
+
+	float DistanceToChunk( const glm::ivec3& chunkCoord ) const;
+	// The LOD selector's level for the chunk (see VoxelLodSelector::SelectLevel), 0 without one
+	uint32_t SelectLod( const glm::ivec3& chunkCoord, float distanceOffset ) const;
+	void UpdateResidentChunk( const glm::ivec3& chunkCoord, ResidentChunk& residentChunk );
+	ChunkMap::iterator FindFarthestChunk( float fartherThan );
+	// Evicts chunks farther than fartherThan, farthest first, until the resident memory fits the budget.
+	// Evicts nothing & returns false when the farther chunks can't free enough.
+	bool EvictFartherChunks( float fartherThan );
+	void UnloadChunk( ChunkMap::iterator it );
+
+	ChunkMap m_chunks;
+	ChunkLoader m_chunkLoader;
+	JobSystem* m_jobSystem = nullptr;
+	const VoxelLodSelector* m_lodSelector = nullptr;
+
+	size_t m_residentMemoryBudget;
+	size_t m_residentMemory = 0;
+	size_t m_droppedFootprint = 0; // of the first candidate the last update couldn't fit, 0 if they all did
+	float m_viewDistance;
+	float m_compressDistance;
+	glm::vec3 m_viewpoint = glm::vec3( 0.0f );
+
+	// Kept around to avoid reallocating every update
+	std::vector<glm::ivec3> m_loadCandidates;
+	std::vector<std::unique_ptr<VoxelObject>> m_loadedChunks;
+};
+
+//-----------------------
+
+template<typename Callback>
+void VoxelChunkManager::ForEachChunk( Callback&& callback )
+{
+	for( auto& chunk : m_chunks )
+	{
+		if( chunk.second.voxelObject )
+		{
+			callback( chunk.first, *chunk.second.voxelObject );
+		}
+	}
+}
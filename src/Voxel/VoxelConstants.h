@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Chunks are cubes of VOXEL_CHUNK_SIZE voxels, stored x fastest, then y, then z.
+// A row is the VOXEL_CHUNK_SIZE voxels along x at a given (y, z).
+constexpr int32_t VOXEL_CHUNK_SIZE = 32;
+constexpr int32_t VOXEL_CHUNK_ROW_COUNT = VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE;
+constexpr int32_t VOXEL_CHUNK_VOXEL_COUNT = VOXEL_CHUNK_ROW_COUNT * VOXEL_CHUNK_SIZE;
+
+inline int32_t VoxelChunkIndex( int32_t x, int32_t y, int32_t z )
+{
+	return ( z * VOXEL_CHUNK_SIZE + y ) * VOXEL_CHUNK_SIZE + x;
+}
+
+// Bricks are cubes of VOXEL_BRICK_SIZE voxels tiling a chunk, the unit voxel data is stored in on the GPU (see GpuVoxelStore).
+// Voxels in a brick and bricks in a chunk are both stored x fastest, then y, then z.
+constexpr int32_t VOXEL_BRICK_SIZE = 8;
+constexpr int32_t VOXEL_BRICK_VOXEL_COUNT = VOXEL_BRICK_SIZE * VOXEL_BRICK_SIZE * VOXEL_BRICK_SIZE;
+constexpr int32_t VOXEL_CHUNK_BRICKS = VOXEL_CHUNK_SIZE / VOXEL_BRICK_SIZE; // per axis
+constexpr int32_t VOXEL_CHUNK_BRICK_COUNT = VOXEL_CHUNK_BRICKS * VOXEL_CHUNK_BRICKS * VOXEL_CHUNK_BRICKS;
+static_assert( VOXEL_CHUNK_BRICK_COUNT == 64, "dirty bricks are tracked as a uint64_t mask per chunk" );
+
+inline int32_t VoxelBrickIndex( int32_t brickX, int32_t brickY, int32_t brickZ )
+{
+	return ( brickZ * VOXEL_CHUNK_BRICKS + brickY ) * VOXEL_CHUNK_BRICKS + brickX;
+}
+
+// Chunks carry downsampled copies of their voxels for distant levels of detail (see VoxelMipChain).
+// Level n is ( VOXEL_CHUNK_SIZE >> n )^3 voxels, each standing for 2^n voxels per axis: the last level's voxels are bricks.
+constexpr uint32_t VOXEL_MIP_LEVEL_COUNT = 4;
+static_assert( ( VOXEL_CHUNK_SIZE >> ( VOXEL_MIP_LEVEL_COUNT - 1 ) ) == VOXEL_CHUNK_BRICKS, "the coarsest mip has a voxel per brick" );
@@ -0,0 +1,263 @@
+#include <Voxel/VoxelEditQueue.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Jobs/JobSystem.h>
+#include <Voxel/VoxelChunkManager.h>
+
+namespace
+{
+	// Chunk space bounds of the voxels an edit changed, empty until one does
+	struct ChangedBounds
+	{
+		glm::ivec3 min = glm::ivec3( VOXEL_CHUNK_SIZE );
+		glm::ivec3 max = glm::ivec3( 0 );
+	};
+
+	// Writes voxels [minX, maxX) of a chunk row, only the ones that didn't hold their value already count as changed
+	template<typename ValueAt>
+	void WriteRow( int8_t* denseVoxels, int32_t y, int32_t z, int32_t minX, int32_t maxX, ValueAt&& valueAt, ChangedBounds& changedBounds )
+	{
+		int8_t* row = denseVoxels + VoxelChunkIndex( 0, y, z );
+		int32_t firstChangedX = maxX;
+		int32_t lastChangedX = minX - 1;
+		for( int32_t x = minX; x < maxX; ++x )
+		{
+			const int8_t value = valueAt( x );
+			if( row[x] != value )
+			{
+				row[x] = value;
+				firstChangedX = std::min( firstChangedX, x );
+				lastChangedX = x;
+			}
+		}
+
+		if( firstChangedX <= lastChangedX )
+		{
+			changedBounds.min = glm::min( changedBounds.min, glm::ivec3( firstChangedX, y, z ) );
+			changedBounds.max = glm::max( changedBounds.max, glm::ivec3( lastChangedX + 1, y + 1, z + 1 ) );
+		}
+	}
+
+	bool IsChunkCoordLess( const glm::ivec3& a, const glm::ivec3& b )
+	{
+		if( a.z != b.z )
+		{
+			return a.z < b.z;
+		}
+		return a.y != b.y ? a.y < b.y : a.x < b.x;
+	}
+} // namespace
+
+void VoxelEditQueue::SetVoxel( const glm::ivec3& position, int8_t material )
+{
+	FillBox( position, position + 1, material );
+}
+
+void VoxelEditQueue::FillBox( const glm::ivec3& min, const glm::ivec3& max, int8_t material )
+{
+	m_edits.push_back( Edit{ Shape::Box, material, min, max, glm::vec3( 0.0f ), 0.0f, 0 } );
+}
+
+void VoxelEditQueue::FillSphere( const glm::vec3& center, float radius, int8_t material )
+{
+	// Voxel x is inside when x + 0.5 is within radius of center
+	const glm::ivec3 min = glm::ivec3( glm::ceil( center - radius - 0.5f ) );
+	const glm::ivec3 max = glm::ivec3( glm::floor( center + radius - 0.5f ) ) + 1;
+	m_edits.push_back( Edit{ Shape::Sphere, material, min, max, center, radius, 0 } );
+}
+
+void VoxelEditQueue::Paste( const glm::ivec3& origin, const glm::ivec3& size, const int8_t* voxels )
+{
+	const size_t voxelCount = static_cast<size_t>( size.x ) * size.y * size.z;
+	m_edits.push_back( Edit{ Shape::Paste, 0, origin, origin + size, glm::vec3( 0.0f ), 0.0f, m_pasteVoxels.size() } );
+	m_pasteVoxels.insert( m_pasteVoxels.end(), voxels, voxels + voxelCount );
+}
+
+void VoxelEditQueue::Apply( VoxelChunkManager& chunkManager, JobSystem* jobSystem )
+{
+	m_appliedEditCount = static_cast<uint32_t>( m_edits.size() );
+	m_touchedChunkCount = 0;
+	m_changedChunkCount = 0;
+	m_dirtiedNeighbourCount = 0;
+	m_droppedChunkCount = 0;
+	if( m_edits.empty() )
+	{
+		return;
+	}
+
+	// Every chunk an edit's bounds overlap, grouped by chunk with the edits kept in order
+	m_chunkEdits.clear();
+	for( uint32_t editIndex = 0; editIndex < m_edits.size(); ++editIndex )
+	{
+		const Edit& edit = m_edits[editIndex];
+		if( glm::any( glm::greaterThanEqual( edit.min, edit.max ) ) )
+		{
+			continue;
+		}
+
+		const glm::ivec3 minChunk = VoxelChunkManager::WorldToChunkCoord( glm::vec3( edit.min ) );
+		const glm::ivec3 maxChunk = VoxelChunkManager::WorldToChunkCoord( glm::vec3( edit.max - 1 ) );
+		for( int32_t z = minChunk.z; z <= maxChunk.z; ++z )
+		{
+			for( int32_t y = minChunk.y; y <= maxChunk.y; ++y )
+			{
+				for( int32_t x = minChunk.x; x <= maxChunk.x; ++x )
+				{
+					m_chunkEdits.emplace_back( glm::ivec3( x, y, z ), editIndex );
+				}
+			}
+		}
+	}
+	std::stable_sort( m_chunkEdits.begin(), m_chunkEdits.end(), []( const auto& a, const auto& b ) {
+		return IsChunkCoordLess( a.first, b.first );
+	} );
+
+	m_touchedChunks.clear();
+	for( size_t first = 0; first < m_chunkEdits.size(); )
+	{
+		const glm::ivec3 chunkCoord = m_chunkEdits[first].first;
+		size_t end = first;
+		bool isAdding = false;
+		for( ; end < m_chunkEdits.size() && m_chunkEdits[end].first == chunkCoord; ++end )
+		{
+			const Edit& edit = m_edits[m_chunkEdits[end].second];
+			isAdding = isAdding || edit.shape == Shape::Paste || edit.material != 0;
+		}
+
+		if( !chunkManager.IsChunkResident( chunkCoord ) )
+		{
+			++m_droppedChunkCount;
+		}
+		// Nothing to carve out of known empty chunks
+		else if( VoxelObject* chunk = isAdding ? chunkManager.FindOrCreateChunk( chunkCoord ) : chunkManager.FindChunk( chunkCoord ) )
+		{
+			m_touchedChunks.push_back(
+			  TouchedChunk{ chunkCoord, chunk, static_cast<uint32_t>( first ), static_cast<uint32_t>( end - first ), glm::ivec3( 0 ), glm::ivec3( 0 ), false } );
+		}
+		first = end;
+	}
+	m_touchedChunkCount = static_cast<uint32_t>( m_touchedChunks.size() );
+
+	// Chunks only touch their own voxels while applying, so they can all go in parallel
+	const uint32_t threadCount = jobSystem != nullptr ? jobSystem->GetThreadCount() : 1;
+	if( m_threadDenseVoxels.size() < threadCount )
+	{
+		m_threadDenseVoxels.resize( threadCount, std::vector<int8_t>( VOXEL_CHUNK_VOXEL_COUNT ) );
+	}
+	if( jobSystem != nullptr )
+	{
+		jobSystem->ParallelFor( m_touchedChunks.size(), 1, [this, jobSystem]( size_t index ) {
+			ApplyToChunk( m_touchedChunks[index], m_threadDenseVoxels[jobSystem->GetCurrentThreadIndex()].data() );
+		} );
+	}
+	else
+	{
+		for( TouchedChunk& touchedChunk : m_touchedChunks )
+		{
+			ApplyToChunk( touchedChunk, m_threadDenseVoxels[0].data() );
+		}
+	}
+
+	// Neighbours mesh against the border voxels, at this chunk's LOD: one mip voxel deep
+	for( const TouchedChunk& touchedChunk : m_touchedChunks )
+	{
+		if( !touchedChunk.isChanged )
+		{
+			continue;
+		}
+		++m_changedChunkCount;
+
+		const int32_t borderDepth = 1 << touchedChunk.chunk->GetLod();
+		for( uint32_t faceDirection = 0; faceDirection < 6; ++faceDirection )
+		{
+			const uint32_t axis = faceDirection / 2;
+			const bool isPositive = ( faceDirection % 2 ) == 0;
+			const bool isBorderChanged =
+			  isPositive ? touchedChunk.changedMax[axis] > VOXEL_CHUNK_SIZE - borderDepth : touchedChunk.changedMin[axis] < borderDepth;
+			if( !isBorderChanged )
+			{
+				continue;
+			}
+
+			glm::ivec3 offset( 0 );
+			offset[axis] = isPositive ? 1 : -1;
+			if( VoxelObject* neighbour = chunkManager.FindChunk( touchedChunk.chunkCoord + offset ) )
+			{
+				neighbour->MarkMeshDirty();
+				++m_dirtiedNeighbourCount;
+			}
+		}
+	}
+
+	m_edits.clear();
+	m_pasteVoxels.clear();
+}
+
+void VoxelEditQueue::ApplyToChunk( TouchedChunk& touchedChunk, int8_t* denseVoxels ) const
+{
+	VoxelObject& chunk = *touchedChunk.chunk;
+	chunk.CopyToDense( denseVoxels );
+
+	const glm::ivec3 chunkOrigin = touchedChunk.chunkCoord * VOXEL_CHUNK_SIZE;
+	ChangedBounds changedBounds;
+	for( uint32_t i = 0; i < touchedChunk.editCount; ++i )
+	{
+		const Edit& edit = m_edits[m_chunkEdits[touchedChunk.firstEdit + i].second];
+		const glm::ivec3 min = glm::max( edit.min - chunkOrigin, 0 );
+		const glm::ivec3 max = glm::min( edit.max - chunkOrigin, VOXEL_CHUNK_SIZE );
+
+		for( int32_t z = min.z; z < max.z; ++z )
+		{
+			for( int32_t y = min.y; y < max.y; ++y )
+			{
+				switch( edit.shape )
+				{
+				case Shape::Box:
+					WriteRow( denseVoxels, y, z, min.x, max.x, [&edit]( int32_t ) { return edit.material; }, changedBounds );
+					break;
+				case Shape::Sphere:
+				{
+					// The row's span inside the sphere, see FillSphere
+					const glm::vec3 toRow = glm::vec3( chunkOrigin ) + glm::vec3( 0.0f, y + 0.5f, z + 0.5f ) - edit.center;
+					const float remainingSquared = edit.radius * edit.radius - toRow.y * toRow.y - toRow.z * toRow.z;
+					if( remainingSquared < 0.0f )
+					{
+						break;
+					}
+					const float halfSpan = std::sqrt( remainingSquared );
+					const int32_t spanMinX = static_cast<int32_t>( std::ceil( edit.center.x - halfSpan - 0.5f ) ) - chunkOrigin.x;
+					const int32_t spanMaxX = static_cast<int32_t>( std::floor( edit.center.x + halfSpan - 0.5f ) ) + 1 - chunkOrigin.x;
+					WriteRow( denseVoxels,
+					  y,
+					  z,
+					  std::max( min.x, spanMinX ),
+					  std::min( max.x, spanMaxX ),
+					  [&edit]( int32_t ) { return edit.material; },
+					  changedBounds );
+					break;
+				}
+				case Shape::Paste:
+				{
+					const glm::ivec3 size = edit.max - edit.min;
+					const glm::ivec3 rowInPaste = chunkOrigin + glm::ivec3( 0, y, z ) - edit.min;
+					const int8_t* pasteRow = m_pasteVoxels.data() + edit.firstPasteVoxel + ( static_cast<size_t>( rowInPaste.z ) * size.y + rowInPaste.y ) * size.x;
+					WriteRow( denseVoxels, y, z, min.x, max.x, [pasteRow, rowInPaste]( int32_t x ) { return pasteRow[rowInPaste.x + x]; }, changedBounds );
+					break;
+				}
+				}
+			}
+		}
+	}
+
+	touchedChunk.isChanged = changedBounds.min.x < changedBounds.max.x;
+	if( touchedChunk.isChanged )
+	{
+		touchedChunk.changedMin = changedBounds.min;
+		touchedChunk.changedMax = changedBounds.max;
+		chunk.GetVoxelData().SetFromDense( denseVoxels );
+		chunk.MarkVoxelsDirty( changedBounds.min, changedBounds.max );
+		chunk.UpdateOccupancy( denseVoxels );
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Voxel/VoxelConstants.h>
+
+class JobSystem;
+class VoxelChunkManager;
+class VoxelObject;
+
+//-----------------------
+// Voxel edits in world voxel coordinates, queued up & applied together once a frame.
+// Brushes are CSG: a material adds (union), material 0 carves (subtraction). Edits apply in the order they were queued.
+// Applying only visits the chunks the edits' bounds overlap. Each of those gets its edits applied on a dense copy
+// (in parallel), then only the voxels that actually changed dirty its mesh, mips & bricks (see VoxelObject::MarkVoxelsDirty)
+// and get their occupancy repacked.
+// Neighbours only get remeshed when the changes reach the border they mesh against.
+// Only resident chunks can be edited, edits of the others get dropped.
+
+class VoxelEditQueue
+{
+  public:
+	void SetVoxel( const glm::ivec3& position, int8_t material );
+	// The box [min, max)
+	void FillBox( const glm::ivec3& min, const glm::ivec3& max, int8_t material );
+	// Voxels whose center is within radius of center
+	void FillSphere( const glm::vec3& center, float radius, int8_t material );
+	// voxels holds size.x * size.y * size.z voxels, x fastest, then y, then z. Empty ones get written too.
+	void Paste( const glm::ivec3& origin, const glm::ivec3& size, const int8_t* voxels );
+
+	// Applies & clears the queued edits, jobSystem can be nullptr to apply them on the calling thread
+	void Apply( VoxelChunkManager& chunkManager, JobSystem* jobSystem );
+	bool IsEmpty() const { return m_edits.empty(); }
+
+	// The last Apply's stats
+	uint32_t GetAppliedEditCount() const { return m_appliedEditCount; }
+	uint32_t GetTouchedChunkCount() const { return m_touchedChunkCount; } // resident chunks the edits overlapped
+	uint32_t GetChangedChunkCount() const { return m_changedChunkCount; } // the ones whose voxels changed
+	uint32_t GetDirtiedNeighbourCount() const { return m_dirtiedNeighbourCount; } // meshes dirtied across a chunk border
+	uint32_t GetDroppedChunkCount() const { return m_droppedChunkCount; } // overlapped chunks that weren't resident
+
+  private:
+	enum class Shape : uint8_t
+	{
+		Box,
+		Sphere,
+		Paste,
+	};
+
+	struct Edit
+	{
+		Shape shape;
+		int8_t material; // unused by pastes
+		glm::ivec3 min; // bounds [min, max)
+		glm::ivec3 max;
+		glm::vec3 center; // spheres only
+		float radius;
+		size_t firstPasteVoxel; // pastes only, in m_pasteVoxels
+	};
+
+	struct TouchedChunk
+	{
+		glm::ivec3 chunkCoord;
+		VoxelObject* chunk;
+		uint32_t firstEdit; // in m_chunkEdits
+		uint32_t editCount;
+		glm::ivec3 changedMin; // chunk space, empty unless isChanged
+		glm::ivec3 changedMax;
+		bool isChanged;
+	};
+
+	void ApplyToChunk( TouchedChunk& touchedChunk, int8_t* denseVoxels ) const;
+
+	std::vector<Edit> m_edits;
+	std::vector<int8_t> m_pasteVoxels;
+
+	uint32_t m_appliedEditCount = 0;
+	uint32_t m_touchedChunkCount = 0;
+	uint32_t m_changedChunkCount = 0;
+	uint32_t m_dirtiedNeighbourCount = 0;
+	uint32_t m_droppedChunkCount = 0;
+
+	// Kept around to avoid reallocating every Apply
+	std::vector<std::pair<glm::ivec3, uint32_t>> m_chunkEdits; // chunk coordinate & edit index, sorted by chunk
+	std::vector<TouchedChunk> m_touchedChunks;
+	std::vector<std::vector<int8_t>> m_threadDenseVoxels; // a chunk's worth per job system thread
+};
@@ -0,0 +1,39 @@
+#include <Voxel/VoxelLodSelector.h>
+
+#include <cmath>
+#include <limits>
+
+void VoxelLodSelector::SetCamera( const glm::vec3& position, float verticalFov, uint32_t screenHeight )
+{
+	m_cameraPosition = position;
+	m_pixelsPerUnit = static_cast<float>( screenHeight ) / ( 2.0f * std::tan( verticalFov * 0.5f ) );
+}
+
+uint32_t VoxelLodSelector::SelectLevel( const glm::vec3& chunkMin, float distanceOffset ) const
+{
+	// Distance to the closest point of the chunk, so the chunk the camera is in always gets level 0
+	const glm::vec3 closestPoint = glm::clamp( m_cameraPosition, chunkMin, chunkMin + static_cast<float>( VOXEL_CHUNK_SIZE ) );
+	const float distance = glm::length( m_cameraPosition - closestPoint ) + distanceOffset;
+
+	uint32_t level = 0;
+	while( level + 1 < VOXEL_MIP_LEVEL_COUNT && distance >= GetLevelDistance( level + 1 ) )
+	{
+		++level;
+	}
+	return level;
+}
+
+float VoxelLodSelector::GetLevelDistance( uint32_t level ) const
+{
+	if( level == 0 )
+	{
+		return 0.0f;
+	}
+	if( m_maxPixelError <= 0.0f )
+	{
+		return std::numeric_limits<float>::infinity();
+	}
+
+	// A level n voxel is 2^n units wide, it spans 2^n * pixelsPerUnit / distance pixels
+	return static_cast<float>( 1u << level ) * m_pixelsPerUnit / m_maxPixelError;
+}
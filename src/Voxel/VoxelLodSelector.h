@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <Voxel/VoxelConstants.h>
+
+//-----------------------
+// Picks the mip level chunks get meshed & uploaded at, by screen space error: the coarsest level whose voxels still
+// project to at most maxPixelError pixels at the chunk's distance from the camera.
+// Clipmap like: rings of ever coarser levels around the camera, each level starting twice as far out as the previous one.
+// A maxPixelError of 0 keeps every chunk at full resolution.
+
+class VoxelLodSelector
+{
+  public:
+	void SetCamera( const glm::vec3& position, float verticalFov, uint32_t screenHeight );
+	void SetMaxPixelError( float maxPixelError ) { m_maxPixelError = maxPixelError; }
+
+	// chunkMin is the chunk's world space min corner. distanceOffset gets added to its distance, eg: to leave a margin.
+	uint32_t SelectLevel( const glm::vec3& chunkMin, float distanceOffset = 0.0f ) const;
+	// Distance from which level is used, level 0 from 0
+	float GetLevelDistance( uint32_t level ) const;
+
+  private:
+	glm::vec3 m_cameraPosition = glm::vec3( 0.0f );
+	float m_pixelsPerUnit = 1.0f; // on screen, for something 1 unit away
+	float m_maxPixelError = 0.0f;
+};
@@ -0,0 +1,297 @@
+#include <Voxel/VoxelMesher.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <Voxel/VoxelObject.h>
+#include <Voxel/VoxelOccupancy.h>
+
+namespace
+{
+	inline int32_t PaddedIndex( int32_t x, int32_t y, int32_t z )
+	{
+		return ( z * VoxelMesher::PADDED_SIZE + y ) * VoxelMesher::PADDED_SIZE + x;
+	}
+
+	// Face mask entry: 0 for no face, otherwise material in the low byte and the face direction above it
+	inline uint16_t FaceMaskValue( int8_t material, uint32_t faceDirection )
+	{
+		return static_cast<uint16_t>( static_cast<uint8_t>( material ) | ( ( faceDirection + 1 ) << 8 ) );
+	}
+
+	void EmitQuad( VoxelMesh& mesh, const int32_t corners[4][3], uint32_t faceDirection, int8_t material, bool reverseWinding )
+	{
+		const uint32_t firstVertex = static_cast<uint32_t>( mesh.vertices.size() );
+		for( int i = 0; i < 4; ++i )
+		{
+			const int32_t* corner = corners[reverseWinding ? ( 4 - i ) % 4 : i];
+			mesh.vertices.push_back( PackVoxelVertex( corner[0], corner[1], corner[2], faceDirection, material ) );
+		}
+
+		const uint32_t quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+		for( uint32_t index : quadIndices )
+		{
+			mesh.indices.push_back( firstVertex + index );
+		}
+	}
+
+	// Whether the neighbour's voxels touching this chunk's faceDirection side, over [i, i + span) x [j, j + span), are all solid.
+	// Read at the neighbour's LOD, a border voxel only culls the faces it covers entirely: no cracks, whatever the two LODs.
+	bool IsBorderSolid( const VoxelObject& neighbour, uint32_t faceDirection, int32_t i, int32_t j, int32_t span )
+	{
+		const int32_t d = faceDirection / 2;
+		glm::ivec3 position;
+		position[d] = ( faceDirection % 2 ) == 0 ? 0 : VOXEL_CHUNK_SIZE - 1;
+
+		// One read per neighbour LOD voxel is enough
+		const int32_t step = std::min( span, 1 << neighbour.GetLod() );
+		for( int32_t b = j; b < j + span; b += step )
+		{
+			for( int32_t a = i; a < i + span; a += step )
+			{
+				position[d == 0 ? 1 : 0] = a;
+				position[d == 2 ? 1 : 2] = b;
+				if( neighbour.GetLodVoxel( position ) == 0 )
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+} // namespace
+
+void VoxelMesher::GatherPaddedVoxels( const VoxelObject& chunk, const VoxelObject* const neighbours[6], int8_t* paddedVoxels )
+{
+	memset( paddedVoxels, 0, PADDED_VOXEL_COUNT );
+
+	// Interior, the LOD's own voxels row by row into the padded layout
+	const int32_t size = static_cast<int32_t>( chunk.GetLodSize() );
+	int8_t denseVoxels[VOXEL_CHUNK_VOXEL_COUNT];
+	chunk.CopyLodToDense( denseVoxels );
+	for( int32_t z = 0; z < size; ++z )
+	{
+		for( int32_t y = 0; y < size; ++y )
+		{
+			memcpy( paddedVoxels + PaddedIndex( 1, y + 1, z + 1 ), denseVoxels + ( z * size + y ) * size, size );
+		}
+	}
+
+	// Borders, only the slice of each neighbour touching this chunk
+	const int32_t span = 1 << chunk.GetLod();
+	for( uint32_t faceDirection = 0; faceDirection < 6; ++faceDirection )
+	{
+		if( !neighbours[faceDirection] )
+		{
+			continue;
+		}
+
+		const int32_t d = faceDirection / 2;
+		int32_t position[3];
+		position[d] = ( faceDirection % 2 ) == 0 ? size + 1 : 0;
+		for( int32_t j = 0; j < size; ++j )
+		{
+			for( int32_t i = 0; i < size; ++i )
+			{
+				position[d == 0 ? 1 : 0] = i + 1;
+				position[d == 2 ? 1 : 2] = j + 1;
+				paddedVoxels[PaddedIndex( position[0], position[1], position[2] )] =
+				  IsBorderSolid( *neighbours[faceDirection], faceDirection, i * span, j * span, span ) ? 1 : 0;
+			}
+		}
+	}
+}
+
+void VoxelMesher::MeshPaddedVoxels( const int8_t* paddedVoxels, uint32_t lod, VoxelMesh& mesh )
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.lod = lod;
+
+	const int32_t size = VOXEL_CHUNK_SIZE >> lod;
+	const uint32_t sizeMask = size == 32 ? ~0u : ( 1u << size ) - 1;
+
+	// Bit x of a padded row is set when that voxel is solid, faces then come out of a few bit operations per row
+	// Past the border, padded rows are all empty: the row bits above size are left 0 for smaller LODs.
+	uint64_t paddedRows[PADDED_SIZE * PADDED_SIZE];
+	for( int32_t z = 0; z < size + 2; ++z )
+	{
+		for( int32_t y = 0; y < size + 2; ++y )
+		{
+			const int8_t* row = paddedVoxels + PaddedIndex( 0, y, z );
+			paddedRows[z * PADDED_SIZE + y] = static_cast<uint64_t>( row[0] != 0 ) | ( static_cast<uint64_t>( VoxelOccupancy::PackRow( row + 1 ) ) << 1 )
+											  | ( static_cast<uint64_t>( row[PADDED_SIZE - 1] != 0 ) << ( PADDED_SIZE - 1 ) );
+		}
+	}
+
+	uint16_t faceMask[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
+	// Per face mask row j, bit i set where the plane has a face (solid behind & empty in front, or the other way around)
+	uint32_t positiveFaces[VOXEL_CHUNK_SIZE];
+	uint32_t negativeFaces[VOXEL_CHUNK_SIZE];
+
+	// For each axis d, sweep the planes between voxel layers, u & v being the two other axes (u x v = d)
+	for( int32_t d = 0; d < 3; ++d )
+	{
+		const int32_t u = ( d + 1 ) % 3;
+		const int32_t v = ( d + 2 ) % 3;
+
+		int32_t step[3] = { 0, 0, 0 };
+		step[d] = 1;
+		const int32_t neighbourOffset = PaddedIndex( step[0], step[1], step[2] );
+		const uint32_t positiveFace = static_cast<uint32_t>( d * 2 );
+		const uint32_t negativeFace = positiveFace + 1;
+
+		// Plane `slice` sits between chunk layers slice - 1 and slice, the border layers stand in for -1 and size.
+		// Faces on the outer planes belong to this chunk only when they face outwards, the neighbour meshes the other side.
+		for( int32_t slice = 0; slice <= size; ++slice )
+		{
+			// Rows run along x: across the planes for d = 0, along u for d = 2 & along v for d = 1
+			memset( positiveFaces, 0, sizeof( positiveFaces ) );
+			memset( negativeFaces, 0, sizeof( negativeFaces ) );
+			for( int32_t j = 0; j < size; ++j )
+			{
+				if( d == 0 )
+				{
+					for( int32_t i = 0; i < size; ++i )
+					{
+						const uint64_t row = paddedRows[( j + 1 ) * PADDED_SIZE + i + 1] >> slice;
+						positiveFaces[j] |= static_cast<uint32_t>( row & ~( row >> 1 ) & 1u ) << i;
+						negativeFaces[j] |= static_cast<uint32_t>( ~row & ( row >> 1 ) & 1u ) << i;
+					}
+				}
+				else
+				{
+					const uint64_t behind = d == 1 ? paddedRows[( j + 1 ) * PADDED_SIZE + slice] : paddedRows[slice * PADDED_SIZE + j + 1];
+					const uint64_t inFront = d == 1 ? paddedRows[( j + 1 ) * PADDED_SIZE + slice + 1] : paddedRows[( slice + 1 ) * PADDED_SIZE + j + 1];
+					const uint32_t rowPositiveFaces = static_cast<uint32_t>( ( behind & ~inFront ) >> 1 ) & sizeMask;
+					const uint32_t rowNegativeFaces = static_cast<uint32_t>( ( ~behind & inFront ) >> 1 ) & sizeMask;
+					if( d == 2 )
+					{
+						positiveFaces[j] = rowPositiveFaces;
+						negativeFaces[j] = rowNegativeFaces;
+					}
+					else
+					{
+						// Row j is z here, its bits are x: the mask's rows
+						for( uint32_t bits = rowPositiveFaces; bits != 0; bits &= bits - 1 )
+						{
+							positiveFaces[__builtin_ctz( bits )] |= 1u << j;
+						}
+						for( uint32_t bits = rowNegativeFaces; bits != 0; bits &= bits - 1 )
+						{
+							negativeFaces[__builtin_ctz( bits )] |= 1u << j;
+						}
+					}
+				}
+			}
+
+			if( slice == 0 )
+			{
+				memset( positiveFaces, 0, sizeof( positiveFaces ) );
+			}
+			if( slice == size )
+			{
+				memset( negativeFaces, 0, sizeof( negativeFaces ) );
+			}
+
+			uint32_t anyFaces = 0;
+			for( int32_t j = 0; j < size; ++j )
+			{
+				anyFaces |= positiveFaces[j] | negativeFaces[j];
+			}
+			if( anyFaces == 0 )
+			{
+				continue;
+			}
+
+			// Build the face mask for this plane, only visiting the faces
+			memset( faceMask, 0, size * VOXEL_CHUNK_SIZE * sizeof( uint16_t ) );
+			int32_t position[3];
+			position[d] = slice; // padded coordinate of the voxel behind the plane
+			for( int32_t j = 0; j < size; ++j )
+			{
+				position[v] = j + 1;
+				for( uint32_t bits = positiveFaces[j]; bits != 0; bits &= bits - 1 )
+				{
+					const int32_t i = __builtin_ctz( bits );
+					position[u] = i + 1;
+					faceMask[j * VOXEL_CHUNK_SIZE + i] = FaceMaskValue( paddedVoxels[PaddedIndex( position[0], position[1], position[2] )], positiveFace );
+				}
+				for( uint32_t bits = negativeFaces[j]; bits != 0; bits &= bits - 1 )
+				{
+					const int32_t i = __builtin_ctz( bits );
+					position[u] = i + 1;
+					faceMask[j * VOXEL_CHUNK_SIZE + i] =
+					  FaceMaskValue( paddedVoxels[PaddedIndex( position[0], position[1], position[2] ) + neighbourOffset], negativeFace );
+				}
+			}
+
+			// Greedily grow rectangles of identical mask values, first along u then along v
+			for( int32_t j = 0; j < size; ++j )
+			{
+				if( ( positiveFaces[j] | negativeFaces[j] ) == 0 )
+				{
+					continue;
+				}
+
+				for( int32_t i = 0; i < size; )
+				{
+					const uint16_t maskValue = faceMask[j * VOXEL_CHUNK_SIZE + i];
+					if( maskValue == 0 )
+					{
+						++i;
+						continue;
+					}
+
+					int32_t width = 1;
+					while( i + width < size && faceMask[j * VOXEL_CHUNK_SIZE + i + width] == maskValue )
+					{
+						++width;
+					}
+
+					int32_t height = 1;
+					for( ; j + height < size; ++height )
+					{
+						const uint16_t* row = faceMask + ( j + height ) * VOXEL_CHUNK_SIZE + i;
+						bool isRowMatching = true;
+						for( int32_t k = 0; k < width; ++k )
+						{
+							if( row[k] != maskValue )
+							{
+								isRowMatching = false;
+								break;
+							}
+						}
+						if( !isRowMatching )
+						{
+							break;
+						}
+					}
+
+					// Consume the rectangle
+					for( int32_t h = 0; h < height; ++h )
+					{
+						memset( faceMask + ( j + h ) * VOXEL_CHUNK_SIZE + i, 0, width * sizeof( uint16_t ) );
+					}
+
+					int32_t corners[4][3];
+					for( auto& corner : corners )
+					{
+						corner[d] = slice;
+						corner[u] = i;
+						corner[v] = j;
+					}
+					corners[1][u] += width;
+					corners[2][u] += width;
+					corners[2][v] += height;
+					corners[3][v] += height;
+
+					const uint32_t faceDirection = ( maskValue >> 8 ) - 1;
+					EmitQuad( mesh, corners, faceDirection, static_cast<int8_t>( maskValue & 0xFF ), faceDirection == negativeFace );
+
+					i += width;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Voxel/VoxelConstants.h>
+
+class VoxelObject;
+
+//-----------------------
+// Packed vertex, one uint32_t:
+//   bits  0-5  : x (0 - VOXEL_CHUNK_SIZE, chunk local, in the mesh's LOD voxels: 2^lod units each)
+//   bits  6-11 : y
+//   bits 12-17 : z
+//   bits 18-20 : face direction (0: +x, 1: -x, 2: +y, 3: -y, 4: +z, 5: -z)
+//   bits 21-28 : material
+// Triangles are counter clockwise when seen from outside the voxel.
+
+struct VoxelMesh
+{
+	std::vector<uint32_t> vertices;
+	std::vector<uint32_t> indices;
+	uint32_t lod = 0; // the mip level it got meshed at, see VoxelObject::SetLod
+
+	size_t GetTriangleCount() const { return indices.size() / 3; }
+	size_t GetMemoryFootprint() const { return vertices.capacity() * sizeof( uint32_t ) + indices.capacity() * sizeof( uint32_t ); }
+};
+
+inline uint32_t PackVoxelVertex( int32_t x, int32_t y, int32_t z, uint32_t faceDirection, int8_t material )
+{
+	return static_cast<uint32_t>( x ) | ( static_cast<uint32_t>( y ) << 6 ) | ( static_cast<uint32_t>( z ) << 12 )
+		   | ( faceDirection << 18 ) | ( static_cast<uint32_t>( static_cast<uint8_t>( material ) ) << 21 );
+}
+
+//-----------------------
+// Greedy mesher: merges coplanar faces of the same material into as few quads as possible.
+// Works on a padded copy of the chunk holding a one voxel border from its neighbours,
+// so faces against solid neighbour voxels get culled.
+// Chunks get meshed at their LOD, in its own voxels: a level 1 chunk has 8 times fewer voxels to go through.
+
+namespace VoxelMesher
+{
+	constexpr int32_t PADDED_SIZE = VOXEL_CHUNK_SIZE + 2;
+	constexpr int32_t PADDED_VOXEL_COUNT = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+
+	// The chunk's LOD voxels go in [1, GetLodSize()] on each axis, its border right past them, the rest stays empty.
+	// Neighbour order: +x, -x, +y, -y, +z, -z (same as the face directions), missing neighbours count as empty.
+	// Border voxels are 1 where solid: only their solidity matters.
+	void GatherPaddedVoxels( const VoxelObject& chunk, const VoxelObject* const neighbours[6], int8_t* paddedVoxels );
+
+	// paddedVoxels as gathered for a chunk at lod
+	void MeshPaddedVoxels( const int8_t* paddedVoxels, uint32_t lod, VoxelMesh& mesh );
+} // namespace VoxelMesher
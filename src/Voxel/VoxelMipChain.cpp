@@ -0,0 +1,291 @@
+#include <Voxel/VoxelMipChain.h>
+
+#include <algorithm>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define ASTRO_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+static_assert( VOXEL_CHUNK_SIZE == 32, "the SIMD paths halve rows of exactly 32 voxels" );
+
+namespace
+{
+	using SimdPath = VoxelMipChain::SimdPath;
+
+	SimdPath DetectSimdPath()
+	{
+#ifdef ASTRO_X86_SIMD
+		if( __builtin_cpu_supports( "avx2" ) )
+		{
+			return SimdPath::Avx2;
+		}
+		if( __builtin_cpu_supports( "sse4.1" ) )
+		{
+			return SimdPath::Sse41;
+		}
+#endif
+		return SimdPath::Scalar;
+	}
+
+	SimdPath Selected_Simd_Path = DetectSimdPath();
+
+	// Offset of every level in the chain, level 1 first
+	size_t GetLevelOffset( uint32_t level )
+	{
+		size_t offset = 0;
+		for( uint32_t previousLevel = 1; previousLevel < level; ++previousLevel )
+		{
+			const size_t size = static_cast<size_t>( VoxelMipChain::GetLevelSize( previousLevel ) );
+			offset += size * size * size;
+		}
+		return offset;
+	}
+
+	//-----------------------
+	// Scalar
+
+	// children in x, then y, then z order
+	int8_t MajorityScalar( const int8_t children[8] )
+	{
+		int32_t solidCount = 0;
+		int32_t bestCount = 0;
+		int8_t best = 0;
+		for( int32_t i = 0; i < 8; ++i )
+		{
+			if( children[i] == 0 )
+			{
+				continue;
+			}
+			++solidCount;
+
+			int32_t count = 0;
+			for( int32_t j = 0; j < 8; ++j )
+			{
+				count += children[j] == children[i];
+			}
+			if( count > bestCount )
+			{
+				bestCount = count;
+				best = children[i];
+			}
+		}
+		return solidCount >= 4 ? best : 0;
+	}
+
+	void DownsampleScalar( const int8_t* voxels, int32_t size, int8_t* halfVoxels )
+	{
+		const int32_t halfSize = size / 2;
+		for( int32_t z = 0; z < halfSize; ++z )
+		{
+			for( int32_t y = 0; y < halfSize; ++y )
+			{
+				for( int32_t x = 0; x < halfSize; ++x )
+				{
+					int8_t children[8];
+					for( int32_t child = 0; child < 8; ++child )
+					{
+						const int32_t childX = x * 2 + ( child & 1 );
+						const int32_t childY = y * 2 + ( ( child >> 1 ) & 1 );
+						const int32_t childZ = z * 2 + ( child >> 2 );
+						children[child] = voxels[( childZ * size + childY ) * size + childX];
+					}
+					halfVoxels[( z * halfSize + y ) * halfSize + x] = MajorityScalar( children );
+				}
+			}
+		}
+	}
+
+#ifdef ASTRO_X86_SIMD
+	//-----------------------
+	// SSE4.1
+	// A row of 32 voxels gets split in its even & odd voxels, so the 8 children of 16 mip voxels sit in 8 registers.
+	// Every child is compared with all the others to count its material, the vote then is a running max & blend.
+
+	__attribute__( ( target( "sse4.1" ) ) ) inline void SplitRowSse( const int8_t* row, __m128i& evens, __m128i& odds )
+	{
+		// Evens to the low 8 bytes, odds to the high ones
+		const __m128i splitMask = _mm_setr_epi8( 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15 );
+		const __m128i low = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( row ) ), splitMask );
+		const __m128i high = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( row + 16 ) ), splitMask );
+		evens = _mm_unpacklo_epi64( low, high );
+		odds = _mm_unpackhi_epi64( low, high );
+	}
+
+	__attribute__( ( target( "sse4.1" ) ) ) inline __m128i MajoritySse( const __m128i children[8] )
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i emptyCount = zero; // counted down, cmpeq gives -1
+		__m128i best = zero;
+		__m128i bestCount = zero;
+		for( int32_t i = 0; i < 8; ++i )
+		{
+			const __m128i isEmpty = _mm_cmpeq_epi8( children[i], zero );
+			emptyCount = _mm_sub_epi8( emptyCount, isEmpty );
+
+			__m128i count = zero;
+			for( int32_t j = 0; j < 8; ++j )
+			{
+				count = _mm_sub_epi8( count, _mm_cmpeq_epi8( children[i], children[j] ) );
+			}
+			count = _mm_andnot_si128( isEmpty, count );
+
+			best = _mm_blendv_epi8( best, children[i], _mm_cmpgt_epi8( count, bestCount ) );
+			bestCount = _mm_max_epi8( bestCount, count );
+		}
+		// At least 4 solid children: at most 4 empty ones
+		return _mm_and_si128( best, _mm_cmpgt_epi8( _mm_set1_epi8( 5 ), emptyCount ) );
+	}
+
+	__attribute__( ( target( "sse4.1" ) ) ) void DownsampleChunkSse41( const int8_t* voxels, int8_t* halfVoxels )
+	{
+		constexpr int32_t halfSize = VOXEL_CHUNK_SIZE / 2;
+		for( int32_t z = 0; z < halfSize; ++z )
+		{
+			for( int32_t y = 0; y < halfSize; ++y )
+			{
+				__m128i children[8];
+				for( int32_t rowChild = 0; rowChild < 4; ++rowChild )
+				{
+					const int8_t* row = voxels + VoxelChunkIndex( 0, y * 2 + ( rowChild & 1 ), z * 2 + ( rowChild >> 1 ) );
+					SplitRowSse( row, children[rowChild * 2], children[rowChild * 2 + 1] );
+				}
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( halfVoxels + ( z * halfSize + y ) * halfSize ), MajoritySse( children ) );
+			}
+		}
+	}
+
+	//-----------------------
+	// AVX2
+	// Same as SSE4.1, two mip rows at once: (y, z) in the low lane, (y + 1, z) in the high one, stored next to each other.
+
+	__attribute__( ( target( "avx2" ) ) ) inline void SplitRowsAvx( const int8_t* lowLaneRow, const int8_t* highLaneRow, __m256i& evens, __m256i& odds )
+	{
+		const __m256i splitMask = _mm256_setr_epi8( 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15 );
+		const __m256i firstHalves = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( lowLaneRow ) ) ),
+		  _mm_loadu_si128( reinterpret_cast<const __m128i*>( highLaneRow ) ),
+		  1 );
+		const __m256i secondHalves = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( lowLaneRow + 16 ) ) ),
+		  _mm_loadu_si128( reinterpret_cast<const __m128i*>( highLaneRow + 16 ) ),
+		  1 );
+		const __m256i low = _mm256_shuffle_epi8( firstHalves, splitMask );
+		const __m256i high = _mm256_shuffle_epi8( secondHalves, splitMask );
+		evens = _mm256_unpacklo_epi64( low, high );
+		odds = _mm256_unpackhi_epi64( low, high );
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) inline __m256i MajorityAvx( const __m256i children[8] )
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i emptyCount = zero;
+		__m256i best = zero;
+		__m256i bestCount = zero;
+		for( int32_t i = 0; i < 8; ++i )
+		{
+			const __m256i isEmpty = _mm256_cmpeq_epi8( children[i], zero );
+			emptyCount = _mm256_sub_epi8( emptyCount, isEmpty );
+
+			__m256i count = zero;
+			for( int32_t j = 0; j < 8; ++j )
+			{
+				count = _mm256_sub_epi8( count, _mm256_cmpeq_epi8( children[i], children[j] ) );
+			}
+			count = _mm256_andnot_si256( isEmpty, count );
+
+			best = _mm256_blendv_epi8( best, children[i], _mm256_cmpgt_epi8( count, bestCount ) );
+			bestCount = _mm256_max_epi8( bestCount, count );
+		}
+		return _mm256_and_si256( best, _mm256_cmpgt_epi8( _mm256_set1_epi8( 5 ), emptyCount ) );
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) void DownsampleChunkAvx2( const int8_t* voxels, int8_t* halfVoxels )
+	{
+		constexpr int32_t halfSize = VOXEL_CHUNK_SIZE / 2;
+		for( int32_t z = 0; z < halfSize; ++z )
+		{
+			for( int32_t y = 0; y < halfSize; y += 2 )
+			{
+				__m256i children[8];
+				for( int32_t rowChild = 0; rowChild < 4; ++rowChild )
+				{
+					const int32_t rowY = y * 2 + ( rowChild & 1 );
+					const int32_t rowZ = z * 2 + ( rowChild >> 1 );
+					SplitRowsAvx( voxels + VoxelChunkIndex( 0, rowY, rowZ ), voxels + VoxelChunkIndex( 0, rowY + 2, rowZ ), children[rowChild * 2], children[rowChild * 2 + 1] );
+				}
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( halfVoxels + ( z * halfSize + y ) * halfSize ), MajorityAvx( children ) );
+			}
+		}
+	}
+#endif // ASTRO_X86_SIMD
+} // namespace
+
+void VoxelMipChain::Build( const int8_t* denseVoxels )
+{
+	m_firstLevel = 1;
+	m_voxels.resize( GetLevelOffset( VOXEL_MIP_LEVEL_COUNT ) );
+
+	const int8_t* previousLevel = denseVoxels;
+	for( uint32_t level = 1; level < VOXEL_MIP_LEVEL_COUNT; ++level )
+	{
+		int8_t* levelVoxels = m_voxels.data() + GetLevelOffset( level );
+		Downsample( previousLevel, GetLevelSize( level - 1 ), levelVoxels );
+		previousLevel = levelVoxels;
+	}
+}
+
+int8_t VoxelMipChain::Get( const glm::ivec3& position, uint32_t level ) const
+{
+	const int32_t size = GetLevelSize( level );
+	return GetLevel( level )[( position.z * size + position.y ) * size + position.x];
+}
+
+const int8_t* VoxelMipChain::GetLevel( uint32_t level ) const
+{
+	return m_voxels.data() + GetLevelOffset( level ) - GetLevelOffset( m_firstLevel );
+}
+
+void VoxelMipChain::DropLevelsFinerThan( uint32_t level )
+{
+	if( level <= m_firstLevel || m_voxels.empty() )
+	{
+		return;
+	}
+
+	// Into a new vector, erasing would keep the capacity around
+	std::vector<int8_t> coarseVoxels( m_voxels.begin() + ( GetLevel( level ) - m_voxels.data() ), m_voxels.end() );
+	m_voxels = std::move( coarseVoxels );
+	m_firstLevel = level;
+}
+
+void VoxelMipChain::Downsample( const int8_t* voxels, int32_t size, int8_t* halfVoxels )
+{
+	// Smaller levels are 8 times cheaper each, not worth vectorizing
+#ifdef ASTRO_X86_SIMD
+	if( size == VOXEL_CHUNK_SIZE )
+	{
+		switch( Selected_Simd_Path )
+		{
+		case SimdPath::Avx2:
+			DownsampleChunkAvx2( voxels, halfVoxels );
+			return;
+		case SimdPath::Sse41:
+			DownsampleChunkSse41( voxels, halfVoxels );
+			return;
+		case SimdPath::Scalar:
+			break;
+		}
+	}
+#endif
+	DownsampleScalar( voxels, size, halfVoxels );
+}
+
+VoxelMipChain::SimdPath VoxelMipChain::GetSimdPath()
+{
+	return Selected_Simd_Path;
+}
+
+void VoxelMipChain::SetSimdPath( SimdPath simdPath )
+{
+	// Never go above what the CPU supports
+	Selected_Simd_Path = std::min( simdPath, DetectSimdPath() );
+}
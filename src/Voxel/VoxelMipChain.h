@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Voxel/CompressedVoxelChunk.h>
+#include <Voxel/VoxelConstants.h>
+
+//-----------------------
+// Downsampled copies of a chunk's voxels, levels 1 to VOXEL_MIP_LEVEL_COUNT - 1, each dense (see VoxelChunkIndex, per level size).
+// A mip voxel takes the majority of its 8 children: solid when at least half of them are, then the most common solid material
+// (the first child's in x, y, z order on ties). Averaging would invent materials, and thin features would all disappear
+// with a strict majority.
+// The first level, by far the biggest, goes through SIMD kernels, the same paths as CompressedVoxelChunk.
+// Chunks that only need the coarse levels can drop the finer ones (see VoxelObject::Coarsen).
+
+class VoxelMipChain
+{
+  public:
+	using SimdPath = CompressedVoxelChunk::SimdPath;
+
+	// denseVoxels holds VOXEL_CHUNK_VOXEL_COUNT voxels, see VoxelChunkIndex
+	void Build( const int8_t* denseVoxels );
+
+	static int32_t GetLevelSize( uint32_t level ) { return VOXEL_CHUNK_SIZE >> level; }
+	// level in [GetFirstLevel(), VOXEL_MIP_LEVEL_COUNT), position in the level's voxels
+	int8_t Get( const glm::ivec3& position, uint32_t level ) const;
+	const int8_t* GetLevel( uint32_t level ) const;
+
+	// Releases the levels finer than level, until the next Build
+	void DropLevelsFinerThan( uint32_t level );
+	uint32_t GetFirstLevel() const { return m_firstLevel; }
+
+	bool IsBuilt() const { return !m_voxels.empty(); }
+	size_t GetMemoryFootprint() const { return m_voxels.capacity(); }
+
+	// Halves a size^3 dense block into ( size / 2 )^3, exposed for benchmarks
+	static void Downsample( const int8_t* voxels, int32_t size, int8_t* halfVoxels );
+
+	// Best path the CPU supports by default, can be lowered to compare paths
+	static SimdPath GetSimdPath();
+	static void SetSimdPath( SimdPath simdPath );
+
+  private:
+	std::vector<int8_t> m_voxels; // every level from m_firstLevel, finest first
+	uint32_t m_firstLevel = 1;
+};
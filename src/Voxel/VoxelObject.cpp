@@ -1,15 +1,294 @@
 #include <Voxel/VoxelObject.h>
 
-VoxelObject::VoxelObject( glm::vec3 position, int8_t* voxelData )
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace
+{
+	// Chunks get meshed in parallel, 0 is never handed out
+	std::atomic<uint64_t> s_nextMeshVersion{ 1 };
+} // namespace
+
+VoxelObject::VoxelObject( glm::vec3 position, uint32_t size )
   : m_position( position )
-  , m_voxelData( voxelData )
+  , m_voxelData( size )
+  , m_compressedData{}
+  , m_mesh{}
 {
 }
 
-void VoxelObject::Render()
+void VoxelObject::Render( const VoxelObject* const neighbours[6] )
 {
+	if( !m_isMeshDirty || GetSize() != VOXEL_CHUNK_SIZE )
+	{
+		return;
+	}
+
+	// Nothing solid, nothing to face: not even the neighbours' voxels need gathering
+	UpdateOccupancy();
+	if( m_occupancy.IsEmpty() )
+	{
+		m_mesh.vertices.clear();
+		m_mesh.indices.clear();
+		m_isMeshDirty = false;
+		m_meshVersion = s_nextMeshVersion.fetch_add( 1, std::memory_order_relaxed );
+		return;
+	}
+
+	int8_t paddedVoxels[VoxelMesher::PADDED_VOXEL_COUNT];
+	VoxelMesher::GatherPaddedVoxels( *this, neighbours, paddedVoxels );
+	VoxelMesher::MeshPaddedVoxels( paddedVoxels, m_lod, m_mesh );
+	m_isMeshDirty = false;
+	m_meshVersion = s_nextMeshVersion.fetch_add( 1, std::memory_order_relaxed );
 }
 
 void VoxelObject::ComputeFrame()
 {
 }
+
+void VoxelObject::MarkVoxelsDirty( const glm::ivec3& min, const glm::ivec3& max )
+{
+	m_isMeshDirty = true;
+	m_areMipsDirty = true;
+	m_staleOccupancyMin = glm::min( m_staleOccupancyMin, glm::clamp( min, 0, VOXEL_CHUNK_SIZE ) );
+	m_staleOccupancyMax = glm::max( m_staleOccupancyMax, glm::clamp( max, 0, VOXEL_CHUNK_SIZE ) );
+
+	const glm::ivec3 minBrick = glm::clamp( min, 0, VOXEL_CHUNK_SIZE - 1 ) / VOXEL_BRICK_SIZE;
+	const glm::ivec3 maxBrick = glm::clamp( max - 1, 0, VOXEL_CHUNK_SIZE - 1 ) / VOXEL_BRICK_SIZE;
+	for( int32_t brickZ = minBrick.z; brickZ <= maxBrick.z; ++brickZ )
+	{
+		for( int32_t brickY = minBrick.y; brickY <= maxBrick.y; ++brickY )
+		{
+			for( int32_t brickX = minBrick.x; brickX <= maxBrick.x; ++brickX )
+			{
+				m_dirtyBricks |= 1ull << VoxelBrickIndex( brickX, brickY, brickZ );
+			}
+		}
+	}
+}
+
+size_t VoxelObject::GetMemoryFootprint() const
+{
+	size_t memoryFootprint = sizeof( VoxelObject ) - sizeof( SparseVoxelOctree ) + m_voxelData.GetMemoryFootprint() + m_mesh.GetMemoryFootprint()
+							 + m_mips.GetMemoryFootprint();
+	if( m_compressedData )
+	{
+		memoryFootprint += m_compressedData->GetMemoryFootprint();
+	}
+	return memoryFootprint;
+}
+
+SparseVoxelOctree& VoxelObject::GetVoxelData()
+{
+	Decompress();
+	Refine();
+	return m_voxelData;
+}
+
+int8_t VoxelObject::GetVoxel( const glm::ivec3& position ) const
+{
+	if( m_finestLod != 0 )
+	{
+		return m_mips.Get( position >> static_cast<int32_t>( m_finestLod ), m_finestLod );
+	}
+	return m_compressedData ? m_compressedData->Get( position ) : m_voxelData.Get( position );
+}
+
+void VoxelObject::CopyToDense( int8_t* denseVoxels ) const
+{
+	if( m_finestLod != 0 )
+	{
+		ExpandFinestLod( denseVoxels );
+	}
+	else if( m_compressedData )
+	{
+		m_compressedData->Decode( denseVoxels );
+	}
+	else
+	{
+		m_voxelData.CopyToDense( denseVoxels );
+	}
+}
+
+bool VoxelObject::SetLod( uint32_t lod )
+{
+	lod = std::max( lod, m_finestLod );
+	if( lod == m_lod || GetSize() != VOXEL_CHUNK_SIZE )
+	{
+		return false;
+	}
+
+	m_lod = lod;
+	m_isMeshDirty = true;
+	m_dirtyBricks = ~0ull;
+	return true;
+}
+
+void VoxelObject::UpdateMips()
+{
+	if( m_lod == 0 )
+	{
+		// Full resolution chunks are the near ones, only far ones pay for mips
+		if( m_mips.IsBuilt() )
+		{
+			m_mips = VoxelMipChain();
+			m_areMipsDirty = true;
+		}
+		return;
+	}
+
+	if( m_areMipsDirty || !m_mips.IsBuilt() )
+	{
+		std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+		CopyToDense( denseVoxels.data() );
+		m_mips.Build( denseVoxels.data() );
+		m_areMipsDirty = false;
+	}
+}
+
+int8_t VoxelObject::GetLodVoxel( const glm::ivec3& position ) const
+{
+	return m_lod == 0 ? GetVoxel( position ) : m_mips.Get( position >> static_cast<int32_t>( m_lod ), m_lod );
+}
+
+void VoxelObject::CopyLodToDense( int8_t* denseVoxels ) const
+{
+	if( m_lod == 0 )
+	{
+		CopyToDense( denseVoxels );
+		return;
+	}
+
+	const size_t levelSize = static_cast<size_t>( GetLodSize() );
+	memcpy( denseVoxels, m_mips.GetLevel( m_lod ), levelSize * levelSize * levelSize );
+}
+
+void VoxelObject::Coarsen( uint32_t lod )
+{
+	if( lod <= m_finestLod || m_voxelData.HasExternalNodes() || GetSize() != VOXEL_CHUNK_SIZE )
+	{
+		return;
+	}
+
+	std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+	if( m_finestLod == 0 && ( m_areMipsDirty || !m_mips.IsBuilt() ) )
+	{
+		CopyToDense( denseVoxels.data() );
+		m_mips.Build( denseVoxels.data() );
+		m_areMipsDirty = false;
+	}
+	m_mips.DropLevelsFinerThan( lod );
+	m_finestLod = lod;
+
+	// Release the octree memory for good, Clear() keeps the node capacity around
+	m_voxelData = SparseVoxelOctree( VOXEL_CHUNK_SIZE );
+	m_compressedData.reset();
+	SetLod( m_lod );
+
+	// Raycasts & the mesher go by the occupancy, it has to match what's left
+	CopyToDense( denseVoxels.data() );
+	m_staleOccupancyMin = glm::ivec3( 0 );
+	m_staleOccupancyMax = glm::ivec3( VOXEL_CHUNK_SIZE );
+	UpdateOccupancy( denseVoxels.data() );
+}
+
+void VoxelObject::Refine()
+{
+	if( m_finestLod == 0 )
+	{
+		return;
+	}
+
+	// Same voxels, the finer mips get rebuilt from them when needed
+	std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+	ExpandFinestLod( denseVoxels.data() );
+	m_voxelData.SetFromDense( denseVoxels.data() );
+	m_finestLod = 0;
+	m_areMipsDirty = true;
+}
+
+void VoxelObject::ExpandFinestLod( int8_t* denseVoxels ) const
+{
+	const int32_t levelSize = VoxelMipChain::GetLevelSize( m_finestLod );
+	const int8_t* levelVoxels = m_mips.GetLevel( m_finestLod );
+	for( int32_t z = 0; z < VOXEL_CHUNK_SIZE; ++z )
+	{
+		for( int32_t y = 0; y < VOXEL_CHUNK_SIZE; ++y )
+		{
+			const int8_t* levelRow = levelVoxels + ( ( z >> m_finestLod ) * levelSize + ( y >> m_finestLod ) ) * levelSize;
+			int8_t* row = denseVoxels + VoxelChunkIndex( 0, y, z );
+			for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+			{
+				row[x] = levelRow[x >> m_finestLod];
+			}
+		}
+	}
+}
+
+std::vector<SparseVoxelOctree::Node> VoxelObject::GetCompactNodes() const
+{
+	if( !m_compressedData && m_finestLod == 0 )
+	{
+		return m_voxelData.GetCompactNodes();
+	}
+
+	std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+	CopyToDense( denseVoxels.data() );
+
+	SparseVoxelOctree octree( VOXEL_CHUNK_SIZE );
+	octree.SetFromDense( denseVoxels.data() );
+	return octree.GetCompactNodes();
+}
+
+void VoxelObject::UpdateOccupancy()
+{
+	if( glm::any( glm::greaterThanEqual( m_staleOccupancyMin, m_staleOccupancyMax ) ) || GetSize() != VOXEL_CHUNK_SIZE )
+	{
+		return;
+	}
+
+	std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+	CopyToDense( denseVoxels.data() );
+	UpdateOccupancy( denseVoxels.data() );
+}
+
+void VoxelObject::UpdateOccupancy( const int8_t* denseVoxels )
+{
+	if( glm::any( glm::greaterThanEqual( m_staleOccupancyMin, m_staleOccupancyMax ) ) || GetSize() != VOXEL_CHUNK_SIZE )
+	{
+		return;
+	}
+
+	m_occupancy.Update( denseVoxels, m_staleOccupancyMin, m_staleOccupancyMax );
+	m_staleOccupancyMin = glm::ivec3( VOXEL_CHUNK_SIZE );
+	m_staleOccupancyMax = glm::ivec3( 0 );
+}
+
+void VoxelObject::Compress()
+{
+	if( m_compressedData || m_finestLod != 0 || m_voxelData.HasExternalNodes() || m_voxelData.GetSize() != VOXEL_CHUNK_SIZE )
+	{
+		return;
+	}
+
+	std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+	m_voxelData.CopyToDense( denseVoxels.data() );
+	m_compressedData = std::make_unique<CompressedVoxelChunk>( CompressedVoxelChunk::Encode( denseVoxels.data() ) );
+
+	// Release the octree memory for good, Clear() keeps the node capacity around
+	m_voxelData = SparseVoxelOctree( VOXEL_CHUNK_SIZE );
+}
+
+void VoxelObject::Decompress()
+{
+	if( !m_compressedData )
+	{
+		return;
+	}
+
+	std::vector<int8_t> denseVoxels( VOXEL_CHUNK_VOXEL_COUNT );
+	m_compressedData->Decode( denseVoxels.data() );
+	m_voxelData.SetFromDense( denseVoxels.data() );
+	m_compressedData.reset();
+}
@@ -1,16 +1,104 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <glm/glm.hpp>
 
+#include <Voxel/CompressedVoxelChunk.h>
+#include <Voxel/SparseVoxelOctree.h>
+#include <Voxel/VoxelMipChain.h>
+#include <Voxel/VoxelMesher.h>
+#include <Voxel/VoxelOccupancy.h>
+
 class VoxelObject
 {
   public:
-	VoxelObject( glm::vec3 position, int8_t* voxelData );
+	VoxelObject( glm::vec3 position, uint32_t size );
 
-	void Render();
+	// Remeshes the object if its voxels (or a neighbour's border) changed since the last call.
+	// Only reads the neighbours, so chunks can be rendered in parallel.
+	void Render( const VoxelObject* const neighbours[6] );
 	void ComputeFrame();
 
+	const VoxelMesh& GetMesh() const { return m_mesh; }
+	// Changes every time the mesh is rebuilt, unique across objects: tells GPU copies of the mesh they're stale. 0 until meshed.
+	uint64_t GetMeshVersion() const { return m_meshVersion; }
+	bool IsMeshDirty() const { return m_isMeshDirty; }
+	void MarkMeshDirty() { m_isMeshDirty = true; }
+
+	// Voxels in [min, max) (object space) changed: remeshes the object, marks the bricks they touch dirty, the mips & occupancy stale
+	void MarkVoxelsDirty( const glm::ivec3& min, const glm::ivec3& max );
+	// A bit per brick (see VoxelBrickIndex) whose voxels changed since ClearDirtyBricks, chunk sized objects only.
+	// Every brick starts dirty. Tells GPU copies of the voxels which bricks they need again (see GpuVoxelStore).
+	uint64_t GetDirtyBricks() const { return m_dirtyBricks; }
+	void ClearDirtyBricks() { m_dirtyBricks = 0; }
+
+	const glm::vec3& GetPosition() const { return m_position; }
+	uint32_t GetSize() const { return m_voxelData.GetSize(); }
+	size_t GetMemoryFootprint() const;
+
+	// Editable voxel data, decompresses (or refines, see Coarsen) the object first if needed (callers editing voxels must MarkVoxelsDirty)
+	SparseVoxelOctree& GetVoxelData();
+
+	// Read access, works on any representation. Coarsened objects read as their finest mip voxels repeated.
+	int8_t GetVoxel( const glm::ivec3& position ) const;
+	// denseVoxels holds GetSize()^3 voxels, x fastest, then y, then z
+	void CopyToDense( int8_t* denseVoxels ) const;
+
+	// Mip level the object gets meshed & uploaded at (see VoxelMipChain), chunk sized objects only.
+	// Never finer than GetFinestLod(). Changing it remeshes the object & dirties all its bricks, returns whether it changed.
+	bool SetLod( uint32_t lod );
+	uint32_t GetLod() const { return m_lod; }
+	uint32_t GetLodSize() const { return static_cast<uint32_t>( VoxelMipChain::GetLevelSize( m_lod ) ); } // in LOD voxels, per axis
+	// (Re)builds the mips if the LOD needs them & the voxels changed since, drops them at LOD 0. Only touches the object's own data.
+	void UpdateMips();
+	// The LOD's voxel covering position (object space, full resolution). Mips must be up to date.
+	int8_t GetLodVoxel( const glm::ivec3& position ) const;
+	// denseVoxels holds GetLodSize()^3 voxels, the LOD's own: x fastest, then y, then z. Mips must be up to date.
+	void CopyLodToDense( int8_t* denseVoxels ) const;
+
+	// Keeps only the mips from lod on & releases the voxels (octree or compressed) for far chunks, which never need more detail.
+	// The object stays readable at that detail, GetVoxelData brings the full resolution back from the mips (the detail is lost).
+	// Nothing to gain for octrees reading external (memory mapped) nodes, those are left alone. Only touches the object's own data.
+	void Coarsen( uint32_t lod );
+	uint32_t GetFinestLod() const { return m_finestLod; } // 0 unless coarsened
+	std::vector<SparseVoxelOctree::Node> GetCompactNodes() const;
+
+	// Solid voxels as bits, at full resolution (see VoxelOccupancy), chunk sized objects only. Up to date as of UpdateOccupancy.
+	const VoxelOccupancy& GetOccupancy() const { return m_occupancy; }
+	// Repacks the occupancy of the voxels marked dirty since, only touches the object's own data
+	void UpdateOccupancy();
+	// Same, from a dense copy of the current voxels the caller already has (see CopyToDense)
+	void UpdateOccupancy( const int8_t* denseVoxels );
+
+	// Swaps the octree for a palette compressed copy, only chunk sized objects can be compressed.
+	// Nothing to gain for octrees reading external (memory mapped) nodes or coarsened objects, those are left alone.
+	void Compress();
+	void Decompress();
+	bool IsCompressed() const { return m_compressedData != nullptr; }
+
   private:
+	// Back to full resolution, from the finest mip kept
+	void Refine();
+	// The finest mip kept, every voxel repeated over the ones it stands for
+	void ExpandFinestLod( int8_t* denseVoxels ) const;
+
 	glm::vec3 m_position;
-	int8_t* m_voxelData;
-};
\ No newline at end of file
+	SparseVoxelOctree m_voxelData;
+	std::unique_ptr<CompressedVoxelChunk> m_compressedData;
+
+	VoxelMesh m_mesh;
+	bool m_isMeshDirty = true;
+	uint64_t m_meshVersion = 0;
+	uint64_t m_dirtyBricks = ~0ull;
+
+	VoxelMipChain m_mips;
+	uint32_t m_lod = 0;
+	uint32_t m_finestLod = 0; // past 0, the mips are all the voxels there are
+	bool m_areMipsDirty = true;
+
+	VoxelOccupancy m_occupancy;
+	glm::ivec3 m_staleOccupancyMin = glm::ivec3( 0 ); // voxels whose bits are out of date, [min, max)
+	glm::ivec3 m_staleOccupancyMax = glm::ivec3( VOXEL_CHUNK_SIZE );
+};
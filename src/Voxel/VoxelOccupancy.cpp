@@ -0,0 +1,82 @@
+#include <Voxel/VoxelOccupancy.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define ASTRO_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+void VoxelOccupancy::Build( const int8_t* denseVoxels )
+{
+	Update( denseVoxels, glm::ivec3( 0 ), glm::ivec3( VOXEL_CHUNK_SIZE ) );
+}
+
+void VoxelOccupancy::Update( const int8_t* denseVoxels, const glm::ivec3& min, const glm::ivec3& max )
+{
+	// Whole rows, repacking them costs about the same as masking the changed bits in
+	for( int32_t z = min.z; z < max.z; ++z )
+	{
+		for( int32_t y = min.y; y < max.y; ++y )
+		{
+			m_rows[z * VOXEL_CHUNK_SIZE + y] = PackRow( denseVoxels + VoxelChunkIndex( 0, y, z ) );
+		}
+	}
+	UpdateBricks( min.y, max.y, min.z, max.z );
+}
+
+uint32_t VoxelOccupancy::CountOccupied() const
+{
+	uint32_t count = 0;
+	for( uint32_t row : m_rows )
+	{
+		count += static_cast<uint32_t>( __builtin_popcount( row ) );
+	}
+	return count;
+}
+
+uint32_t VoxelOccupancy::PackRow( const int8_t* voxels )
+{
+#ifdef ASTRO_X86_SIMD
+	// SSE2 is part of x86-64: a compare & movemask per 16 voxels
+	const __m128i zero = _mm_setzero_si128();
+	const uint32_t emptyLow = static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( voxels ) ), zero ) ) );
+	const uint32_t emptyHigh = static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( voxels + 16 ) ), zero ) ) );
+	return ~( emptyLow | ( emptyHigh << 16 ) );
+#else
+	uint32_t bits = 0;
+	for( int32_t x = 0; x < VOXEL_CHUNK_SIZE; ++x )
+	{
+		bits |= static_cast<uint32_t>( voxels[x] != 0 ) << x;
+	}
+	return bits;
+#endif
+}
+
+void VoxelOccupancy::UpdateBricks( int32_t minY, int32_t maxY, int32_t minZ, int32_t maxZ )
+{
+	const int32_t minBrickY = minY / VOXEL_BRICK_SIZE;
+	const int32_t maxBrickY = ( maxY + VOXEL_BRICK_SIZE - 1 ) / VOXEL_BRICK_SIZE;
+	const int32_t minBrickZ = minZ / VOXEL_BRICK_SIZE;
+	const int32_t maxBrickZ = ( maxZ + VOXEL_BRICK_SIZE - 1 ) / VOXEL_BRICK_SIZE;
+	for( int32_t brickZ = minBrickZ; brickZ < maxBrickZ; ++brickZ )
+	{
+		for( int32_t brickY = minBrickY; brickY < maxBrickY; ++brickY )
+		{
+			// A brick row's bricks all at once: OR their rows, each brick gets a byte
+			uint32_t rows = 0;
+			for( int32_t z = brickZ * VOXEL_BRICK_SIZE; z < ( brickZ + 1 ) * VOXEL_BRICK_SIZE; ++z )
+			{
+				for( int32_t y = brickY * VOXEL_BRICK_SIZE; y < ( brickY + 1 ) * VOXEL_BRICK_SIZE; ++y )
+				{
+					rows |= m_rows[z * VOXEL_CHUNK_SIZE + y];
+				}
+			}
+
+			for( int32_t brickX = 0; brickX < VOXEL_CHUNK_BRICKS; ++brickX )
+			{
+				const uint64_t brickBit = 1ull << VoxelBrickIndex( brickX, brickY, brickZ );
+				const bool isOccupied = ( ( rows >> ( brickX * VOXEL_BRICK_SIZE ) ) & ( ( 1u << VOXEL_BRICK_SIZE ) - 1 ) ) != 0;
+				m_brickMask = isOccupied ? m_brickMask | brickBit : m_brickMask & ~brickBit;
+			}
+		}
+	}
+}
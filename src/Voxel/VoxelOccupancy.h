@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <Voxel/VoxelConstants.h>
+
+static_assert( VOXEL_CHUNK_SIZE == 32, "occupancy rows are a uint32_t" );
+
+//-----------------------
+// Which voxels of a chunk are solid, a bit each: a uint32_t per row (bit x), rows in VoxelChunkIndex order.
+// Above it a bit per brick (see VoxelBrickIndex) with any solid voxel, so empty space gets skipped a brick at a time,
+// and rows a word at a time (ctz to the next solid voxel, popcount to count them) instead of branching on every voxel.
+
+class VoxelOccupancy
+{
+  public:
+	// denseVoxels holds VOXEL_CHUNK_VOXEL_COUNT voxels, see VoxelChunkIndex
+	void Build( const int8_t* denseVoxels );
+	// Only the voxels in [min, max) changed: repacks their rows & the bricks those are in
+	void Update( const int8_t* denseVoxels, const glm::ivec3& min, const glm::ivec3& max );
+
+	bool IsOccupied( const glm::ivec3& position ) const { return ( m_rows[position.z * VOXEL_CHUNK_SIZE + position.y] >> position.x ) & 1u; }
+	uint32_t GetRow( int32_t y, int32_t z ) const { return m_rows[z * VOXEL_CHUNK_SIZE + y]; }
+	uint64_t GetBrickMask() const { return m_brickMask; }
+	bool IsBrickOccupied( const glm::ivec3& brickCoord ) const { return ( m_brickMask >> VoxelBrickIndex( brickCoord.x, brickCoord.y, brickCoord.z ) ) & 1u; }
+	bool IsEmpty() const { return m_brickMask == 0; }
+	uint32_t CountOccupied() const;
+
+	// Bit x set for every non-empty voxel of a VOXEL_CHUNK_SIZE voxel row
+	static uint32_t PackRow( const int8_t* voxels );
+
+  private:
+	// Bricks of the rows in [minY, maxY) x [minZ, maxZ) (rounded out to bricks)
+	void UpdateBricks( int32_t minY, int32_t maxY, int32_t minZ, int32_t maxZ );
+
+	uint32_t m_rows[VOXEL_CHUNK_ROW_COUNT] = {};
+	uint64_t m_brickMask = 0;
+};
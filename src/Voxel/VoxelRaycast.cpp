@@ -0,0 +1,75 @@
+#include <Voxel/VoxelRaycast.h>
+
+#include <cmath>
+
+#include <Voxel/VoxelChunkManager.h>
+
+namespace
+{
+	// Voxel to chunk & brick coordinates by arithmetic shifts, which floor negative coordinates too
+	constexpr int32_t CHUNK_SHIFT = 5;
+	constexpr int32_t BRICK_SHIFT = 3;
+	static_assert( ( 1 << CHUNK_SHIFT ) == VOXEL_CHUNK_SIZE && ( 1 << BRICK_SHIFT ) == VOXEL_BRICK_SIZE, "shifts don't match the chunk layout" );
+} // namespace
+
+std::optional<VoxelRaycast::Hit> VoxelRaycast::Trace( const VoxelChunkManager& chunkManager, const glm::vec3& origin, const glm::vec3& direction, float maxDistance )
+{
+	// No zero components: axes the ray runs along are just never crossed
+	const glm::vec3 safeDirection = direction + glm::vec3( glm::equal( direction, glm::vec3( 0.0f ) ) ) * 1e-7f;
+	const glm::vec3 inverseDirection = 1.0f / safeDirection;
+	const glm::ivec3 stepDirection = glm::ivec3( glm::sign( safeDirection ) );
+
+	glm::ivec3 voxel = glm::ivec3( glm::floor( origin ) );
+	int32_t axis = -1; // crossed last, none yet
+	float t = 0.0f;
+
+	glm::ivec3 chunkCoord = voxel >> CHUNK_SHIFT;
+	const VoxelObject* chunk = chunkManager.FindChunk( chunkCoord );
+	for( ;; )
+	{
+		if( ( voxel >> CHUNK_SHIFT ) != chunkCoord )
+		{
+			chunkCoord = voxel >> CHUNK_SHIFT;
+			chunk = chunkManager.FindChunk( chunkCoord );
+		}
+
+		// Largest empty cell around the voxel: chunk, brick or the voxel itself
+		int32_t cellSize = VOXEL_CHUNK_SIZE;
+		if( chunk != nullptr && !chunk->GetOccupancy().IsEmpty() )
+		{
+			const VoxelOccupancy& occupancy = chunk->GetOccupancy();
+			const glm::ivec3 chunkVoxel = voxel & ( VOXEL_CHUNK_SIZE - 1 );
+			cellSize = VOXEL_BRICK_SIZE;
+			if( occupancy.IsBrickOccupied( chunkVoxel >> BRICK_SHIFT ) )
+			{
+				cellSize = 1;
+				if( occupancy.IsOccupied( chunkVoxel ) )
+				{
+					glm::ivec3 normal( 0 );
+					if( axis >= 0 )
+					{
+						normal[axis] = -stepDirection[axis];
+					}
+					return Hit{ voxel, normal, t, chunk->GetVoxel( chunkVoxel ) };
+				}
+			}
+		}
+
+		// Power of two cells, aligned to their size: leave through the nearest of their planes
+		const glm::ivec3 cellMin = voxel & ~( cellSize - 1 );
+		const glm::vec3 exitPlanes = glm::vec3( cellMin ) + glm::vec3( glm::greaterThan( stepDirection, glm::ivec3( 0 ) ) ) * static_cast<float>( cellSize );
+		const glm::vec3 tCellExits = ( exitPlanes - origin ) * inverseDirection;
+		axis = tCellExits.x < tCellExits.y ? ( tCellExits.x < tCellExits.z ? 0 : 2 ) : ( tCellExits.y < tCellExits.z ? 1 : 2 );
+		t = tCellExits[axis];
+		if( t > maxDistance )
+		{
+			return std::nullopt;
+		}
+
+		// The crossed plane is exact, whatever the rounding of the position on it.
+		// Rounding mustn't take the other axes back against the ray either, grazing an edge would cross it back & forth.
+		const glm::ivec3 nextVoxel = glm::ivec3( glm::floor( origin + direction * t ) );
+		voxel = glm::mix( glm::max( nextVoxel, voxel ), glm::min( nextVoxel, voxel ), glm::lessThan( stepDirection, glm::ivec3( 0 ) ) );
+		voxel[axis] = static_cast<int32_t>( exitPlanes[axis] ) - ( stepDirection[axis] > 0 ? 0 : 1 );
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include <glm/glm.hpp>
+
+class VoxelChunkManager;
+
+//-----------------------
+// Rays through the resident chunks' voxels, the CPU counterpart of Raymarch.comp: the same hierarchical DDA,
+// over the chunks' occupancy (see VoxelOccupancy) rather than their voxels. Missing or empty chunks & empty bricks
+// are crossed in one step, only bricks with solid voxels get walked voxel by voxel, testing bits.
+// Voxels are hit at full resolution, whatever the chunks' LODs: coarsened chunks (see VoxelObject::Coarsen) at the detail they kept.
+
+namespace VoxelRaycast
+{
+	struct Hit
+	{
+		glm::ivec3 voxel; // world voxel coordinate
+		glm::ivec3 normal; // of the face the ray came in through, 0 when it started inside the voxel
+		float distance; // along the ray to that face
+		int8_t material;
+	};
+
+	// direction must be normalized, chunks that aren't resident count as empty
+	std::optional<Hit> Trace( const VoxelChunkManager& chunkManager, const glm::vec3& origin, const glm::vec3& direction, float maxDistance );
+} // namespace VoxelRaycast
@@ -12,13 +12,13 @@
 // #include <glm/mat4x4.hpp>
 
 #include <GameFramework/AstroApp.h>
+#include <GameFramework/AstroAppSettings.h>
 
-int main()
+int main( int argc, char** argv )
 {
-	AstroApp app;
-
 	try
 	{
+		AstroApp app( AstroAppSettings::ParseCommandLine( argc, argv ) );
 		app.Run();
 	}
 	catch( const std::exception& e )